@@ -56,7 +56,9 @@ void registerCompilation(py::module_& m) {
         .value("AllowBareValParamAssignment", CompilationFlags::AllowBareValParamAssignment)
         .value("AllowSelfDeterminedStreamConcat", CompilationFlags::AllowSelfDeterminedStreamConcat)
         .value("AllowMultiDrivenLocals", CompilationFlags::AllowMultiDrivenLocals)
-        .value("AllowMergingAnsiPorts", CompilationFlags::AllowMergingAnsiPorts);
+        .value("AllowMergingAnsiPorts", CompilationFlags::AllowMergingAnsiPorts)
+        .value("DisableInstanceCaching", CompilationFlags::DisableInstanceCaching)
+        .value("CompileConstantFunctions", CompilationFlags::CompileConstantFunctions);
 
     py::class_<CompilationOptions>(m, "CompilationOptions")
         .def(py::init<>())
@@ -66,6 +68,7 @@ void registerCompilation(py::module_& m) {
         .def_readwrite("maxConstexprDepth", &CompilationOptions::maxConstexprDepth)
         .def_readwrite("maxConstexprSteps", &CompilationOptions::maxConstexprSteps)
         .def_readwrite("maxConstexprBacktrace", &CompilationOptions::maxConstexprBacktrace)
+        .def_readwrite("maxConstexprCallCache", &CompilationOptions::maxConstexprCallCache)
         .def_readwrite("maxDefParamSteps", &CompilationOptions::maxDefParamSteps)
         .def_readwrite("maxInstanceArray", &CompilationOptions::maxInstanceArray)
         .def_readwrite("errorLimit", &CompilationOptions::errorLimit)
@@ -75,13 +78,28 @@ void registerCompilation(py::module_& m) {
         .def_readwrite("defaultTimeScale", &CompilationOptions::defaultTimeScale)
         .def_readwrite("topModules", &CompilationOptions::topModules)
         .def_readwrite("paramOverrides", &CompilationOptions::paramOverrides)
+        .def_readwrite("elabPaths", &CompilationOptions::elabPaths)
         .def_readwrite("defaultLiblist", &CompilationOptions::defaultLiblist);
 
+    py::class_<LookupCacheStats>(m, "LookupCacheStats")
+        .def_readonly("unqualifiedHits", &LookupCacheStats::unqualifiedHits)
+        .def_readonly("unqualifiedMisses", &LookupCacheStats::unqualifiedMisses)
+        .def_readonly("upwardHits", &LookupCacheStats::upwardHits)
+        .def_readonly("upwardMisses", &LookupCacheStats::upwardMisses);
+
+    py::class_<ConstexprCallCacheStats>(m, "ConstexprCallCacheStats")
+        .def_readonly("hits", &ConstexprCallCacheStats::hits)
+        .def_readonly("misses", &ConstexprCallCacheStats::misses)
+        .def_readonly("evictions", &ConstexprCallCacheStats::evictions);
+
     py::class_<Compilation> comp(m, "Compilation");
     comp.def(py::init<>())
         .def(py::init<const Bag&>(), "options"_a)
         .def_property_readonly("options", &Compilation::getOptions)
         .def_property_readonly("isFinalized", &Compilation::isFinalized)
+        .def_property_readonly("lookupCacheStats", &Compilation::getLookupCacheStats)
+        .def_property_readonly("constexprCallCacheStats",
+                               &Compilation::getConstexprCallCacheStats)
         .def_property_readonly("sourceManager", &Compilation::getSourceManager)
         .def_property_readonly("defaultLibrary", &Compilation::getDefaultLibrary)
         .def("addSyntaxTree", &Compilation::addSyntaxTree, "tree"_a)
@@ -97,7 +115,9 @@ void registerCompilation(py::module_& m) {
         .def("tryParseName", &Compilation::tryParseName, byrefint, "name"_a, "diags"_a)
         .def("createScriptScope", &Compilation::createScriptScope, byrefint)
         .def("getParseDiagnostics", &Compilation::getParseDiagnostics, byrefint)
-        .def("getSemanticDiagnostics", &Compilation::getSemanticDiagnostics, byrefint)
+        .def("getSemanticDiagnostics", py::overload_cast<>(&Compilation::getSemanticDiagnostics),
+             byrefint)
+        .def("reuseElaboration", &Compilation::reuseElaboration, "previous"_a)
         .def("getAllDiagnostics", &Compilation::getAllDiagnostics, byrefint)
         .def("addDiagnostics", &Compilation::addDiagnostics, "diagnostics"_a)
         .def("getCompilationUnit", &Compilation::getCompilationUnit, byrefint, "syntax"_a)
@@ -169,11 +189,17 @@ void registerCompilation(py::module_& m) {
 
     py::class_<Driver>(m, "Driver")
         .def(py::init<>())
-        .def_readonly("sourceManager", &Driver::sourceManager)
+        .def(py::init<SourceManager&>(), "sourceManager"_a, py::keep_alive<1, 2>())
+        .def_property_readonly(
+            "sourceManager", [](Driver& self) -> SourceManager& { return self.sourceManager; },
+            py::return_value_policy::reference_internal)
         .def_readonly("diagEngine", &Driver::diagEngine)
         .def_readonly("diagClient", &Driver::diagClient)
         .def_readonly("sourceLoader", &Driver::sourceLoader)
         .def_readonly("syntaxTrees", &Driver::syntaxTrees)
+        .def_property_readonly(
+            "includeTokenCache", [](const Driver& self) { return self.includeTokenCache.get(); },
+            py::return_value_policy::reference_internal)
         .def_readwrite("languageVersion", &Driver::languageVersion)
         .def("addStandardArgs", &Driver::addStandardArgs)
         .def(
@@ -199,7 +225,18 @@ void registerCompilation(py::module_& m) {
         .def_readwrite("numThreads", &SourceOptions::numThreads)
         .def_readwrite("singleUnit", &SourceOptions::singleUnit)
         .def_readwrite("onlyLint", &SourceOptions::onlyLint)
-        .def_readwrite("librariesInheritMacros", &SourceOptions::librariesInheritMacros);
+        .def_readwrite("librariesInheritMacros", &SourceOptions::librariesInheritMacros)
+        .def_readwrite("parallelSingleUnit", &SourceOptions::parallelSingleUnit)
+        .def_readwrite("precomputeLineOffsets", &SourceOptions::precomputeLineOffsets)
+        .def_readwrite("parseCacheDir", &SourceOptions::parseCacheDir)
+        .def_readwrite("parseCacheMaxSize", &SourceOptions::parseCacheMaxSize);
+
+    py::class_<SyntaxTreeCache, std::shared_ptr<SyntaxTreeCache>>(m, "SyntaxTreeCache")
+        .def(py::init<>())
+        .def("invalidate", &SyntaxTreeCache::invalidate, "changedFiles"_a)
+        .def_property_readonly("hits", &SyntaxTreeCache::getHits)
+        .def_property_readonly("misses", &SyntaxTreeCache::getMisses)
+        .def("__len__", &SyntaxTreeCache::size);
 
     py::class_<SourceLoader> sourceLoader(m, "SourceLoader");
     sourceLoader.def(py::init<SourceManager&>(), "sourceManager"_a)
@@ -213,6 +250,7 @@ void registerCompilation(py::module_& m) {
              "defines"_a, "libraryName"_a)
         .def("loadSources", &SourceLoader::loadSources)
         .def("loadAndParseSources", &SourceLoader::loadAndParseSources, "optionBag"_a)
+        .def("setTreeCache", &SourceLoader::setTreeCache, "cache"_a)
         .def_property_readonly("hasFiles", &SourceLoader::hasFiles)
         .def_property_readonly("libraryMaps", &SourceLoader::getLibraryMaps)
         .def_property_readonly("errors", &SourceLoader::getErrors);
@@ -268,7 +268,14 @@ void registerSyntax(py::module_& m) {
     py::class_<LexerOptions>(m, "LexerOptions")
         .def(py::init<>())
         .def_readwrite("maxErrors", &LexerOptions::maxErrors)
-        .def_readwrite("languageVersion", &LexerOptions::languageVersion);
+        .def_readwrite("languageVersion", &LexerOptions::languageVersion)
+        .def_readwrite("discardTrivia", &LexerOptions::discardTrivia);
+
+    py::class_<IncludeTokenCache>(m, "IncludeTokenCache")
+        .def(py::init<>())
+        .def_property_readonly("hits", &IncludeTokenCache::getHits)
+        .def_property_readonly("misses", &IncludeTokenCache::getMisses)
+        .def("__len__", &IncludeTokenCache::size);
 
     py::class_<PreprocessorOptions>(m, "PreprocessorOptions")
         .def(py::init<>())
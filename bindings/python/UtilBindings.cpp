@@ -106,8 +106,8 @@ void registerUtil(py::module_& m) {
         .def_readonly("data", &SourceBuffer::data)
         .def("__bool__", &SourceBuffer::operator bool);
 
-    py::class_<SourceManager>(m, "SourceManager")
-        .def(py::init<>())
+    py::class_<SourceManager> sourceManager(m, "SourceManager");
+    sourceManager.def(py::init<>())
         .def(
             "addSystemDirectories",
             [](SourceManager& self, std::string_view path) {
@@ -170,6 +170,7 @@ void registerUtil(py::module_& m) {
             },
             "path"_a, "includedFrom"_a, "library"_a, "isSystemPath"_a)
         .def("isCached", &SourceManager::isCached, "path"_a)
+        .def("invalidateChangedFiles", &SourceManager::invalidateChangedFiles)
         .def("setDisableProximatePaths", &SourceManager::setDisableProximatePaths, "set"_a)
         .def("addLineDirective", &SourceManager::addLineDirective, "location"_a, "lineNum"_a,
              "name"_a, "level"_a)
@@ -177,6 +178,10 @@ void registerUtil(py::module_& m) {
              "name"_a, "severity"_a)
         .def("getAllBuffers", &SourceManager::getAllBuffers);
 
+    py::class_<SourceManager::ChangedFile>(sourceManager, "ChangedFile")
+        .def_readonly("path", &SourceManager::ChangedFile::path)
+        .def_readonly("wasIncluded", &SourceManager::ChangedFile::wasIncluded);
+
     py::class_<VersionInfo>(m, "VersionInfo")
         .def_static("getMajor", &VersionInfo::getMajor)
         .def_static("getMinor", &VersionInfo::getMinor)
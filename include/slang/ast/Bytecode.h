@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------------
+//! @file Bytecode.h
+//! @brief Bytecode compilation and execution of constant functions
+//
+// SPDX-FileCopyrightText: Michael Popoloski
+// SPDX-License-Identifier: MIT
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "slang/ast/Lookup.h"
+#include "slang/numeric/ConstantValue.h"
+#include "slang/text/SourceLocation.h"
+
+namespace slang::ast {
+
+class EvalContext;
+class Expression;
+class Statement;
+class SubroutineSymbol;
+class ValueSymbol;
+
+/// @brief The body of a constant function compiled to a register-based bytecode.
+///
+/// Evaluating a constant function by walking its statement and expression trees spends
+/// much of its time dispatching on node kinds and looking up local variables by symbol.
+/// The bytecode form refers to locals and temporaries by slot index and runs in a single
+/// interpreter loop. Expressions and statements that aren't compiled are handed back to
+/// the tree walker one at a time; this works because the slots for local variables point
+/// at the same storage the tree walker uses for them in the current stack frame.
+class SLANG_EXPORT Bytecode {
+public:
+    /// Compiles the body of the given subroutine. Returns nullptr if the body contains
+    /// something that prevents it from being compiled, in which case calls need to be
+    /// evaluated by walking the AST instead.
+    static std::unique_ptr<Bytecode> compile(const SubroutineSymbol& subroutine);
+
+    /// Evaluates a call of the compiled subroutine, given argument values that have
+    /// already been evaluated by the caller.
+    ConstantValue run(EvalContext& context, SourceLocation callLocation,
+                      LookupLocation lookupLocation, std::span<ConstantValue> args) const;
+
+    /// Gets the number of instructions in the compiled body.
+    size_t size() const { return code.size(); }
+
+private:
+    class Compiler;
+
+    enum class Opcode : uint8_t {
+        Step,
+        StaticInitSkipped,
+        SysTaskIgnored,
+        Move,
+        Tree,
+        TreeStmt,
+        CheckCall,
+        Call,
+        Unary,
+        IncDec,
+        Binary,
+        Convert,
+        Select,
+        StoreSelect,
+        Jump,
+        JumpIfTrue,
+        JumpIfFalse,
+        JumpIfNotTrue,
+        JumpIfUnknown,
+        ClearItem,
+        MarkItem,
+        SwitchItem,
+        Return
+    };
+
+    // Operands are slot indices, jump targets, or indices into the side tables,
+    // depending on the opcode. The AST node is whatever the instruction was
+    // compiled from and supplies operators, types, and source ranges.
+    struct Instruction {
+        Opcode op;
+        uint32_t a = 0;
+        uint32_t b = 0;
+        uint32_t c = 0;
+        const Expression* expr = nullptr;
+        const Statement* stmt = nullptr;
+    };
+
+    explicit Bytecode(const SubroutineSymbol& subroutine) : subroutine(&subroutine) {}
+
+    bool execute(EvalContext& context, std::span<ConstantValue*> slots) const;
+
+    const SubroutineSymbol* subroutine;
+    std::vector<Instruction> code;
+    std::vector<ConstantValue> constants;
+    std::vector<std::vector<uint32_t>> jumpTables;
+
+    // The first slots belong to local variables, starting with the arguments and the
+    // return value, and are bound to storage in the stack frame on entry. The remaining
+    // slots are temporaries owned by the interpreter.
+    std::vector<const ValueSymbol*> locals;
+    uint32_t numSlots = 0;
+    uint32_t returnSlot = 0;
+};
+
+} // namespace slang::ast
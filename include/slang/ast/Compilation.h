@@ -15,12 +15,17 @@
 #include "slang/numeric/Time.h"
 #include "slang/syntax/SyntaxFwd.h"
 #include "slang/syntax/SyntaxNode.h"
+#include "slang/util/BKTree.h"
 #include "slang/util/Bag.h"
 #include "slang/util/BumpAllocator.h"
 #include "slang/util/IntervalMap.h"
 #include "slang/util/LanguageVersion.h"
 #include "slang/util/SafeIndexedVector.h"
 
+namespace slang {
+class ThreadPool;
+}
+
 namespace slang::syntax {
 class SyntaxTree;
 }
@@ -29,11 +34,15 @@ namespace slang::ast {
 
 class AttributeSymbol;
 class ASTContext;
+class Bytecode;
 class CompilationUnitSymbol;
 class ConfigBlockSymbol;
 class DefinitionSymbol;
+class EvalFrameLayout;
 class Expression;
 class GenericClassDefSymbol;
+class InstanceBodySymbol;
+class InstanceSymbol;
 class InterfacePortSymbol;
 class MethodPrototypeSymbol;
 class ModportSymbol;
@@ -48,6 +57,7 @@ class SystemSubroutine;
 class ValueDriver;
 struct AssertionInstanceDetails;
 struct ConfigRule;
+struct DiagnosticVisitor;
 struct ResolvedConfig;
 
 using DriverIntervalMap = IntervalMap<uint64_t, const ValueDriver*>;
@@ -129,9 +139,18 @@ enum class SLANG_EXPORT CompilationFlags {
 
     /// Allow merging ANSI port declarations with nets and variables
     /// declared in the module body.
-    AllowMergingAnsiPorts = 1 << 14
+    AllowMergingAnsiPorts = 1 << 14,
+
+    /// Disable sharing of elaborated bodies between instances that have the
+    /// same definition, parameter values, and interface port connections.
+    /// Normally only one such body is fully elaborated and the rest are skipped.
+    DisableInstanceCaching = 1 << 15,
+
+    /// Evaluate calls to constant functions by compiling their bodies to bytecode
+    /// instead of walking their statement and expression trees.
+    CompileConstantFunctions = 1 << 16
 };
-SLANG_BITMASK(CompilationFlags, AllowMergingAnsiPorts)
+SLANG_BITMASK(CompilationFlags, CompileConstantFunctions)
 
 /// Contains various options that can control compilation behavior.
 struct SLANG_EXPORT CompilationOptions {
@@ -162,6 +181,11 @@ struct SLANG_EXPORT CompilationOptions {
     /// before abbreviating them.
     uint32_t maxConstexprBacktrace = 10;
 
+    /// The maximum number of results of constant function calls to remember
+    /// so that later calls with the same arguments can reuse them. Setting this
+    /// to zero disables memoization of constant function calls.
+    uint32_t maxConstexprCallCache = 16384;
+
     /// The maximum number of iterations to try to resolve defparams before
     /// giving up due to potentially cyclic dependencies in parameter values.
     uint32_t maxDefParamSteps = 128;
@@ -204,6 +228,13 @@ struct SLANG_EXPORT CompilationOptions {
     /// A list of library names, in the order in which they should be searched
     /// when binding cells to instances.
     std::vector<std::string> defaultLiblist;
+
+    /// If non-empty, specifies hierarchical paths to the instances (or instance arrays
+    /// or generate blocks) that should be elaborated when collecting semantic diagnostics.
+    /// Instances that aren't within one of these paths are skipped, except for the
+    /// instances above them, which are elaborated without their other child instances.
+    /// This allows checking one part of a large design without paying for the rest of it.
+    std::vector<std::string> elabPaths;
 };
 
 /// Information about how a bind directive applies to some definition
@@ -258,6 +289,40 @@ struct SLANG_EXPORT HierarchyOverrideNode {
     std::vector<std::pair<BindDirectiveInfo, const syntax::SyntaxNode*>> binds;
 };
 
+/// Counters that describe how effective the caching of name lookup
+/// results has been for a compilation.
+struct SLANG_EXPORT LookupCacheStats {
+    /// The number of unqualified lookups that continued into a parent
+    /// scope and were answered from the cache.
+    uint64_t unqualifiedHits = 0;
+
+    /// The number of unqualified lookups that continued into a parent
+    /// scope and had to be resolved there.
+    uint64_t unqualifiedMisses = 0;
+
+    /// The number of upward hierarchical lookups whose candidate
+    /// scopes and instances were found in the cache.
+    uint64_t upwardHits = 0;
+
+    /// The number of upward hierarchical lookups whose candidate
+    /// scopes and instances had to be searched for.
+    uint64_t upwardMisses = 0;
+};
+
+/// Counters that describe how effective the memoization of
+/// constant function calls has been for a compilation.
+struct SLANG_EXPORT ConstexprCallCacheStats {
+    /// The number of calls whose result was found in the cache.
+    uint64_t hits = 0;
+
+    /// The number of calls of memoizable functions that had to be evaluated.
+    uint64_t misses = 0;
+
+    /// The number of cached results that were discarded to stay within
+    /// the configured size limit.
+    uint64_t evictions = 0;
+};
+
 /// A centralized location for creating and caching symbols. This includes
 /// creating symbols from syntax nodes as well as fabricating them synthetically.
 /// Common symbols such as built in types are exposed here as well.
@@ -307,6 +372,17 @@ public:
     /// Indicates whether the design has been compiled and can no longer accept modifications.
     bool isFinalized() const { return finalized; }
 
+    /// Gets counters that describe how many name lookups have been answered from the
+    /// compilation's cache of lookup results. Results are only cached once the compilation
+    /// has been finalized.
+    const LookupCacheStats& getLookupCacheStats() const { return lookupCacheStats; }
+
+    /// Gets counters that describe how many constant function calls have been
+    /// answered from the compilation's cache of call results.
+    const ConstexprCallCacheStats& getConstexprCallCacheStats() const {
+        return constexprCallCacheStats;
+    }
+
     /// Gets the diagnostics produced during lexing, preprocessing, and syntax parsing.
     const Diagnostics& getParseDiagnostics();
 
@@ -316,6 +392,35 @@ public:
     /// for lazy evaluation.
     const Diagnostics& getSemanticDiagnostics();
 
+    /// Gets the diagnostics produced during semantic analysis, like @a getSemanticDiagnostics,
+    /// but uses the threads in @a threadPool to elaborate independent subtrees of the instance
+    /// hierarchy concurrently. Each thread elaborates its share of the design using a separate
+    /// compilation object over the same syntax trees, and the results are merged back together
+    /// such that the returned diagnostics are the same as the ones serial elaboration reports.
+    /// Parts of the design that can't be elaborated independently, such as instances that
+    /// are the target of hierarchical references from elsewhere in the design, are elaborated
+    /// serially instead.
+    ///
+    /// Note that the symbols in the hierarchy that was elaborated on another thread will
+    /// only be partially elaborated in this compilation's AST; they will be lazily elaborated
+    /// on demand when accessed. If elaboration stops early because the error limit is reached
+    /// or the hierarchy is too deep, the exact set of diagnostics reported may differ.
+    const Diagnostics& getSemanticDiagnostics(ThreadPool& threadPool);
+
+    /// Seeds this compilation with the results of elaborating @a previous, which should be
+    /// an earlier version of the same design, compiled with the same options, that has
+    /// already been elaborated with @a getSemanticDiagnostics(ThreadPool&). When this
+    /// compilation is elaborated the same way, subtrees of the hierarchy whose definitions
+    /// all come from syntax trees that are shared with @a previous (and which none of the
+    /// changed syntax trees could affect) reuse the previous results instead of being
+    /// elaborated again.
+    ///
+    /// Syntax trees are only considered unchanged if the same tree object was added to both
+    /// compilations. Nothing is reused if any added or removed tree contains anything other
+    /// than module, interface, and program declarations. Elaboration results can be shared
+    /// by several compilations, but only one of them may be elaborated at a time.
+    void reuseElaboration(const Compilation& previous);
+
     /// Gets all of the diagnostics produced during compilation.
     const Diagnostics& getAllDiagnostics();
 
@@ -546,6 +651,31 @@ public:
     /// if no such declaration is in effect.
     const Expression* getDefaultDisable(const Scope& scope) const;
 
+    /// Gets the bytecode for the body of the given constant function, compiling it
+    /// the first time it's requested. Returns nullptr if the body can't be compiled.
+    const Bytecode* getConstantFunctionBytecode(const SubroutineSymbol& subroutine);
+
+    /// Gets the layout of local variables in stack frames used to evaluate calls
+    /// to the given subroutine, creating it the first time it's requested.
+    const EvalFrameLayout& getEvalFrameLayout(const SubroutineSymbol& subroutine);
+
+    /// Indicates whether the results of calls to the given constant function can be
+    /// memoized, which requires that they depend only on the values of the arguments.
+    /// Functions that reference anything other than their own locals, parameters,
+    /// and enum values, or that call system tasks or other functions that can't be
+    /// memoized, are excluded.
+    bool canMemoizeConstexprCalls(const SubroutineSymbol& subroutine);
+
+    /// Looks up the memoized result of calling the given constant function with the given
+    /// argument values. Returns nullptr if there is no such result.
+    const ConstantValue* findConstexprCallResult(const SubroutineSymbol& subroutine,
+                                                 std::span<const ConstantValue> args);
+
+    /// Records the result of calling the given constant function with the given argument
+    /// values, for later calls to reuse. This does nothing if memoization is disabled.
+    void addConstexprCallResult(const SubroutineSymbol& subroutine,
+                                std::vector<ConstantValue> args, const ConstantValue& result);
+
     /// Notes the existence of an extern module/interface/program/primitive declaration.
     void noteExternDefinition(const Scope& scope, const syntax::SyntaxNode& syntax);
 
@@ -725,6 +855,20 @@ private:
         const ResolvedConfig* resolvedConfig = nullptr;
     };
 
+    // A map from diag code + location to the diagnostics that have occurred at that location.
+    // This is used to collapse duplicate diagnostics across instantiations into a single report.
+    using DiagMap = flat_hash_map<std::tuple<DiagCode, SourceLocation>, std::vector<Diagnostic>>;
+
+    // A subtree of the hierarchy that was elaborated by a worker compilation, along with
+    // the references and interface port uses that were found within it.
+    struct ElabPartition {
+        std::string path;
+        std::shared_ptr<Compilation> compilation;
+        const InstanceSymbol* instance = nullptr;
+        flat_hash_set<const DefinitionSymbol*> usedIfacePorts;
+        flat_hash_map<const syntax::SyntaxNode*, std::pair<bool, bool>> references;
+    };
+
     // These functions are called by Scopes to create and track various members.
     Scope::DeferredMemberData& getOrAddDeferredData(Scope::DeferredMemberIndex& index);
 
@@ -737,6 +881,15 @@ private:
 
     const RootSymbol& getRoot(bool skipDefParamsAndBinds);
     void elaborate();
+    bool elaborateParallel(ThreadPool& threadPool);
+    void finishElaboration(DiagnosticVisitor& elabVisitor);
+    void checkBindsAndNameConflicts();
+    void findElabPaths(SmallVector<const Symbol*>& results);
+    flat_hash_map<std::string_view, ElabPartition*> findReusablePartitions();
+    Diagnostics coalesceDiagnostics(
+        DiagMap& diags, flat_hash_map<const InstanceBodySymbol*, size_t>& pathCounts,
+        const flat_hash_map<const syntax::SyntaxNode*, const DefinitionSymbol*>* defsBySyntax =
+            nullptr);
     void insertDefinition(Symbol& symbol, const Scope& scope);
     void parseParamOverrides(flat_hash_map<std::string_view, const ConstantValue*>& results);
     void checkDPIMethods(std::span<const SubroutineSymbol* const> dpiImports);
@@ -756,6 +909,14 @@ private:
         const ConfigRule* configRule, const std::vector<Symbol*>& defList) const;
     Diagnostic* errorMissingDef(std::string_view name, const Scope& scope, SourceRange sourceRange,
                                 DiagCode code) const;
+    void noteSharedInstances(
+        std::span<const std::pair<const InstanceSymbol*, const InstanceBodySymbol*>> instances);
+    void countInstantiations(const Scope& scope,
+                             flat_hash_map<const DefinitionSymbol*, size_t>& counts);
+    std::span<const std::pair<const DefinitionSymbol*, size_t>> getNestedInstantiations(
+        const InstanceBodySymbol& body);
+    size_t getInstancePathCount(const InstanceBodySymbol& body,
+                                flat_hash_map<const InstanceBodySymbol*, size_t>& cache) const;
 
     // Stored options object.
     CompilationOptions options;
@@ -837,9 +998,7 @@ private:
     // A list of all created definitions, as storage for their memory.
     std::vector<std::unique_ptr<DefinitionSymbol>> definitionMemory;
 
-    // A map from diag code + location to the diagnostics that have occurred at that location.
-    // This is used to collapse duplicate diagnostics across instantiations into a single report.
-    using DiagMap = flat_hash_map<std::tuple<DiagCode, SourceLocation>, std::vector<Diagnostic>>;
+    // The diagnostics that have been issued, keyed by code + location.
     DiagMap diagMap;
 
     // A list of libraries that control the order in which we search for cell bindings.
@@ -920,6 +1079,18 @@ private:
     // A list of name conflicts to later resolve by issuing diagnostics.
     std::vector<const Symbol*> nameConflicts;
 
+    // A map of instance bodies that were elaborated in place of identical bodies
+    // to the other instances that share them. Diagnostics issued in one of these
+    // bodies are counted as also applying to each of the sharing instances.
+    flat_hash_map<const InstanceBodySymbol*, std::vector<const InstanceSymbol*>>
+        sharedInstanceBodies;
+
+    // A cache of the definitions instantiated within shared instance bodies,
+    // along with how many times each was instantiated.
+    flat_hash_map<const InstanceBodySymbol*,
+                  std::vector<std::pair<const DefinitionSymbol*, size_t>>>
+        nestedInstantiations;
+
     // A map of scopes to default clocking blocks.
     flat_hash_map<const Scope*, const Symbol*> defaultClockingMap;
 
@@ -945,12 +1116,117 @@ private:
     flat_hash_map<std::tuple<std::string_view, const Scope*>, const syntax::SyntaxNode*>
         externDefMap;
 
+    // Compiled bodies of constant functions, or nullptr for those that
+    // couldn't be compiled. See getConstantFunctionBytecode.
+    flat_hash_map<const SubroutineSymbol*, std::unique_ptr<Bytecode>> bytecodeMap;
+
+    // Layouts of local variables for evaluating calls to subroutines.
+    // See getEvalFrameLayout.
+    flat_hash_map<const SubroutineSymbol*, std::unique_ptr<EvalFrameLayout>> frameLayoutMap;
+
+    // Memoized results of constant function calls, keyed by the function and the argument
+    // values. The hash and equality functions are transparent so that lookups can be done
+    // with a span of arguments without copying them. See findConstexprCallResult.
+    struct ConstexprCallKey {
+        const SubroutineSymbol* subroutine;
+        std::vector<ConstantValue> args;
+    };
+    struct ConstexprCallRef {
+        const SubroutineSymbol* subroutine;
+        std::span<const ConstantValue> args;
+    };
+    struct ConstexprCallHash {
+        using is_transparent = void;
+        size_t operator()(const ConstexprCallRef& ref) const;
+        size_t operator()(const ConstexprCallKey& key) const {
+            return (*this)(ConstexprCallRef{key.subroutine, key.args});
+        }
+    };
+    struct ConstexprCallEqual {
+        using is_transparent = void;
+        bool operator()(const ConstexprCallRef& lhs, const ConstexprCallRef& rhs) const;
+        bool operator()(const ConstexprCallKey& lhs, const ConstexprCallKey& rhs) const {
+            return (*this)(ConstexprCallRef{lhs.subroutine, lhs.args},
+                           ConstexprCallRef{rhs.subroutine, rhs.args});
+        }
+        bool operator()(const ConstexprCallRef& lhs, const ConstexprCallKey& rhs) const {
+            return (*this)(lhs, ConstexprCallRef{rhs.subroutine, rhs.args});
+        }
+        bool operator()(const ConstexprCallKey& lhs, const ConstexprCallRef& rhs) const {
+            return (*this)(ConstexprCallRef{lhs.subroutine, lhs.args}, rhs);
+        }
+    };
+    flat_hash_map<ConstexprCallKey, ConstantValue, ConstexprCallHash, ConstexprCallEqual>
+        constexprCallCache;
+
+    // Whether calls to each constant function can be memoized.
+    // See canMemoizeConstexprCalls.
+    flat_hash_map<const SubroutineSymbol*, bool> memoizableFunctions;
+
+    ConstexprCallCacheStats constexprCallCacheStats;
+
+    // Results of unqualified lookups that continued into a parent scope, keyed by the
+    // parent scope, name, lookup flags, location within the parent scope, out-of-block
+    // index and whether a source range was provided. The stored symbol is the import that
+    // was noted as referenced by the lookup, if any. See Lookup::unqualifiedImpl.
+    struct CachedLookup {
+        const Symbol* found = nullptr;
+        bitmask<LookupResultFlags> flags;
+        const Symbol* import = nullptr;
+    };
+    flat_hash_map<std::tuple<const Scope*, std::string_view, uint32_t, uint32_t, uint32_t, bool>,
+                  CachedLookup>
+        unqualifiedLookupCache;
+
+    // Symbols that upward hierarchical lookups for a given name starting in a given scope
+    // try to match, in order. Instance bodies in the list are the points past which the
+    // lookup depends on where the body is instantiated. See Lookup::findUpwardCandidates.
+    flat_hash_map<std::tuple<const Scope*, std::string_view>, std::vector<const Symbol*>>
+        upwardLookupCache;
+
+    // Indices of the names of members of scopes and the packages they import, built on
+    // demand to find typo corrections for undeclared identifiers. The last member of the
+    // scope is recorded so that the index can be rebuilt if members are added later.
+    // See Lookup::reportUndeclared.
+    struct MemberNameIndex {
+        BKTree names;
+        std::vector<const Symbol*> members;
+        const Symbol* lastMember = nullptr;
+    };
+    flat_hash_map<const Scope*, MemberNameIndex> memberNameIndices;
+
+    LookupCacheStats lookupCacheStats;
+
+    // The import that the most recent unqualified lookup noted as referenced, so that
+    // cached results can note it again.
+    const Symbol* lastLookupImport = nullptr;
+
+    // The number of scopes currently being elaborated, and a counter that is bumped whenever
+    // something happens that could make a lookup in progress give a different result later,
+    // such as a scope starting elaboration. Lookups are only cached when they finish without
+    // any scopes elaborating and without the counter changing.
+    uint32_t numScopesElaborating = 0;
+    uint64_t lookupCacheGeneration = 0;
+
     // The built-in std package.
     const PackageSymbol* stdPkg = nullptr;
 
     // The default library.
     std::unique_ptr<SourceLibrary> defaultLibMem;
     const SourceLibrary* defaultLibPtr;
+
+    // Compilations that elaborated parts of the hierarchy on other threads. These are kept
+    // alive because the diagnostics they issued refer to their symbols.
+    std::vector<std::shared_ptr<Compilation>> elabWorkers;
+
+    // The parts of the hierarchy that were elaborated by worker compilations,
+    // which later compilations of the same design can reuse.
+    std::vector<ElabPartition> elabPartitions;
+
+    // Partitions of a previous compilation that this one may reuse,
+    // along with the syntax trees that the previous compilation was built from.
+    std::vector<ElabPartition> reusablePartitions;
+    std::vector<std::shared_ptr<syntax::SyntaxTree>> previousTrees;
 };
 
 } // namespace slang::ast
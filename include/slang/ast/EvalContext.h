@@ -8,10 +8,13 @@
 #pragma once
 
 #include <map>
+#include <optional>
+#include <vector>
 
 #include "slang/ast/ASTContext.h"
 #include "slang/numeric/ConstantValue.h"
 #include "slang/text/SourceLocation.h"
+#include "slang/util/Hash.h"
 #include "slang/util/ScopeGuard.h"
 
 namespace slang::ast {
@@ -21,6 +24,34 @@ class LValue;
 class SubroutineSymbol;
 class ValueSymbol;
 
+/// @brief Assigns dense indices to the local variables of a subroutine.
+///
+/// Stack frames for calls of the subroutine store these locals contiguously
+/// by index instead of in a map keyed by symbol. The layout covers the
+/// arguments, the return value, and every variable declared in the body.
+class SLANG_EXPORT EvalFrameLayout {
+public:
+    /// Constructs the layout for the given subroutine, binding its body if needed.
+    explicit EvalFrameLayout(const SubroutineSymbol& subroutine);
+
+    /// Gets the locals in the layout, ordered by index.
+    std::span<const ValueSymbol* const> getLocals() const { return locals; }
+
+    /// Gets the index of the given local, or nullopt if it's not in the layout.
+    std::optional<uint32_t> find(const ValueSymbol* symbol) const {
+        if (auto it = indices.find(symbol); it != indices.end())
+            return it->second;
+        return std::nullopt;
+    }
+
+    /// Gets the number of locals in the layout.
+    size_t size() const { return locals.size(); }
+
+private:
+    std::vector<const ValueSymbol*> locals;
+    flat_hash_map<const ValueSymbol*, uint32_t> indices;
+};
+
 /// @brief A container for all context required to evaluate a statement or expression.
 ///
 /// Mostly this involves tracking the callstack and maintaining
@@ -35,10 +66,19 @@ public:
 
     /// Represents a single frame in the call stack.
     struct Frame {
-        /// A set of temporary values materialized within the stack frame.
+        /// Storage for the locals in the frame layout, indexed by their position
+        /// in the layout. Locals that haven't been created yet are empty.
+        /// The storage is sized when the frame is pushed and never reallocated.
+        std::vector<std::optional<ConstantValue>> locals;
+
+        /// A set of temporary values materialized within the stack frame that
+        /// aren't part of the frame layout, such as iteration variables.
         /// Uses a map so that the values don't move around in memory.
         std::map<const ValueSymbol*, ConstantValue> temporaries;
 
+        /// The layout of locals for the function being executed, if any.
+        const EvalFrameLayout* layout = nullptr;
+
         /// The function that is being executed in this frame, if any.
         const SubroutineSymbol* subroutine = nullptr;
 
@@ -161,6 +201,10 @@ public:
     /// Gets the set of diagnostics that have been produced during constant evaluation.
     Diagnostics getAllDiagnostics() const;
 
+    /// Gets the number of diagnostics that have been produced during constant evaluation
+    /// and not yet issued to the AST context.
+    size_t getDiagnosticCount() const { return diags.size() + warnings.size(); }
+
     /// Records a diagnostic under the current evaluation context.
     Diagnostic& addDiag(DiagCode code, SourceLocation location);
 
@@ -184,6 +228,10 @@ private:
     const ConstantValue* queueTarget = nullptr;
     SmallVector<Frame> stack;
     SmallVector<LValue*> lvalStack;
+
+    // Storage for locals from frames that have been popped, kept around
+    // so that later calls can reuse their allocations.
+    SmallVector<std::vector<std::optional<ConstantValue>>> localsPool;
     Diagnostics diags;
     Diagnostics warnings;
     SourceRange disableRange;
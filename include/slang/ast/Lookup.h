@@ -337,6 +337,9 @@ private:
     static void qualified(const syntax::ScopedNameSyntax& syntax, const ASTContext& context,
                           bitmask<LookupFlags> flags, LookupResult& result);
 
+    static void findUpwardCandidates(const Scope& scope, std::string_view name,
+                                     SmallVectorBase<const Symbol*>& results);
+
     static void reportUndeclared(const Scope& scope, std::string_view name, SourceRange range,
                                  bitmask<LookupFlags> flags, bool isHierarchical,
                                  LookupResult& result);
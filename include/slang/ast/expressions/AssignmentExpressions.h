@@ -118,6 +118,10 @@ public:
     Expression& operand() { return *operand_; }
 
     ConstantValue evalImpl(EvalContext& context) const;
+
+    /// Applies the conversion to an already evaluated operand value.
+    ConstantValue applyTo(EvalContext& context, ConstantValue&& value) const;
+
     std::optional<bitwidth_t> getEffectiveWidthImpl() const;
     EffectiveSign getEffectiveSignImpl(bool isForConversion) const;
 
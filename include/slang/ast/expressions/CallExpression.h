@@ -86,6 +86,12 @@ public:
     bool hasOutputArgs() const;
 
     ConstantValue evalImpl(EvalContext& context) const;
+
+    /// Evaluates a call of a user-defined subroutine using argument values
+    /// that have already been evaluated by the caller, who is also responsible
+    /// for having checked the call with @a checkConstant first.
+    ConstantValue evalWithArgs(EvalContext& context, std::span<ConstantValue> args) const;
+
     std::optional<bitwidth_t> getEffectiveWidthImpl() const;
 
     void serializeTo(ASTSerializer& serializer) const;
@@ -128,6 +134,11 @@ public:
                          std::string_view symbolName, SourceRange range, const ASTContext& context,
                          SmallVectorBase<const Expression*>& boundArgs, bool isBuiltInMethod);
 
+    /// Checks whether the given subroutine can be called in a constant expression,
+    /// issuing a diagnostic to the context if not.
+    static bool checkConstant(EvalContext& context, const SubroutineSymbol& subroutine,
+                              SourceRange range);
+
     static bool isKind(ExpressionKind kind) { return kind == ExpressionKind::Call; }
 
     template<typename TVisitor>
@@ -168,8 +179,7 @@ private:
         const syntax::ArrayOrRandomizeMethodExpressionSyntax* withClause, SourceRange range,
         const ASTContext& context, const Scope* randomizeScope = nullptr);
 
-    static bool checkConstant(EvalContext& context, const SubroutineSymbol& subroutine,
-                              SourceRange range);
+    ConstantValue evalBody(EvalContext& context, std::span<ConstantValue> args) const;
 
     const Expression* thisClass_;
     std::span<const Expression*> arguments_;
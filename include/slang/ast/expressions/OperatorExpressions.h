@@ -32,6 +32,11 @@ public:
     Expression& operand() { return *operand_; }
 
     ConstantValue evalImpl(EvalContext& context) const;
+
+    /// Applies the operator to an already evaluated operand value.
+    /// Only valid for operators that don't require an lvalue.
+    ConstantValue applyTo(ConstantValue&& value) const;
+
     bool propagateType(const ASTContext& context, const Type& newType, SourceRange opRange);
     std::optional<bitwidth_t> getEffectiveWidthImpl() const;
     EffectiveSign getEffectiveSignImpl(bool isForConversion) const;
@@ -88,6 +93,13 @@ public:
     Expression& right() { return *right_; }
 
     ConstantValue evalImpl(EvalContext& context) const;
+
+    /// Applies the operator to already evaluated operand values. Short-circuiting
+    /// of the logical operators is up to the caller.
+    ConstantValue applyTo(const ConstantValue& cvl, const ConstantValue& cvr) const {
+        return evalBinaryOperator(op, cvl, cvr);
+    }
+
     bool propagateType(const ASTContext& context, const Type& newType, SourceRange opRange);
     std::optional<bitwidth_t> getEffectiveWidthImpl() const;
     EffectiveSign getEffectiveSignImpl(bool isForConversion) const;
@@ -44,6 +44,12 @@ public:
     std::optional<ConstantRange> evalIndex(EvalContext& context, const ConstantValue& val,
                                            ConstantValue& associativeIndex, bool& softFail) const;
 
+    /// Translates an already evaluated selector value into the range of @a val
+    /// that it selects. Not valid for associative arrays.
+    std::optional<ConstantRange> translateIndex(EvalContext& context, const ConstantValue& val,
+                                                const ConstantValue& selectorValue,
+                                                bool& softFail) const;
+
     void serializeTo(ASTSerializer& serializer) const;
 
     static Expression& fromSyntax(Compilation& compilation, Expression& value,
@@ -104,6 +104,12 @@ public:
     const PortConnection* getPortConnection(const InterfacePortSymbol& port) const;
     std::span<const PortConnection* const> getPortConnections() const;
 
+    /// If elaboration found this instance to be identical to another instance, so that
+    /// only the other instance's body was elaborated, returns that other body.
+    /// Otherwise returns nullptr. This instance's own body remains valid and is
+    /// elaborated on demand if anything looks inside it.
+    const InstanceBodySymbol* getCanonicalBody() const { return canonicalBody; }
+
     void serializeTo(ASTSerializer& serializer) const;
 
     static void fromSyntax(Compilation& compilation,
@@ -145,11 +151,14 @@ public:
     void visitExprs(TVisitor&& visitor) const; // implementation is in ASTVisitor.h
 
 private:
+    friend class Compilation;
+
     void resolvePortConnections() const;
     void connectDefaultIfacePorts() const;
 
     mutable PointerMap* connectionMap = nullptr;
     mutable std::span<const PortConnection* const> connections;
+    mutable const InstanceBodySymbol* canonicalBody = nullptr;
 };
 
 class SLANG_EXPORT InstanceBodySymbol : public Symbol, public Scope {
@@ -164,6 +173,12 @@ public:
     /// Flags that describe properties of the instance.
     bitmask<InstanceFlags> flags;
 
+    /// Set if anything within this body (including any instances nested within it)
+    /// refers to or drives symbols elsewhere in the hierarchy, such as through an
+    /// upward hierarchical name. The contents of such a body depend on where it is
+    /// instantiated, so it can't be shared with other instances that look identical.
+    mutable bool isLocationDependent = false;
+
     InstanceBodySymbol(Compilation& compilation, const DefinitionSymbol& definition,
                        const HierarchyOverrideNode* hierarchyOverrideNode,
                        bitmask<InstanceFlags> flags);
@@ -184,6 +199,18 @@ public:
 
     bool hasSameType(const InstanceBodySymbol& other) const;
 
+    /// Notes that @a source refers to or drives @a target, which may live in a
+    /// different part of the hierarchy. Every instance body between the two
+    /// (not counting those that contain both) is marked as location dependent.
+    /// If @a target is null or not within any instance, every body containing
+    /// @a source is marked.
+    static void noteExternalReference(const Symbol& source, const Symbol* target);
+
+    /// Gets the body of the instance that contains @a symbol, if any. Symbols
+    /// within checker instances are considered to be contained by the body that
+    /// the checker was instantiated in.
+    static const InstanceBodySymbol* getContainingBody(const Symbol* symbol);
+
     static InstanceBodySymbol& fromDefinition(
         Compilation& compilation, const DefinitionSymbol& definition, SourceLocation instanceLoc,
         bitmask<InstanceFlags> flags, const HierarchyOverrideNode* hierarchyOverrideNode,
@@ -10,6 +10,7 @@
 
 #include "slang/diagnostics/DiagnosticEngine.h"
 #include "slang/driver/SourceLoader.h"
+#include "slang/parsing/IncludeTokenCache.h"
 #include "slang/text/SourceManager.h"
 #include "slang/util/Bag.h"
 #include "slang/util/CommandLine.h"
@@ -55,13 +56,16 @@ namespace slang::driver {
 /// @endcode
 ///
 class SLANG_EXPORT Driver {
+    // Declared first so that it gets constructed before the members that refer to it.
+    std::unique_ptr<SourceManager> ownedSourceManager;
+
 public:
     /// The command line object that will be used to parse
     /// arguments if the @a parseCommandLine method is called.
     CommandLine cmdLine;
 
     /// The source manager that holds all loaded source files.
-    SourceManager sourceManager;
+    SourceManager& sourceManager;
 
     /// The diagnostics engine that will be used to report diagnostics.
     DiagnosticEngine diagEngine;
@@ -75,6 +79,11 @@ public:
     /// A list of syntax trees that have been parsed.
     std::vector<std::shared_ptr<syntax::SyntaxTree>> syntaxTrees;
 
+    /// A cache of lexed include files that is shared by all parsed sources.
+    /// This is only set when the cacheIncludes option is enabled; its hit and
+    /// miss counters can be inspected after parsing.
+    std::unique_ptr<parsing::IncludeTokenCache> includeTokenCache;
+
     /// The version of the SystemVerilog language to use.
     LanguageVersion languageVersion = LanguageVersion::Default;
 
@@ -119,6 +128,40 @@ public:
         /// The number of threads to use for parsing.
         std::optional<uint32_t> numThreads;
 
+        /// If true, source files will be memory mapped instead of being
+        /// copied into memory when they are loaded.
+        std::optional<bool> memoryMapFiles;
+
+        /// If true, the line offsets of source files will be computed when they are loaded.
+        std::optional<bool> precomputeLineOffsets;
+
+        /// If true, the files of a single compilation unit will be parsed in parallel.
+        std::optional<bool> parallelSingleUnit;
+
+        /// If true, independent parts of the design hierarchy will be elaborated in parallel.
+        std::optional<bool> parallelElaboration;
+
+        /// If true, the tokens of included files will be cached and replayed
+        /// instead of lexing each include of a file from scratch.
+        std::optional<bool> cacheIncludes;
+
+        /// If true, whitespace and comments will not be kept in the
+        /// trivia of lexed tokens, to save memory and time.
+        std::optional<bool> discardTrivia;
+
+        /// A directory in which to cache parsed syntax trees between runs.
+        std::optional<std::string> parseCacheDir;
+
+        /// The maximum total size of the parse cache directory, in megabytes.
+        std::optional<uint32_t> parseCacheMaxSize;
+
+        /// A list of files containing precompiled syntax trees to load.
+        std::vector<std::string> precompiledFiles;
+
+        /// If set, a file to which all parsed syntax trees should be
+        /// written so that they can later be loaded as precompiled trees.
+        std::optional<std::string> writePrecompiled;
+
         /// @}
         /// @name Compilation
         /// @{
@@ -143,6 +186,10 @@ public:
         /// before abbreviating them.
         std::optional<uint32_t> maxConstexprBacktrace;
 
+        /// The maximum number of results of constant function calls to remember
+        /// for reuse by later calls with the same arguments.
+        std::optional<uint32_t> maxConstexprCallCache;
+
         /// The maximum number of instances allowed in a single instance array.
         std::optional<uint32_t> maxInstanceArray;
 
@@ -170,6 +217,9 @@ public:
         /// for now at least this only applies to parameters in top-level modules.
         std::vector<std::string> paramOverrides;
 
+        /// A list of hierarchical paths to the parts of the design that should be elaborated.
+        std::vector<std::string> elabPaths;
+
         /// A list of library names specifying the order in which module lookup
         /// should be resolved between libraries.
         std::vector<std::string> libraryOrder;
@@ -232,6 +282,14 @@ public:
     /// Constructs a new instance of the @a Driver class.
     Driver();
 
+    /// @brief Constructs a new instance of the @a Driver class that loads files
+    /// via the given source manager instead of one of its own.
+    ///
+    /// This allows loaded files to be shared across multiple drivers, such as
+    /// when the same design is compiled repeatedly by a long-lived process.
+    /// The source manager must outlive the driver.
+    explicit Driver(SourceManager& sourceManager);
+
     /// @brief Adds standard command line arguments to the @a cmdLine object.
     ///
     /// If not called, no arguments will be added by default, though the user
@@ -314,6 +372,8 @@ public:
     [[nodiscard]] bool reportCompilation(ast::Compilation& compilation, bool quiet);
 
 private:
+    explicit Driver(SourceManager* externalSourceManager);
+
     bool parseUnitListing(std::string_view text);
     void addLibraryFiles(std::string_view pattern);
     void addParseOptions(Bag& bag) const;
@@ -7,6 +7,7 @@
 //------------------------------------------------------------------------------
 #pragma once
 
+#include <atomic>
 #include <deque>
 #include <filesystem>
 #include <memory>
@@ -17,13 +18,13 @@
 
 #include "slang/syntax/SyntaxFwd.h"
 #include "slang/text/Glob.h"
+#include "slang/text/SourceManager.h"
 #include "slang/util/Hash.h"
 #include "slang/util/Util.h"
 
 namespace slang {
 
 class Bag;
-class SourceManager;
 struct SourceBuffer;
 struct SourceLibrary;
 
@@ -49,6 +50,93 @@ struct SLANG_EXPORT SourceOptions {
 
     /// If true, library files will inherit macro definitions from primary source files.
     bool librariesInheritMacros;
+
+    /// If true, and @a singleUnit is also set, the files of the single compilation
+    /// unit will be parsed in parallel instead of one after another.
+    bool parallelSingleUnit;
+
+    /// If true, the line offsets of each source file will be computed as soon as it's
+    /// loaded, on the same thread, instead of on the first request for a line number.
+    bool precomputeLineOffsets;
+
+    /// If non-empty, a directory in which to cache the syntax trees of files
+    /// that are parsed independently. Trees are keyed by the contents of the
+    /// file along with all options that affect parsing, and are only reused
+    /// if none of the files they include have changed.
+    std::filesystem::path parseCacheDir;
+
+    /// The maximum total size, in bytes, of the entries kept in @a parseCacheDir.
+    /// Whenever a load writes new entries, the least recently used ones are removed
+    /// until the cache fits. If not set, @a DefaultParseCacheMaxSize is used.
+    std::optional<uint64_t> parseCacheMaxSize;
+
+    /// The default maximum total size of the parse cache (1 GiB).
+    static constexpr uint64_t DefaultParseCacheMaxSize = 1ull << 30;
+};
+
+/// @brief A cache of parsed syntax trees that can be shared by a series of
+/// SourceLoader instances that all load files through the same SourceManager.
+///
+/// This is intended for long-lived processes that repeatedly load the same set of
+/// sources, such as a compile server. Trees are keyed by the absolute path of the
+/// file and the options used to parse it. Only files that are parsed on their own,
+/// and that don't belong to a named library, are cached. Before reusing the cache
+/// for a new load, callers should pass the files reported by
+/// @a SourceManager::invalidateChangedFiles to @a invalidate.
+///
+/// The cache also owns the source libraries created by loaders that use it, so that
+/// trees and compilations that refer to them remain valid after the loader that
+/// created them has been destroyed.
+class SLANG_EXPORT SyntaxTreeCache {
+public:
+    SyntaxTreeCache() = default;
+    SyntaxTreeCache(const SyntaxTreeCache&) = delete;
+    SyntaxTreeCache& operator=(const SyntaxTreeCache&) = delete;
+
+    /// Looks for a cached tree for the file at the given absolute @a path that was
+    /// parsed with options matching @a optionsKey. Updates the hit and miss
+    /// counters accordingly.
+    /// @returns The cached tree, or nullptr if there isn't one.
+    std::shared_ptr<syntax::SyntaxTree> find(const std::filesystem::path& path,
+                                             std::string_view optionsKey);
+
+    /// Adds the tree for the file at the given absolute @a path to the cache,
+    /// replacing any existing entry. @a fullPath is the path of the file as
+    /// known to the source manager, which is used for invalidation.
+    void insert(const std::filesystem::path& path, const std::filesystem::path& fullPath,
+                std::string optionsKey, std::shared_ptr<syntax::SyntaxTree> tree);
+
+    /// Removes the trees affected by the given changed files. It isn't known which
+    /// trees a given include file contributes to, so if any of the files were ever
+    /// included the entire cache is cleared.
+    void invalidate(std::span<const SourceManager::ChangedFile> changedFiles);
+
+    /// Gets the source library with the given name, creating it if it does not
+    /// exist yet. An existing library is reset to the given priority and has its
+    /// other properties cleared, as if it had just been created.
+    std::shared_ptr<SourceLibrary> getOrAddLibrary(std::string_view name, int priority);
+
+    /// Gets the number of lookups that found a cached tree.
+    uint64_t getHits() const { return hits.load(std::memory_order_relaxed); }
+
+    /// Gets the number of lookups that did not find a cached tree.
+    uint64_t getMisses() const { return misses.load(std::memory_order_relaxed); }
+
+    /// Gets the number of trees in the cache.
+    size_t size() const;
+
+private:
+    struct Entry {
+        std::filesystem::path fullPath;
+        std::string optionsKey;
+        std::shared_ptr<syntax::SyntaxTree> tree;
+    };
+
+    flat_hash_map<std::filesystem::path, Entry> entries;
+    flat_hash_map<std::string, std::shared_ptr<SourceLibrary>> libraries;
+    mutable std::mutex mutex;
+    std::atomic<uint64_t> hits = 0;
+    std::atomic<uint64_t> misses = 0;
 };
 
 /// @brief Handles loading and parsing of groups of source files
@@ -145,6 +233,13 @@ public:
     /// it does not exist. Returns nullptr if @a name is empty.
     SourceLibrary* getOrAddLibrary(std::string_view name);
 
+    /// @brief Sets a cache of syntax trees to reuse when loading and parsing sources.
+    ///
+    /// Files found in the cache are neither read nor parsed again, and newly parsed
+    /// files are added to it. Source libraries are also created via the cache.
+    /// This must be set before any files or libraries are added to the loader.
+    void setTreeCache(std::shared_ptr<SyntaxTreeCache> cache) { treeCache = std::move(cache); }
+
 private:
     // One entry per unit of files + options to compile them.
     // Only used for addSeparateUnit.
@@ -210,19 +305,29 @@ private:
                        const std::filesystem::path& basePath);
     LoadResult loadAndParse(const FileEntry& fileEntry, const Bag& optionBag,
                             const SourceOptions& srcOptions, uint64_t fileSortKey = UINT64_MAX);
+    void addToTreeCache(const std::filesystem::path& absPath, const SourceBuffer& buffer,
+                        const std::shared_ptr<syntax::SyntaxTree>& tree);
+    static std::string getParseOptionsKey(const Bag& optionBag);
+    std::shared_ptr<syntax::SyntaxTree> parseCached(const SourceBuffer& buffer,
+                                                    const Bag& optionBag,
+                                                    const std::filesystem::path& cacheDir);
+    static void pruneParseCache(const std::filesystem::path& cacheDir, uint64_t maxSize);
     void addError(const std::filesystem::path& path, std::error_code ec);
 
     SourceManager& sourceManager;
 
     std::vector<FileEntry> fileEntries;
     flat_hash_map<std::filesystem::path, size_t> fileIndex;
-    flat_hash_map<std::string, std::unique_ptr<SourceLibrary>> libraries;
+    flat_hash_map<std::string, std::shared_ptr<SourceLibrary>> libraries;
     std::deque<UnitEntry> unitEntries;
     std::vector<std::filesystem::path> searchDirectories;
     std::vector<std::filesystem::path> searchExtensions;
     flat_hash_set<std::string_view> uniqueExtensions;
     std::vector<std::string> errors;
     SyntaxTreeList libraryMapTrees;
+    std::shared_ptr<SyntaxTreeCache> treeCache;
+    std::string treeCacheOptionsKey;
+    std::atomic<bool> parseCacheWritten = false;
 
     static constexpr int MinFilesForThreading = 4;
 };
@@ -116,18 +116,26 @@ struct SLANG_EXPORT logic_t {
 /// large bit widths.
 class SLANG_EXPORT SVIntStorage {
 public:
-    SVIntStorage() : val(0), bitWidth(1), signFlag(false), unknownFlag(false) {}
+    /// The number of data words that can be stored without a heap allocation.
+    static constexpr uint32_t INLINE_WORDS = 2;
+
+    SVIntStorage() : inlineVal{}, bitWidth(1), signFlag(false), unknownFlag(false) {}
     SVIntStorage(bitwidth_t bits, bool signFlag, bool unknownFlag) :
-        val(0), bitWidth(bits), signFlag(signFlag), unknownFlag(unknownFlag) {}
+        inlineVal{}, bitWidth(bits), signFlag(signFlag), unknownFlag(unknownFlag) {}
     SVIntStorage(uint64_t* data, bitwidth_t bits, bool signFlag, bool unknownFlag) :
         pVal(data), bitWidth(bits), signFlag(signFlag), unknownFlag(unknownFlag) {}
 
-    // 64 bits of value data; if bits > 64, we allocate words on the heap to hold
-    // the values. If we have unknown values (X or Z) we allocate double the number
+    /// Checks whether the data words are stored inline in the object, which is the
+    /// case for 2-state values up to 128 bits and 4-state values up to 64 bits.
+    bool isInline() const { return bitWidth <= (unknownFlag ? 64u : 64u * INLINE_WORDS); }
+
+    // 128 bits of value data; if more words than that are needed, we allocate them
+    // on the heap. If we have unknown values (X or Z) we need double the number
     // of data words, with the extra set indicating X or Z for each particular bit.
     union {
-        uint64_t val;   // value used when bits <= 64
-        uint64_t* pVal; // value used when bits > 64
+        uint64_t val;                     // value used when bits <= 64
+        uint64_t inlineVal[INLINE_WORDS]; // words used when isInline() is true
+        uint64_t* pVal;                   // words used when isInline() is false
     };
 
     bitwidth_t bitWidth; // number of bits in the integer
@@ -144,10 +152,11 @@ public:
 /// Additionally, SVInt can represent a 4-state value, where each bit can take on additional
 /// states of X and Z.
 ///
-/// Small integer values that fit within 64 bits are kept in a simple native integer. Otherwise,
-/// space is allocated on the heap. If there are any unknown bits in the number, an extra set of
-/// words are allocated adjacent in memory. The bits in these extra words indicate whether the
-/// corresponding bits in the low words are unknown or normal.
+/// Small integer values that fit within 64 bits are kept in a simple native integer, and values
+/// that need at most two words are stored inline in the object. Otherwise, space is allocated on
+/// the heap. If there are any unknown bits in the number, an extra set of words are kept adjacent
+/// in memory. The bits in these extra words indicate whether the corresponding bits in the low
+/// words are unknown or normal.
 ///
 class SLANG_EXPORT SVInt : SVIntStorage {
 public:
@@ -209,7 +218,7 @@ public:
     }
 
     ~SVInt() {
-        if (!isSingleWord())
+        if (!isInline())
             delete[] pVal;
     }
 
@@ -217,8 +226,8 @@ public:
     SVInt(const SVInt& other) : SVInt(static_cast<const SVIntStorage&>(other)) {}
     SVInt(const SVIntStorage& other) :
         SVIntStorage(other.bitWidth, other.signFlag, other.unknownFlag) {
-        if (isSingleWord())
-            val = other.val;
+        if (isInline())
+            copyInline(other);
         else
             initSlowCase(other);
     }
@@ -226,8 +235,8 @@ public:
     /// Move construct.
     SVInt(SVInt&& other) noexcept :
         SVIntStorage(other.bitWidth, other.signFlag, other.unknownFlag) {
-        if (isSingleWord())
-            val = other.val;
+        if (isInline())
+            copyInline(other);
         else
             pVal = std::exchange(other.pVal, nullptr);
     }
@@ -243,7 +252,7 @@ public:
     uint32_t getNumWords() const { return getNumWords(bitWidth, unknownFlag); }
 
     /// Gets a pointer to the underlying numeric data.
-    const uint64_t* getRawPtr() const { return isSingleWord() ? &val : pVal; }
+    const uint64_t* getRawPtr() const { return getRawData(); }
 
     /// Checks whether it's possible to convert the value to a simple built-in
     /// integer type and if so returns it.
@@ -418,8 +427,8 @@ public:
     [[nodiscard]] SVInt reverse() const;
 
     SVInt& operator=(const SVInt& rhs) {
-        if (isSingleWord() && rhs.isSingleWord()) {
-            val = rhs.val;
+        if (isInline() && rhs.isInline()) {
+            copyInline(rhs);
             bitWidth = rhs.bitWidth;
             signFlag = rhs.signFlag;
             unknownFlag = rhs.unknownFlag;
@@ -432,10 +441,14 @@ public:
         if (this == &rhs)
             return *this;
 
-        if (!isSingleWord())
+        if (!isInline())
             delete[] pVal;
 
-        val = rhs.val;
+        if (rhs.isInline())
+            copyInline(rhs);
+        else
+            pVal = rhs.pVal;
+
         bitWidth = rhs.bitWidth;
         signFlag = rhs.signFlag;
         unknownFlag = rhs.unknownFlag;
@@ -580,8 +593,19 @@ private:
     void initSlowCase(std::span<const byte> bytes);
     void initSlowCase(const SVIntStorage& other);
 
-    uint64_t* getRawData() { return isSingleWord() ? &val : pVal; }
-    const uint64_t* getRawData() const { return isSingleWord() ? &val : pVal; }
+    uint64_t* getRawData() { return isInline() ? inlineVal : pVal; }
+    const uint64_t* getRawData() const { return isInline() ? inlineVal : pVal; }
+
+    // Copies the inline data words from another value.
+    void copyInline(const SVIntStorage& other) {
+        inlineVal[0] = other.inlineVal[0];
+        inlineVal[1] = other.inlineVal[1];
+    }
+
+    // Moves the data words between inline and heap storage as needed to account
+    // for a change in the unknown flag, keeping the value words and clearing any
+    // new unknown words.
+    void reallocate(bool newUnknownFlag);
 
     // Slow cases for assignment, equality checking, and counting leading zeros.
     SVInt& assignSlowCase(const SVInt& other);
@@ -613,6 +637,16 @@ private:
     static SVInt fromPow2Digits(bitwidth_t bits, bool isSigned, bool anyUnknown, uint32_t radix,
                                 uint32_t shift, std::span<logic_t const> digits);
 
+    // Converts decimal digits to an unsigned value by splitting them in half recursively,
+    // using a table of powers of ten as built by the toString / fromString helpers.
+    static SVInt decimalDigitsToValue(std::span<logic_t const> digits,
+                                      std::span<const SVInt> powers, bitwidth_t minBits);
+
+    // Appends the decimal digits of a nonnegative value to the buffer, least significant
+    // digit first, padding with zeros to at least minDigits.
+    static void writeDecimalDigits(SmallVectorBase<char>& buffer, const SVInt& value,
+                                   std::span<const SVInt> powers, size_t minDigits);
+
     // Split an integer's data into 32-bit words.
     static void splitWords(const SVInt& value, uint32_t* dest, uint32_t numWords);
 
@@ -0,0 +1,98 @@
+//------------------------------------------------------------------------------
+//! @file IncludeTokenCache.h
+//! @brief Thread-safe cache of lexed include files
+//
+// SPDX-FileCopyrightText: Michael Popoloski
+// SPDX-License-Identifier: MIT
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+#include "slang/diagnostics/Diagnostics.h"
+#include "slang/parsing/Lexer.h"
+#include "slang/parsing/Token.h"
+#include "slang/util/BumpAllocator.h"
+#include "slang/util/Hash.h"
+#include "slang/util/SmallVector.h"
+
+namespace slang::parsing {
+
+/// @brief A cache of the raw token streams of included files.
+///
+/// Headers that are included many times, whether by many files in one compilation
+/// unit or by many units parsed on separate threads, only need to be lexed once;
+/// the preprocessor replays the cached tokens for later includes of the same file.
+///
+/// Entries are keyed by the header's text buffer, which the SourceManager shares
+/// between all includes of the same file, so a cache must only ever be used with a
+/// single SourceManager. Replayed tokens reference memory owned by the cache, so it
+/// must outlive any syntax trees that were parsed using it.
+///
+/// All methods are safe to call concurrently from multiple threads.
+class SLANG_EXPORT IncludeTokenCache {
+public:
+    /// A diagnostic issued by the lexer, along with the index of the
+    /// token that was being lexed when it was issued.
+    struct LexerDiag {
+        uint32_t tokenIndex;
+        Diagnostic diag;
+    };
+
+    /// The lexed contents of a single included file.
+    struct Entry {
+        /// The raw tokens of the file, up to and including the EndOfFile token.
+        std::span<const Token> tokens;
+
+        /// Diagnostics issued by the lexer, in the order they were issued.
+        std::vector<LexerDiag> diagnostics;
+
+        /// The keyword version that was active while lexing the file.
+        KeywordVersion keywordVersion;
+
+        /// The options used to lex the file.
+        LexerOptions options;
+    };
+
+    IncludeTokenCache() = default;
+    IncludeTokenCache(const IncludeTokenCache&) = delete;
+    IncludeTokenCache& operator=(const IncludeTokenCache&) = delete;
+
+    /// Looks for a cached token stream for the file whose text starts at @a text,
+    /// lexed using the given keyword version and options. Updates the hit and
+    /// miss counters accordingly.
+    /// @returns The cached entry, or nullptr if there isn't one.
+    const Entry* find(const char* text, KeywordVersion keywordVersion,
+                      const LexerOptions& options);
+
+    /// Adds the token stream for the file whose text starts at @a text to the cache.
+    /// The tokens are copied into memory owned by the cache. If an entry for the same
+    /// file and options already exists (for example because another thread lexed it
+    /// concurrently) the existing entry is kept.
+    void insert(const char* text, KeywordVersion keywordVersion, const LexerOptions& options,
+                std::span<const Token> tokens, std::vector<LexerDiag> diagnostics);
+
+    /// Gets the number of lookups that found a cached entry.
+    uint64_t getHits() const { return hits.load(std::memory_order_relaxed); }
+
+    /// Gets the number of lookups that did not find a cached entry.
+    uint64_t getMisses() const { return misses.load(std::memory_order_relaxed); }
+
+    /// Gets the number of entries in the cache.
+    size_t size() const;
+
+private:
+    static bool matches(const Entry& entry, KeywordVersion keywordVersion,
+                        const LexerOptions& options);
+
+    BumpAllocator alloc;
+    flat_hash_map<const char*, std::vector<std::unique_ptr<Entry>>> entries;
+    mutable std::shared_mutex mutex;
+    std::atomic<uint64_t> hits = 0;
+    std::atomic<uint64_t> misses = 0;
+};
+
+} // namespace slang::parsing
@@ -35,6 +35,14 @@ struct SLANG_EXPORT LexerOptions {
     /// If true, the preprocessor will support legacy protected envelope directives,
     /// for compatibility with old Verilog tools.
     bool enableLegacyProtect = false;
+
+    /// If true, whitespace and comments are not kept in the trivia of lexed tokens.
+    /// Each token instead gets a small shared stand-in that records only whether it
+    /// was preceded by whitespace or a line break, which is all the parser and
+    /// semantic analysis need. Directives and macros still see the full trivia.
+    /// This saves memory and time for flows that only compile the source, but
+    /// trees parsed this way can't be printed back out as their original text.
+    bool discardTrivia = false;
 };
 
 /// Possible encodings for encrypted text used in a pragma protect region.
@@ -61,6 +69,12 @@ public:
     Token lex();
     Token lex(KeywordVersion keywordVersion);
 
+    /// Lexes the next token from within a region of source code that is excluded by
+    /// conditional compilation. Text that can't contain a conditional compilation
+    /// directive is skipped over without being tokenized, and is attached to the
+    /// returned token as a single DisabledText trivia.
+    Token lexInactive(KeywordVersion keywordVersion);
+
     /// Looks ahead in the source stream to see if the next token we would lex
     /// is on the same line as the previous token we've lexed.
     bool isNextTokenOnSameLine();
@@ -69,6 +83,15 @@ public:
     Token lexEncodedText(ProtectEncoding encoding, uint32_t expectedBytes, bool singleLine,
                          bool legacyProtectedMode);
 
+    /// Moves the lexer to the given byte offset within its source buffer, so that
+    /// lexing continues from there. Used to resume lexing after tokens for the
+    /// buffer have been replayed from a cache.
+    void seek(size_t offset);
+
+    /// Sets whether whitespace and comment trivia is discarded from tokens lexed
+    /// from here on; see LexerOptions::discardTrivia.
+    void setDiscardTrivia(bool value) { discardTrivia = value; }
+
     /// Returns the library with which the lexer's source buffer is associated.
     const SourceLibrary* getLibrary() const { return library; }
 
@@ -79,6 +102,12 @@ public:
     static Token stringify(Lexer& parentLexer, Token startToken, std::span<Token> bodyTokens,
                            Token endToken);
 
+    /// Gets the shared stand-in trivia that is used in place of @a trivia when
+    /// trivia is being discarded, or std::nullopt if it contains trivia other than
+    /// whitespace and comments, which needs to be kept as-is.
+    static std::optional<std::span<Trivia const>> condenseTrivia(
+        std::span<Trivia const> trivia);
+
     /// Converts a range of tokens into a block comment; used for macro expansion.
     static Trivia commentify(BumpAllocator& alloc, std::span<Token> tokens);
 
@@ -92,6 +121,7 @@ private:
     Lexer(BufferID bufferId, std::string_view source, const char* startPtr, BumpAllocator& alloc,
           Diagnostics& diagnostics, LexerOptions options);
 
+    Token lexTokenAndTrivia(KeywordVersion keywordVersion);
     Token lexToken(KeywordVersion keywordVersion);
     Token lexEscapeSequence(bool isMacroName);
     Token lexNumericLiteral();
@@ -105,6 +135,7 @@ private:
     template<bool StopAfterNewline>
     void lexTrivia();
 
+    const char* scanInactiveText() const;
     void scanBlockComment();
     void scanLineComment();
     void scanWhitespace();
@@ -160,6 +191,9 @@ private:
     // the number of errors that have occurred while lexing the current buffer
     uint32_t errorCount = 0;
 
+    // whether whitespace and comment trivia is currently being discarded
+    bool discardTrivia = false;
+
     // temporary storage for building arrays of trivia
     SmallVector<Trivia, 32> triviaBuffer;
 
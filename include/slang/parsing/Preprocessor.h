@@ -9,6 +9,7 @@
 
 #include <memory>
 
+#include "slang/parsing/IncludeTokenCache.h"
 #include "slang/parsing/Lexer.h"
 #include "slang/parsing/NumberParser.h"
 #include "slang/parsing/Token.h"
@@ -57,6 +58,121 @@ struct SLANG_EXPORT PreprocessorOptions {
 
     /// A set of preprocessor directives to be ignored.
     flat_hash_set<std::string_view> ignoreDirectives;
+
+    /// An optional cache of lexed include files, which can be shared between
+    /// preprocessors (including ones running on other threads). When set, included
+    /// files are lexed once and their tokens are replayed from the cache thereafter.
+    IncludeTokenCache* includeTokenCache = nullptr;
+};
+
+/// @brief Preprocessor state that carries over from one source buffer to the next
+/// when several buffers are preprocessed as part of a single compilation unit.
+///
+/// The state can be captured from a preprocessor and used to seed another one,
+/// which allows the buffers of a unit to be preprocessed independently of each other.
+struct SLANG_EXPORT PreprocessorUnitState {
+    /// A macro definition that carries over between buffers.
+    struct Macro {
+        /// The syntax of the macro definition.
+        const syntax::DefineDirectiveSyntax* syntax = nullptr;
+
+        /// Indicates whether the macro was predefined on the command line.
+        bool commandLine = false;
+    };
+
+    /// The set of defined macros, keyed by name. Built-in and intrinsic macros
+    /// are not included since they are always defined.
+    flat_hash_map<std::string_view, Macro> macros;
+
+    /// The set of files (identified by a pointer to the start of their text buffer)
+    /// that have been marked `pragma once.
+    flat_hash_set<const char*> includeOnceHeaders;
+
+    /// The set of files (identified by a pointer to the start of their text buffer)
+    /// that are known to be wrapped in an include guard, along with the name of
+    /// the macro that guards them.
+    flat_hash_map<const char*, std::string_view> includeGuards;
+
+    /// The stack of keyword versions set by `begin_keywords directives.
+    SmallVector<KeywordVersion, 2> keywordVersionStack;
+
+    /// The active time scale, if any.
+    std::optional<TimeScale> timeScale;
+
+    /// The default net type set via `default_nettype.
+    TokenKind defaultNetType = TokenKind::WireKeyword;
+
+    /// The drive strength set via `unconnected_drive.
+    TokenKind unconnectedDrive = TokenKind::Unknown;
+};
+
+/// @brief Records how preprocessing a single source buffer depended on and modified
+/// the state carried over from earlier buffers in the same compilation unit.
+///
+/// A trace is filled in by a preprocessor that has been seeded via
+/// @a Preprocessor::setUnitState. Afterwards it can be used to check whether the
+/// results are still valid given some other incoming state, and to compute the
+/// state that would be passed along to the next buffer.
+struct SLANG_EXPORT PreprocessorUnitTrace {
+    using MacroValue = std::optional<PreprocessorUnitState::Macro>;
+
+    /// Flags for the pieces of directive state that can be observed or modified.
+    enum DirectiveFlags : uint8_t {
+        TimeScaleFlag = 1 << 0,
+        DefaultNetTypeFlag = 1 << 1,
+        UnconnectedDriveFlag = 1 << 2
+    };
+
+    /// Macros that were looked up before being defined or undefined by the buffer,
+    /// along with the definition that was found at the time, if any.
+    flat_hash_map<std::string_view, MacroValue> macroDeps;
+
+    /// Macros that were defined or undefined by the buffer, along with their
+    /// final definition, if any.
+    flat_hash_map<std::string_view, MacroValue> macroChanges;
+
+    /// Files whose `pragma once status was checked before being marked by the
+    /// buffer, along with the status that was found at the time.
+    flat_hash_map<const char*, bool> includeOnceDeps;
+
+    /// Files that were marked `pragma once by the buffer.
+    std::vector<const char*> includeOnceAdded;
+
+    /// Files whose include guard was looked up before being detected by the buffer,
+    /// along with whether it was known at the time.
+    flat_hash_map<const char*, bool> includeGuardDeps;
+
+    /// Files whose include guard was detected by the buffer, along with the
+    /// name of the guard macro.
+    std::vector<std::pair<const char*, std::string_view>> includeGuardsAdded;
+
+    /// The incoming state, of which only the directive state is filled in.
+    PreprocessorUnitState incoming;
+
+    /// The outgoing state, of which only the directive state is filled in.
+    PreprocessorUnitState outgoing;
+
+    /// Pieces of directive state that were observed before being modified.
+    uint8_t directivesRead = 0;
+
+    /// Pieces of directive state that were modified.
+    uint8_t directivesWritten = 0;
+
+    /// Set if all macros were undefined by the buffer, in which case
+    /// @a macroChanges contains the full set of outgoing macros.
+    bool undefinedAll = false;
+
+    /// Set if the buffer ended with state open that can't be carried over to another
+    /// buffer, such as an unterminated conditional directive.
+    bool hasOpenState = false;
+
+    /// Checks whether preprocessing the buffer would have produced the same result
+    /// if it had been given the provided incoming state.
+    bool isValidFor(const PreprocessorUnitState& state) const;
+
+    /// Applies the changes made by the buffer to the given state, converting it
+    /// from the buffer's incoming state to its outgoing state.
+    void applyTo(PreprocessorUnitState& state) const;
 };
 
 /// Preprocessor - Interface between lexer and parser
@@ -118,16 +234,25 @@ public:
     void popDesignElementStack() { designElementDepth--; }
 
     /// Gets the currently active time scale value, if any has been set by the user.
-    const std::optional<TimeScale>& getTimeScale() const { return activeTimeScale; }
+    const std::optional<TimeScale>& getTimeScale() const {
+        traceDirectiveRead(PreprocessorUnitTrace::TimeScaleFlag);
+        return activeTimeScale;
+    }
 
     /// Gets the default net type to use if none is specified. This is set via
     /// the `default_nettype directive. If it is set to "none" by the user, this
     /// will return TokenKind::Unknown.
-    TokenKind getDefaultNetType() const { return defaultNetType; }
+    TokenKind getDefaultNetType() const {
+        traceDirectiveRead(PreprocessorUnitTrace::DefaultNetTypeFlag);
+        return defaultNetType;
+    }
 
     /// Gets the currently active drive strength to apply to unconnected nets,
     /// if any has been set by the user. If none is set, this returns TokenKind::Unknown.
-    TokenKind getUnconnectedDrive() const { return unconnectedDrive; }
+    TokenKind getUnconnectedDrive() const {
+        traceDirectiveRead(PreprocessorUnitTrace::UnconnectedDriveFlag);
+        return unconnectedDrive;
+    }
 
     /// Gets the currently active keyword version in use by the preprocessor.
     KeywordVersion getCurrentKeywordVersion() const { return keywordVersionStack.back(); }
@@ -147,13 +272,24 @@ public:
     /// Gets all macros that have been defined thus far in the preprocessor.
     std::vector<const syntax::DefineDirectiveSyntax*> getDefinedMacros() const;
 
+    /// Gets the state that would carry over from the preprocessor to a subsequent
+    /// source buffer in the same compilation unit.
+    PreprocessorUnitState getUnitState() const;
+
+    /// Seeds the preprocessor with state carried over from earlier source buffers
+    /// in the same compilation unit. All currently defined macros, other than the
+    /// built-in ones, are replaced by the ones in @a state.
+    /// If @a trace is provided it will be filled in as preprocessing proceeds;
+    /// it must outlive any further use of the preprocessor.
+    void setUnitState(const PreprocessorUnitState& state, PreprocessorUnitTrace* trace = nullptr);
+
 private:
     Preprocessor(const Preprocessor& other);
     Preprocessor& operator=(const Preprocessor& other) = delete;
 
     // Internal methods to grab and handle the next token
     Token nextProcessed();
-    Token nextRaw();
+    Token nextRaw(bool inactive = false);
     void popSource();
 
     // directive handling methods
@@ -305,6 +441,18 @@ private:
 
     static bool isSameMacro(const syntax::DefineDirectiveSyntax& left,
                             const syntax::DefineDirectiveSyntax& right);
+    friend struct PreprocessorUnitTrace;
+
+    // Helpers for recording state in the active unit trace, if there is one.
+    void traceMacroRead(std::string_view name) const;
+    void traceMacroWrite(std::string_view name);
+    void traceDirectiveWrite(uint8_t flags);
+    bool isIncludeOnceHeader(const char* text);
+    const std::string_view* findIncludeGuard(const char* text);
+    void traceDirectiveRead(uint8_t flag) const {
+        if (unitTrace && !(unitTrace->directivesWritten & flag))
+            unitTrace->directivesRead |= flag;
+    }
 
     // functions to advance the underlying token stream
     Token peek();
@@ -381,8 +529,48 @@ private:
     PreprocessorOptions options;
     LexerOptions lexerOptions;
 
+    // A source of raw tokens on the include stack. Tokens are normally pulled from
+    // the lexer, but included files can instead have their tokens replayed from,
+    // or recorded into, the include token cache.
+    struct LexerSource {
+        std::unique_ptr<Lexer> lexer;
+        BufferID buffer;
+        const char* text = nullptr;
+
+        // The keyword version the source is being replayed or recorded with.
+        KeywordVersion keywordVersion = KeywordVersion::v1800_2023;
+
+        // Set while tokens are being replayed from a cache entry.
+        const IncludeTokenCache::Entry* replay = nullptr;
+        uint32_t replayIndex = 0;
+        uint32_t replayDiagIndex = 0;
+
+        // Set while tokens are being recorded for adding to the cache.
+        bool recording = false;
+        SmallVector<Token> recordedTokens;
+        std::vector<IncludeTokenCache::LexerDiag> recordedDiags;
+
+        // Tracks whether an included file is wrapped in an include guard, i.e. an
+        // `ifndef at the very start of the file whose `endif is at the very end.
+        enum class GuardState : uint8_t { None, Start, Open, Closed };
+        GuardState guardState = GuardState::None;
+        std::string_view guardName;
+        size_t guardDepth = 0;
+        size_t guardEnd = 0;
+    };
+
+    void pushIncludeSource(SourceBuffer buffer);
+    Token lexSource(LexerSource& source, bool inactive = false);
+    Token lexSourceToken(LexerSource& source, bool inactive);
+    Token replayToken(LexerSource& source);
+    Lexer& getActiveLexer();
+    void checkIncludeGuardStart(Token directive,
+                                const syntax::ConditionalDirectiveExpressionSyntax& expr);
+    void checkIncludeGuardBranch(Token directive, bool isEnd);
+    void checkIncludeGuardEnd(LexerSource& source, Token eof);
+
     // stack of active lexers; each `include pushes a new lexer
-    SmallVector<std::unique_ptr<Lexer>, 2> lexerStack;
+    SmallVector<LexerSource, 2> lexerStack;
 
     // keep track of nested processor branches (ifdef, ifndef, else, elsif, endif)
     SmallVector<BranchEntry, 2> branchStack;
@@ -405,6 +593,10 @@ private:
     // (either define or usage).
     bool inMacroBody = false;
 
+    // Set while directives are being handled, to keep full trivia for their tokens
+    // when the lexer is otherwise discarding it.
+    bool inDirective = false;
+
     // Special handling for pulling directives when in an ifdef condition expr.
     bool inIfDefCondition = false;
 
@@ -415,12 +607,20 @@ private:
     // have been marked `pragma once so that we avoid trying to include them more than once.
     flat_hash_set<const char*> includeOnceHeaders;
 
+    // A map of files (identified by a pointer to the start of their text buffer) that
+    // are wrapped in an include guard to the guard macro, so that including them again
+    // while the macro is defined can skip the file entirely.
+    flat_hash_map<const char*, std::string_view> includeGuards;
+
     /// Various state set by preprocessor directives.
     std::vector<KeywordVersion> keywordVersionStack;
     std::optional<TimeScale> activeTimeScale;
     TokenKind defaultNetType = TokenKind::WireKeyword;
     TokenKind unconnectedDrive = TokenKind::Unknown;
 
+    // Records dependencies on state carried over from earlier buffers in the unit, if set.
+    PreprocessorUnitTrace* unitTrace = nullptr;
+
     int designElementDepth = 0;
     uint32_t includeDepth = 0;
     uint32_t protectEncryptDepth = 0;
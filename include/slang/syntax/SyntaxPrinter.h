@@ -114,6 +114,7 @@ private:
     bool includePreprocessed = true;
     bool includeComments = true;
     bool squashNewlines = true;
+    bool inDirective = false;
 };
 
 } // namespace slang::syntax
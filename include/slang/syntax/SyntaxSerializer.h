@@ -0,0 +1,198 @@
+//------------------------------------------------------------------------------
+//! @file SyntaxSerializer.h
+//! @brief Binary serialization of syntax trees
+//
+// SPDX-FileCopyrightText: Michael Popoloski
+// SPDX-License-Identifier: MIT
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <vector>
+
+#include "slang/syntax/SyntaxNode.h"
+#include "slang/util/Bag.h"
+#include "slang/util/Function.h"
+
+namespace slang {
+
+class SourceManager;
+struct SourceBuffer;
+struct SourceLibrary;
+
+} // namespace slang
+
+namespace slang::syntax {
+
+class SyntaxTree;
+
+/// @brief Serializes syntax trees to and from a compact binary format.
+///
+/// A serialized tree holds everything needed to reconstruct it without lexing or
+/// parsing the original source text again: the nodes and tokens themselves, the
+/// parser metadata, any diagnostics that were issued, and the macros that were
+/// defined by the time parsing finished.
+///
+/// Source locations are stored relative to a table of the buffers that the tree
+/// refers to. When the tree is loaded back in, source files are looked up again
+/// and included files are found using the same include search rules that the
+/// preprocessor uses. Loading fails if any of those files now resolve to a different
+/// path or their contents differ from when the tree was serialized, which means a
+/// successfully loaded tree is always identical to what parsing the files would produce.
+///
+/// Groups of trees can also be written to and loaded from files, which allows packages
+/// that rarely change (such as UVM) to be "precompiled" once and then loaded much more
+/// quickly than they could be parsed on later runs.
+class SLANG_EXPORT SyntaxSerializer {
+public:
+    /// The version of the binary format. Data written with a different
+    /// version of the format will fail to load.
+    static constexpr uint32_t FormatVersion = 3;
+
+    /// Gets a hash that identifies the exact layout of serialized data, combining
+    /// @a FormatVersion, the layout of every kind of syntax node, and the version of
+    /// the library. Data written by a build with a different hash will fail to load.
+    static uint64_t getFormatHash();
+
+    /// Serializes the given syntax tree.
+    /// @returns The serialized data, or std::nullopt if the tree contains something
+    /// that can't be represented in serialized form, such as diagnostics with
+    /// arguments that refer to semantic information.
+    static std::optional<std::vector<char>> serialize(const SyntaxTree& tree);
+
+    /// Reconstructs a syntax tree from data previously produced by @a serialize.
+    ///
+    /// @a buffers are source buffers that have already been loaded for any of the
+    /// files the tree was originally parsed from; they will be used instead of looking
+    /// those files up again. @a options should match the options that were used when
+    /// the tree was originally parsed; the preprocessor options are used to search
+    /// for included files.
+    ///
+    /// @returns The reconstructed tree, or nullptr if the data is malformed, was written
+    /// with a different format version, or any of the files it depends on have changed.
+    static std::shared_ptr<SyntaxTree> deserialize(std::span<const char> data,
+                                                   SourceManager& sourceManager,
+                                                   std::span<const SourceBuffer> buffers = {},
+                                                   const Bag& options = {});
+
+    /// Serializes the given syntax trees and writes them to the file at @a path,
+    /// replacing any existing contents.
+    /// @returns An error code if any of the trees can't be serialized
+    /// (std::errc::not_supported) or the file can't be written.
+    static std::error_code writeFile(const std::filesystem::path& path,
+                                     std::span<const std::shared_ptr<SyntaxTree>> trees);
+
+    /// Loads syntax trees from a file previously written by @a writeFile. The file is
+    /// memory mapped while the trees are reconstructed, and the trees don't reference
+    /// its contents once loaded. The loaded trees are appended to @a results.
+    ///
+    /// Trees that were parsed into a source library other than the default one are
+    /// placed back into the library returned by @a getLibrary for that library's name.
+    ///
+    /// @returns An error code if the file can't be read, or std::errc::invalid_argument
+    /// if its contents are malformed, any of the source files the trees were parsed
+    /// from have changed, or a tree's library can't be found. Nothing is added to
+    /// @a results on failure.
+    static std::error_code readFile(
+        const std::filesystem::path& path, SourceManager& sourceManager,
+        std::vector<std::shared_ptr<SyntaxTree>>& results, const Bag& options = {},
+        function_ref<const SourceLibrary*(std::string_view)> getLibrary = nullptr);
+
+private:
+    static std::shared_ptr<SyntaxTree> deserialize(std::span<const char> data,
+                                                   SourceManager& sourceManager,
+                                                   std::span<const SourceBuffer> buffers,
+                                                   const SourceLibrary* library,
+                                                   const Bag& options);
+};
+
+namespace detail {
+
+/// Interface used by the generated node deserialization code to read back
+/// the members of a serialized node, in the order they were written.
+class SLANG_EXPORT SyntaxReader {
+public:
+    BumpAllocator& alloc;
+
+    /// Set if something that was read doesn't fit where it was found,
+    /// such as a missing required child node or one of the wrong kind.
+    bool failed = false;
+
+    explicit SyntaxReader(BumpAllocator& alloc) : alloc(alloc) {}
+    virtual ~SyntaxReader() = default;
+
+    /// Reads a token.
+    virtual parsing::Token token() = 0;
+
+    /// Reads a syntax node, which may be null.
+    virtual SyntaxNode* node() = 0;
+
+    /// Reads the number of elements in a list.
+    virtual size_t count() = 0;
+
+    template<typename T>
+    T* node() {
+        auto result = node();
+        if (!result)
+            return nullptr;
+
+        if (!T::isKind(result->kind)) {
+            failed = true;
+            return nullptr;
+        }
+        return &result->as<T>();
+    }
+
+    template<typename T>
+    SyntaxList<T> list() {
+        const size_t size = count();
+        SmallVector<T*> buffer(size, UninitializedTag());
+        for (size_t i = 0; i < size; i++)
+            buffer.push_back(node<T>());
+
+        return SyntaxList<T>(buffer.copy(alloc));
+    }
+
+    template<typename T>
+    SeparatedSyntaxList<T> separatedList() {
+        // Elements always alternate between nodes and separator tokens.
+        const size_t size = count();
+        SmallVector<TokenOrSyntax> buffer(size, UninitializedTag());
+        for (size_t i = 0; i < size; i++) {
+            if (i % 2 == 0)
+                buffer.push_back(node<T>());
+            else
+                buffer.push_back(token());
+        }
+
+        return SeparatedSyntaxList<T>(buffer.copy(alloc));
+    }
+
+    TokenList tokenList() {
+        const size_t size = count();
+        SmallVector<parsing::Token> buffer(size, UninitializedTag());
+        for (size_t i = 0; i < size; i++)
+            buffer.push_back(token());
+
+        return TokenList(buffer.copy(alloc));
+    }
+};
+
+/// Constructs a node of the given kind, reading its members from @a reader.
+/// Returns nullptr if @a kind is not a kind of node that can be deserialized,
+/// or if a required child node is missing.
+/// This is defined in the generated SyntaxDeserialize.cpp file.
+SyntaxNode* deserializeNode(SyntaxKind kind, SyntaxReader& reader);
+
+/// Gets a hash of the numbering of syntax, token, and trivia kinds and of the
+/// members of every kind of syntax node, which together determine how serialized
+/// nodes are laid out. This is defined in the generated SyntaxDeserialize.cpp file.
+uint64_t getSyntaxSchemaHash();
+
+} // namespace detail
+
+} // namespace slang::syntax
@@ -18,6 +18,7 @@
 namespace slang {
 
 class SourceManager;
+class ThreadPool;
 struct SourceBuffer;
 
 } // namespace slang
@@ -149,6 +150,31 @@ public:
                                                    const Bag& options = {},
                                                    MacroList inheritedMacros = {});
 
+    /// Creates a syntax tree by concatenating several loaded source buffers, like
+    /// @a fromBuffers, but preprocesses and parses the buffers concurrently.
+    ///
+    /// Each buffer is first parsed on its own, assuming some guess as to the
+    /// macros and directive state that earlier buffers will leave behind. Buffers
+    /// whose guesses turn out to be wrong are parsed again until all of them agree
+    /// with what a sequential parse would have seen, and the results are then
+    /// stitched together into a single compilation unit. If the buffers can't be
+    /// parsed independently (for example because a conditional directive spans
+    /// more than one of them, or because there are parse errors) this falls back
+    /// to parsing them all sequentially.
+    ///
+    /// @a buffers is the list of buffers that should be concatenated to form
+    /// the compilation unit to parse.
+    /// @a sourceManager is the manager that owns the buffers.
+    /// @a threadPool is the thread pool to use for parsing.
+    /// @a options is an optional bag of lexer, preprocessor, and parser options.
+    /// @a inheritedMacros is a list of macros to predefine in the new syntax tree.
+    /// @return the created and parsed syntax tree.
+    static std::shared_ptr<SyntaxTree> fromBuffersParallel(std::span<const SourceBuffer> buffers,
+                                                           SourceManager& sourceManager,
+                                                           ThreadPool& threadPool,
+                                                           const Bag& options = {},
+                                                           MacroList inheritedMacros = {});
+
     /// Creates a syntax tree from a library map file.
     /// @a path is the path to the source file on disk.
     /// @a sourceManager is the manager that owns all of the loaded source code.
@@ -217,6 +243,8 @@ public:
     static SourceManager& getDefaultSourceManager();
 
 private:
+    friend class SyntaxSerializer;
+
     SyntaxTree(SyntaxNode* root, const SourceLibrary* library, SourceManager& sourceManager,
                BumpAllocator&& alloc, Diagnostics&& diagnostics, parsing::ParserMetadata&& metadata,
                std::vector<const DefineDirectiveSyntax*>&& macros, Bag options);
@@ -9,6 +9,8 @@
 
 #include <cstdint>
 
+#include "slang/slang_export.h"
+
 namespace slang {
 
 /// Returns whether the given character is a valid ASCII character.
@@ -198,4 +200,37 @@ constexpr const char* utf8Decode(const char* b, uint32_t* c, int* e, int& comput
     return next;
 }
 
+/// Scans forward from @a ptr and returns a pointer to the first character that is
+/// not horizontal whitespace (a space, tab, vertical tab, or form feed), or @a end if
+/// every character in the range is whitespace.
+///
+/// This and the other scanning routines below use vectorized implementations
+/// when the host CPU supports them; see @ref getSimdLevel
+SLANG_EXPORT const char* skipHorizontalWhitespace(const char* ptr, const char* end);
+
+/// Scans forward from @a ptr and returns a pointer to the first character that is
+/// not valid within a simple identifier (alphanumerics, underscores, and dollar signs),
+/// or @a end if there is no such character.
+SLANG_EXPORT const char* skipIdentifierChars(const char* ptr, const char* end);
+
+/// Scans forward from @a ptr and returns a pointer to the first character that
+/// is of interest when lexing a line comment: a newline, a null character, or
+/// any non-ASCII byte. Returns @a end if there is no such character.
+SLANG_EXPORT const char* findLineCommentBreak(const char* ptr, const char* end);
+
+/// Scans forward from @a ptr and returns a pointer to the first character that
+/// is of interest when lexing a block comment: a '*', a '/', a null character,
+/// or any non-ASCII byte. Returns @a end if there is no such character.
+SLANG_EXPORT const char* findBlockCommentBreak(const char* ptr, const char* end);
+
+/// Scans forward from @a ptr and returns a pointer to the first character that is
+/// of interest when skipping over the text of an inactive conditional compilation
+/// region: a '`', '"', '/', or '\\', a null or other non-whitespace control
+/// character, or any non-ASCII byte. Returns @a end if there is no such character.
+SLANG_EXPORT const char* findInactiveTextBreak(const char* ptr, const char* end);
+
+/// Scans forward from @a ptr and returns a pointer to the first newline
+/// character ('\n' or '\r'), or @a end if there is no such character.
+SLANG_EXPORT const char* findNewline(const char* ptr, const char* end);
+
 } // namespace slang
@@ -20,6 +20,7 @@
 
 #include "slang/text/SourceLocation.h"
 #include "slang/util/Hash.h"
+#include "slang/util/OS.h"
 #include "slang/util/SmallVector.h"
 #include "slang/util/Util.h"
 
@@ -76,6 +77,13 @@ public:
     /// returns an empty string.
     const std::filesystem::path& getFullPath(BufferID buffer) const;
 
+    /// Computes the offsets of the start of each line in the given buffer's file ahead
+    /// of time. Otherwise this happens on the first request for a line number in the file,
+    /// so computing them up front (such as on the thread that loaded the file) avoids
+    /// doing the work while diagnostics are being reported. This is safe to call from
+    /// multiple threads at once.
+    void precomputeLineOffsets(BufferID buffer) const;
+
     /// Gets the column line number for a given source location.
     /// @a location must be a file location.
     size_t getColumnNumber(SourceLocation location) const;
@@ -167,11 +175,50 @@ public:
     /// Returns true if the given file path is already loaded and cached in the source manager.
     bool isCached(const std::filesystem::path& path) const;
 
+    /// Describes a cached file whose contents on disk no longer match
+    /// what was loaded, as returned by @a invalidateChangedFiles.
+    struct ChangedFile {
+        /// The full path to the file.
+        std::filesystem::path path;
+
+        /// True if the file was ever loaded as an include file,
+        /// as opposed to only being read directly as a source file.
+        bool wasIncluded = false;
+    };
+
+    /// @brief Checks all files loaded from disk for modifications and drops
+    /// the cached contents of any that have changed.
+    ///
+    /// A file is considered changed if its modification time differs from when
+    /// it was loaded and its contents (or existence) differ as well; files that
+    /// were only touched keep their cached contents. Subsequent reads of a changed
+    /// file will load it again from disk. Buffers that were already created for
+    /// the old contents remain valid until @a releaseRetiredFiles is called.
+    /// Cached failures to open files are also dropped so that they get retried.
+    ///
+    /// @returns the list of files that have changed.
+    std::vector<ChangedFile> invalidateChangedFiles();
+
+    /// @brief Frees the old contents of all files dropped by @a invalidateChangedFiles.
+    ///
+    /// Buffers that were created for the old contents are left empty, so callers
+    /// must make sure that nothing refers to them anymore, such as syntax trees
+    /// that were parsed from them or compilations that include those trees.
+    void releaseRetiredFiles();
+
     /// Sets whether filenames should be made "proximate" to the current directory
     /// for diagnostic reporting purposes. This is on by default but can be
     /// disabled to always use the simple filename.
     void setDisableProximatePaths(bool set) { disableProximatePaths = set; }
 
+    /// Sets whether files loaded from disk should be memory mapped instead of
+    /// being copied into memory. Mapped files avoid a copy of their contents
+    /// and don't count against the process heap, at the cost of relying on
+    /// the files remaining unmodified for the lifetime of the source manager.
+    /// Files that can't be mapped (such as pipes) are always read normally.
+    /// This is off by default.
+    void setMemoryMapFiles(bool set) { memoryMapFiles = set; }
+
     /// Adds a line directive at the given location.
     void addLineDirective(SourceLocation location, size_t lineNum, std::string_view name,
                           uint8_t level);
@@ -180,6 +227,10 @@ public:
     void addDiagnosticDirective(SourceLocation location, std::string_view name,
                                 DiagnosticSeverity severity);
 
+    /// Removes all line and diagnostic directives that have been added for the
+    /// given buffer, such as when it is about to be preprocessed again.
+    void clearDirectives(BufferID buffer);
+
     /// Stores information specified in a `pragma diagnostic directive, which alters the
     /// currently active set of diagnostic mappings.
     struct DiagnosticDirectiveInfo {
@@ -197,6 +248,33 @@ public:
             name(name), offset(offset), severity(severity) {}
     };
 
+    /// Stores information specified in a `line directive, which alters the
+    /// line number and file name that we report in diagnostics.
+    struct LineDirectiveInfo {
+        /// The file name set by the directive.
+        std::string name;
+
+        /// The actual line in the file where the directive occurred.
+        size_t lineInFile;
+
+        /// The line number set by the directive.
+        size_t lineOfDirective;
+
+        /// The level of the directive. Either 0, 1, or 2.
+        uint8_t level;
+
+        LineDirectiveInfo(std::string&& fname, size_t lif, size_t lod, uint8_t level) noexcept :
+            name(std::move(fname)), lineInFile(lif), lineOfDirective(lod), level(level) {}
+    };
+
+    /// Gets a copy of the line directives that have been added for the given buffer.
+    std::vector<LineDirectiveInfo> getLineDirectives(BufferID buffer) const;
+
+    /// Adds a set of line directives, as previously returned by @a getLineDirectives,
+    /// to the given buffer. This is used to restore the directives of a buffer with
+    /// the same text without having to preprocess it again.
+    void addLineDirectives(BufferID buffer, std::span<const LineDirectiveInfo> directives);
+
     /// Visits each buffer that contains diagnostic directives and invokes the provided
     /// callback with the first argument being the buffer and the second being an
     /// iterable collection of DiagnosticDirectiveInfos.
@@ -218,30 +296,38 @@ public:
     std::vector<BufferID> getAllBuffers() const;
 
 private:
-    // Stores information specified in a `line directive, which alters the
-    // line number and file name that we report in diagnostics.
-    struct LineDirectiveInfo {
-        std::string name;       // File name set by directive
-        size_t lineInFile;      // Actual file line where directive occurred
-        size_t lineOfDirective; // Line number set by directive
-        uint8_t level;          // Level of directive. Either 0, 1, or 2.
-
-        LineDirectiveInfo(std::string&& fname, size_t lif, size_t lod, uint8_t level) noexcept :
-            name(std::move(fname)), lineInFile(lif), lineOfDirective(lod), level(level) {}
-    };
-
     // Stores actual file contents and metadata; only one per loaded file
     struct FileData {
         const std::string name;                       // name of the file
-        const SmallVector<char> mem;                  // file contents
-        std::vector<size_t> lineOffsets;              // cache of compute line offsets
+        const SmallVector<char> mem;                  // file contents, if read into memory
+        const MappedFile mapping;                     // file contents, if memory mapped
+        const std::string_view text;                  // view of the file contents
+        std::vector<size_t> lineOffsets;              // cache of computed line offsets
+        std::once_flag lineOffsetsFlag;               // guards computing lineOffsets
         const std::filesystem::path* const directory; // directory in which the file exists
         const std::filesystem::path fullPath;         // full path to the file
+        bool isIncluded = false;                      // whether the file was ever included
+
+        // last write time of the file, or min() if it wasn't loaded from disk
+        std::filesystem::file_time_type modTime = std::filesystem::file_time_type::min();
 
         FileData(const std::filesystem::path* directory, std::string name, SmallVector<char>&& data,
                  std::filesystem::path fullPath) :
-            name(std::move(name)), mem(std::move(data)), directory(directory),
+            name(std::move(name)), mem(std::move(data)), text(mem.data(), mem.size()),
+            directory(directory), fullPath(std::move(fullPath)) {}
+
+        FileData(const std::filesystem::path* directory, std::string name, MappedFile&& data,
+                 std::filesystem::path fullPath) :
+            name(std::move(name)), mapping(std::move(data)),
+            text(mapping.data(), mapping.size()), directory(directory),
             fullPath(std::move(fullPath)) {}
+
+        // Gets the line offsets, computing them first if this is the first request.
+        // Once computed they never change, so they can be read without locking.
+        const std::vector<size_t>& getLineOffsets() {
+            std::call_once(lineOffsetsFlag, [this] { computeLineOffsets(text, lineOffsets); });
+            return lineOffsets;
+        }
     };
 
     // Stores a pointer to file data along with information about where we included it.
@@ -299,6 +385,11 @@ private:
     // cache for file lookups; this holds on to the actual file data
     flat_hash_map<std::string, std::pair<std::unique_ptr<FileData>, std::error_code>> lookupCache;
 
+    // file data that has been dropped from the lookup cache because the file
+    // changed on disk, kept alive for the buffers that still refer to it
+    // until releaseRetiredFiles is called
+    std::vector<std::unique_ptr<FileData>> retiredFiles;
+
     // directories for system and user includes
     std::vector<std::filesystem::path> systemDirectories;
     std::vector<std::filesystem::path> userDirectories;
@@ -311,6 +402,7 @@ private:
 
     std::atomic<uint32_t> unnamedBufferCount = 0;
     bool disableProximatePaths = false;
+    bool memoryMapFiles = false;
 
     template<IsLock TLock>
     FileInfo* getFileInfo(BufferID buffer, TLock& lock);
@@ -324,9 +416,12 @@ private:
 
     BufferOrError openCached(const std::filesystem::path& fullPath, SourceLocation includedFrom,
                              const SourceLibrary* library, uint64_t sortKey = UINT64_MAX);
+    template<typename TContents>
     SourceBuffer cacheBuffer(std::filesystem::path&& path, std::string&& pathStr,
                              SourceLocation includedFrom, const SourceLibrary* library,
-                             uint64_t sortKey, SmallVector<char>&& buffer);
+                             uint64_t sortKey, TContents&& contents,
+                             std::filesystem::file_time_type modTime =
+                                 std::filesystem::file_time_type::min());
 
     template<IsLock TLock>
     size_t getRawLineNumber(SourceLocation location, TLock& lock) const;
@@ -346,8 +441,7 @@ private:
     template<IsLock TLock>
     SourceRange getExpansionRangeImpl(SourceLocation location, TLock& lock) const;
 
-    static void computeLineOffsets(const SmallVector<char>& buffer,
-                                   std::vector<size_t>& offsets) noexcept;
+    static void computeLineOffsets(std::string_view text, std::vector<size_t>& offsets) noexcept;
 };
 
 } // namespace slang
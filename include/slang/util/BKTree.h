@@ -0,0 +1,62 @@
+//------------------------------------------------------------------------------
+//! @file BKTree.h
+//! @brief Index of strings for finding approximate matches
+//
+// SPDX-FileCopyrightText: Michael Popoloski
+// SPDX-License-Identifier: MIT
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "slang/util/SmallVector.h"
+
+namespace slang {
+
+/// A BK-tree of strings, using the edit distance between them (with replacements
+/// allowed) as its metric. This allows finding all of the strings that are within
+/// some small distance of a query string without comparing against each of them.
+///
+/// The tree does not copy the strings added to it; their storage must outlive the tree.
+class SLANG_EXPORT BKTree {
+public:
+    /// A string found by a call to @a find.
+    struct Match {
+        /// The index of the string, which is the number of strings
+        /// that were added to the tree before it.
+        uint32_t index;
+
+        /// The edit distance between the string and the query.
+        int distance;
+    };
+
+    /// Adds a string to the tree.
+    void add(std::string_view str);
+
+    /// Finds all strings in the tree that are no more than @a maxDistance
+    /// edits away from @a str. Matches are appended to @a results in no
+    /// particular order.
+    void find(std::string_view str, int maxDistance, SmallVectorBase<Match>& results) const;
+
+    /// Gets the number of strings that have been added to the tree.
+    size_t size() const { return nodes.size(); }
+
+    /// Indicates whether the tree is empty.
+    bool empty() const { return nodes.empty(); }
+
+private:
+    // Children of a node are kept in a singly linked list; each child
+    // records its distance from the parent.
+    struct Node {
+        std::string_view str;
+        int distance;
+        uint32_t firstChild = 0;
+        uint32_t nextSibling = 0;
+    };
+
+    // Index zero is the root, so it doubles as the "no node" value for links.
+    std::vector<Node> nodes;
+};
+
+} // namespace slang
@@ -0,0 +1,49 @@
+//------------------------------------------------------------------------------
+//! @file CpuFeatures.h
+//! @brief Runtime detection of host CPU capabilities
+//
+// SPDX-FileCopyrightText: Michael Popoloski
+// SPDX-License-Identifier: MIT
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "slang/util/Util.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#    define SLANG_SIMD_X86 1
+#    if defined(_MSC_VER) && !defined(__clang__)
+#        define SLANG_TARGET_AVX2
+#    else
+#        define SLANG_TARGET_AVX2 __attribute__((target("avx2")))
+#    endif
+#endif
+
+namespace slang {
+
+/// Levels of SIMD instruction set support that vectorized
+/// routines in the library know how to make use of.
+enum class SLANG_EXPORT SimdLevel {
+    /// No vector instructions; portable scalar code only.
+    Scalar,
+
+    /// 128-bit SSE2 instructions.
+    SSE2,
+
+    /// 256-bit AVX2 instructions.
+    AVX2
+};
+
+/// Returns the highest SIMD level supported by the host CPU.
+/// The result is computed once and cached.
+SLANG_EXPORT SimdLevel detectSimdLevel();
+
+/// Returns the SIMD level that vectorized routines should currently use.
+/// This defaults to the detected level of the host CPU.
+SLANG_EXPORT SimdLevel getSimdLevel();
+
+/// Limits vectorized routines to use at most the given SIMD level.
+/// Requests for a level higher than what the host supports are clamped.
+/// This is mostly useful for testing and benchmarking the various implementations.
+SLANG_EXPORT void setSimdLevel(SimdLevel level);
+
+} // namespace slang
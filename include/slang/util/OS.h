@@ -16,6 +16,41 @@
 
 namespace slang {
 
+/// @brief A read-only, memory-mapped view of the contents of a file.
+///
+/// The mapped contents are always followed by a null terminator, which is
+/// included in the reported size so that the view can be used directly as
+/// a source buffer. Mapped files must not be truncated by other processes
+/// while the mapping is alive.
+class SLANG_EXPORT MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /// Gets a pointer to the start of the mapped file contents.
+    const char* data() const { return static_cast<const char*>(base); }
+
+    /// Gets the size of the mapped file contents, including the null terminator.
+    size_t size() const { return length; }
+
+    /// Indicates whether the object holds a valid mapping.
+    explicit operator bool() const { return base != nullptr; }
+
+private:
+    friend class OS;
+
+    void reset();
+
+    void* base = nullptr;
+    size_t length = 0;
+    size_t mappedLength = 0;
+};
+
 /// A collection of various OS-specific utility functions.
 class SLANG_EXPORT OS {
 public:
@@ -42,6 +77,12 @@ public:
     /// Note that the buffer will be null-terminated.
     static std::error_code readFile(const std::filesystem::path& path, SmallVector<char>& buffer);
 
+    /// Maps the file at @a path into memory in read-only mode. If successful, the
+    /// mapping is placed into @a result -- otherwise, returns an error. Files that
+    /// can't be mapped (such as pipes or stdin) fail with std::errc::not_supported,
+    /// in which case the caller should fall back to @a readFile instead.
+    static std::error_code mapFile(const std::filesystem::path& path, MappedFile& result);
+
     /// Writes the given contents to the specified file.
     static void writeFile(const std::filesystem::path& path, std::string_view contents);
 
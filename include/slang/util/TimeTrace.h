@@ -27,6 +27,10 @@ public:
     /// Initializes time tracing support.
     static void initialize();
 
+    /// Disables time tracing and discards any results recorded since it
+    /// was initialized, allowing it to be initialized again later.
+    static void reset();
+
     /// Writes the results of time tracing to the given stream.
     /// The output is JSON, in Chrome "Trace Event" format, see
     /// https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU/preview
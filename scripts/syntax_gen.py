@@ -5,6 +5,7 @@
 # SPDX-License-Identifier: MIT
 
 import argparse
+import hashlib
 import math
 import os
 
@@ -57,6 +58,7 @@ def main():
         generatePyBindings(args.dir, alltypes)
     else:
         generateSyntaxClone(args.dir, alltypes, kindmap)
+        generateSyntaxDeserialize(ourdir, args.dir, alltypes, kindmap)
         generateSyntax(args.dir, alltypes, kindmap)
         generateTokenKinds(ourdir, args.dir)
 
@@ -945,6 +947,106 @@ SyntaxNode* clone(const SyntaxNode& node, BumpAllocator& alloc) {
     )
 
 
+def getSchemaHash(ourdir, alltypes, kindmap):
+    # Hashes everything that determines how serialized syntax trees are laid out:
+    # the numbering of the kind enums and the members of each node type, in order.
+    lines = ["Unknown", "SyntaxList", "TokenList", "SeparatedList"]
+    lines += [k for k, _ in sorted(kindmap.items())]
+    for k, v in sorted(alltypes.items()):
+        if not v.final:
+            continue
+        lines.append(k)
+        for m in v.combinedMembers:
+            lines.append("{} {} {}".format(m[0], m[1], m[1] in v.notNullMembers))
+
+    lines += loadkinds(ourdir, "triviakinds.txt")
+    lines += loadkinds(ourdir, "tokenkinds.txt")
+
+    digest = hashlib.sha256("\n".join(lines).encode("utf-8")).hexdigest()
+    return digest[:16]
+
+
+def generateSyntaxDeserialize(ourdir, builddir, alltypes, kindmap):
+    outf = open(os.path.join(builddir, "SyntaxDeserialize.cpp"), "w")
+    outf.write(
+        """//------------------------------------------------------------------------------
+// SyntaxDeserialize.cpp
+// All generated syntax node deserialization functionality
+//
+// SPDX-FileCopyrightText: Michael Popoloski
+// SPDX-License-Identifier: MIT
+//------------------------------------------------------------------------------
+#include "slang/syntax/AllSyntax.h"
+#include "slang/syntax/SyntaxSerializer.h"
+
+// This file contains all syntax generated deserialization implementations.
+// It is auto-generated by the syntax_gen.py script under the scripts/ directory.
+
+namespace slang::syntax::detail {
+
+uint64_t getSyntaxSchemaHash() {
+    return 0x%sull;
+}
+
+SyntaxNode* deserializeNode(SyntaxKind kind, SyntaxReader& reader) {
+    switch (kind) {
+"""
+        % getSchemaHash(ourdir, alltypes, kindmap)
+    )
+
+    # Group the kinds by the type that is used to represent them.
+    typeKinds = {}
+    for k, v in sorted(kindmap.items()):
+        typeKinds.setdefault(v, []).append(k)
+
+    for k, v in sorted(alltypes.items()):
+        if not v.final or k not in typeKinds:
+            continue
+
+        for kind in typeKinds[k]:
+            outf.write("        case SyntaxKind::{}:\n".format(kind))
+        outf.write("        {\n")
+
+        # Members must be read in order, so pull each one into
+        # a local before passing them all to the constructor.
+        # Required children that are missing mean the data is bad.
+        for m in v.combinedMembers:
+            if m[0] == "Token":
+                read = "reader.token()"
+            elif m[0] == "TokenList":
+                read = "reader.tokenList()"
+            elif m[0].startswith("SyntaxList<"):
+                read = "reader.list<{}>()".format(m[0][11:-1])
+            elif m[0].startswith("SeparatedSyntaxList<"):
+                read = "reader.separatedList<{}>()".format(m[0][20:-1])
+            else:
+                read = "reader.node<{}>()".format(m[2])
+
+            outf.write("            auto {} = {};\n".format(m[1], read))
+            if m[1] in v.notNullMembers:
+                outf.write("            if (!{}) {{\n".format(m[1]))
+                outf.write("                reader.failed = true;\n")
+                outf.write("                return nullptr;\n")
+                outf.write("            }\n")
+
+        args = [
+            "*" + m[1] if m[1] in v.notNullMembers else m[1] for m in v.combinedMembers
+        ]
+        if "kind" in v.argNames:
+            args.insert(0, "kind")
+
+        outf.write(
+            "            return reader.alloc.emplace<{}>({});\n".format(k, ", ".join(args))
+        )
+        outf.write("        }\n")
+
+    outf.write("        default:\n")
+    outf.write("            return nullptr;\n")
+    outf.write("    }\n")
+    outf.write("}\n\n")
+    outf.write("}\n")
+
+
 def loadkinds(ourdir, filename):
     kinds = []
     inf = open(os.path.join(ourdir, filename))
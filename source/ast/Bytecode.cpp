@@ -0,0 +1,992 @@
+//------------------------------------------------------------------------------
+// Bytecode.cpp
+// Bytecode compilation and execution of constant functions
+//
+// SPDX-FileCopyrightText: Michael Popoloski
+// SPDX-License-Identifier: MIT
+//------------------------------------------------------------------------------
+#include "slang/ast/Bytecode.h"
+
+#include "slang/ast/ASTVisitor.h"
+#include "slang/ast/EvalContext.h"
+#include "slang/diagnostics/ConstEvalDiags.h"
+
+namespace {
+
+using namespace slang;
+using namespace slang::ast;
+
+// Slot operands with this bit set refer to the table of constants
+// instead of to a local variable or temporary.
+constexpr uint32_t ConstantBit = 1u << 31;
+constexpr uint32_t NoSlot = UINT32_MAX;
+constexpr uint32_t NoItem = UINT32_MAX;
+
+bool isIncDec(UnaryOperator op) {
+    switch (op) {
+        case UnaryOperator::Preincrement:
+        case UnaryOperator::Predecrement:
+        case UnaryOperator::Postincrement:
+        case UnaryOperator::Postdecrement:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Conservatively determines whether evaluating the expression can modify
+// a local variable. Any call counts, since system calls can write to their
+// arguments and we don't want to re-evaluate user calls for no reason.
+bool hasSideEffects(const Expression& expr) {
+    bool result = false;
+    auto checker = makeVisitor([&](auto&, const AssignmentExpression&) { result = true; },
+                               [&](auto&, const CallExpression&) { result = true; },
+                               [&](auto& visitor, const UnaryExpression& unary) {
+                                   if (isIncDec(unary.op))
+                                       result = true;
+                                   else
+                                       visitor.visitDefault(unary);
+                               });
+    expr.visit(checker);
+    return result;
+}
+
+bool containsLValueRef(const Expression& expr) {
+    bool result = false;
+    auto checker = makeVisitor([&](auto&, const LValueReferenceExpression&) { result = true; });
+    expr.visit(checker);
+    return result;
+}
+
+// The tree walker flattens chains of nested if statements and evaluates
+// every condition in the chain before picking a branch to run; we can
+// only mimic that when no pattern matching is involved.
+bool isPlainChain(const ConditionalStatement& stmt) {
+    for (auto& cond : stmt.conditions) {
+        if (cond.pattern)
+            return false;
+    }
+
+    if (stmt.ifTrue.kind == StatementKind::Conditional &&
+        !isPlainChain(stmt.ifTrue.as<ConditionalStatement>())) {
+        return false;
+    }
+
+    if (stmt.ifFalse && stmt.ifFalse->kind == StatementKind::Conditional &&
+        !isPlainChain(stmt.ifFalse->as<ConditionalStatement>())) {
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+namespace slang::ast {
+
+class Bytecode::Compiler {
+public:
+    explicit Compiler(Bytecode& bc) : bc(bc) {}
+
+    void run() {
+        numLocals = uint32_t(bc.locals.size());
+        for (uint32_t i = 0; i < numLocals; i++)
+            localSlots.emplace(bc.locals[i], i);
+
+        nextTemp = maxTemp = numLocals;
+        bc.returnSlot = localSlots.at(bc.subroutine->returnValVar);
+
+        // Stray breaks and continues at the top level, which can only come from
+        // the tree walker, end the function just like a return.
+        Labels top;
+        labels = &top;
+        compileStmt(bc.subroutine->getBody());
+        resolve(top.breaks, here());
+        resolve(top.continues, here());
+
+        bc.numSlots = maxTemp;
+    }
+
+private:
+    using Fixups = SmallVector<std::pair<size_t, uint32_t Instruction::*>>;
+
+    // Jumps that need to be pointed at the exits of the innermost loop.
+    struct Labels {
+        Fixups breaks;
+        Fixups continues;
+    };
+
+    Bytecode& bc;
+    flat_hash_map<const ValueSymbol*, uint32_t> localSlots;
+    Labels* labels = nullptr;
+    uint32_t numLocals = 0;
+    uint32_t nextTemp = 0;
+    uint32_t maxTemp = 0;
+
+    // The local that LValueReference expressions refer to while
+    // compiling the right hand side of a compound assignment.
+    uint32_t compoundTarget = NoSlot;
+    bool lvalueRefDelegated = false;
+
+    // The number of emitted instructions that can fail at runtime.
+    uint32_t numFallible = 0;
+
+    uint32_t here() const { return uint32_t(bc.code.size()); }
+
+    size_t emit(Opcode op, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0) {
+        bc.code.push_back({op, a, b, c});
+        return bc.code.size() - 1;
+    }
+
+    size_t emit(Opcode op, const Expression& expr, uint32_t a = 0, uint32_t b = 0,
+                uint32_t c = 0) {
+        bc.code.push_back({op, a, b, c, &expr});
+        return bc.code.size() - 1;
+    }
+
+    size_t emit(Opcode op, const Statement& stmt, uint32_t a = 0, uint32_t b = 0,
+                uint32_t c = 0) {
+        bc.code.push_back({op, a, b, c, nullptr, &stmt});
+        return bc.code.size() - 1;
+    }
+
+    void resolve(const Fixups& fixups, uint32_t target) {
+        for (auto [index, field] : fixups)
+            bc.code[index].*field = target;
+    }
+
+    void rollback(size_t codeSize, uint32_t fallible, uint32_t mark) {
+        bc.code.erase(bc.code.begin() + ptrdiff_t(codeSize), bc.code.end());
+        numFallible = fallible;
+        nextTemp = mark;
+    }
+
+    uint32_t addConstant(ConstantValue value) {
+        bc.constants.emplace_back(std::move(value));
+        return uint32_t(bc.constants.size() - 1) | ConstantBit;
+    }
+
+    uint32_t allocTemp() {
+        uint32_t slot = nextTemp++;
+        maxTemp = std::max(maxTemp, nextTemp);
+        return slot;
+    }
+
+    // Releases temporaries allocated since @a mark and picks the slot
+    // where an expression should leave its result.
+    uint32_t target(uint32_t dest, uint32_t mark) {
+        nextTemp = mark;
+        return dest != NoSlot ? dest : allocTemp();
+    }
+
+    uint32_t use(uint32_t slot, uint32_t dest) {
+        if (dest == NoSlot || dest == slot)
+            return slot;
+
+        emit(Opcode::Move, dest, slot);
+        return dest;
+    }
+
+    uint32_t findLocal(const Expression& expr) const {
+        if (expr.kind != ExpressionKind::NamedValue || expr.type->isClass() ||
+            expr.type->isCovergroup()) {
+            return NoSlot;
+        }
+
+        auto it = localSlots.find(&expr.as<NamedValueExpression>().symbol);
+        return it == localSlots.end() ? NoSlot : it->second;
+    }
+
+    void step(const Statement& stmt) { emit(Opcode::Step, stmt); }
+
+    void treeStmt(const Statement& stmt) {
+        auto index = emit(Opcode::TreeStmt, stmt);
+        labels->breaks.push_back({index, &Instruction::b});
+        labels->continues.push_back({index, &Instruction::c});
+        numFallible++;
+    }
+
+    void compileBody(const Statement& body, Labels& loopLabels) {
+        auto saved = labels;
+        labels = &loopLabels;
+        compileStmt(body);
+        labels = saved;
+    }
+
+    // Emits a conditional jump on the value of the given expression;
+    // the jump target (operand b) is left for the caller to fill in.
+    size_t condJump(Opcode op, const Expression& expr) {
+        auto mark = nextTemp;
+        auto slot = compileExpr(expr, NoSlot);
+        nextTemp = mark;
+        return emit(op, slot);
+    }
+
+    // Statements are compiled such that they emit a step everywhere the tree
+    // walker would call Statement::eval, to keep step limits consistent.
+    void compileStmt(const Statement& stmt) {
+        auto mark = nextTemp;
+        switch (stmt.kind) {
+            case StatementKind::Empty:
+                step(stmt);
+                break;
+            case StatementKind::List:
+                step(stmt);
+                for (auto item : stmt.as<StatementList>().list)
+                    compileStmt(*item);
+                break;
+            case StatementKind::Block: {
+                auto& block = stmt.as<BlockStatement>();
+                if (block.blockKind != StatementBlockKind::Sequential) {
+                    treeStmt(stmt);
+                    break;
+                }
+
+                step(stmt);
+                compileStmt(block.body);
+                break;
+            }
+            case StatementKind::ExpressionStatement:
+                step(stmt);
+                compileExprStmt(stmt.as<ExpressionStatement>().expr);
+                break;
+            case StatementKind::VariableDeclaration:
+                step(stmt);
+                compileVarDecl(stmt.as<VariableDeclStatement>().symbol);
+                break;
+            case StatementKind::Return:
+                step(stmt);
+                if (auto expr = stmt.as<ReturnStatement>().expr)
+                    compileExpr(*expr, bc.returnSlot);
+                emit(Opcode::Return);
+                break;
+            case StatementKind::Break:
+                step(stmt);
+                labels->breaks.push_back({emit(Opcode::Jump), &Instruction::a});
+                break;
+            case StatementKind::Continue:
+                step(stmt);
+                labels->continues.push_back({emit(Opcode::Jump), &Instruction::a});
+                break;
+            case StatementKind::Conditional:
+                compileConditional(stmt.as<ConditionalStatement>());
+                break;
+            case StatementKind::ForLoop:
+                compileForLoop(stmt.as<ForLoopStatement>());
+                break;
+            case StatementKind::WhileLoop:
+                compileWhileLoop(stmt.as<WhileLoopStatement>());
+                break;
+            case StatementKind::DoWhileLoop:
+                compileDoWhileLoop(stmt.as<DoWhileLoopStatement>());
+                break;
+            default:
+                treeStmt(stmt);
+                break;
+        }
+        nextTemp = mark;
+    }
+
+    void compileExprStmt(const Expression& expr) {
+        if (expr.kind == ExpressionKind::Call) {
+            auto& call = expr.as<CallExpression>();
+            if (call.isSystemCall() && call.getSubroutineKind() == SubroutineKind::Task) {
+                emit(Opcode::SysTaskIgnored, expr);
+                return;
+            }
+        }
+        compileEffect(expr);
+    }
+
+    // Compiles an expression that is only evaluated for its side effects.
+    void compileEffect(const Expression& expr) {
+        auto mark = nextTemp;
+        if (expr.kind == ExpressionKind::UnaryOp && !expr.bad() && !expr.constant &&
+            isIncDec(expr.as<UnaryExpression>().op)) {
+            auto& unary = expr.as<UnaryExpression>();
+            auto local = findLocal(unary.operand());
+            if (local != NoSlot && unary.operand().type->isIntegral()) {
+                emit(Opcode::IncDec, expr, NoSlot, local);
+                return;
+            }
+        }
+
+        compileExpr(expr, NoSlot);
+        nextTemp = mark;
+    }
+
+    void compileVarDecl(const VariableSymbol& symbol) {
+        auto slot = localSlots.at(&symbol);
+        if (auto initializer = symbol.getInitializer()) {
+            // Initialization of static variables is skipped in constant functions.
+            if (symbol.lifetime != VariableLifetime::Static || initializer->bad()) {
+                compileExpr(*initializer, slot);
+                return;
+            }
+            emit(Opcode::StaticInitSkipped, *initializer);
+        }
+
+        emit(Opcode::Move, slot, addConstant(symbol.getType().getDefaultValue()));
+    }
+
+    void compileConditional(const ConditionalStatement& stmt) {
+        if (stmt.check != UniquePriorityCheck::None || !isPlainChain(stmt)) {
+            treeStmt(stmt);
+            return;
+        }
+
+        auto isConditional = [](const Statement* s) {
+            return s && s->kind == StatementKind::Conditional;
+        };
+
+        // A lone if / else can be done with a simple branch.
+        if (stmt.conditions.size() == 1 && !isConditional(&stmt.ifTrue) &&
+            !isConditional(stmt.ifFalse)) {
+            step(stmt);
+            auto skipTrue = condJump(Opcode::JumpIfNotTrue, *stmt.conditions[0].expr);
+            compileStmt(stmt.ifTrue);
+            if (stmt.ifFalse) {
+                auto skipFalse = emit(Opcode::Jump);
+                bc.code[skipTrue].b = here();
+                compileStmt(*stmt.ifFalse);
+                bc.code[skipFalse].a = here();
+            }
+            else {
+                bc.code[skipTrue].b = here();
+            }
+            return;
+        }
+
+        // Otherwise evaluate all of the conditions in the chain to select a
+        // branch, then jump to it. If any condition can fail we'd stop early
+        // where the tree walker wouldn't, so leave those chains to it.
+        auto codeSize = bc.code.size();
+        auto fallible = numFallible;
+        step(stmt);
+        emit(Opcode::ClearItem);
+
+        SmallVector<const Statement*> items;
+        compileChain(stmt, items);
+        if (numFallible != fallible) {
+            rollback(codeSize, fallible, nextTemp);
+            treeStmt(stmt);
+            return;
+        }
+
+        auto table = uint32_t(bc.jumpTables.size());
+        bc.jumpTables.emplace_back(items.size() + 1);
+        emit(Opcode::SwitchItem, table);
+
+        SmallVector<size_t> exits;
+        for (size_t i = 0; i < items.size(); i++) {
+            bc.jumpTables[table][i] = here();
+            compileStmt(*items[i]);
+            exits.push_back(emit(Opcode::Jump));
+        }
+
+        bc.jumpTables[table].back() = here();
+        for (auto exit : exits)
+            bc.code[exit].a = here();
+    }
+
+    void compileChain(const ConditionalStatement& stmt, SmallVector<const Statement*>& items) {
+        SmallVector<size_t> unmatched;
+        for (auto& cond : stmt.conditions)
+            unmatched.push_back(condJump(Opcode::JumpIfNotTrue, *cond.expr));
+
+        auto visitArm = [&](const Statement& arm) {
+            if (arm.kind == StatementKind::Conditional) {
+                compileChain(arm.as<ConditionalStatement>(), items);
+            }
+            else {
+                emit(Opcode::MarkItem, uint32_t(items.size()));
+                items.push_back(&arm);
+            }
+        };
+
+        visitArm(stmt.ifTrue);
+
+        // Nested conditionals in the else branch get visited even when
+        // this one matched; a plain else only when it didn't.
+        std::optional<size_t> skipFalse;
+        if (stmt.ifFalse && stmt.ifFalse->kind != StatementKind::Conditional)
+            skipFalse = emit(Opcode::Jump);
+
+        for (auto jump : unmatched)
+            bc.code[jump].b = here();
+
+        if (stmt.ifFalse)
+            visitArm(*stmt.ifFalse);
+
+        if (skipFalse)
+            bc.code[*skipFalse].a = here();
+    }
+
+    void compileForLoop(const ForLoopStatement& loop) {
+        step(loop);
+        for (auto init : loop.initializers)
+            compileEffect(*init);
+
+        Labels loopLabels;
+        auto top = here();
+        if (loop.stopExpr) {
+            auto exit = condJump(Opcode::JumpIfNotTrue, *loop.stopExpr);
+            loopLabels.breaks.push_back({exit, &Instruction::b});
+        }
+
+        compileBody(loop.body, loopLabels);
+
+        auto next = here();
+        for (auto stepExpr : loop.steps)
+            compileEffect(*stepExpr);
+        emit(Opcode::Jump, top);
+
+        resolve(loopLabels.continues, next);
+        resolve(loopLabels.breaks, here());
+    }
+
+    void compileWhileLoop(const WhileLoopStatement& loop) {
+        step(loop);
+
+        Labels loopLabels;
+        auto top = here();
+        auto exit = condJump(Opcode::JumpIfNotTrue, loop.cond);
+        loopLabels.breaks.push_back({exit, &Instruction::b});
+
+        compileBody(loop.body, loopLabels);
+        emit(Opcode::Jump, top);
+
+        resolve(loopLabels.continues, top);
+        resolve(loopLabels.breaks, here());
+    }
+
+    void compileDoWhileLoop(const DoWhileLoopStatement& loop) {
+        step(loop);
+
+        Labels loopLabels;
+        auto top = here();
+        compileBody(loop.body, loopLabels);
+
+        auto next = here();
+        auto repeat = condJump(Opcode::JumpIfTrue, loop.cond);
+        bc.code[repeat].b = top;
+
+        resolve(loopLabels.continues, next);
+        resolve(loopLabels.breaks, here());
+    }
+
+    // Compiles an expression, returning the slot that holds its result. If @a dest
+    // is given the result is always placed there, otherwise the result may be left
+    // in a local or a constant, which the caller must not modify.
+    uint32_t compileExpr(const Expression& expr, uint32_t dest) {
+        if (expr.constant)
+            return use(addConstant(*expr.constant), dest);
+
+        if (expr.bad())
+            return tree(expr, dest);
+
+        switch (expr.kind) {
+            case ExpressionKind::IntegerLiteral:
+                return use(addConstant(expr.as<IntegerLiteral>().getValue()), dest);
+            case ExpressionKind::UnbasedUnsizedIntegerLiteral:
+                return use(addConstant(expr.as<UnbasedUnsizedIntegerLiteral>().getValue()),
+                           dest);
+            case ExpressionKind::NamedValue:
+                if (auto local = findLocal(expr); local != NoSlot)
+                    return use(local, dest);
+                break;
+            case ExpressionKind::LValueReference:
+                if (compoundTarget != NoSlot)
+                    return use(compoundTarget, dest);
+                break;
+            case ExpressionKind::UnaryOp:
+                return compileUnary(expr.as<UnaryExpression>(), dest);
+            case ExpressionKind::BinaryOp:
+                return compileBinary(expr.as<BinaryExpression>(), dest);
+            case ExpressionKind::ConditionalOp:
+                return compileConditionalOp(expr.as<ConditionalExpression>(), dest);
+            case ExpressionKind::Conversion:
+                return compileConversion(expr.as<ConversionExpression>(), dest);
+            case ExpressionKind::ElementSelect:
+                return compileElementSelect(expr.as<ElementSelectExpression>(), dest);
+            case ExpressionKind::Assignment:
+                return compileAssignment(expr.as<AssignmentExpression>(), dest);
+            case ExpressionKind::Call:
+                return compileCall(expr.as<CallExpression>(), dest);
+            default:
+                break;
+        }
+
+        return tree(expr, dest);
+    }
+
+    // Compiles an operand whose value needs to survive the evaluation of its
+    // siblings; locals get copied if those siblings might modify them.
+    uint32_t compileOperand(const Expression& expr, bool siblingsHaveEffects) {
+        auto slot = compileExpr(expr, NoSlot);
+        if (siblingsHaveEffects && slot < numLocals) {
+            auto temp = allocTemp();
+            emit(Opcode::Move, temp, slot);
+            return temp;
+        }
+        return slot;
+    }
+
+    // Hands the expression off to the tree walker.
+    uint32_t tree(const Expression& expr, uint32_t dest) {
+        // The tree walker can't see the target of a compound assignment
+        // that we're compiling, so let the caller know to back off.
+        if (compoundTarget != NoSlot && containsLValueRef(expr))
+            lvalueRefDelegated = true;
+
+        auto dst = dest != NoSlot ? dest : allocTemp();
+        emit(Opcode::Tree, expr, dst);
+        numFallible++;
+        return dst;
+    }
+
+    uint32_t compileUnary(const UnaryExpression& unary, uint32_t dest) {
+        if (!unary.operand().type->isIntegral())
+            return tree(unary, dest);
+
+        auto mark = nextTemp;
+        if (isIncDec(unary.op)) {
+            auto local = findLocal(unary.operand());
+            if (local == NoSlot)
+                return tree(unary, dest);
+
+            auto dst = target(dest, mark);
+            emit(Opcode::IncDec, unary, dst, local);
+            return dst;
+        }
+
+        auto src = compileExpr(unary.operand(), NoSlot);
+        auto dst = target(dest, mark);
+        emit(Opcode::Unary, unary, dst, src);
+        return dst;
+    }
+
+    uint32_t compileBinary(const BinaryExpression& binary, uint32_t dest) {
+        if (!binary.left().type->isIntegral() || !binary.right().type->isIntegral())
+            return tree(binary, dest);
+
+        auto mark = nextTemp;
+        auto lhs = compileOperand(binary.left(), hasSideEffects(binary.right()));
+
+        // Short-circuiting operators skip the rhs entirely based on the lhs.
+        std::optional<size_t> shortCircuit;
+        bool shortCircuitValue = false;
+        switch (binary.op) {
+            case BinaryOperator::LogicalOr:
+                shortCircuit = emit(Opcode::JumpIfTrue, lhs);
+                shortCircuitValue = true;
+                break;
+            case BinaryOperator::LogicalAnd:
+                shortCircuit = emit(Opcode::JumpIfFalse, lhs);
+                shortCircuitValue = false;
+                break;
+            case BinaryOperator::LogicalImplication:
+                shortCircuit = emit(Opcode::JumpIfFalse, lhs);
+                shortCircuitValue = true;
+                break;
+            default:
+                break;
+        }
+
+        auto rhs = compileExpr(binary.right(), NoSlot);
+        auto dst = target(dest, mark);
+        emit(Opcode::Binary, binary, dst, lhs, rhs);
+
+        if (shortCircuit) {
+            auto done = emit(Opcode::Jump);
+            bc.code[*shortCircuit].b = here();
+            emit(Opcode::Move, dst, addConstant(SVInt(shortCircuitValue)));
+            bc.code[done].a = here();
+        }
+        return dst;
+    }
+
+    uint32_t compileConditionalOp(const ConditionalExpression& expr, uint32_t dest) {
+        // An unknown predicate is handed to the tree walker to merge both arms,
+        // which means evaluating the predicate a second time.
+        if (expr.conditions.size() != 1 || expr.conditions[0].pattern ||
+            hasSideEffects(*expr.conditions[0].expr)) {
+            return tree(expr, dest);
+        }
+
+        auto mark = nextTemp;
+        auto pred = compileExpr(*expr.conditions[0].expr, NoSlot);
+        auto unknown = emit(Opcode::JumpIfUnknown, pred);
+        auto isFalse = emit(Opcode::JumpIfNotTrue, pred);
+
+        auto dst = target(dest, mark);
+        compileExpr(expr.left(), dst);
+        auto doneLeft = emit(Opcode::Jump);
+
+        bc.code[isFalse].b = here();
+        compileExpr(expr.right(), dst);
+        auto doneRight = emit(Opcode::Jump);
+
+        bc.code[unknown].b = here();
+        tree(expr, dst);
+
+        bc.code[doneLeft].a = here();
+        bc.code[doneRight].a = here();
+        return dst;
+    }
+
+    uint32_t compileConversion(const ConversionExpression& conv, uint32_t dest) {
+        if (!conv.type->isIntegral() || !conv.operand().type->isIntegral())
+            return tree(conv, dest);
+
+        auto mark = nextTemp;
+        auto src = compileExpr(conv.operand(), NoSlot);
+        auto dst = target(dest, mark);
+        emit(Opcode::Convert, conv, dst, src);
+        return dst;
+    }
+
+    uint32_t compileElementSelect(const ElementSelectExpression& select, uint32_t dest) {
+        if (!select.value().type->hasFixedRange() || !select.selector().type->isIntegral())
+            return tree(select, dest);
+
+        auto mark = nextTemp;
+        auto value = compileOperand(select.value(), hasSideEffects(select.selector()));
+        auto index = compileExpr(select.selector(), NoSlot);
+        auto dst = target(dest, mark);
+        emit(Opcode::Select, select, dst, value, index);
+        return dst;
+    }
+
+    uint32_t compileAssignment(const AssignmentExpression& assign, uint32_t dest) {
+        if (assign.timingControl)
+            return tree(assign, dest);
+
+        // Whole variable assignments evaluate the rhs straight into the local.
+        auto& left = assign.left();
+        if (auto local = findLocal(left); local != NoSlot && !left.type->isQueue()) {
+            auto codeSize = bc.code.size();
+            auto fallible = numFallible;
+            auto mark = nextTemp;
+            auto savedTarget = compoundTarget;
+            auto savedDelegated = std::exchange(lvalueRefDelegated, false);
+            if (assign.isCompound())
+                compoundTarget = local;
+
+            compileExpr(assign.right(), local);
+
+            compoundTarget = savedTarget;
+            bool delegated = std::exchange(lvalueRefDelegated, savedDelegated);
+            if (delegated && assign.isCompound()) {
+                rollback(codeSize, fallible, mark);
+                return tree(assign, dest);
+            }
+
+            lvalueRefDelegated |= delegated;
+            return use(local, dest);
+        }
+
+        // Stores to a single element of a local fixed size array.
+        if (left.kind == ExpressionKind::ElementSelect && !assign.isCompound()) {
+            auto& select = left.as<ElementSelectExpression>();
+            auto local = findLocal(select.value());
+            if (local != NoSlot && select.value().type->hasFixedRange() &&
+                select.type->isIntegral() && select.selector().type->isIntegral()) {
+                auto index = compileOperand(select.selector(), hasSideEffects(assign.right()));
+                auto value = compileExpr(assign.right(), NoSlot);
+                emit(Opcode::StoreSelect, select, local, index, value);
+                return use(value, dest);
+            }
+        }
+
+        return tree(assign, dest);
+    }
+
+    uint32_t compileCall(const CallExpression& call, uint32_t dest) {
+        if (call.isSystemCall() || call.thisClass())
+            return tree(call, dest);
+
+        auto mark = nextTemp;
+        emit(Opcode::CheckCall, call);
+        numFallible++;
+
+        // Arguments are evaluated into consecutive temporaries so that
+        // they can be passed along as a single span.
+        auto args = call.arguments();
+        auto first = args.empty() ? 0 : nextTemp;
+        for (size_t i = 0; i < args.size(); i++)
+            allocTemp();
+
+        for (size_t i = 0; i < args.size(); i++)
+            compileExpr(*args[i], first + uint32_t(i));
+
+        auto dst = target(dest, mark);
+        emit(Opcode::Call, call, dst, first, uint32_t(args.size()));
+        numFallible++;
+        return dst;
+    }
+};
+
+std::unique_ptr<Bytecode> Bytecode::compile(const SubroutineSymbol& subroutine) {
+    auto& body = subroutine.getBody();
+    if (body.bad() || !subroutine.returnValVar)
+        return nullptr;
+
+    // Every local in the subroutine's frame layout gets a slot, in the same order.
+    // The layout can be missing the body's locals if it was requested while the body
+    // was still being bound; we need a slot for each of them, so give up in that case.
+    // Disable statements unwind through blocks in a way we don't model, so bodies
+    // containing them are left to the tree walker as well.
+    auto& layout = subroutine.getCompilation().getEvalFrameLayout(subroutine);
+    bool canCompile = true;
+    auto scanner = makeVisitor(
+        [&](auto& visitor, const VariableDeclStatement& stmt) {
+            if (!layout.find(&stmt.symbol))
+                canCompile = false;
+            visitor.visitDefault(stmt);
+        },
+        [&](auto&, const DisableStatement&) { canCompile = false; });
+    body.visit(scanner);
+
+    if (!canCompile)
+        return nullptr;
+
+    std::unique_ptr<Bytecode> result(new Bytecode(subroutine));
+    result->locals.assign(layout.getLocals().begin(), layout.getLocals().end());
+
+    Compiler compiler(*result);
+    compiler.run();
+    return result;
+}
+
+ConstantValue Bytecode::run(EvalContext& context, SourceLocation callLocation,
+                            LookupLocation lookupLocation, std::span<ConstantValue> args) const {
+    if (!context.pushFrame(*subroutine, callLocation, lookupLocation))
+        return nullptr;
+
+    // Locals live in the stack frame, where anything we hand off to
+    // the tree walker will look for them.
+    SmallVector<ConstantValue*> slots;
+    slots.reserve(numSlots);
+    for (size_t i = 0; i < locals.size(); i++) {
+        if (i < args.size())
+            slots.push_back(context.createLocal(locals[i], std::move(args[i])));
+        else
+            slots.push_back(context.createLocal(locals[i]));
+    }
+
+    SmallVector<ConstantValue> temps;
+    temps.resize(numSlots - locals.size());
+    for (auto& temp : temps)
+        slots.push_back(&temp);
+
+    bool ok = execute(context, slots);
+
+    ConstantValue result = std::move(*slots[returnSlot]);
+    context.popFrame();
+
+    if (!ok)
+        return nullptr;
+    return result;
+}
+
+bool Bytecode::execute(EvalContext& context, std::span<ConstantValue*> slots) const {
+    const auto numLocals = locals.size();
+    auto in = [&](uint32_t slot) -> const ConstantValue& {
+        if (slot & ConstantBit)
+            return constants[slot & ~ConstantBit];
+        return *slots[slot];
+    };
+
+    // Temporaries are only ever read once, so their values can be moved out.
+    auto take = [&](uint32_t slot) -> ConstantValue {
+        if (slot & ConstantBit)
+            return constants[slot & ~ConstantBit];
+        if (slot >= numLocals)
+            return std::move(*slots[slot]);
+        return *slots[slot];
+    };
+
+    using ER = Statement::EvalResult;
+    uint32_t selectedItem = NoItem;
+    size_t pc = 0;
+    while (pc < code.size()) {
+        auto& inst = code[pc++];
+        switch (inst.op) {
+            case Opcode::Step:
+                if (!context.step(inst.stmt->sourceRange.start()))
+                    return false;
+                break;
+            case Opcode::StaticInitSkipped:
+                context.addDiag(diag::ConstEvalStaticSkipped, inst.expr->sourceRange);
+                break;
+            case Opcode::SysTaskIgnored:
+                context.addDiag(diag::ConstSysTaskIgnored, inst.expr->sourceRange)
+                    << inst.expr->as<CallExpression>().getSubroutineName();
+                break;
+            case Opcode::Move:
+                if (inst.a != inst.b)
+                    *slots[inst.a] = take(inst.b);
+                break;
+            case Opcode::Tree: {
+                ConstantValue cv = inst.expr->eval(context);
+                if (cv.bad())
+                    return false;
+                *slots[inst.a] = std::move(cv);
+                break;
+            }
+            case Opcode::TreeStmt: {
+                ER result = inst.stmt->eval(context);
+                if (result == ER::Return)
+                    return true;
+                if (result == ER::Break)
+                    pc = inst.b;
+                else if (result == ER::Continue)
+                    pc = inst.c;
+                else if (result != ER::Success)
+                    return false;
+                break;
+            }
+            case Opcode::CheckCall: {
+                auto& call = inst.expr->as<CallExpression>();
+                if (!CallExpression::checkConstant(context, *std::get<0>(call.subroutine),
+                                                   call.sourceRange)) {
+                    return false;
+                }
+                break;
+            }
+            case Opcode::Call: {
+                std::span<ConstantValue> args;
+                if (inst.c)
+                    args = std::span<ConstantValue>(slots[inst.b], inst.c);
+
+                ConstantValue cv = inst.expr->as<CallExpression>().evalWithArgs(context, args);
+                if (cv.bad())
+                    return false;
+                *slots[inst.a] = std::move(cv);
+                break;
+            }
+            case Opcode::Unary:
+                *slots[inst.a] = inst.expr->as<UnaryExpression>().applyTo(take(inst.b));
+                break;
+            case Opcode::IncDec: {
+                // Like the tree walker, store to the variable before producing the result.
+                auto& unary = inst.expr->as<UnaryExpression>();
+                auto& local = *slots[inst.b];
+                ConstantValue result;
+                if (inst.a != NoSlot && (unary.op == UnaryOperator::Postincrement ||
+                                         unary.op == UnaryOperator::Postdecrement)) {
+                    result = local;
+                }
+
+                if (unary.op == UnaryOperator::Preincrement ||
+                    unary.op == UnaryOperator::Postincrement) {
+                    ++local.integer();
+                }
+                else {
+                    --local.integer();
+                }
+
+                if (inst.a != NoSlot) {
+                    if (!result)
+                        result = local;
+                    *slots[inst.a] = std::move(result);
+                }
+                break;
+            }
+            case Opcode::Binary:
+                *slots[inst.a] = inst.expr->as<BinaryExpression>().applyTo(in(inst.b),
+                                                                           in(inst.c));
+                break;
+            case Opcode::Convert: {
+                ConstantValue cv = inst.expr->as<ConversionExpression>().applyTo(context,
+                                                                                 take(inst.b));
+                if (cv.bad())
+                    return false;
+                *slots[inst.a] = std::move(cv);
+                break;
+            }
+            case Opcode::Select: {
+                auto& select = inst.expr->as<ElementSelectExpression>();
+                auto& value = in(inst.b);
+                bool softFail = false;
+                auto range = select.translateIndex(context, value, in(inst.c), softFail);
+
+                ConstantValue result;
+                if (!range) {
+                    if (!softFail)
+                        return false;
+                    result = select.type->getDefaultValue();
+                }
+                else if (value.isUnpacked()) {
+                    result = value.elements()[size_t(range->left)];
+                }
+                else {
+                    result = value.integer().slice(range->left, range->right);
+                }
+
+                *slots[inst.a] = std::move(result);
+                break;
+            }
+            case Opcode::StoreSelect: {
+                // Out of range writes are ignored, same as with an LValue.
+                auto& select = inst.expr->as<ElementSelectExpression>();
+                auto& local = *slots[inst.a];
+                bool softFail = false;
+                auto range = select.translateIndex(context, local, in(inst.b), softFail);
+                if (!range) {
+                    if (!softFail)
+                        return false;
+                    break;
+                }
+
+                auto& value = in(inst.c);
+                if (local.isUnpacked())
+                    local.elements()[size_t(range->left)] = value;
+                else
+                    local.integer().set(range->upper(), range->lower(), value.integer());
+                break;
+            }
+            case Opcode::Jump:
+                pc = inst.a;
+                break;
+            case Opcode::JumpIfTrue:
+                if (in(inst.a).isTrue())
+                    pc = inst.b;
+                break;
+            case Opcode::JumpIfFalse:
+                if (in(inst.a).isFalse())
+                    pc = inst.b;
+                break;
+            case Opcode::JumpIfNotTrue:
+                if (!in(inst.a).isTrue())
+                    pc = inst.b;
+                break;
+            case Opcode::JumpIfUnknown: {
+                auto& cv = in(inst.a);
+                if (cv.isInteger() && cv.integer().hasUnknown())
+                    pc = inst.b;
+                break;
+            }
+            case Opcode::ClearItem:
+                selectedItem = NoItem;
+                break;
+            case Opcode::MarkItem:
+                if (selectedItem == NoItem)
+                    selectedItem = inst.a;
+                break;
+            case Opcode::SwitchItem: {
+                // The last entry in the table is for when nothing was selected.
+                auto& table = jumpTables[inst.a];
+                pc = table[selectedItem == NoItem ? table.size() - 1 : selectedItem];
+                break;
+            }
+            case Opcode::Return:
+                return true;
+        }
+    }
+
+    return true;
+}
+
+} // namespace slang::ast
@@ -9,9 +9,13 @@
 
 #include "ElabVisitors.h"
 #include "builtins/Builtins.h"
+#include <condition_variable>
+#include <deque>
 #include <fmt/core.h>
 #include <mutex>
 
+#include "slang/ast/Bytecode.h"
+#include "slang/ast/EvalContext.h"
 #include "slang/ast/ScriptSession.h"
 #include "slang/ast/SystemSubroutine.h"
 #include "slang/ast/types/TypePrinter.h"
@@ -24,6 +28,7 @@
 #include "slang/syntax/SyntaxTree.h"
 #include "slang/text/CharInfo.h"
 #include "slang/text/SourceManager.h"
+#include "slang/util/ThreadPool.h"
 #include "slang/util/TimeTrace.h"
 
 using namespace slang::parsing;
@@ -1216,6 +1221,197 @@ const Expression* Compilation::getDefaultDisable(const Scope& scope) const {
     }
 }
 
+const Bytecode* Compilation::getConstantFunctionBytecode(const SubroutineSymbol& subroutine) {
+    if (auto it = bytecodeMap.find(&subroutine); it != bytecodeMap.end())
+        return it->second.get();
+
+    auto bytecode = Bytecode::compile(subroutine);
+    auto result = bytecode.get();
+    bytecodeMap.emplace(&subroutine, std::move(bytecode));
+    return result;
+}
+
+const EvalFrameLayout& Compilation::getEvalFrameLayout(const SubroutineSymbol& subroutine) {
+    if (auto it = frameLayoutMap.find(&subroutine); it != frameLayoutMap.end())
+        return *it->second;
+
+    // Building the layout binds the body of the subroutine, which can end up evaluating
+    // a call to it and requesting its layout recursively. The inner request gets a layout
+    // that's missing the body's locals; that's fine since any local not in a layout is
+    // stored separately in the frame, so we just keep whichever layout got there first.
+    auto layout = std::make_unique<EvalFrameLayout>(subroutine);
+    return *frameLayoutMap.emplace(&subroutine, std::move(layout)).first->second;
+}
+
+static bool isDeclaredWithin(const Symbol& symbol, const SubroutineSymbol& subroutine) {
+    for (auto scope = symbol.getParentScope(); scope; scope = scope->asSymbol().getParentScope()) {
+        if (&scope->asSymbol() == &subroutine)
+            return true;
+    }
+    return false;
+}
+
+bool Compilation::canMemoizeConstexprCalls(const SubroutineSymbol& subroutine) {
+    if (auto it = memoizableFunctions.find(&subroutine); it != memoizableFunctions.end())
+        return it->second;
+
+    // Check the body of the function along with the bodies of every function it can
+    // end up calling. Only the answer for the function we were asked about gets
+    // recorded; the others may be part of a cycle that hasn't been fully explored.
+    SmallVector<const SubroutineSymbol*> worklist;
+    SmallSet<const SubroutineSymbol*, 4> visited;
+    worklist.push_back(&subroutine);
+    visited.emplace(&subroutine);
+
+    bool result = true;
+    while (result && !worklist.empty()) {
+        auto& current = *worklist.back();
+        worklist.pop_back();
+
+        if (&current != &subroutine) {
+            if (auto it = memoizableFunctions.find(&current); it != memoizableFunctions.end()) {
+                result = it->second;
+                continue;
+            }
+        }
+
+        if (current.subroutineKind != SubroutineKind::Function || !current.returnValVar ||
+            current.thisVar || current.hasOutputArgs()) {
+            result = false;
+            break;
+        }
+
+        auto& body = current.getBody();
+        if (body.bad()) {
+            result = false;
+            break;
+        }
+
+        auto visitor = makeVisitor(
+            [&](auto&, const HierarchicalValueExpression&) { result = false; },
+            [&](auto&, const NamedValueExpression& expr) {
+                switch (expr.symbol.kind) {
+                    case SymbolKind::Parameter:
+                    case SymbolKind::EnumValue:
+                        break;
+                    default:
+                        if (!isDeclaredWithin(expr.symbol, current))
+                            result = false;
+                        break;
+                }
+            },
+            [&](auto& v, const CallExpression& call) {
+                if (call.isSystemCall()) {
+                    if (call.getSubroutineKind() == SubroutineKind::Task)
+                        result = false;
+                }
+                else if (call.thisClass()) {
+                    result = false;
+                }
+                else if (auto callee = std::get<0>(call.subroutine);
+                         visited.emplace(callee).second) {
+                    worklist.push_back(callee);
+                }
+                v.visitDefault(call);
+            });
+        body.visit(visitor);
+    }
+
+    memoizableFunctions[&subroutine] = result;
+    return result;
+}
+
+const ConstantValue* Compilation::findConstexprCallResult(const SubroutineSymbol& subroutine,
+                                                         std::span<const ConstantValue> args) {
+    auto it = constexprCallCache.find(ConstexprCallRef{&subroutine, args});
+    if (it == constexprCallCache.end()) {
+        constexprCallCacheStats.misses++;
+        return nullptr;
+    }
+
+    constexprCallCacheStats.hits++;
+    return &it->second;
+}
+
+void Compilation::addConstexprCallResult(const SubroutineSymbol& subroutine,
+                                         std::vector<ConstantValue> args,
+                                         const ConstantValue& result) {
+    const size_t limit = options.maxConstexprCallCache;
+    if (!limit)
+        return;
+
+    // Rather than tracking how recently each entry was used, just start
+    // over when the cache fills up; results that are needed again will
+    // get added back soon enough.
+    if (constexprCallCache.size() >= limit) {
+        constexprCallCacheStats.evictions += constexprCallCache.size();
+        constexprCallCache.clear();
+    }
+
+    constexprCallCache.emplace(ConstexprCallKey{&subroutine, std::move(args)}, result);
+}
+
+// Checks whether two argument values are indistinguishable to the function being called.
+// This is stricter than ConstantValue's operator==: reals must have the same bits, since
+// 0.0 and -0.0 compare equal but can lead to different results, and associative arrays
+// must have the same default value. Values that match here always hash the same.
+static bool isSameArgValue(const ConstantValue& lhs, const ConstantValue& rhs) {
+    if (lhs.isReal()) {
+        return rhs.isReal() && std::bit_cast<uint64_t>(double(lhs.real())) ==
+                                   std::bit_cast<uint64_t>(double(rhs.real()));
+    }
+
+    if (lhs.isShortReal()) {
+        return rhs.isShortReal() && std::bit_cast<uint32_t>(float(lhs.shortReal())) ==
+                                        std::bit_cast<uint32_t>(float(rhs.shortReal()));
+    }
+
+    if (lhs.isUnpacked()) {
+        return rhs.isUnpacked() &&
+               std::ranges::equal(lhs.elements(), rhs.elements(), isSameArgValue);
+    }
+
+    if (lhs.isQueue())
+        return rhs.isQueue() && std::ranges::equal(*lhs.queue(), *rhs.queue(), isSameArgValue);
+
+    if (lhs.isMap()) {
+        if (!rhs.isMap())
+            return false;
+
+        auto& lm = *lhs.map();
+        auto& rm = *rhs.map();
+        return isSameArgValue(lm.defaultValue, rm.defaultValue) &&
+               std::ranges::equal(lm, rm, [](auto& l, auto& r) {
+                   return isSameArgValue(l.first, r.first) && isSameArgValue(l.second, r.second);
+               });
+    }
+
+    if (lhs.isUnion()) {
+        if (!rhs.isUnion())
+            return false;
+
+        auto& lu = *lhs.unionVal();
+        auto& ru = *rhs.unionVal();
+        return lu.activeMember == ru.activeMember && isSameArgValue(lu.value, ru.value);
+    }
+
+    return lhs == rhs;
+}
+
+size_t Compilation::ConstexprCallHash::operator()(const ConstexprCallRef& ref) const {
+    size_t h = 0;
+    hash_combine(h, ref.subroutine);
+    for (auto& arg : ref.args)
+        hash_combine(h, arg.hash());
+    return h;
+}
+
+bool Compilation::ConstexprCallEqual::operator()(const ConstexprCallRef& lhs,
+                                                 const ConstexprCallRef& rhs) const {
+    return lhs.subroutine == rhs.subroutine &&
+           std::ranges::equal(lhs.args, rhs.args, isSameArgValue);
+}
+
 void Compilation::noteExternDefinition(const Scope& scope, const SyntaxNode& syntax) {
     auto nameToken = getExternNameToken(syntax);
     auto name = nameToken.valueText();
@@ -1311,12 +1507,108 @@ void Compilation::elaborate() {
     // we can be sure we have all the diagnostics.
     uint32_t errorLimit = options.errorLimit == 0 ? UINT32_MAX : options.errorLimit;
     DiagnosticVisitor elabVisitor(*this, numErrors, errorLimit);
+
+    // If only some parts of the hierarchy were requested, skip any instances
+    // that aren't within them or above them.
+    SmallVector<const Symbol*> elabRoots;
+    flat_hash_set<const Symbol*> selected;
+    auto isSelected = [&](const Symbol& symbol) {
+        for (auto sym = &symbol; sym;) {
+            if (selected.contains(sym))
+                return true;
+
+            if (sym->kind == SymbolKind::InstanceBody) {
+                sym = sym->as<InstanceBodySymbol>().parentInstance;
+            }
+            else {
+                auto scope = sym->getParentScope();
+                sym = scope ? &scope->asSymbol() : nullptr;
+            }
+        }
+        return false;
+    };
+
+    auto skipInstance = [&](const InstanceSymbol& symbol) {
+        return !elabVisitor.partialBodies.contains(&symbol.body) && !isSelected(symbol);
+    };
+
+    if (!options.elabPaths.empty()) {
+        SmallVector<const Symbol*> found;
+        findElabPaths(found);
+        selected.insert(found.begin(), found.end());
+
+        for (auto symbol : found) {
+            auto scope = symbol->getParentScope();
+            if (!scope || !isSelected(scope->asSymbol())) {
+                if (std::ranges::find(elabRoots, symbol) == elabRoots.end())
+                    elabRoots.push_back(symbol);
+            }
+
+            for (auto body = scope ? scope->getContainingInstance() : nullptr; body;
+                 body = body->parentInstance->getParentScope()->getContainingInstance()) {
+                elabVisitor.partialBodies.emplace(body);
+            }
+        }
+
+        elabVisitor.skipInstance = skipInstance;
+    }
+
     getRoot().visit(elabVisitor);
 
     if (elabVisitor.finishedEarly())
         return;
 
     elabVisitor.finalize();
+    finishElaboration(elabVisitor);
+
+    if (!hasFlag(CompilationFlags::SuppressUnused)) {
+        // Unused symbols can only be reliably found within
+        // the selected parts of the hierarchy, if there are any.
+        PostElabVisitor postElabVisitor(*this);
+        if (options.elabPaths.empty()) {
+            getRoot().visit(postElabVisitor);
+        }
+        else {
+            for (auto symbol : elabRoots)
+                symbol->visit(postElabVisitor);
+        }
+    }
+}
+
+void Compilation::findElabPaths(SmallVector<const Symbol*>& results) {
+    auto& root = getRoot();
+    for (auto& path : options.elabPaths) {
+        const Symbol* symbol = nullptr;
+        Diagnostics localDiags;
+        auto& name = tryParseName(path, localDiags);
+        if (localDiags.empty()) {
+            LookupResult result;
+            ASTContext context(root, LookupLocation::max);
+            Lookup::name(name, context, LookupFlags::None, result);
+            if (result.selectors.empty())
+                symbol = result.found;
+        }
+
+        if (symbol) {
+            switch (symbol->kind) {
+                case SymbolKind::Instance:
+                case SymbolKind::InstanceArray:
+                case SymbolKind::GenerateBlock:
+                case SymbolKind::GenerateBlockArray:
+                    results.push_back(symbol);
+                    continue;
+                default:
+                    break;
+            }
+        }
+
+        root.addDiag(diag::InvalidElabPath, SourceLocation::NoLocation) << path;
+    }
+}
+
+void Compilation::finishElaboration(DiagnosticVisitor& elabVisitor) {
+    if (!elabVisitor.sharedInstances.empty())
+        noteSharedInstances(elabVisitor.sharedInstances);
 
     // Note for the following checks here: anything that depends on a list
     // stored in the compilation object should think carefully about taking
@@ -1328,130 +1620,991 @@ void Compilation::elaborate() {
     if (!dpiExports.empty() || !elabVisitor.dpiImports.empty())
         checkDPIMethods(elabVisitor.dpiImports);
 
-    // Check extern interface methods for correctness.
-    if (!externInterfaceMethods.empty()) {
-        auto methods = externInterfaceMethods;
-        for (auto method : methods)
-            method->connectExternInterfacePrototype();
+    // Check extern interface methods for correctness.
+    if (!externInterfaceMethods.empty()) {
+        auto methods = externInterfaceMethods;
+        for (auto method : methods)
+            method->connectExternInterfacePrototype();
+    }
+
+    if (!elabVisitor.externIfaceProtos.empty())
+        checkExternIfaceMethods(elabVisitor.externIfaceProtos);
+
+    if (!elabVisitor.modportsWithExports.empty())
+        checkModportExports(elabVisitor.modportsWithExports);
+
+    checkBindsAndNameConflicts();
+
+    // Report on unused out-of-block definitions. These are always a real error.
+    if (!outOfBlockDecls.empty()) {
+        auto decls = outOfBlockDecls;
+        for (auto& [key, val] : decls) {
+            auto& [syntax, name, index, used] = val;
+            if (!used) {
+                auto& [className, declName, scope] = key;
+                auto classRange = name->left->sourceRange();
+                auto sym = Lookup::unqualifiedAt(*scope, className,
+                                                 LookupLocation(scope, uint32_t(index)),
+                                                 classRange);
+
+                if (sym && !declName.empty() && !className.empty()) {
+                    if (sym->kind == SymbolKind::ClassType ||
+                        sym->kind == SymbolKind::GenericClassDef) {
+                        auto& diag = scope->addDiag(diag::NoDeclInClass, name->sourceRange());
+                        diag << declName << className;
+                    }
+                    else {
+                        auto& diag = scope->addDiag(diag::NotAClass, classRange);
+                        diag << className;
+                    }
+                }
+            }
+        }
+    }
+
+    // Report on unused config rules.
+    if (!configBlocks.empty()) {
+        for (auto& [name, confList] : configBlocks) {
+            for (auto config : confList) {
+                if (config->isUsed)
+                    config->checkUnusedRules();
+            }
+        }
+    }
+
+    if (!hasFlag(CompilationFlags::AllowTopLevelIfacePorts)) {
+        // Top level instances cannot have interface or ref ports.
+        for (auto inst : getRoot().topInstances) {
+            for (auto port : inst->body.getPortList()) {
+                if (port->kind == SymbolKind::InterfacePort) {
+                    inst->body.addDiag(diag::TopModuleIfacePort, port->location)
+                        << inst->name << port->name;
+                    break;
+                }
+                else {
+                    ArgumentDirection dir;
+                    if (port->kind == SymbolKind::MultiPort)
+                        dir = port->as<MultiPortSymbol>().direction;
+                    else
+                        dir = port->as<PortSymbol>().direction;
+
+                    if (dir == ArgumentDirection::Ref) {
+                        if (port->name.empty()) {
+                            inst->body.addDiag(diag::TopModuleUnnamedRefPort, port->location)
+                                << inst->name;
+                        }
+                        else {
+                            inst->body.addDiag(diag::TopModuleRefPort, port->location)
+                                << inst->name << port->name;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Interfaces can be used by ports in instances that weren't elaborated,
+    // so unused definitions can only be found when elaborating everything.
+    if (!hasFlag(CompilationFlags::SuppressUnused) && options.elabPaths.empty()) {
+        // Report on unused definitions.
+        for (auto def : unreferencedDefs) {
+            // If this is an interface, it may have been referenced in a port.
+            if (elabVisitor.usedIfacePorts.find(def) != elabVisitor.usedIfacePorts.end())
+                continue;
+
+            auto hasUnusedAttrib = [&] {
+                for (auto attr : getAttributes(*def)) {
+                    if (attr->name == "unused"sv || attr->name == "maybe_unused"sv)
+                        return attr->getValue().isTrue();
+                }
+                return false;
+            };
+
+            if (!def->name.empty() && def->name != "_"sv && !hasUnusedAttrib()) {
+                def->getParentScope()->addDiag(diag::UnusedDefinition, def->location)
+                    << def->getKindString();
+            }
+        }
+    }
+}
+
+void Compilation::checkBindsAndNameConflicts() {
+    // Double check any bind directives for correctness. These were already
+    // resolved prior to full elaboration but their diagnostics were not
+    // issued so we need to check again.
+    for (auto [directive, scope] : bindDirectives) {
+        ResolvedBind resolvedBind;
+        resolveBindTargets(*directive, *scope, resolvedBind);
+        checkBindTargetParams(*directive, *scope, resolvedBind);
+    }
+
+    // Report any lingering name conflicts.
+    if (!nameConflicts.empty()) {
+        auto conflicts = nameConflicts;
+        for (auto symbol : conflicts) {
+            auto scope = symbol->getParentScope();
+            SLANG_ASSERT(scope);
+            scope->handleNameConflict(*symbol);
+        }
+    }
+}
+
+// Finds which of the given partition roots contains the given symbol, if any.
+// Also notes whether the symbol is inside of an instance at all.
+static std::optional<size_t> findPartition(
+    const Symbol* symbol, const flat_hash_map<const InstanceSymbol*, size_t>& roots,
+    bool& inInstance) {
+    while (symbol) {
+        const Scope* scope;
+        if (symbol->kind == SymbolKind::InstanceBody) {
+            inInstance = true;
+            auto inst = symbol->as<InstanceBodySymbol>().parentInstance;
+            if (!inst)
+                return std::nullopt;
+
+            if (auto it = roots.find(inst); it != roots.end())
+                return it->second;
+
+            scope = inst->getParentScope();
+        }
+        else if (symbol->kind == SymbolKind::CheckerInstanceBody) {
+            auto inst = symbol->as<CheckerInstanceBodySymbol>().parentInstance;
+            scope = inst ? inst->getParentScope() : nullptr;
+        }
+        else {
+            scope = symbol->getParentScope();
+        }
+
+        symbol = scope ? &scope->asSymbol() : nullptr;
+    }
+    return std::nullopt;
+}
+
+// Gets a key that orders symbols by their position in the hierarchy,
+// which is the order in which elaboration visits them.
+static SmallVector<uint32_t> getHierarchyPosition(const Symbol* symbol) {
+    SmallVector<uint32_t> result;
+    while (symbol && symbol->kind != SymbolKind::Root) {
+        if (symbol->kind == SymbolKind::InstanceBody) {
+            symbol = symbol->as<InstanceBodySymbol>().parentInstance;
+            continue;
+        }
+
+        result.push_back(uint32_t(symbol->getIndex()));
+        auto scope = symbol->getParentScope();
+        symbol = scope ? &scope->asSymbol() : nullptr;
+    }
+
+    std::ranges::reverse(result);
+    return result;
+}
+
+// Gets a key that identifies an instance body in a way that can be compared between
+// compilations; bodies with the same key would have been able to share their elaboration
+// in a single compilation. This is conservative; bodies with anything that can't be easily
+// compared between compilations don't get a key at all.
+//
+// During defparam resolution (@a forDefParams) bodies with hierarchy overrides get a key
+// too, and the caller must check that their overrides are the same in some other way.
+// Port connections aren't bound in that case, so any interface port rules out a key.
+static std::optional<std::string> getEquivalenceKey(const InstanceBodySymbol& body,
+                                                    bool forDefParams = false) {
+    auto isSimpleType = [](const Type& type) {
+        return type.isSimpleBitVector() || type.isFloating() || type.isString();
+    };
+
+    if (body.flags != InstanceFlags::None || (body.hierarchyOverrideNode && !forDefParams) ||
+        !body.parentInstance || body.parentInstance->resolvedConfig ||
+        body.parentInstance->getParentScope()->asSymbol().kind == SymbolKind::Root) {
+        return std::nullopt;
+    }
+
+    if (forDefParams) {
+        for (auto port : body.getPortList()) {
+            if (port->kind == SymbolKind::InterfacePort)
+                return std::nullopt;
+        }
+    }
+    else {
+        for (auto conn : body.parentInstance->getPortConnections()) {
+            if (conn->getIfaceConn().first)
+                return std::nullopt;
+        }
+    }
+
+    auto result = fmt::format("{}", static_cast<const void*>(body.getDefinition().getSyntax()));
+    for (auto param : body.getParameters()) {
+        auto& symbol = param->symbol;
+        result += fmt::format(";{}", toString(symbol.kind));
+        if (param->isLocalParam())
+            continue;
+
+        if (symbol.kind == SymbolKind::Parameter) {
+            auto& valueParam = symbol.as<ParameterSymbol>();
+            auto& type = valueParam.getType();
+            if (!isSimpleType(type))
+                return std::nullopt;
+
+            result += fmt::format(":{}={}", type.toString(), valueParam.getValue().toString());
+        }
+        else {
+            auto& type = symbol.as<TypeParameterSymbol>().targetType.getType();
+            if (!isSimpleType(type))
+                return std::nullopt;
+
+            result += fmt::format(":{}", type.toString());
+        }
+    }
+    return result;
+}
+
+// Adds the bodies of all instances above the given one to the set of active
+// bodies, as if the visitor had descended into the instance from the top.
+static void seedActiveInstances(DiagnosticVisitor& visitor, const InstanceSymbol& inst) {
+    visitor.activeInstanceBodies.clear();
+    for (auto body = inst.getParentScope()->getContainingInstance(); body;
+         body = body->parentInstance->getParentScope()->getContainingInstance()) {
+        visitor.activeInstanceBodies.emplace(body);
+    }
+}
+
+flat_hash_map<std::string_view, Compilation::ElabPartition*> Compilation::
+    findReusablePartitions() {
+    flat_hash_map<std::string_view, ElabPartition*> results;
+    if (reusablePartitions.empty())
+        return results;
+
+    // Syntax trees that were added or removed since the previous compilation must only
+    // declare definitions; anything else (packages, binds, compilation unit members)
+    // could affect elaboration anywhere in the design.
+    flat_hash_set<const SyntaxTree*> currentTrees;
+    for (auto& tree : syntaxTrees)
+        currentTrees.emplace(tree.get());
+
+    flat_hash_set<const SyntaxTree*> oldTrees;
+    for (auto& tree : previousTrees)
+        oldTrees.emplace(tree.get());
+
+    flat_hash_set<std::string_view> changedNames;
+    auto addChangedMember = [&](const SyntaxNode& member) {
+        switch (member.kind) {
+            case SyntaxKind::ModuleDeclaration:
+            case SyntaxKind::InterfaceDeclaration:
+            case SyntaxKind::ProgramDeclaration:
+                changedNames.emplace(member.as<ModuleDeclarationSyntax>().header->name.valueText());
+                return true;
+            case SyntaxKind::EmptyMember:
+                return true;
+            default:
+                return false;
+        }
+    };
+
+    auto addChangedTree = [&](const SyntaxTree& tree) {
+        if (tree.getMetadata().hasBindDirectives)
+            return false;
+
+        auto& root = tree.root();
+        if (root.kind != SyntaxKind::CompilationUnit)
+            return addChangedMember(root);
+
+        for (auto member : root.as<CompilationUnitSyntax>().members) {
+            if (!addChangedMember(*member))
+                return false;
+        }
+        return true;
+    };
+
+    for (auto& tree : syntaxTrees) {
+        if (!oldTrees.contains(tree.get()) && !addChangedTree(*tree))
+            return results;
+    }
+
+    for (auto& tree : previousTrees) {
+        if (!currentTrees.contains(tree.get()) && !addChangedTree(*tree))
+            return results;
+    }
+
+    // A partition can be reused if all of the definitions instantiated within it come
+    // from unchanged trees, and none of the names that those trees use to refer to
+    // other definitions have been declared or removed by the changed trees.
+    for (auto& part : reusablePartitions) {
+        auto& comp = *part.compilation;
+        flat_hash_set<const SyntaxTree*> trees;
+        flat_hash_set<const InstanceBodySymbol*> visited;
+        bool isReusable = true;
+
+        auto addDefinition = [&](const DefinitionSymbol& def) {
+            auto it = comp.syntaxMetadata.find(def.getSyntax());
+            if (it == comp.syntaxMetadata.end() || !it->second.tree ||
+                changedNames.contains(def.name)) {
+                isReusable = false;
+            }
+            else {
+                trees.emplace(it->second.tree);
+            }
+        };
+
+        auto addDependencies = [&](auto& self, const Scope& scope) -> void {
+            for (auto& member : scope.members()) {
+                switch (member.kind) {
+                    case SymbolKind::Instance: {
+                        auto& inst = member.as<InstanceSymbol>();
+                        addDefinition(inst.getDefinition());
+
+                        auto body = inst.getCanonicalBody();
+                        if (!body)
+                            body = &inst.body;
+                        if (visited.emplace(body).second)
+                            self(self, *body);
+                        break;
+                    }
+                    case SymbolKind::InstanceArray:
+                    case SymbolKind::GenerateBlock:
+                    case SymbolKind::GenerateBlockArray:
+                        self(self, member.as<Scope>());
+                        break;
+                    default:
+                        break;
+                }
+            }
+        };
+
+        addDefinition(part.instance->getDefinition());
+        addDependencies(addDependencies, part.instance->body);
+
+        for (auto tree : trees) {
+            if (!isReusable)
+                break;
+
+            if (!currentTrees.contains(tree)) {
+                isReusable = false;
+                break;
+            }
+
+            auto& meta = tree->getMetadata();
+            for (auto name : meta.globalInstances) {
+                if (changedNames.contains(name))
+                    isReusable = false;
+            }
+
+            for (auto header : meta.interfacePorts) {
+                if (changedNames.contains(header->nameOrKeyword.valueText()))
+                    isReusable = false;
+            }
+        }
+
+        if (isReusable)
+            results.emplace(part.path, &part);
+    }
+    return results;
+}
+
+bool Compilation::elaborateParallel(ThreadPool& threadPool) {
+    // Configurations can change what an instance refers to based on where it
+    // sits in the hierarchy, so designs that use them are always elaborated serially,
+    // as is elaboration of only some parts of the hierarchy.
+    auto& root = getRoot();
+    if (!configBlocks.empty() || !options.elabPaths.empty())
+        return false;
+
+    // The hierarchy is split into subtrees rooted at module instances, which get
+    // elaborated independently of each other by worker compilations. Bodies that have
+    // been modified by defparams, binds, or configurations are left to this compilation,
+    // along with interfaces, since those are likely to be referred to from elsewhere.
+    auto canPartition = [](const InstanceSymbol& inst) {
+        auto& body = inst.body;
+        return inst.getDefinition().definitionKind == DefinitionKind::Module &&
+               body.flags == InstanceFlags::None && !body.hierarchyOverrideNode &&
+               !inst.resolvedConfig;
+    };
+
+    auto countChildren = [&](auto& self, const Scope& scope) -> size_t {
+        size_t count = 0;
+        for (auto& member : scope.members()) {
+            switch (member.kind) {
+                case SymbolKind::Instance:
+                    if (canPartition(member.as<InstanceSymbol>()))
+                        count++;
+                    break;
+                case SymbolKind::GenerateBlock:
+                    if (!member.as<GenerateBlockSymbol>().isUninstantiated)
+                        count += self(self, member.as<Scope>());
+                    break;
+                case SymbolKind::GenerateBlockArray:
+                case SymbolKind::InstanceArray:
+                    count += self(self, member.as<Scope>());
+                    break;
+                default:
+                    break;
+            }
+        }
+        return count;
+    };
+
+    // Split at the children of the top-level instances if there are enough
+    // of them to keep all of the threads busy, and otherwise one level down.
+    const size_t numWorkers = threadPool.getThreadCount();
+    size_t numChildren = 0;
+    for (auto top : root.topInstances)
+        numChildren += countChildren(countChildren, top->body);
+
+    const size_t partitionDepth = numChildren >= numWorkers * 2 ? 1 : 2;
+
+    // Each partition is located in the worker compilations via the positions
+    // of the symbols along the path to it from the root.
+    struct Partition {
+        const InstanceSymbol* instance;
+        SmallVector<uint32_t> path;
+        ElabPartition result;
+        bool handled = false;
+        bool visited = false;
+        bool locationDependent = false;
+    };
+
+    auto getPath = [](const InstanceSymbol& inst) {
+        SmallVector<uint32_t> path;
+        const Symbol* sym = &inst;
+        while (true) {
+            auto scope = sym->getParentScope();
+            uint32_t index = 0;
+            for (auto member = scope->getFirstMember(); member != sym;
+                 member = member->getNextSibling()) {
+                index++;
+            }
+            path.push_back(index);
+
+            auto& parent = scope->asSymbol();
+            if (parent.kind == SymbolKind::Root)
+                break;
+
+            if (parent.kind == SymbolKind::InstanceBody)
+                sym = parent.as<InstanceBodySymbol>().parentInstance;
+            else
+                sym = &parent;
+        }
+
+        std::ranges::reverse(path);
+        return path;
+    };
+
+    auto findWorkerInstance = [](const Scope& workerRoot,
+                                 const Partition& part) -> const InstanceSymbol* {
+        const Scope* scope = &workerRoot;
+        const Symbol* sym = nullptr;
+        for (auto index : part.path) {
+            if (!scope)
+                return nullptr;
+
+            sym = nullptr;
+            for (auto& member : scope->members()) {
+                if (index-- == 0) {
+                    sym = &member;
+                    break;
+                }
+            }
+
+            if (!sym)
+                return nullptr;
+
+            if (sym->kind == SymbolKind::Instance)
+                scope = &sym->as<InstanceSymbol>().body;
+            else
+                scope = sym->as_if<Scope>();
+        }
+
+        // Make sure we actually found the same instance.
+        if (!sym || sym->kind != SymbolKind::Instance ||
+            sym->getSyntax() != part.instance->getSyntax() || sym->name != part.instance->name) {
+            return nullptr;
+        }
+        return &sym->as<InstanceSymbol>();
+    };
+
+    // Some things are checked across the whole design once elaboration is finished, and
+    // the order in which they're found matters, so partitions that contain any of them
+    // get elaborated by this compilation instead.
+    auto findGlobalChecks = [](Compilation& comp, const DiagnosticVisitor& visitor,
+                               const flat_hash_map<const InstanceSymbol*, size_t>& roots,
+                               flat_hash_set<size_t>& results) {
+        auto check = [&](const Symbol* symbol) {
+            bool inInstance = false;
+            if (auto index = findPartition(symbol, roots, inInstance))
+                results.emplace(*index);
+        };
+
+        for (auto sub : visitor.dpiImports)
+            check(sub);
+        for (auto proto : visitor.externIfaceProtos)
+            check(proto);
+        for (auto [port, _] : visitor.modportsWithExports)
+            check(port);
+        for (auto sub : comp.externInterfaceMethods)
+            check(sub);
+        for (auto [_, scope] : comp.dpiExports)
+            check(&scope->asSymbol());
+        for (auto& [key, _] : comp.outOfBlockDecls)
+            check(&std::get<2>(key)->asSymbol());
+    };
+
+    // Partitions are handed out to the workers as they're found.
+    std::deque<Partition> partitions;
+    std::deque<Partition*> queue;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    bool queueDone = false;
+
+    auto nextPartition = [&]() -> Partition* {
+        std::unique_lock lock(queueMutex);
+        queueCondition.wait(lock, [&] { return !queue.empty() || queueDone; });
+        if (queue.empty())
+            return nullptr;
+
+        auto part = queue.front();
+        queue.pop_front();
+        return part;
+    };
+
+    auto mergeReferences = [](auto& target, const auto& source) {
+        for (auto& [syntax, status] : source) {
+            auto [it, inserted] = target.emplace(syntax, status);
+            if (!inserted) {
+                it->second.first |= status.first;
+                it->second.second |= status.second;
+            }
+        }
+    };
+
+    // Each worker gets its own compilation over the same syntax trees, created
+    // once it has something to do.
+    const uint32_t errorLimit = options.errorLimit == 0 ? UINT32_MAX : options.errorLimit;
+    elabWorkers.resize(numWorkers);
+    std::vector<std::unique_ptr<DiagnosticVisitor>> workerVisitors(numWorkers);
+    std::vector<flat_hash_map<const InstanceSymbol*, size_t>> workerRoots(numWorkers);
+
+    auto elaborateWorker = [&](size_t workerIndex) {
+        auto part = nextPartition();
+        if (!part)
+            return;
+
+        Bag bag;
+        bag.set(options);
+
+        // Workers can outlive this compilation if later ones reuse their results,
+        // so they can only share the default library if it's owned by someone else.
+        auto& compPtr = elabWorkers[workerIndex];
+        compPtr = std::make_shared<Compilation>(bag, defaultLibMem ? nullptr : defaultLibPtr);
+
+        auto& comp = *compPtr;
+        comp.subroutineMap = subroutineMap;
+        comp.methodMap = methodMap;
+        for (auto& tree : syntaxTrees)
+            comp.addSyntaxTree(tree);
+
+        auto& visitor = *(workerVisitors[workerIndex] =
+                              std::make_unique<DiagnosticVisitor>(comp, comp.numErrors,
+                                                                  errorLimit));
+
+        // References and interface port uses are tracked per partition so that
+        // later compilations can reuse partitions individually. Anything found outside
+        // of a partition's visit is attributed to all of them.
+        auto& roots = workerRoots[workerIndex];
+        std::vector<Partition*> visited;
+        flat_hash_map<const SyntaxNode*, std::pair<bool, bool>> sharedReferences;
+        auto& workerRoot = comp.getRoot();
+        for (; part; part = nextPartition()) {
+            if (visitor.finishedEarly())
+                continue;
+
+            auto inst = findWorkerInstance(workerRoot, *part);
+            if (!inst)
+                continue;
+
+            mergeReferences(sharedReferences, std::exchange(comp.referenceStatusMap, {}));
+
+            // Instance bodies are only shared within each partition so that
+            // the results don't depend on how partitions get assigned to workers.
+            seedActiveInstances(visitor, *inst);
+            visitor.instanceCache.clear();
+            visitor.visitInstanceBody(*inst);
+
+            part->result.compilation = compPtr;
+            part->result.instance = inst;
+            part->result.references = std::exchange(comp.referenceStatusMap, {});
+            part->result.usedIfacePorts = std::exchange(visitor.usedIfacePorts, {});
+            roots.emplace(inst, visited.size());
+            visited.push_back(part);
+        }
+
+        if (visitor.finishedEarly())
+            return;
+
+        visitor.activeInstanceBodies.clear();
+        visitor.finalize();
+        if (!visitor.sharedInstances.empty())
+            comp.noteSharedInstances(visitor.sharedInstances);
+
+        comp.checkBindsAndNameConflicts();
+
+        mergeReferences(sharedReferences, comp.referenceStatusMap);
+        for (auto part : visited) {
+            mergeReferences(part->result.references, sharedReferences);
+            part->result.usedIfacePorts.insert(visitor.usedIfacePorts.begin(),
+                                               visitor.usedIfacePorts.end());
+        }
+
+        // Anything that refers to or from outside of a partition means that the partition
+        // can't be elaborated by itself, so leave it for the main compilation.
+        flat_hash_set<size_t> excluded;
+        findGlobalChecks(comp, visitor, roots, excluded);
+        for (auto [inst, index] : roots) {
+            if (inst->body.isLocationDependent)
+                visited[index]->locationDependent = true;
+            else if (!excluded.contains(index))
+                visited[index]->handled = true;
+        }
+    };
+
+    // Partitions that a previous compilation of the design elaborated get reused
+    // instead if nothing that they depend on has changed.
+    auto reusable = findReusablePartitions();
+    std::vector<std::shared_ptr<Compilation>> reusedCompilations;
+
+    for (size_t i = 0; i < numWorkers; i++)
+        threadPool.pushTask(elaborateWorker, i);
+
+    // Elaborate everything outside of the partitions while the workers are going.
+    DiagnosticVisitor elabVisitor(*this, numErrors, errorLimit);
+    auto deferBody = [&](const InstanceSymbol& inst) {
+        if (elabVisitor.activeInstanceBodies.size() != partitionDepth + 1 || !canPartition(inst))
+            return false;
+
+        auto& part = partitions.emplace_back();
+        part.instance = &inst;
+        inst.getHierarchicalPath(part.result.path);
+        if (auto it = reusable.find(part.result.path); it != reusable.end()) {
+            auto& previous = *it->second;
+            auto bodyKey = getEquivalenceKey(inst.body);
+            if (bodyKey && bodyKey == getEquivalenceKey(previous.instance->body)) {
+                reusable.erase(it);
+                part.result = std::move(previous);
+                part.handled = true;
+                if (std::ranges::find(reusedCompilations, part.result.compilation) ==
+                    reusedCompilations.end()) {
+                    reusedCompilations.push_back(part.result.compilation);
+                }
+                return true;
+            }
+        }
+
+        part.path = getPath(inst);
+        {
+            std::unique_lock lock(queueMutex);
+            queue.push_back(&part);
+        }
+        queueCondition.notify_one();
+        return true;
+    };
+
+    elabVisitor.deferBody = deferBody;
+    root.visit(elabVisitor);
+    elabVisitor.deferBody = nullptr;
+
+    {
+        std::unique_lock lock(queueMutex);
+        queueDone = true;
+    }
+    queueCondition.notify_all();
+    threadPool.waitForAll();
+    elabWorkers.insert(elabWorkers.end(), reusedCompilations.begin(), reusedCompilations.end());
+
+    // Our visitor reads these flags while looking for bodies to share, so what the
+    // workers found is only applied to our bodies once they've all finished.
+    for (auto& part : partitions) {
+        if (part.locationDependent)
+            part.instance->body.isLocationDependent = true;
+    }
+
+    // Elaborate any partitions that the workers couldn't handle, which may in turn
+    // reveal references into other partitions, so keep going until nothing changes.
+    flat_hash_map<const InstanceSymbol*, size_t> handledRoots;
+    bool didSomething;
+    do {
+        didSomething = false;
+
+        handledRoots.clear();
+        for (size_t i = 0; i < partitions.size(); i++) {
+            if (partitions[i].handled)
+                handledRoots.emplace(partitions[i].instance, i);
+        }
+
+        flat_hash_set<size_t> excluded;
+        findGlobalChecks(*this, elabVisitor, handledRoots, excluded);
+
+        SmallVector<Partition*> toVisit;
+        for (size_t i = 0; i < partitions.size(); i++) {
+            auto& part = partitions[i];
+            if (!part.visited &&
+                (!part.handled || part.instance->body.isLocationDependent ||
+                 excluded.contains(i))) {
+                toVisit.push_back(&part);
+            }
+        }
+
+        // These instances were tentatively put in the cache of shareable bodies, so
+        // take them all back out before visiting any of them. Otherwise instances
+        // within them could end up sharing the bodies of their own ancestors.
+        for (auto part : toVisit) {
+            auto& inst = *part->instance;
+            if (auto it = elabVisitor.instanceCache.find(DiagnosticVisitor::hashInstance(inst));
+                it != elabVisitor.instanceCache.end()) {
+                auto& list = it->second;
+                if (auto pos = std::ranges::find(list, &inst); pos != list.end())
+                    list.erase(pos);
+            }
+        }
+
+        for (auto part : toVisit) {
+            if (elabVisitor.finishedEarly())
+                break;
+
+            part->handled = false;
+            part->visited = true;
+            seedActiveInstances(elabVisitor, *part->instance);
+            elabVisitor.visitInstanceBody(*part->instance);
+            didSomething = true;
+        }
+
+        elabVisitor.activeInstanceBodies.clear();
+        if (elabVisitor.revisitSharedInstances())
+            didSomething = true;
+    } while (didSomething && !elabVisitor.finishedEarly());
+
+    if (elabVisitor.finishedEarly()) {
+        flat_hash_map<const InstanceBodySymbol*, size_t> pathCounts;
+        cachedSemanticDiagnostics.emplace(coalesceDiagnostics(diagMap, pathCounts));
+        return true;
+    }
+
+    elabVisitor.finalize();
+
+    // Merge in the things the workers found that the remaining checks depend on.
+    flat_hash_map<const SyntaxNode*, const DefinitionSymbol*> defsBySyntax;
+    for (auto& [_, defs] : definitionMap) {
+        for (auto def : defs.first) {
+            if (def->kind == SymbolKind::Definition)
+                defsBySyntax.emplace(def->getSyntax(), &def->as<DefinitionSymbol>());
+        }
     }
 
-    if (!elabVisitor.externIfaceProtos.empty())
-        checkExternIfaceMethods(elabVisitor.externIfaceProtos);
+    auto getMainDef = [&](const DefinitionSymbol& def) -> const DefinitionSymbol* {
+        auto it = defsBySyntax.find(def.getSyntax());
+        return it == defsBySyntax.end() ? nullptr : it->second;
+    };
 
-    if (!elabVisitor.modportsWithExports.empty())
-        checkModportExports(elabVisitor.modportsWithExports);
+    for (auto& part : partitions) {
+        if (!part.handled)
+            continue;
 
-    // Double check any bind directives for correctness. These were already
-    // resolved prior to full elaboration but their diagnostics were not
-    // issued so we need to check again.
-    for (auto [directive, scope] : bindDirectives) {
-        ResolvedBind resolvedBind;
-        resolveBindTargets(*directive, *scope, resolvedBind);
-        checkBindTargetParams(*directive, *scope, resolvedBind);
+        for (auto def : part.result.usedIfacePorts) {
+            if (auto mainDef = getMainDef(*def))
+                elabVisitor.usedIfacePorts.emplace(mainDef);
+        }
+        mergeReferences(referenceStatusMap, part.result.references);
     }
 
-    // Report any lingering name conflicts.
-    if (!nameConflicts.empty()) {
-        auto conflicts = nameConflicts;
-        for (auto symbol : conflicts) {
-            auto scope = symbol->getParentScope();
-            SLANG_ASSERT(scope);
-            scope->handleNameConflict(*symbol);
+    // Definitions instantiated within the partitions have only been partially counted
+    // here, and instances that share the partitions' bodies need to know what the
+    // workers found inside of them.
+    flat_hash_map<const DefinitionSymbol*, int64_t> countAdjustments;
+    flat_hash_map<const DefinitionSymbol*, size_t> counts;
+    for (auto& part : partitions) {
+        if (!part.handled)
+            continue;
+
+        counts.clear();
+        countInstantiations(part.instance->body, counts);
+        for (auto [def, count] : counts)
+            countAdjustments[def] -= int64_t(count);
+
+        counts.clear();
+        auto& workerBody = part.result.instance->body;
+        workerBody.getCompilation().countInstantiations(workerBody, counts);
+
+        auto& nested = nestedInstantiations[&part.instance->body];
+        nested.clear();
+        for (auto [def, count] : counts) {
+            if (auto mainDef = getMainDef(*def)) {
+                countAdjustments[mainDef] += int64_t(count);
+                nested.emplace_back(mainDef, count);
+            }
         }
     }
 
-    // Report on unused out-of-block definitions. These are always a real error.
-    if (!outOfBlockDecls.empty()) {
-        auto decls = outOfBlockDecls;
-        for (auto& [key, val] : decls) {
-            auto& [syntax, name, index, used] = val;
-            if (!used) {
-                auto& [className, declName, scope] = key;
-                auto classRange = name->left->sourceRange();
-                auto sym = Lookup::unqualifiedAt(*scope, className,
-                                                 LookupLocation(scope, uint32_t(index)),
-                                                 classRange);
+    for (auto [def, adjustment] : countAdjustments) {
+        if (adjustment > 0)
+            def->noteInstantiated(size_t(adjustment));
+    }
 
-                if (sym && !declName.empty() && !className.empty()) {
-                    if (sym->kind == SymbolKind::ClassType ||
-                        sym->kind == SymbolKind::GenericClassDef) {
-                        auto& diag = scope->addDiag(diag::NoDeclInClass, name->sourceRange());
-                        diag << declName << className;
-                    }
-                    else {
-                        auto& diag = scope->addDiag(diag::NotAClass, classRange);
-                        diag << className;
-                    }
+    finishElaboration(elabVisitor);
+
+    // Look for unused symbols in each partition using the references that were found
+    // across the whole design. The workers' elaboration diagnostics are kept separate
+    // from these, since later compilations might reuse them.
+    std::vector<DiagMap> postElabDiags(elabWorkers.size());
+    if (!hasFlag(CompilationFlags::SuppressUnused)) {
+        for (size_t i = 0; i < elabWorkers.size(); i++) {
+            if (!elabWorkers[i])
+                continue;
+
+            auto& comp = *elabWorkers[i];
+            comp.referenceStatusMap = referenceStatusMap;
+            threadPool.pushTask([&comp, &partitions, &results = postElabDiags[i]] {
+                auto elabDiags = std::exchange(comp.diagMap, {});
+                PostElabVisitor postElabVisitor(comp);
+                for (auto& part : partitions) {
+                    if (part.handled && part.result.compilation.get() == &comp)
+                        part.result.instance->visit(postElabVisitor);
                 }
-            }
+                results = std::exchange(comp.diagMap, std::move(elabDiags));
+            });
         }
+
+        PostElabVisitor postElabVisitor(*this);
+        for (auto& [inst, _] : handledRoots)
+            postElabVisitor.deferredInstances.emplace(inst);
+
+        root.visit(postElabVisitor);
+        threadPool.waitForAll();
     }
 
-    // Report on unused config rules.
-    if (!configBlocks.empty()) {
-        for (auto& [name, confList] : configBlocks) {
-            for (auto config : confList) {
-                if (config->isUsed)
-                    config->checkUnusedRules();
-            }
+    // Now merge all of the diagnostics. Anything inside a partition that a worker handled
+    // comes from that worker, and everything else inside an instance comes from this
+    // compilation. Diagnostics outside of any instance (in packages, for example) can come
+    // from any of them, since workers might create things like class specializations
+    // that aren't created anywhere else, except for reused compilations that still have
+    // diagnostics in syntax trees that are no longer part of the design.
+    flat_hash_set<const SyntaxNode*> currentUnits;
+    for (auto& tree : syntaxTrees)
+        currentUnits.emplace(&tree->root());
+
+    auto isInCurrentUnit = [&](const Symbol* symbol) {
+        while (symbol && symbol->kind != SymbolKind::CompilationUnit) {
+            auto scope = symbol->getParentScope();
+            symbol = scope ? &scope->asSymbol() : nullptr;
+        }
+        return !symbol || currentUnits.contains(symbol->getSyntax());
+    };
+
+    DiagMap merged;
+    for (auto& [key, diagList] : diagMap) {
+        for (auto& diag : diagList) {
+            bool inInstance = false;
+            if (!findPartition(diag.symbol, handledRoots, inInstance))
+                merged[key].push_back(diag);
         }
     }
 
-    if (!hasFlag(CompilationFlags::AllowTopLevelIfacePorts)) {
-        // Top level instances cannot have interface or ref ports.
-        for (auto inst : getRoot().topInstances) {
-            for (auto port : inst->body.getPortList()) {
-                if (port->kind == SymbolKind::InterfacePort) {
-                    inst->body.addDiag(diag::TopModuleIfacePort, port->location)
-                        << inst->name << port->name;
-                    break;
-                }
-                else {
-                    ArgumentDirection dir;
-                    if (port->kind == SymbolKind::MultiPort)
-                        dir = port->as<MultiPortSymbol>().direction;
-                    else
-                        dir = port->as<PortSymbol>().direction;
+    flat_hash_set<std::tuple<DiagCode, SourceLocation>> needsSort;
+    for (size_t i = 0; i < elabWorkers.size(); i++) {
+        if (!elabWorkers[i])
+            continue;
 
-                    if (dir == ArgumentDirection::Ref) {
-                        if (port->name.empty()) {
-                            inst->body.addDiag(diag::TopModuleUnnamedRefPort, port->location)
-                                << inst->name;
-                        }
-                        else {
-                            inst->body.addDiag(diag::TopModuleRefPort, port->location)
-                                << inst->name << port->name;
+        flat_hash_map<const InstanceSymbol*, size_t> roots;
+        for (size_t j = 0; j < partitions.size(); j++) {
+            auto& part = partitions[j];
+            if (part.handled && part.result.compilation == elabWorkers[i])
+                roots.emplace(part.result.instance, j);
+        }
+
+        for (auto workerDiags : {&elabWorkers[i]->diagMap, &postElabDiags[i]}) {
+            for (auto& [key, diagList] : *workerDiags) {
+                for (auto& diag : diagList) {
+                    bool inInstance = false;
+                    if (!findPartition(diag.symbol, roots, inInstance)) {
+                        if (inInstance || !isInCurrentUnit(diag.symbol))
+                            continue;
+
+                        if (auto it = merged.find(key); it != merged.end() &&
+                                                         std::ranges::find(it->second, diag) !=
+                                                             it->second.end()) {
+                            continue;
                         }
                     }
+
+                    auto& list = merged[key];
+                    list.push_back(diag);
+                    if (list.size() > 1)
+                        needsSort.emplace(key);
                 }
             }
         }
     }
 
-    if (!hasFlag(CompilationFlags::SuppressUnused)) {
-        // Report on unused definitions.
-        for (auto def : unreferencedDefs) {
-            // If this is an interface, it may have been referenced in a port.
-            if (elabVisitor.usedIfacePorts.find(def) != elabVisitor.usedIfacePorts.end())
-                continue;
+    // Put diagnostics that came from different compilations back into
+    // the order in which serial elaboration would have found them.
+    flat_hash_map<const InstanceBodySymbol*, std::optional<std::string>> bodyKeys;
+    for (auto& key : needsSort) {
+        auto& list = merged[key];
+        std::vector<std::pair<SmallVector<uint32_t>, size_t>> order;
+        for (size_t i = 0; i < list.size(); i++)
+            order.emplace_back(getHierarchyPosition(list[i].symbol), i);
 
-            auto hasUnusedAttrib = [&] {
-                for (auto attr : getAttributes(*def)) {
-                    if (attr->name == "unused"sv || attr->name == "maybe_unused"sv)
-                        return attr->getValue().isTrue();
-                }
-                return false;
-            };
+        std::ranges::stable_sort(order, [](auto& a, auto& b) {
+            return std::ranges::lexicographical_compare(a.first, b.first);
+        });
 
-            if (!def->name.empty() && def->name != "_"sv && !hasUnusedAttrib()) {
-                def->getParentScope()->addDiag(diag::UnusedDefinition, def->location)
-                    << def->getKindString();
+        // Bodies in different partitions that serial elaboration would have shared
+        // report the same diagnostic more than once. The duplicates still count toward
+        // the number of instances but shouldn't be picked as the example instance,
+        // so move them to the front where they won't be.
+        std::vector<Diagnostic> sorted;
+        std::vector<Diagnostic> duplicates;
+        flat_hash_map<std::string, const InstanceBodySymbol*> canonical;
+        sorted.reserve(list.size());
+        for (auto& [_, index] : order) {
+            auto& diag = list[index];
+            auto body = InstanceBodySymbol::getContainingBody(diag.symbol);
+            if (body) {
+                auto keyIt = bodyKeys.find(body);
+                if (keyIt == bodyKeys.end())
+                    keyIt = bodyKeys.emplace(body, getEquivalenceKey(*body)).first;
+
+                if (auto& bodyKey = keyIt->second) {
+                    auto [it, inserted] = canonical.emplace(*bodyKey, body);
+                    if (!inserted && it->second != body) {
+                        duplicates.emplace_back(std::move(diag));
+                        continue;
+                    }
+                }
             }
+            sorted.emplace_back(std::move(diag));
         }
 
-        PostElabVisitor postElabVisitor(*this);
-        getRoot().visit(postElabVisitor);
+        for (auto& diag : sorted)
+            duplicates.emplace_back(std::move(diag));
+        list = std::move(duplicates);
+    }
+
+    // Paths to the partitions are counted here, since the workers don't know
+    // about instances sharing the bodies of the partitions or their ancestors.
+    flat_hash_map<const InstanceBodySymbol*, size_t> pathCounts;
+    for (auto& part : partitions) {
+        if (part.handled) {
+            auto count = getInstancePathCount(part.instance->body, pathCounts);
+            pathCounts[&part.result.instance->body] = count;
+        }
+    }
+
+    // Diagnostics are reported relative to the definitions of the instances they're in,
+    // which only have the full instance counts in this compilation.
+    cachedSemanticDiagnostics.emplace(coalesceDiagnostics(merged, pathCounts, &defsBySyntax));
+
+    for (auto& part : partitions) {
+        if (part.handled)
+            elabPartitions.emplace_back(std::move(part.result));
     }
+    return true;
 }
 
 const Diagnostics& Compilation::getParseDiagnostics() {
@@ -1474,8 +2627,34 @@ const Diagnostics& Compilation::getSemanticDiagnostics() {
     // Elaborate the design.
     elaborate();
 
+    flat_hash_map<const InstanceBodySymbol*, size_t> pathCounts;
+    cachedSemanticDiagnostics.emplace(coalesceDiagnostics(diagMap, pathCounts));
+    return *cachedSemanticDiagnostics;
+}
+
+const Diagnostics& Compilation::getSemanticDiagnostics(ThreadPool& threadPool) {
+    if (cachedSemanticDiagnostics)
+        return *cachedSemanticDiagnostics;
+
+    // A single thread is still worth using if there are previous results to reuse.
+    if ((threadPool.getThreadCount() < 2 && reusablePartitions.empty()) ||
+        !elaborateParallel(threadPool)) {
+        return getSemanticDiagnostics();
+    }
+
+    return *cachedSemanticDiagnostics;
+}
+
+void Compilation::reuseElaboration(const Compilation& previous) {
+    reusablePartitions = previous.elabPartitions;
+    previousTrees = previous.syntaxTrees;
+}
+
+Diagnostics Compilation::coalesceDiagnostics(
+    DiagMap& diags, flat_hash_map<const InstanceBodySymbol*, size_t>& pathCounts,
+    const flat_hash_map<const SyntaxNode*, const DefinitionSymbol*>* defsBySyntax) {
     Diagnostics results;
-    for (auto& [key, diagList] : diagMap) {
+    for (auto& [key, diagList] : diags) {
         // If the location is NoLocation, just issue each diagnostic.
         if (std::get<1>(key) == SourceLocation::NoLocation) {
             for (auto& diag : diagList)
@@ -1521,10 +2700,11 @@ const Diagnostics& Compilation::getSemanticDiagnostics() {
             if (!symbol)
                 continue;
 
-            auto parent = symbol->as<InstanceBodySymbol>().parentInstance;
+            auto& body = symbol->as<InstanceBodySymbol>();
+            auto parent = body.parentInstance;
             SLANG_ASSERT(parent);
 
-            count++;
+            count += body.getCompilation().getInstancePathCount(body, pathCounts);
             if (auto scope = parent->getParentScope()) {
                 auto& sym = scope->asSymbol();
                 if (sym.kind != SymbolKind::Root && sym.kind != SymbolKind::CompilationUnit) {
@@ -1534,8 +2714,16 @@ const Diagnostics& Compilation::getSemanticDiagnostics() {
             }
         }
 
-        if (!differingArgs && found &&
-            inst->as<InstanceSymbol>().getDefinition().getInstanceCount() > count) {
+        auto getInstanceCount = [&] {
+            auto def = &inst->as<InstanceSymbol>().getDefinition();
+            if (defsBySyntax) {
+                if (auto it = defsBySyntax->find(def->getSyntax()); it != defsBySyntax->end())
+                    def = it->second;
+            }
+            return def->getInstanceCount();
+        };
+
+        if (!differingArgs && found && getInstanceCount() > count) {
             // The diagnostic is present only in some instances, so include the coalescing
             // information to point the user towards the right ones.
             Diagnostic diag = *found;
@@ -1571,8 +2759,7 @@ const Diagnostics& Compilation::getSemanticDiagnostics() {
     if (sourceManager)
         results.sort(*sourceManager);
 
-    cachedSemanticDiagnostics.emplace(std::move(results));
-    return *cachedSemanticDiagnostics;
+    return results;
 }
 
 const Diagnostics& Compilation::getAllDiagnostics() {
@@ -1649,10 +2836,17 @@ const ImplicitTypeSyntax& Compilation::createEmptyTypeSyntax(SourceLocation loc)
 }
 
 void Compilation::forceElaborate(const Symbol& symbol) {
+    // Force elaborating a package can add to its list of exported names,
+    // so lookups can't cache their results while it's going on.
+    numScopesElaborating++;
+    lookupCacheGeneration++;
+
     DiagnosticVisitor visitor(*this, numErrors,
                               options.errorLimit == 0 ? UINT32_MAX : options.errorLimit);
     visitor.visitInstances = false;
     symbol.visit(visitor);
+
+    numScopesElaborating--;
 }
 
 const Type& Compilation::getType(SyntaxKind typeKind) const {
@@ -2141,14 +3335,7 @@ void Compilation::checkBindTargetParams(const syntax::BindDirectiveSyntax& synta
 void Compilation::resolveDefParamsAndBinds() {
     TimeTraceScope timeScope("resolveDefParamsAndBinds"sv, ""sv);
 
-    struct OverrideEntry {
-        OpaqueInstancePath path;
-        const SyntaxNode* targetSyntax = nullptr;
-        const SyntaxNode* defparamSyntax = nullptr;
-        ConstantValue value;
-        std::string pathStr;
-    };
-    SmallVector<OverrideEntry, 4> overrides;
+    std::vector<DefParamOverride> overrides;
 
     struct BindEntry {
         OpaqueInstancePath path;
@@ -2207,7 +3394,99 @@ void Compilation::resolveDefParamsAndBinds() {
         }
     };
 
+    // Each iteration below elaborates a fresh clone of the design, but most of the
+    // hierarchy usually comes out the same as in the previous iteration. The results of
+    // visiting instance subtrees are kept here, keyed by the path to the instance, and get
+    // reused instead of elaborating the subtree again as long as the instance's body is
+    // equivalent and none of the overrides applied within the subtree have changed.
+    struct SubtreeResult {
+        std::string bodyKey;
+        std::vector<DefParamOverride> found;
+        size_t numBlocksSeen = 0;
+        size_t generateLevel = 0;
+        bool truncated = false;
+    };
+    flat_hash_map<std::string, SubtreeResult> subtreeResults;
+
+    // The state that the most recent clone was given, for finding out
+    // which subtree results are invalidated by the next one.
+    std::vector<DefParamOverride> appliedOverrides;
+    SmallVector<BindEntry> appliedBinds;
+
+    // Hierarchical references in constant expressions can make
+    // a subtree depend on anything else in the design.
+    const bool canReuseSubtrees = !hasFlag(CompilationFlags::AllowHierarchicalConst);
+
+    auto getPathKey = [](const OpaqueInstancePath& path) {
+        std::string key;
+        for (auto& entry : path.entries) {
+            auto value = entry.getOpaqueValue();
+            key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+        return key;
+    };
+
+    auto invalidateSubtrees = [&] {
+        auto sameBind = [](const BindEntry& a, const BindEntry& b) {
+            return a.path.entries == b.path.entries && a.definitionTarget == b.definitionTarget &&
+                   a.info.bindSyntax == b.info.bindSyntax &&
+                   a.info.configRuleSyntax == b.info.configRuleSyntax &&
+                   a.info.configBlockSyntax == b.info.configBlockSyntax &&
+                   a.info.instantiationDefSyntax == b.info.instantiationDefSyntax &&
+                   a.info.isNewConfigRoot == b.info.isNewConfigRoot &&
+                   std::ranges::equal(a.info.liblist, b.info.liblist);
+        };
+
+        // Binds can target definitions anywhere in the design,
+        // so any change to them throws away everything.
+        if (!std::ranges::equal(binds, appliedBinds, sameBind)) {
+            subtreeResults.clear();
+        }
+        else if (!subtreeResults.empty()) {
+            using OverrideMap = flat_hash_map<std::string, SmallVector<const DefParamOverride*>>;
+            auto groupByPath = [&](const std::vector<DefParamOverride>& list) {
+                OverrideMap result;
+                for (auto& entry : list) {
+                    if (entry.targetSyntax)
+                        result[getPathKey(entry.path)].push_back(&entry);
+                }
+                return result;
+            };
+
+            auto sameOverride = [](const DefParamOverride* a, const DefParamOverride* b) {
+                return a->targetSyntax == b->targetSyntax &&
+                       a->defparamSyntax == b->defparamSyntax && a->value == b->value;
+            };
+
+            // A changed override invalidates the subtrees of its
+            // target instance and of every instance above it.
+            auto invalidatePath = [&](const std::string& key) {
+                for (size_t len = key.size(); len > 0; len -= sizeof(uintptr_t))
+                    subtreeResults.erase(key.substr(0, len));
+            };
+
+            auto prev = groupByPath(appliedOverrides);
+            auto curr = groupByPath(overrides);
+            for (auto& [key, list] : curr) {
+                auto it = prev.find(key);
+                if (it == prev.end() || !std::ranges::equal(list, it->second, sameOverride))
+                    invalidatePath(key);
+            }
+
+            for (auto& [key, list] : prev) {
+                if (!curr.contains(key))
+                    invalidatePath(key);
+            }
+        }
+
+        appliedOverrides = overrides;
+        appliedBinds = binds;
+    };
+
     auto cloneInto = [&](Compilation& c) {
+        if (canReuseSubtrees)
+            invalidateSubtrees();
+
         c.options = options;
         for (auto& tree : syntaxTrees)
             c.addSyntaxTree(tree);
@@ -2215,22 +3494,85 @@ void Compilation::resolveDefParamsAndBinds() {
         copyStateInto(c, false);
     };
 
-    auto saveState = [&](DefParamVisitor& visitor, Compilation& c) {
-        overrides.clear();
-        for (auto defparam : visitor.found) {
-            auto target = defparam->getTarget();
-            if (!target) {
-                overrides.emplace_back();
+    size_t numIterations = 0;
+    auto visitClone = [&](Compilation& c, DefParamVisitor& visitor) {
+        TimeTraceScope iterScope("defParamIteration"sv, [&] {
+            return fmt::format("iteration {}, generate level {}", numIterations,
+                               visitor.generateLevel);
+        });
+        numIterations++;
+
+        struct PendingSubtree {
+            std::string pathKey;
+            std::optional<std::string> bodyKey;
+            size_t numBindDirectives;
+        };
+        SmallVector<PendingSubtree> pending;
+
+        auto reuseInstance = [&](const InstanceSymbol& inst) {
+            auto& curr = pending.emplace_back(PendingSubtree{getPathKey(OpaqueInstancePath(inst)),
+                                                             getEquivalenceKey(inst.body, true),
+                                                             c.bindDirectives.size()});
+            if (!curr.bodyKey)
+                return false;
+
+            auto it = subtreeResults.find(curr.pathKey);
+            if (it == subtreeResults.end())
+                return false;
+
+            auto& result = it->second;
+            if (result.bodyKey != *curr.bodyKey ||
+                (result.truncated && result.generateLevel != visitor.generateLevel)) {
+                return false;
+            }
+
+            visitor.found.insert(visitor.found.end(), result.found.begin(), result.found.end());
+            visitor.numBlocksSeen += result.numBlocksSeen;
+            pending.pop_back();
+            return true;
+        };
+
+        auto finishInstance = [&](const InstanceSymbol&,
+                                  const DefParamVisitor::SubtreeStart& start) {
+            auto curr = std::move(pending.back());
+            pending.pop_back();
+
+            // Subtrees that register bind directives need to be visited every time
+            // to get them registered with the compilation again.
+            if (!curr.bodyKey || visitor.numRecursive != start.numRecursive ||
+                c.bindDirectives.size() != curr.numBindDirectives) {
+                return;
             }
-            else {
-                std::string path;
-                target->getHierarchicalPath(path);
 
-                overrides.push_back({OpaqueInstancePath(*target), target->getSyntax(),
-                                     defparam->getSyntax(), defparam->getValue(), std::move(path)});
+            // Defparams that failed to resolve, or that target something outside of
+            // the subtree, depend on more than the subtree itself.
+            std::span found(visitor.found.begin() + ptrdiff_t(start.numFound),
+                            visitor.found.end());
+            for (auto& entry : found) {
+                if (!entry.targetSyntax || !getPathKey(entry.path).starts_with(curr.pathKey))
+                    return;
             }
+
+            subtreeResults[curr.pathKey] = {*curr.bodyKey,
+                                            {found.begin(), found.end()},
+                                            visitor.numBlocksSeen - start.numBlocksSeen,
+                                            visitor.generateLevel,
+                                            visitor.numTruncated != start.numTruncated};
+        };
+
+        if (canReuseSubtrees) {
+            visitor.reuseInstance = reuseInstance;
+            visitor.finishInstance = finishInstance;
         }
 
+        c.getRoot(/* skipDefParamsAndBinds */ true).visit(visitor);
+        visitor.reuseInstance = nullptr;
+        visitor.finishInstance = nullptr;
+    };
+
+    auto saveState = [&](DefParamVisitor& visitor, Compilation& c) {
+        overrides = std::move(visitor.found);
+
         // We make a copy of the bind directives list here because resolveBindTargets
         // can cause the compilation to add more entries to the list (for recursive
         // module instantiations).
@@ -2306,7 +3648,7 @@ void Compilation::resolveDefParamsAndBinds() {
         cloneInto(initialClone);
 
         DefParamVisitor initialVisitor(options.maxInstanceDepth, generateLevel);
-        initialClone.getRoot(/* skipDefParamsAndBinds */ true).visit(initialVisitor);
+        visitClone(initialClone, initialVisitor);
         saveState(initialVisitor, initialClone);
         if (checkProblem(initialVisitor))
             return;
@@ -2328,7 +3670,7 @@ void Compilation::resolveDefParamsAndBinds() {
             cloneInto(c);
 
             DefParamVisitor v(options.maxInstanceDepth, generateLevel);
-            c.getRoot(/* skipDefParamsAndBinds */ true).visit(v);
+            visitClone(c, v);
             if (checkProblem(v))
                 return;
 
@@ -2339,29 +3681,22 @@ void Compilation::resolveDefParamsAndBinds() {
                 // Check that the defparam resolved to the same target we saw previously.
                 // The spec declares it to be an error if a defparam target changes based
                 // on elaboration of other defparam values.
-                const SyntaxNode* targetNode = nullptr;
-                auto target = v.found[j]->getTarget();
-                if (target)
-                    targetNode = target->getSyntax();
-
+                auto& entry = v.found[j];
                 auto getRange = [&] {
-                    auto syntax = v.found[j]->getSyntax();
-                    SLANG_ASSERT(syntax);
-                    return syntax->sourceRange();
+                    SLANG_ASSERT(entry.defparamSyntax);
+                    return entry.defparamSyntax->sourceRange();
                 };
 
                 auto& prevEntry = overrides[j];
-                if (prevEntry.targetSyntax && targetNode && prevEntry.targetSyntax != targetNode) {
-                    std::string path;
-                    target->getHierarchicalPath(path);
-
+                if (prevEntry.targetSyntax && entry.targetSyntax &&
+                    prevEntry.targetSyntax != entry.targetSyntax) {
                     auto& diag = root->addDiag(diag::DefParamTargetChange, getRange());
                     diag << prevEntry.pathStr;
-                    diag << path;
+                    diag << entry.pathStr;
                     return;
                 }
 
-                if (prevEntry.value != v.found[j]->getValue()) {
+                if (prevEntry.value != entry.value) {
                     allSame = false;
                     if (i == options.maxDefParamSteps - 1)
                         root->addDiag(diag::DefParamCycle, getRange());
@@ -2549,4 +3884,135 @@ Diagnostic* Compilation::errorMissingDef(std::string_view name, const Scope& sco
     return &diag;
 }
 
+void Compilation::noteSharedInstances(
+    std::span<const std::pair<const InstanceSymbol*, const InstanceBodySymbol*>> instances) {
+    for (auto [inst, canonical] : instances) {
+        inst->canonicalBody = canonical;
+        sharedInstanceBodies[canonical].push_back(inst);
+    }
+
+    // The instances within the skipped bodies were never created, so they need to be
+    // added to each definition's instance count separately. Some of them may have been
+    // created anyway if something looked inside the body, so don't count those twice.
+    flat_hash_map<const DefinitionSymbol*, size_t> actual;
+    for (auto [inst, canonical] : instances) {
+        actual.clear();
+        countInstantiations(inst->body, actual);
+
+        for (auto [def, count] : getNestedInstantiations(*canonical)) {
+            auto it = actual.find(def);
+            auto existing = it == actual.end() ? 0 : it->second;
+            if (count > existing)
+                def->noteInstantiated(count - existing);
+        }
+    }
+}
+
+void Compilation::countInstantiations(const Scope& scope,
+                                      flat_hash_map<const DefinitionSymbol*, size_t>& counts) {
+    // Each instantiation statement counts once per scope, regardless of how
+    // many instances it declares. Note that this intentionally avoids forcing
+    // elaboration of any scopes; we only want to count what already exists.
+    SmallSet<const SyntaxNode*, 4> seenSyntax;
+    auto noteInstantiation = [&](const Symbol& symbol, const DefinitionSymbol& def) {
+        auto syntax = symbol.getSyntax();
+        if (!syntax || !syntax->parent || seenSyntax.emplace(syntax->parent).second)
+            counts[&def]++;
+    };
+
+    auto visitInstance = [&](auto& self, const Symbol& symbol) -> void {
+        if (symbol.kind == SymbolKind::InstanceArray) {
+            for (auto elem : symbol.as<InstanceArraySymbol>().elements)
+                self(self, *elem);
+        }
+        else if (symbol.kind == SymbolKind::Instance) {
+            auto& inst = symbol.as<InstanceSymbol>();
+            if (auto canonical = inst.getCanonicalBody()) {
+                for (auto [def, count] : getNestedInstantiations(*canonical))
+                    counts[def] += count;
+            }
+            else {
+                countInstantiations(inst.body, counts);
+            }
+        }
+    };
+
+    for (auto member = scope.getFirstMember(); member; member = member->getNextSibling()) {
+        switch (member->kind) {
+            case SymbolKind::Instance:
+                noteInstantiation(*member, member->as<InstanceSymbol>().getDefinition());
+                visitInstance(visitInstance, *member);
+                break;
+            case SymbolKind::InstanceArray: {
+                // Find the definition from the first non-array element, if there is one.
+                auto elem = member;
+                while (elem->kind == SymbolKind::InstanceArray) {
+                    auto& elems = elem->as<InstanceArraySymbol>().elements;
+                    if (elems.empty())
+                        break;
+                    elem = elems[0];
+                }
+
+                if (elem->kind == SymbolKind::Instance)
+                    noteInstantiation(*member, elem->as<InstanceSymbol>().getDefinition());
+                visitInstance(visitInstance, *member);
+                break;
+            }
+            case SymbolKind::GenerateBlock:
+            case SymbolKind::GenerateBlockArray:
+                countInstantiations(member->as<Scope>(), counts);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+std::span<const std::pair<const DefinitionSymbol*, size_t>> Compilation::getNestedInstantiations(
+    const InstanceBodySymbol& body) {
+    if (auto it = nestedInstantiations.find(&body); it != nestedInstantiations.end())
+        return it->second;
+
+    flat_hash_map<const DefinitionSymbol*, size_t> counts;
+    countInstantiations(body, counts);
+
+    auto& result = nestedInstantiations[&body];
+    result.assign(counts.begin(), counts.end());
+    return result;
+}
+
+size_t Compilation::getInstancePathCount(
+    const InstanceBodySymbol& body, flat_hash_map<const InstanceBodySymbol*, size_t>& cache) const {
+    // The cache can also be seeded with counts for bodies whose ancestors
+    // live in another compilation, so only take the shortcut without it.
+    if (sharedInstanceBodies.empty() && cache.empty())
+        return 1;
+
+    if (auto it = cache.find(&body); it != cache.end())
+        return it->second;
+
+    // Anything issued within a body that was skipped is also issued
+    // within its canonical body, which already counts this instance.
+    SLANG_ASSERT(body.parentInstance);
+    if (body.parentInstance->getCanonicalBody())
+        return 0;
+
+    // Each body stands in for the instance that owns it plus every instance that
+    // shares it, and each of those in turn counts once for each path to its parent.
+    auto countPaths = [&](const InstanceSymbol& inst) -> size_t {
+        auto scope = inst.getParentScope();
+        auto parentBody = scope ? scope->getContainingInstance() : nullptr;
+        return parentBody ? getInstancePathCount(*parentBody, cache) : 1;
+    };
+
+    size_t count = countPaths(*body.parentInstance);
+    if (auto it = sharedInstanceBodies.find(&body); it != sharedInstanceBodies.end()) {
+        for (auto inst : it->second)
+            count += countPaths(*inst);
+    }
+
+    cache.emplace(&body, count);
+    return count;
+}
+
 } // namespace slang::ast
@@ -8,8 +8,10 @@
 #pragma once
 
 #include "slang/ast/ASTVisitor.h"
+#include "slang/ast/OpaqueInstancePath.h"
 #include "slang/diagnostics/CompilationDiags.h"
 #include "slang/diagnostics/DeclarationsDiags.h"
+#include "slang/util/Function.h"
 #include "slang/util/TimeTrace.h"
 
 namespace slang::ast {
@@ -295,7 +297,7 @@ struct DiagnosticVisitor : public ASTVisitor<DiagnosticVisitor, false, false> {
     }
 
     void handle(const InstanceSymbol& symbol) {
-        if (finishedEarly())
+        if (finishedEarly() || (skipInstance && skipInstance(symbol)))
             return;
 
         TimeTraceScope timeScope("AST Instance", [&] {
@@ -314,6 +316,10 @@ struct DiagnosticVisitor : public ASTVisitor<DiagnosticVisitor, false, false> {
                 attr->getValue();
         }
 
+        visitInstanceBody(symbol);
+    }
+
+    void visitInstanceBody(const InstanceSymbol& symbol) {
         // Detect infinite recursion, which happens if we see this exact
         // instance body somewhere higher up in the stack.
         if (!activeInstanceBodies.emplace(&symbol.body).second) {
@@ -336,8 +342,34 @@ struct DiagnosticVisitor : public ASTVisitor<DiagnosticVisitor, false, false> {
             return;
         }
 
-        if (visitInstances)
-            visit(symbol.body);
+        if (!visitInstances)
+            return;
+
+        // If we've already visited an identical body we can skip this one,
+        // since it would just produce the same diagnostics again.
+        const bool canShare = canShareBody(symbol);
+        size_t hash = 0;
+        if (canShare) {
+            hash = hashInstance(symbol);
+            if (auto canonical = findSharedBody(symbol, hash)) {
+                sharedInstances.emplace_back(&symbol, canonical);
+                return;
+            }
+        }
+
+        // The body may be getting elaborated by some other compilation instead.
+        // Assume for now that it can be shared; that gets undone later if
+        // it turns out not to be the case.
+        if (deferBody && deferBody(symbol)) {
+            if (canShare)
+                instanceCache[hash].push_back(&symbol);
+            return;
+        }
+
+        visit(symbol.body);
+
+        if (canShare && !symbol.body.isLocationDependent && !finishedEarly())
+            instanceCache[hash].push_back(&symbol);
     }
 
     void handle(const SubroutineSymbol& symbol) {
@@ -420,7 +452,34 @@ struct DiagnosticVisitor : public ASTVisitor<DiagnosticVisitor, false, false> {
         symbol.getPathSource();
     }
 
+    // Instances that we skipped because they matched an earlier body need to be
+    // visited after all if something turned out to refer into either of them from
+    // elsewhere in the hierarchy. Visiting them can in turn skip more instances,
+    // so keep going until nothing changes. Returns true if anything was visited.
+    bool revisitSharedInstances() {
+        bool result = false;
+        bool didSomething;
+        do {
+            didSomething = false;
+            for (size_t i = 0; i < sharedInstances.size();) {
+                auto [inst, canonical] = sharedInstances[i];
+                if (!canonical->isLocationDependent && !inst->body.isLocationDependent) {
+                    i++;
+                    continue;
+                }
+
+                sharedInstances[i] = sharedInstances.back();
+                sharedInstances.pop_back();
+                visit(inst->body);
+                didSomething = result = true;
+            }
+        } while (didSomething && !finishedEarly());
+        return result;
+    }
+
     void finalize() {
+        revisitSharedInstances();
+
         // Once everything has been visited, go back over and check things that might
         // have been influenced by visiting later symbols. Unfortunately visiting
         // a specialization can trigger more specializations to be made for the
@@ -454,6 +513,139 @@ struct DiagnosticVisitor : public ASTVisitor<DiagnosticVisitor, false, false> {
         }
     }
 
+    bool canShareBody(const InstanceSymbol& symbol) const {
+        // Top level instances are all unique, so don't bother with them.
+        if (compilation.hasFlag(CompilationFlags::DisableInstanceCaching) ||
+            symbol.getParentScope()->asSymbol().kind == SymbolKind::Root) {
+            return false;
+        }
+
+        // Bodies that have been modified by defparams, binds, or configurations
+        // are unique to their location in the hierarchy.
+        auto& body = symbol.body;
+        return body.flags == InstanceFlags::None && !body.hierarchyOverrideNode &&
+               !symbol.resolvedConfig && !partialBodies.contains(&body);
+    }
+
+    // Local parameters are fully determined by the other parameters, so only the
+    // overridable ones need to be considered. This also avoids evaluating local
+    // parameters earlier than we otherwise would, which could change which of them
+    // report problems like cycles between their initializers.
+    static size_t hashInstance(const InstanceSymbol& symbol) {
+        size_t hash = 0;
+        hash_combine(hash, &symbol.getDefinition());
+        for (auto param : symbol.body.getParameters()) {
+            auto& sym = param->symbol;
+            if (param->isLocalParam())
+                continue;
+
+            if (sym.kind == SymbolKind::Parameter)
+                hash_combine(hash, sym.as<ParameterSymbol>().getValue().hash());
+            else
+                hash_combine(hash, sym.as<TypeParameterSymbol>().targetType.getType().hash());
+        }
+        return hash;
+    }
+
+    static bool isSameParams(const InstanceBodySymbol& left, const InstanceBodySymbol& right) {
+        if (&left.getDefinition() != &right.getDefinition())
+            return false;
+
+        auto lp = left.getParameters();
+        auto rp = right.getParameters();
+        if (lp.size() != rp.size())
+            return false;
+
+        for (size_t i = 0; i < lp.size(); i++) {
+            auto& ls = lp[i]->symbol;
+            auto& rs = rp[i]->symbol;
+            if (ls.kind != rs.kind)
+                return false;
+
+            if (lp[i]->isLocalParam())
+                continue;
+
+            if (ls.kind == SymbolKind::Parameter) {
+                auto& lparam = ls.as<ParameterSymbol>();
+                auto& rparam = rs.as<ParameterSymbol>();
+                if (!lparam.getType().isMatching(rparam.getType()) ||
+                    lparam.getValue() != rparam.getValue()) {
+                    return false;
+                }
+            }
+            else {
+                auto& lt = ls.as<TypeParameterSymbol>().targetType.getType();
+                auto& rt = rs.as<TypeParameterSymbol>().targetType.getType();
+                if (!lt.isMatching(rt))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    static bool isSameIfaceConn(const Symbol* left, const Symbol* right) {
+        if (!left || !right || left->kind != right->kind)
+            return left == right;
+
+        if (left->kind == SymbolKind::Instance) {
+            auto& lb = left->as<InstanceSymbol>().body;
+            auto& rb = right->as<InstanceSymbol>().body;
+            return !lb.hierarchyOverrideNode && !rb.hierarchyOverrideNode && isSameParams(lb, rb);
+        }
+
+        if (left->kind == SymbolKind::InstanceArray) {
+            auto& la = left->as<InstanceArraySymbol>();
+            auto& ra = right->as<InstanceArraySymbol>();
+            if (la.range != ra.range || la.elements.size() != ra.elements.size())
+                return false;
+
+            for (size_t i = 0; i < la.elements.size(); i++) {
+                if (!isSameIfaceConn(la.elements[i], ra.elements[i]))
+                    return false;
+            }
+            return true;
+        }
+
+        return left == right;
+    }
+
+    static bool isSameInstance(const InstanceSymbol& left, const InstanceSymbol& right) {
+        if (!isSameParams(left.body, right.body))
+            return false;
+
+        auto lc = left.getPortConnections();
+        auto rc = right.getPortConnections();
+        if (lc.size() != rc.size())
+            return false;
+
+        for (size_t i = 0; i < lc.size(); i++) {
+            auto [lsym, lmodport] = lc[i]->getIfaceConn();
+            auto [rsym, rmodport] = rc[i]->getIfaceConn();
+            if (bool(lmodport) != bool(rmodport) || (lmodport && lmodport->name != rmodport->name))
+                return false;
+
+            if (!isSameIfaceConn(lsym, rsym))
+                return false;
+        }
+        return true;
+    }
+
+    const InstanceBodySymbol* findSharedBody(const InstanceSymbol& symbol, size_t hash) const {
+        auto it = instanceCache.find(hash);
+        if (it == instanceCache.end())
+            return nullptr;
+
+        // Bodies that are still being visited can't be shared. That can only happen
+        // when a deferred instance gets visited after its ancestors have finished.
+        for (auto other : it->second) {
+            if (!other->body.isLocationDependent && !activeInstanceBodies.contains(&other->body) &&
+                isSameInstance(symbol, *other)) {
+                return &other->body;
+            }
+        }
+        return nullptr;
+    }
+
     Compilation& compilation;
     const size_t& numErrors;
     uint32_t errorLimit;
@@ -466,6 +658,21 @@ struct DiagnosticVisitor : public ASTVisitor<DiagnosticVisitor, false, false> {
     SmallVector<const MethodPrototypeSymbol*> externIfaceProtos;
     SmallVector<std::pair<const InterfacePortSymbol*, const ModportSymbol*>> modportsWithExports;
     TimingPathMap timingPathMap;
+    flat_hash_map<size_t, SmallVector<const InstanceSymbol*, 2>> instanceCache;
+    std::vector<std::pair<const InstanceSymbol*, const InstanceBodySymbol*>> sharedInstances;
+    function_ref<bool(const InstanceSymbol&)> deferBody;
+    function_ref<bool(const InstanceSymbol&)> skipInstance;
+    flat_hash_set<const InstanceBodySymbol*> partialBodies;
+};
+
+// A defparam found during defparam resolution, copied out of the compilation
+// it was found in so that it can outlive it.
+struct DefParamOverride {
+    OpaqueInstancePath path;
+    const SyntaxNode* targetSyntax = nullptr;
+    const SyntaxNode* defparamSyntax = nullptr;
+    ConstantValue value;
+    std::string pathStr;
 };
 
 // This visitor is for finding all defparam directives in the hierarchy.
@@ -483,7 +690,21 @@ struct DiagnosticVisitor : public ASTVisitor<DiagnosticVisitor, false, false> {
 // This visitor also implicitly serves to discover bind directives. They are registered
 // with the compilation by Scope::addMembers and then get processed after we finish
 // visiting the tree.
+//
+// Found defparams are copied out of the compilation along with their targets and
+// values, so that the results of visiting a subtree can be reused by later visits
+// of other compilations. The optional reuseInstance callback is invoked before
+// descending into an instance; it can splice in previous results and return true
+// to skip the instance's subtree. Otherwise finishInstance is called after the
+// subtree has been visited, with the state the visitor had when entering it.
 struct DefParamVisitor : public ASTVisitor<DefParamVisitor, false, false> {
+    struct SubtreeStart {
+        size_t numFound = 0;
+        size_t numBlocksSeen = 0;
+        size_t numTruncated = 0;
+        size_t numRecursive = 0;
+    };
+
     DefParamVisitor(size_t maxInstanceDepth, size_t generateLevel) :
         maxInstanceDepth(maxInstanceDepth), generateLevel(generateLevel) {}
 
@@ -491,8 +712,17 @@ struct DefParamVisitor : public ASTVisitor<DefParamVisitor, false, false> {
     void handle(const CompilationUnitSymbol& symbol) { visitDefault(symbol); }
 
     void handle(const DefParamSymbol& symbol) {
-        if (generateDepth <= generateLevel)
-            found.push_back(&symbol);
+        if (generateDepth > generateLevel)
+            return;
+
+        auto& entry = found.emplace_back();
+        entry.defparamSyntax = symbol.getSyntax();
+        entry.value = symbol.getValue();
+        if (auto target = symbol.getTarget()) {
+            entry.path = OpaqueInstancePath(*target);
+            entry.targetSyntax = target->getSyntax();
+            target->getHierarchicalPath(entry.pathStr);
+        }
     }
 
     void handle(const InstanceSymbol& symbol) {
@@ -514,8 +744,10 @@ struct DefParamVisitor : public ASTVisitor<DefParamVisitor, false, false> {
             // we potentially have an infinitely recursive instantiation and
             // need to go all the way to the maximum depth to find out.
             inserted = activeInstances.emplace(&symbol.getDefinition()).second;
-            if (!inserted)
+            if (!inserted) {
                 inRecursiveInstance = true;
+                numRecursive++;
+            }
         }
 
         // If we're past our target depth because we're searching for a potentially
@@ -523,9 +755,16 @@ struct DefParamVisitor : public ASTVisitor<DefParamVisitor, false, false> {
         if (generateDepth <= generateLevel)
             numBlocksSeen++;
 
-        instanceDepth++;
-        visitDefault(symbol.body);
-        instanceDepth--;
+        const bool tracked = reuseInstance && !inRecursiveInstance;
+        const SubtreeStart start{found.size(), numBlocksSeen, numTruncated, numRecursive};
+        if (!tracked || !reuseInstance(symbol)) {
+            instanceDepth++;
+            visitDefault(symbol.body);
+            instanceDepth--;
+
+            if (tracked && !hierarchyProblem)
+                finishInstance(symbol, start);
+        }
 
         inRecursiveInstance = wasInRecursive;
         if (inserted)
@@ -536,8 +775,10 @@ struct DefParamVisitor : public ASTVisitor<DefParamVisitor, false, false> {
         if (symbol.isUninstantiated || hierarchyProblem)
             return;
 
-        if (generateDepth >= generateLevel && !inRecursiveInstance)
+        if (generateDepth >= generateLevel && !inRecursiveInstance) {
+            numTruncated++;
             return;
+        }
 
         // We don't count the case where we are *at* the target level
         // because we're about to descend into the generate block,
@@ -561,15 +802,19 @@ struct DefParamVisitor : public ASTVisitor<DefParamVisitor, false, false> {
     template<typename T>
     void handle(const T&) {}
 
-    SmallVector<const DefParamSymbol*> found;
+    std::vector<DefParamOverride> found;
     flat_hash_set<const DefinitionSymbol*> activeInstances;
     size_t instanceDepth = 0;
     size_t maxInstanceDepth = 0;
     size_t generateLevel = 0;
     size_t numBlocksSeen = 0;
     size_t generateDepth = 0;
+    size_t numTruncated = 0;
+    size_t numRecursive = 0;
     bool inRecursiveInstance = false;
     const InstanceSymbol* hierarchyProblem = nullptr;
+    function_ref<bool(const InstanceSymbol&)> reuseInstance;
+    function_ref<void(const InstanceSymbol&, const SubtreeStart&)> finishInstance;
 };
 
 // This visitor runs post-elaboration and can be used to find and report on
@@ -591,6 +836,13 @@ struct PostElabVisitor : public ASTVisitor<PostElabVisitor, false, false> {
         // Ignore method prototype arguments, they're not unused.
     }
 
+    void handle(const InstanceSymbol& symbol) {
+        // Bodies that were skipped in favor of an identical one would
+        // just report the same things again, so don't bother.
+        if (!symbol.getCanonicalBody() && !deferredInstances.contains(&symbol))
+            visitDefault(symbol);
+    }
+
     void handle(const SubroutineSymbol& symbol) {
         if (symbol.flags.has(MethodFlags::Pure | MethodFlags::InterfaceExtern |
                              MethodFlags::DPIImport | MethodFlags::Randomize)) {
@@ -689,6 +941,8 @@ struct PostElabVisitor : public ASTVisitor<PostElabVisitor, false, false> {
         }
     }
 
+    flat_hash_set<const InstanceSymbol*> deferredInstances;
+
 private:
     void checkValueUnused(const ValueSymbol& symbol, DiagCode unusedCode,
                           std::optional<DiagCode> unsetCode, std::optional<DiagCode> unreadCode) {
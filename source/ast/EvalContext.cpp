@@ -8,6 +8,7 @@
 #include "slang/ast/EvalContext.h"
 
 #include "slang/ast/ASTContext.h"
+#include "slang/ast/ASTVisitor.h"
 #include "slang/ast/Compilation.h"
 #include "slang/ast/symbols/SubroutineSymbols.h"
 #include "slang/ast/symbols/VariableSymbols.h"
@@ -17,11 +18,54 @@
 
 namespace slang::ast {
 
+EvalFrameLayout::EvalFrameLayout(const SubroutineSymbol& subroutine) {
+    auto add = [&](const ValueSymbol& symbol) {
+        if (indices.emplace(&symbol, uint32_t(locals.size())).second)
+            locals.push_back(&symbol);
+    };
+
+    for (auto arg : subroutine.getArguments())
+        add(*arg);
+
+    if (subroutine.returnValVar)
+        add(*subroutine.returnValVar);
+
+    auto visitor = makeVisitor(
+        [&](auto& v, const VariableDeclStatement& stmt) {
+            add(stmt.symbol);
+            v.visitDefault(stmt);
+        },
+        [&](auto& v, const ForeachLoopStatement& stmt) {
+            for (auto& dim : stmt.loopDims) {
+                if (dim.loopVar)
+                    add(*dim.loopVar);
+            }
+            v.visitDefault(stmt);
+        });
+    subroutine.getBody().visit(visitor);
+}
+
+static const ConstantValue* findInFrame(const EvalContext::Frame& frame,
+                                        const ValueSymbol* symbol) {
+    if (frame.layout) {
+        if (auto index = frame.layout->find(symbol)) {
+            auto& local = frame.locals[*index];
+            return local ? &*local : nullptr;
+        }
+    }
+
+    auto it = frame.temporaries.find(symbol);
+    if (it == frame.temporaries.end())
+        return nullptr;
+    return &it->second;
+}
+
 void EvalContext::reset() {
     steps = 0;
     disableTarget = nullptr;
     queueTarget = nullptr;
-    stack.clear();
+    while (!stack.empty())
+        popFrame();
     lvalStack.clear();
     diags.clear();
     warnings.clear();
@@ -31,7 +75,13 @@ void EvalContext::reset() {
 
 ConstantValue* EvalContext::createLocal(const ValueSymbol* symbol, ConstantValue value) {
     SLANG_ASSERT(!stack.empty());
-    ConstantValue& result = stack.back().temporaries[symbol];
+    auto& frame = stack.back();
+
+    std::optional<uint32_t> index;
+    if (frame.layout)
+        index = frame.layout->find(symbol);
+
+    ConstantValue& result = index ? frame.locals[*index].emplace() : frame.temporaries[symbol];
     if (!value) {
         result = symbol->getType().getDefaultValue();
     }
@@ -49,16 +99,18 @@ ConstantValue* EvalContext::findLocal(const ValueSymbol* symbol) {
     if (stack.empty())
         return nullptr;
 
-    auto& frame = stack.back();
-    auto it = frame.temporaries.find(symbol);
-    if (it == frame.temporaries.end())
-        return nullptr;
-    return &it->second;
+    return const_cast<ConstantValue*>(findInFrame(stack.back(), symbol));
 }
 
 void EvalContext::deleteLocal(const ValueSymbol* symbol) {
     if (!stack.empty()) {
         auto& frame = stack.back();
+        if (frame.layout) {
+            if (auto index = frame.layout->find(symbol)) {
+                frame.locals[*index].reset();
+                return;
+            }
+        }
         frame.temporaries.erase(symbol);
     }
 }
@@ -72,9 +124,17 @@ bool EvalContext::pushFrame(const SubroutineSymbol& subroutine, SourceLocation c
     }
 
     Frame frame;
+    frame.layout = &getCompilation().getEvalFrameLayout(subroutine);
     frame.subroutine = &subroutine;
     frame.callLocation = callLocation;
     frame.lookupLocation = lookupLocation;
+
+    if (!localsPool.empty()) {
+        frame.locals = std::move(localsPool.back());
+        localsPool.pop_back();
+    }
+    frame.locals.resize(frame.layout->size());
+
     stack.emplace_back(std::move(frame));
     return true;
 }
@@ -84,6 +144,11 @@ void EvalContext::pushEmptyFrame() {
 }
 
 void EvalContext::popFrame() {
+    auto& locals = stack.back().locals;
+    if (locals.capacity()) {
+        locals.clear();
+        localsPool.emplace_back(std::move(locals));
+    }
     stack.pop_back();
 }
 
@@ -115,6 +180,12 @@ std::string EvalContext::dumpStack() const {
     int index = 0;
     for (const Frame& frame : stack) {
         buffer.format("{}: {}\n", index++, frame.subroutine ? frame.subroutine->name : "<global>");
+        for (size_t i = 0; i < frame.locals.size(); i++) {
+            if (auto& value = frame.locals[i]) {
+                buffer.format("    {} = {}\n", frame.layout->getLocals()[i]->name,
+                              value->toString());
+            }
+        }
         for (auto& [symbol, value] : frame.temporaries)
             buffer.format("    {} = {}\n", symbol->name, value.toString());
     }
@@ -171,10 +242,10 @@ static void reportFrame(Diagnostic& diag, const EvalContext::Frame& frame) {
     buffer.format("{}(", frame.subroutine->name);
 
     for (auto arg : frame.subroutine->getArguments()) {
-        auto it = frame.temporaries.find(arg);
-        SLANG_ASSERT(it != frame.temporaries.end());
+        auto value = findInFrame(frame, arg);
+        SLANG_ASSERT(value);
 
-        buffer.append(it->second.toString());
+        buffer.append(value->toString());
         if (arg != frame.subroutine->getArguments().last(1)[0])
             buffer.append(", ");
     }
@@ -528,9 +528,10 @@ bool lookupDownward(std::span<const NamePlusLoc> nameParts, NameComponents name,
 
 // Returns true if the lookup was ok, or if it failed in a way that allows us to continue
 // looking up in other ways. Returns false if the entire lookup has failed and should be
-// aborted.
+// aborted. The candidates come from Lookup::findUpwardCandidates.
 bool lookupUpward(std::span<const NamePlusLoc> nameParts, const NameComponents& name,
-                  const ASTContext& context, bitmask<LookupFlags> flags, LookupResult& result) {
+                  const ASTContext& context, bitmask<LookupFlags> flags,
+                  std::span<const Symbol* const> candidates, LookupResult& result) {
     // Upward lookups can match either a scope name, or a module definition name (on any of the
     // instances). Imports are not considered.
     const Symbol* firstMatch = nullptr;
@@ -547,40 +548,18 @@ bool lookupUpward(std::span<const NamePlusLoc> nameParts, const NameComponents&
         return lookupDownward(nameParts, name, context, flags, result);
     };
 
-    const Scope* scope = context.scope;
-    while (scope) {
-        // Search for a scope or instance target within our current scope.
-        auto symbol = scope->find(name.text);
-        if (symbol && !symbol->isValue() && !symbol->isType() &&
-            (symbol->isScope() || symbol->kind == SymbolKind::Instance)) {
-            if (!tryMatch(*symbol))
-                return false;
-
-            if (result.found)
-                return true;
-        }
-
-        // Advance to the next scope, skipping to the parent instance when
-        // we hit an instance body instead of going on to the compilation unit.
-        symbol = &scope->asSymbol();
-        if (symbol->kind != SymbolKind::InstanceBody) {
-            scope = symbol->getHierarchicalParent();
+    for (auto symbol : candidates) {
+        if (symbol->kind == SymbolKind::InstanceBody) {
+            // Whatever we find from here on depends on where the body is instantiated.
+            symbol->as<InstanceBodySymbol>().isLocationDependent = true;
+            continue;
         }
-        else {
-            auto inst = symbol->as<InstanceBodySymbol>().parentInstance;
-            SLANG_ASSERT(inst);
 
-            // If the instance's definition name matches our target name,
-            // try to match from the current instance.
-            scope = inst->getParentScope();
-            if (inst->getDefinition().name == name.text) {
-                if (!tryMatch(*inst))
-                    return false;
+        if (!tryMatch(*symbol))
+            return false;
 
-                if (result.found)
-                    return true;
-            }
-        }
+        if (result.found)
+            return true;
     }
 
     result.clear();
@@ -838,6 +817,8 @@ void unwrapResult(const Scope& scope, std::optional<SourceRange> range, LookupRe
         return;
 
     if (result.flags.has(LookupResultFlags::IsHierarchical)) {
+        InstanceBodySymbol::noteExternalReference(scope.asSymbol(), result.found);
+
         auto declaredType = result.found->getDeclaredType();
         if (declaredType && declaredType->isEvaluating()) {
             if (range) {
@@ -1092,7 +1073,9 @@ void Lookup::name(const NameSyntax& syntax, const ASTContext& context, bitmask<L
 
     if (!result.found) {
         if (flags.has(LookupFlags::AlwaysAllowUpward)) {
-            if (!lookupUpward({}, name, context, flags, result))
+            SmallVector<const Symbol*> candidates;
+            findUpwardCandidates(scope, name.text, candidates);
+            if (!lookupUpward({}, name, context, flags, candidates, result))
                 return;
         }
 
@@ -1671,7 +1654,11 @@ void Lookup::unqualifiedImpl(const Scope& scope, std::string_view name, LookupLo
                              std::optional<SourceRange> sourceRange, bitmask<LookupFlags> flags,
                              SymbolIndex outOfBlockIndex, LookupResult& result,
                              const Scope& originalScope) {
+    auto& comp = scope.getCompilation();
     auto reportRecursiveError = [&](const Symbol& symbol) {
+        // This depends on what is being evaluated right now,
+        // so the result of this lookup can't be cached.
+        comp.lookupCacheGeneration++;
         if (sourceRange) {
             auto& diag = result.addDiag(scope, diag::RecursiveDefinition, *sourceRange);
             diag << name;
@@ -1780,7 +1767,8 @@ void Lookup::unqualifiedImpl(const Scope& scope, std::string_view name, LookupLo
                 case SymbolKind::ExplicitImport:
                     result.found = symbol->as<ExplicitImportSymbol>().importedSymbol();
                     result.flags |= LookupResultFlags::WasImported;
-                    scope.getCompilation().noteReference(*symbol);
+                    comp.noteReference(*symbol);
+                    comp.lastLookupImport = symbol;
                     break;
                 case SymbolKind::ForwardingTypedef:
                     // If we find a forwarding typedef, the actual typedef was never defined.
@@ -1817,6 +1805,7 @@ void Lookup::unqualifiedImpl(const Scope& scope, std::string_view name, LookupLo
                         // Work around this by just pretending we didn't find anything.
                         done = false;
                         result.clear();
+                        comp.lookupCacheGeneration++;
                     }
                 }
             }
@@ -1900,7 +1889,8 @@ void Lookup::unqualifiedImpl(const Scope& scope, std::string_view name, LookupLo
 
                 result.flags |= LookupResultFlags::WasImported;
                 result.found = imports[0].imported;
-                scope.getCompilation().noteReference(*imports[0].import);
+                comp.noteReference(*imports[0].import);
+                comp.lastLookupImport = imports[0].import;
 
                 wildcardImportData->importedSymbols.try_emplace(result.found->name, result.found);
                 return;
@@ -1950,8 +1940,123 @@ void Lookup::unqualifiedImpl(const Scope& scope, std::string_view name, LookupLo
         return;
     }
 
-    return unqualifiedImpl(*location.getScope(), name, location, sourceRange, flags,
-                           outOfBlockIndex, result, originalScope);
+    // The rest of the lookup only depends on where it continues in the parent scope, so
+    // once the compilation is finalized its result is cached for other lookups that get
+    // here. Lookups that can't see new wildcard imports depend on which imports other
+    // lookups have made so far, so they aren't cached.
+    auto& parentScope = *location.getScope();
+    if (!comp.finalized || flags.has(LookupFlags::DisallowWildcardImport)) {
+        return unqualifiedImpl(parentScope, name, location, sourceRange, flags, outOfBlockIndex,
+                               result, originalScope);
+    }
+
+    std::tuple key{&parentScope,
+                   name,
+                   uint32_t(flags.bits()),
+                   uint32_t(location.getIndex()),
+                   uint32_t(outOfBlockIndex),
+                   sourceRange.has_value()};
+    if (auto it = comp.unqualifiedLookupCache.find(key); it != comp.unqualifiedLookupCache.end()) {
+        // If the symbol is in the middle of having its type evaluated we need to do
+        // the lookup for real to report the recursion.
+        auto& cached = it->second;
+        auto declaredType = cached.found ? cached.found->getDeclaredType() : nullptr;
+        if (!declaredType || !declaredType->isEvaluating()) {
+            comp.lookupCacheStats.unqualifiedHits++;
+            result.found = cached.found;
+            result.flags |= cached.flags;
+            comp.lastLookupImport = cached.import;
+            if (cached.import)
+                comp.noteReference(*cached.import);
+            return;
+        }
+    }
+
+    comp.lookupCacheStats.unqualifiedMisses++;
+    const bool wasElaborating = comp.numScopesElaborating != 0;
+    const auto generation = comp.lookupCacheGeneration;
+    const auto numDiags = result.getDiagnostics().size();
+    const auto prevFlags = std::exchange(result.flags, LookupResultFlags::None);
+    comp.lastLookupImport = nullptr;
+
+    unqualifiedImpl(parentScope, name, location, sourceRange, flags, outOfBlockIndex, result,
+                    originalScope);
+
+    // Members of anonymous programs can only be referenced from within programs,
+    // which is checked against the scope the lookup originally started from.
+    if (!wasElaborating && generation == comp.lookupCacheGeneration &&
+        result.getDiagnostics().size() == numDiags &&
+        (!result.found || !result.found->getParentScope() ||
+         result.found->getParentScope()->asSymbol().kind != SymbolKind::AnonymousProgram)) {
+        auto nameCopy = comp.copyFrom(std::span<const char>(name));
+        std::get<1>(key) = std::string_view(nameCopy.data(), nameCopy.size());
+        auto import = result.flags.has(LookupResultFlags::WasImported) ? comp.lastLookupImport
+                                                                        : nullptr;
+        comp.unqualifiedLookupCache.emplace(key, Compilation::CachedLookup{result.found,
+                                                                           result.flags, import});
+    }
+
+    result.flags |= prevFlags;
+}
+
+void Lookup::findUpwardCandidates(const Scope& scope, std::string_view name,
+                                  SmallVectorBase<const Symbol*>& results) {
+    // The symbols that an upward lookup tries to match only depend on the
+    // scope it starts in and the first part of the name, so once the
+    // compilation is finalized they are cached for other lookups.
+    auto& comp = scope.getCompilation();
+    std::tuple key{&scope, name};
+    if (comp.finalized) {
+        if (auto it = comp.upwardLookupCache.find(key); it != comp.upwardLookupCache.end()) {
+            comp.lookupCacheStats.upwardHits++;
+            results.append_range(it->second);
+            return;
+        }
+        comp.lookupCacheStats.upwardMisses++;
+    }
+
+    const bool wasElaborating = comp.numScopesElaborating != 0;
+    const auto generation = comp.lookupCacheGeneration;
+
+    const Scope* current = &scope;
+    while (current) {
+        // Search for a scope or instance target within our current scope.
+        auto symbol = current->find(name);
+        if (symbol && !symbol->isValue() && !symbol->isType() &&
+            (symbol->isScope() || symbol->kind == SymbolKind::Instance)) {
+            SLANG_ASSERT(symbol->kind != SymbolKind::InstanceBody);
+            results.push_back(symbol);
+        }
+
+        // Advance to the next scope, skipping to the parent instance when
+        // we hit an instance body instead of going on to the compilation unit.
+        symbol = &current->asSymbol();
+        if (symbol->kind != SymbolKind::InstanceBody) {
+            current = symbol->getHierarchicalParent();
+        }
+        else {
+            auto& body = symbol->as<InstanceBodySymbol>();
+            auto inst = body.parentInstance;
+            SLANG_ASSERT(inst);
+
+            // The body marks the point past which the lookup
+            // depends on where the body is instantiated.
+            results.push_back(&body);
+
+            // If the instance's definition name matches our target name,
+            // try to match from the current instance.
+            current = inst->getParentScope();
+            if (inst->getDefinition().name == name)
+                results.push_back(inst);
+        }
+    }
+
+    if (comp.finalized && !wasElaborating && generation == comp.lookupCacheGeneration) {
+        auto nameCopy = comp.copyFrom(std::span<const char>(name));
+        std::get<1>(key) = std::string_view(nameCopy.data(), nameCopy.size());
+        comp.upwardLookupCache.emplace(key, std::vector<const Symbol*>(results.begin(),
+                                                                       results.end()));
+    }
 }
 
 void Lookup::qualified(const ScopedNameSyntax& syntax, const ASTContext& context,
@@ -2098,7 +2203,9 @@ void Lookup::qualified(const ScopedNameSyntax& syntax, const ASTContext& context
 
     // If we reach this point we're in case (2) or (4) above. Go up through the instantiation
     // hierarchy and see if we can find a match there.
-    if (!lookupUpward(nameParts, first, context, flags, result))
+    SmallVector<const Symbol*> candidates;
+    findUpwardCandidates(scope, first.text, candidates);
+    if (!lookupUpward(nameParts, first, context, flags, candidates, result))
         return;
 
     if (result.found)
@@ -2206,15 +2313,42 @@ void Lookup::reportUndeclared(const Scope& initialScope, std::string_view name,
         // disabled by config or if we've tried too many times to correct typos.
         if (comp.doTypoCorrection()) {
             auto checkMembers = [&](const Scope& toCheck) {
-                for (auto& member : toCheck.members()) {
-                    if (member.name.empty() || !isViable(member))
-                        continue;
-
-                    int dist = editDistance(member.name, name, /* allowReplacements */ true,
-                                            bestDistance);
-                    if (dist < bestDistance) {
-                        closestSym = &member;
-                        bestDistance = dist;
+                // Names further than this from the one we want will never be suggested,
+                // and neither will anything that isn't closer than what we already have.
+                int maxDistance = std::min(bestDistance - 1, int(name.length() / 3));
+                if (maxDistance < 0)
+                    return;
+
+                // The names of the scope's members are indexed the first time we need
+                // them, so that large scopes and packages don't need to be scanned in full
+                // each time an undeclared identifier is reported.
+                auto members = toCheck.members();
+                auto& index = comp.memberNameIndices[&toCheck];
+                if (index.lastMember != toCheck.getLastMember() || index.members.empty()) {
+                    index.names = {};
+                    index.members.clear();
+                    for (auto& member : members) {
+                        if (!member.name.empty()) {
+                            index.names.add(member.name);
+                            index.members.push_back(&member);
+                        }
+                    }
+                    index.lastMember = toCheck.getLastMember();
+                }
+
+                // Prefer the closest match, and among those the one declared first.
+                SmallVector<BKTree::Match> matches;
+                index.names.find(name, maxDistance, matches);
+                std::ranges::sort(matches, [](auto& a, auto& b) {
+                    return std::tie(a.distance, a.index) < std::tie(b.distance, b.index);
+                });
+
+                for (auto& match : matches) {
+                    auto member = index.members[match.index];
+                    if (isViable(*member)) {
+                        closestSym = member;
+                        bestDistance = match.distance;
+                        break;
                     }
                 }
             };
@@ -826,6 +826,10 @@ void Scope::elaborate() const {
     auto deferredData = compilation.getOrAddDeferredData(deferredMemberIndex);
     deferredMemberIndex = DeferredMemberIndex::Invalid;
 
+    // Lookups can't cache their results while members are still being added.
+    compilation.numScopesElaborating++;
+    compilation.lookupCacheGeneration++;
+
     SmallSet<const SyntaxNode*, 8> enumDecls;
     for (const auto& pair : deferredData.getTransparentTypes()) {
         auto insertAt = pair.first;
@@ -1240,6 +1244,8 @@ void Scope::elaborate() const {
     }
 
     SLANG_ASSERT(deferredMemberIndex == DeferredMemberIndex::Invalid);
+    compilation.numScopesElaborating--;
+
     if (thisSym->kind == SymbolKind::InstanceBody && TimeTrace::isEnabled())
         TimeTrace::endTrace();
 }
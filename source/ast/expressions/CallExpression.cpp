@@ -8,6 +8,7 @@
 #include "slang/ast/expressions/CallExpression.h"
 
 #include "slang/ast/ASTVisitor.h"
+#include "slang/ast/Bytecode.h"
 #include "slang/ast/Compilation.h"
 #include "slang/ast/Constraints.h"
 #include "slang/ast/EvalContext.h"
@@ -736,6 +737,47 @@ ConstantValue CallExpression::evalImpl(EvalContext& context) const {
         args.emplace_back(std::move(v));
     }
 
+    return evalWithArgs(context, args);
+}
+
+ConstantValue CallExpression::evalWithArgs(EvalContext& context,
+                                           std::span<ConstantValue> args) const {
+    const SubroutineSymbol& symbol = *std::get<0>(subroutine);
+
+    // Calls to functions whose results depend only on their arguments are memoized.
+    // Results that were accompanied by diagnostics aren't recorded, since getting
+    // them from the cache would lose the diagnostics.
+    auto& comp = context.getCompilation();
+    if (comp.getOptions().maxConstexprCallCache &&
+        !context.flags.has(EvalFlags::IsScript | EvalFlags::CovergroupExpr) &&
+        comp.canMemoizeConstexprCalls(symbol)) {
+        if (auto cached = comp.findConstexprCallResult(symbol, args))
+            return *cached;
+
+        std::vector<ConstantValue> savedArgs(args.begin(), args.end());
+        const size_t numDiags = context.getDiagnosticCount();
+
+        ConstantValue result = evalBody(context, args);
+        if (result && context.getDiagnosticCount() == numDiags)
+            comp.addConstexprCallResult(symbol, std::move(savedArgs), result);
+
+        return result;
+    }
+
+    return evalBody(context, args);
+}
+
+ConstantValue CallExpression::evalBody(EvalContext& context, std::span<ConstantValue> args) const {
+    const SubroutineSymbol& symbol = *std::get<0>(subroutine);
+
+    // If enabled, run the function's body as bytecode if it could be compiled.
+    auto& comp = context.getCompilation();
+    if (comp.hasFlag(CompilationFlags::CompileConstantFunctions) &&
+        !context.flags.has(EvalFlags::IsScript)) {
+        if (auto bytecode = comp.getConstantFunctionBytecode(symbol))
+            return bytecode->run(context, sourceRange.start(), lookupLocation, args);
+    }
+
     // Push a new stack frame, push argument values as locals.
     if (!context.pushFrame(symbol, sourceRange.start(), lookupLocation))
         return nullptr;
@@ -25,8 +25,8 @@ IntegerLiteral::IntegerLiteral(BumpAllocator& alloc, const Type& type, const SVI
     isDeclaredUnsized(isDeclaredUnsized),
     valueStorage(value.getBitWidth(), value.isSigned(), value.hasUnknown()) {
 
-    if (value.isSingleWord())
-        valueStorage.val = *value.getRawPtr();
+    if (valueStorage.isInline())
+        memcpy(valueStorage.inlineVal, value.getRawPtr(), sizeof(uint64_t) * value.getNumWords());
     else {
         valueStorage.pVal = (uint64_t*)alloc.allocate(sizeof(uint64_t) * value.getNumWords(),
                                                       alignof(uint64_t));
@@ -542,7 +542,10 @@ ConstantValue UnaryExpression::evalImpl(EvalContext& context) const {
         SLANG_UNREACHABLE;
     }
 
-    ConstantValue cv = operand().eval(context);
+    return applyTo(operand().eval(context));
+}
+
+ConstantValue UnaryExpression::applyTo(ConstantValue&& cv) const {
     if (!cv)
         return nullptr;
 
@@ -341,6 +341,14 @@ std::optional<ConstantRange> ElementSelectExpression::evalIndex(EvalContext& con
         return std::nullopt;
     }
 
+    return translateIndex(context, val, cs, softFail);
+}
+
+std::optional<ConstantRange> ElementSelectExpression::translateIndex(EvalContext& context,
+                                                                     const ConstantValue& val,
+                                                                     const ConstantValue& cs,
+                                                                     bool& softFail) const {
+    const Type& valType = *value().type;
     std::optional<int32_t> index = cs.integer().as<int32_t>();
     if (!index) {
         if (!warnedAboutIndex)
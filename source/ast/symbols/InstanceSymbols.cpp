@@ -1126,6 +1126,53 @@ bool InstanceBodySymbol::hasSameType(const InstanceBodySymbol& other) const {
     return true;
 }
 
+void InstanceBodySymbol::noteExternalReference(const Symbol& source, const Symbol* target) {
+    // Most references stay within a single body, so check for that first.
+    auto sourceBody = getContainingBody(&source);
+    auto targetBody = target ? getContainingBody(target) : nullptr;
+    if (sourceBody == targetBody)
+        return;
+
+    SmallVector<const InstanceBodySymbol*> sourceChain;
+    SmallVector<const InstanceBodySymbol*> targetChain;
+    auto buildChain = [&](const InstanceBodySymbol* body, auto& chain) {
+        while (body) {
+            chain.push_back(body);
+            body = body->parentInstance ? getContainingBody(body->parentInstance) : nullptr;
+        }
+    };
+    buildChain(sourceBody, sourceChain);
+    buildChain(targetBody, targetChain);
+
+    // Strip off the bodies the two have in common, leaving just
+    // the ones that the reference passes through.
+    while (!sourceChain.empty() && !targetChain.empty() &&
+           sourceChain.back() == targetChain.back()) {
+        sourceChain.pop_back();
+        targetChain.pop_back();
+    }
+
+    for (auto body : sourceChain)
+        body->isLocationDependent = true;
+    for (auto body : targetChain)
+        body->isLocationDependent = true;
+}
+
+const InstanceBodySymbol* InstanceBodySymbol::getContainingBody(const Symbol* symbol) {
+    while (symbol && symbol->kind != SymbolKind::InstanceBody) {
+        const Scope* scope;
+        if (symbol->kind == SymbolKind::CheckerInstanceBody) {
+            auto inst = symbol->as<CheckerInstanceBodySymbol>().parentInstance;
+            scope = inst ? inst->getParentScope() : nullptr;
+        }
+        else {
+            scope = symbol->getParentScope();
+        }
+        symbol = scope ? &scope->asSymbol() : nullptr;
+    }
+    return symbol ? &symbol->as<InstanceBodySymbol>() : nullptr;
+}
+
 void InstanceBodySymbol::serializeTo(ASTSerializer& serializer) const {
     serializer.writeLink("definition", definition);
 }
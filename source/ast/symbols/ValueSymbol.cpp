@@ -15,6 +15,7 @@
 #include "slang/ast/expressions/MiscExpressions.h"
 #include "slang/ast/expressions/SelectExpressions.h"
 #include "slang/ast/symbols/BlockSymbols.h"
+#include "slang/ast/symbols/InstanceSymbols.h"
 #include "slang/ast/symbols/VariableSymbols.h"
 #include "slang/ast/types/NetType.h"
 #include "slang/ast/types/Type.h"
@@ -223,6 +224,7 @@ void ValueSymbol::addDriver(DriverBitRange bounds, const ValueDriver& driver) co
     SLANG_ASSERT(scope);
 
     auto& comp = scope->getCompilation();
+    InstanceBodySymbol::noteExternalReference(*driver.containingSymbol, this);
 
     if (driverMap.empty()) {
         // The first time we add a driver, check whether there is also an
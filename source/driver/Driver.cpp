@@ -23,6 +23,7 @@
 #include "slang/parsing/Parser.h"
 #include "slang/parsing/Preprocessor.h"
 #include "slang/syntax/SyntaxPrinter.h"
+#include "slang/syntax/SyntaxSerializer.h"
 #include "slang/syntax/SyntaxTree.h"
 #include "slang/util/Random.h"
 #include "slang/util/String.h"
@@ -36,7 +37,14 @@ using namespace ast;
 using namespace parsing;
 using namespace syntax;
 
-Driver::Driver() : diagEngine(sourceManager), sourceLoader(sourceManager) {
+Driver::Driver() : Driver(nullptr) {}
+
+Driver::Driver(SourceManager& sourceManager) : Driver(&sourceManager) {}
+
+Driver::Driver(SourceManager* externalSourceManager) :
+    ownedSourceManager(externalSourceManager ? nullptr : std::make_unique<SourceManager>()),
+    sourceManager(externalSourceManager ? *externalSourceManager : *ownedSourceManager),
+    diagEngine(sourceManager), sourceLoader(sourceManager) {
     // Construct a compilation object here before the TextDiagnosticClient
     // to ensure that static formatter callbacks are registered.
     Compilation compilation;
@@ -110,7 +118,42 @@ void Driver::addStandardArgs() {
                 "is skipped",
                 "<count>");
     cmdLine.add("-j,--threads", options.numThreads,
-                "The number of threads to use to parallelize parsing", "<count>");
+                "The number of threads to use to parallelize parsing and, with "
+                "--parallel-elaboration, elaboration",
+                "<count>");
+    cmdLine.add("--memory-map-files", options.memoryMapFiles,
+                "Memory map source files instead of copying their contents into memory "
+                "when loading them");
+    cmdLine.add("--precompute-line-offsets", options.precomputeLineOffsets,
+                "Find the line breaks in each source file on the thread that loads it, "
+                "instead of waiting until the first diagnostic in the file is reported");
+    cmdLine.add("--parallel-single-unit", options.parallelSingleUnit,
+                "Parse the files of a single compilation unit in parallel. "
+                "--single-unit must also be passed when this option is used.");
+    cmdLine.add("--parallel-elaboration", options.parallelElaboration,
+                "Elaborate independent parts of the design hierarchy in parallel");
+    cmdLine.add("--cache-includes", options.cacheIncludes,
+                "Cache the lexed tokens of included files so that files that are included "
+                "many times only need to be lexed once");
+    cmdLine.add("--discard-trivia", options.discardTrivia,
+                "Don't keep whitespace and comments in the parsed syntax trees, which saves "
+                "memory and time when sources are only being compiled");
+    cmdLine.add("--parse-cache", options.parseCacheDir,
+                "Cache parsed syntax trees in the given directory so that files that "
+                "haven't changed don't need to be parsed again on later runs",
+                "<dir>", CommandLineFlags::FilePath);
+    cmdLine.add("--parse-cache-max-size", options.parseCacheMaxSize,
+                "Maximum total size of the parse cache directory, in megabytes; the least "
+                "recently used entries are removed when it grows larger (default 1024)",
+                "<megabytes>");
+    cmdLine.add("--precompiled", options.precompiledFiles,
+                "Load syntax trees from a file previously written by --write-precompiled "
+                "instead of parsing their sources again",
+                "<file>[,...]", CommandLineFlags::CommaList | CommandLineFlags::FilePath);
+    cmdLine.add("--write-precompiled", options.writePrecompiled,
+                "Write all parsed syntax trees to the given file so that they can be "
+                "loaded via --precompiled on later runs",
+                "<file>", CommandLineFlags::FilePath);
 
     cmdLine.add(
         "-C",
@@ -140,6 +183,10 @@ void Driver::addStandardArgs() {
                 "Maximum number of frames to show when printing a constant evaluation "
                 "backtrace; the rest will be abbreviated",
                 "<limit>");
+    cmdLine.add("--max-constexpr-call-cache", options.maxConstexprCallCache,
+                "Maximum number of constant function call results to remember for "
+                "reuse by later calls with the same arguments; zero disables this",
+                "<limit>");
     cmdLine.add("--max-instance-array", options.maxInstanceArray,
                 "Maximum number of instances allowed in a single instance array", "<limit>");
     cmdLine.add("--compat", options.compat,
@@ -188,6 +235,12 @@ void Driver::addStandardArgs() {
     addCompFlag(CompilationFlags::StrictDriverChecking, "--strict-driver-checking",
                 "Perform strict driver checking, which currently means disabling "
                 "procedural 'for' loop unrolling.");
+    addCompFlag(CompilationFlags::DisableInstanceCaching, "--disable-instance-caching",
+                "Elaborate every instance body separately, even when other instances "
+                "have identical parameters and connections");
+    addCompFlag(CompilationFlags::CompileConstantFunctions, "--compile-constant-functions",
+                "Evaluate constant function calls by compiling the function bodies to "
+                "bytecode instead of interpreting their syntax trees");
     addCompFlag(CompilationFlags::LintMode, "--lint-only",
                 "Only perform linting of code, don't try to elaborate a full hierarchy");
 
@@ -199,6 +252,10 @@ void Driver::addStandardArgs() {
                 "One or more parameter overrides to apply when "
                 "instantiating top-level modules",
                 "<name>=<value>");
+    cmdLine.add("--elab-path", options.elabPaths,
+                "One or more hierarchical paths to the instances that should be elaborated, "
+                "skipping the rest of the design",
+                "<path>", CommandLineFlags::CommaList);
     cmdLine.add("-L", options.libraryOrder,
                 "A list of library names that controls the priority order for module lookup",
                 "<library>", CommandLineFlags::CommaList);
@@ -478,6 +535,11 @@ bool Driver::processOptions() {
         return false;
     }
 
+    if (options.parallelSingleUnit == true && !options.singleUnit.value_or(false)) {
+        printError("--single-unit must be set when --parallel-single-unit is used");
+        return false;
+    }
+
     if (options.timeScale.has_value() && !TimeScale::fromString(*options.timeScale)) {
         printError(fmt::format("invalid value for time scale option: '{}'", *options.timeScale));
         return false;
@@ -489,10 +551,16 @@ bool Driver::processOptions() {
             opt = true;
     }
 
+    if (options.memoryMapFiles == true)
+        sourceManager.setMemoryMapFiles(true);
+
+    if (options.cacheIncludes == true && !includeTokenCache)
+        includeTokenCache = std::make_unique<IncludeTokenCache>();
+
     if (!reportLoadErrors())
         return false;
 
-    if (!sourceLoader.hasFiles()) {
+    if (!sourceLoader.hasFiles() && options.precompiledFiles.empty()) {
         printError("no input files");
         return false;
     }
@@ -567,6 +635,11 @@ bool Driver::runPreprocessor(bool includeComments, bool includeDirectives, bool
     Bag optionBag;
     addParseOptions(optionBag);
 
+    // The output is printed from the tokens' trivia, so it can't be discarded here.
+    auto loptions = optionBag.getOrDefault<LexerOptions>();
+    loptions.discardTrivia = false;
+    optionBag.set(loptions);
+
     BumpAllocator alloc;
     Diagnostics diagnostics;
     Preprocessor preprocessor(sourceManager, alloc, diagnostics, optionBag);
@@ -674,6 +747,34 @@ bool Driver::parseAllSources() {
     if (!reportLoadErrors())
         return false;
 
+    if (options.writePrecompiled.has_value()) {
+        if (auto ec = SyntaxSerializer::writeFile(*options.writePrecompiled, syntaxTrees)) {
+            printError(fmt::format("unable to write precompiled syntax '{}': {}",
+                                   *options.writePrecompiled, ec.message()));
+            return false;
+        }
+    }
+
+    // Precompiled trees go first, since they typically hold
+    // packages that the rest of the design depends on.
+    std::vector<std::shared_ptr<SyntaxTree>> precompiledTrees;
+    for (auto& file : options.precompiledFiles) {
+        auto ec = SyntaxSerializer::readFile(file, sourceManager, precompiledTrees, optionBag,
+                                             [&](std::string_view name) {
+                                                 return sourceLoader.getOrAddLibrary(name);
+                                             });
+        if (ec) {
+            auto message = ec == std::errc::invalid_argument
+                               ? std::string("file is invalid or its sources have changed")
+                               : ec.message();
+            printError(fmt::format("unable to load precompiled syntax '{}': {}", file, message));
+            return false;
+        }
+    }
+
+    if (!precompiledTrees.empty())
+        syntaxTrees.insert(syntaxTrees.begin(), precompiledTrees.begin(), precompiledTrees.end());
+
     Diagnostics pragmaDiags = diagEngine.setMappingsFromPragmas();
     for (auto& diag : pragmaDiags)
         diagEngine.issue(diag);
@@ -694,6 +795,12 @@ void Driver::addParseOptions(Bag& bag) const {
     soptions.singleUnit = options.singleUnit == true;
     soptions.onlyLint = options.lintMode();
     soptions.librariesInheritMacros = options.librariesInheritMacros == true;
+    soptions.parallelSingleUnit = options.parallelSingleUnit == true;
+    soptions.precomputeLineOffsets = options.precomputeLineOffsets == true;
+    if (options.parseCacheDir.has_value())
+        soptions.parseCacheDir = *options.parseCacheDir;
+    if (options.parseCacheMaxSize.has_value())
+        soptions.parseCacheMaxSize = uint64_t(*options.parseCacheMaxSize) << 20;
 
     PreprocessorOptions ppoptions;
     ppoptions.predefines = options.defines;
@@ -704,10 +811,12 @@ void Driver::addParseOptions(Bag& bag) const {
         ppoptions.maxIncludeDepth = *options.maxIncludeDepth;
     for (const auto& d : options.ignoreDirectives)
         ppoptions.ignoreDirectives.emplace(d);
+    ppoptions.includeTokenCache = includeTokenCache.get();
 
     LexerOptions loptions;
     loptions.languageVersion = languageVersion;
     loptions.enableLegacyProtect = options.enableLegacyProtect == true;
+    loptions.discardTrivia = options.discardTrivia == true;
     if (options.maxLexerErrors.has_value())
         loptions.maxErrors = *options.maxLexerErrors;
 
@@ -736,6 +845,8 @@ void Driver::addCompilationOptions(Bag& bag) const {
         coptions.maxConstexprSteps = *options.maxConstexprSteps;
     if (options.maxConstexprBacktrace.has_value())
         coptions.maxConstexprBacktrace = *options.maxConstexprBacktrace;
+    if (options.maxConstexprCallCache.has_value())
+        coptions.maxConstexprCallCache = *options.maxConstexprCallCache;
     if (options.maxInstanceArray.has_value())
         coptions.maxInstanceArray = *options.maxInstanceArray;
     if (options.errorLimit.has_value())
@@ -753,6 +864,8 @@ void Driver::addCompilationOptions(Bag& bag) const {
         coptions.topModules.emplace(name);
     for (auto& opt : options.paramOverrides)
         coptions.paramOverrides.emplace_back(opt);
+    for (auto& path : options.elabPaths)
+        coptions.elabPaths.emplace_back(path);
     for (auto& lib : options.libraryOrder)
         coptions.defaultLiblist.emplace_back(lib);
 
@@ -816,6 +929,13 @@ bool Driver::reportCompilation(Compilation& compilation, bool quiet) {
         }
     }
 
+    if (options.parallelElaboration == true) {
+        // Elaborate up front so that the results get cached
+        // for when all diagnostics are collected below.
+        ThreadPool threadPool(options.numThreads.value_or(0));
+        compilation.getSemanticDiagnostics(threadPool);
+    }
+
     for (auto& diag : compilation.getAllDiagnostics())
         diagEngine.issue(diag);
 
@@ -8,9 +8,13 @@
 #include "slang/driver/SourceLoader.h"
 
 #include <fmt/core.h>
+#include <fstream>
+#include <random>
 
+#include "slang/parsing/Parser.h"
 #include "slang/parsing/Preprocessor.h"
 #include "slang/syntax/AllSyntax.h"
+#include "slang/syntax/SyntaxSerializer.h"
 #include "slang/syntax/SyntaxTree.h"
 #include "slang/text/SourceManager.h"
 #include "slang/util/String.h"
@@ -22,6 +26,61 @@ namespace slang::driver {
 
 using namespace syntax;
 
+std::shared_ptr<SyntaxTree> SyntaxTreeCache::find(const fs::path& path,
+                                                  std::string_view optionsKey) {
+    {
+        std::unique_lock lock(mutex);
+        auto it = entries.find(path);
+        if (it != entries.end() && it->second.optionsKey == optionsKey) {
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return it->second.tree;
+        }
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+void SyntaxTreeCache::insert(const fs::path& path, const fs::path& fullPath,
+                             std::string optionsKey, std::shared_ptr<SyntaxTree> tree) {
+    std::unique_lock lock(mutex);
+    entries.insert_or_assign(path, Entry{fullPath, std::move(optionsKey), std::move(tree)});
+}
+
+void SyntaxTreeCache::invalidate(std::span<const SourceManager::ChangedFile> changedFiles) {
+    std::unique_lock lock(mutex);
+    flat_hash_set<fs::path> changedPaths;
+    for (auto& file : changedFiles) {
+        if (file.wasIncluded) {
+            entries.clear();
+            return;
+        }
+        changedPaths.insert(file.path);
+    }
+
+    erase_if(entries, [&](auto& pair) { return changedPaths.contains(pair.second.fullPath); });
+}
+
+std::shared_ptr<SourceLibrary> SyntaxTreeCache::getOrAddLibrary(std::string_view name,
+                                                               int priority) {
+    std::unique_lock lock(mutex);
+    auto& lib = libraries[std::string(name)];
+    if (!lib) {
+        lib = std::make_shared<SourceLibrary>(std::string(name), priority);
+    }
+    else {
+        lib->includeDirs.clear();
+        lib->priority = priority;
+        lib->isDefault = false;
+    }
+    return lib;
+}
+
+size_t SyntaxTreeCache::size() const {
+    std::unique_lock lock(mutex);
+    return entries.size();
+}
+
 SourceLoader::SourceLoader(SourceManager& sourceManager) : sourceManager(sourceManager) {
     // When searching for library modules we will always include these extensions
     // in addition to anything the user provides.
@@ -180,6 +239,17 @@ SourceLoader::SyntaxTreeList SourceLoader::loadAndParseSources(const Bag& option
     deferredLibBuffers.reserve(fileEntryCount);
 
     auto srcOptions = optionBag.getOrDefault<SourceOptions>();
+    if (treeCache)
+        treeCacheOptionsKey = getParseOptionsKey(optionBag);
+
+    if (!srcOptions.parseCacheDir.empty()) {
+        // If the cache directory can't be created the cache
+        // is simply not used; it's not worth failing over.
+        std::error_code ec;
+        fs::create_directories(srcOptions.parseCacheDir, ec);
+        if (ec)
+            srcOptions.parseCacheDir.clear();
+    }
 
     auto handleLoadResult = [&](LoadResult&& result) {
         switch (result.index()) {
@@ -213,10 +283,18 @@ SourceLoader::SyntaxTreeList SourceLoader::loadAndParseSources(const Bag& option
         }
     };
 
-    auto parseSingleUnit = [&](std::span<const SourceBuffer> buffers) {
+    auto parseSingleUnit = [&](std::span<const SourceBuffer> buffers, ThreadPool* threadPool) {
         // If we waited to parse direct buffers due to wanting a single unit, parse that unit now.
         if (!buffers.empty()) {
-            auto tree = SyntaxTree::fromBuffers(buffers, sourceManager, optionBag);
+            std::shared_ptr<SyntaxTree> tree;
+            if (threadPool && srcOptions.parallelSingleUnit) {
+                tree = SyntaxTree::fromBuffersParallel(buffers, sourceManager, *threadPool,
+                                                       optionBag);
+            }
+            else {
+                tree = SyntaxTree::fromBuffers(buffers, sourceManager, optionBag);
+            }
+
             if (srcOptions.onlyLint)
                 tree->isLibraryUnit = true;
 
@@ -257,7 +335,7 @@ SourceLoader::SyntaxTreeList SourceLoader::loadAndParseSources(const Bag& option
         for (auto&& result : loadResults)
             handleLoadResult(std::move(result));
 
-        parseSingleUnit(singleUnitBuffers);
+        parseSingleUnit(singleUnitBuffers, &threadPool);
 
         // Parse separate unit groups into their own syntax trees.
         if (!unitToBufferMap.empty()) {
@@ -302,7 +380,7 @@ SourceLoader::SyntaxTreeList SourceLoader::loadAndParseSources(const Bag& option
         for (auto& entry : fileEntries)
             handleLoadResult(loadAndParse(entry, optionBag, srcOptions));
 
-        parseSingleUnit(singleUnitBuffers);
+        parseSingleUnit(singleUnitBuffers, nullptr);
 
         // Parse separate unit groups into their own syntax trees.
         if (!unitToBufferMap.empty()) {
@@ -377,35 +455,76 @@ SourceLoader::SyntaxTreeList SourceLoader::loadAndParseSources(const Bag& option
         for (auto& tree : syntaxTrees)
             findMissingNames(tree, missingNames);
 
+        // With a tree cache the source manager can hold files from earlier loads,
+        // so only the files loaded by this loader count as already loaded.
+        auto absolutePath = [](const fs::path& path) {
+            std::error_code ec;
+            auto result = fs::absolute(path, ec);
+            return ec ? fs::path() : result.lexically_normal();
+        };
+
+        flat_hash_set<fs::path> loadedPaths;
+        if (treeCache) {
+            for (auto& entry : fileEntries)
+                loadedPaths.emplace(absolutePath(entry.path));
+        }
+
+        auto isLoaded = [&](const fs::path& path) {
+            if (!treeCache)
+                return sourceManager.isCached(path);
+            return loadedPaths.contains(absolutePath(path));
+        };
+
         // Keep loading new files as long as we are making forward progress.
         flat_hash_set<std::string_view> nextMissingNames;
         while (true) {
             for (auto name : missingNames) {
+                std::shared_ptr<SyntaxTree> tree;
                 SourceBuffer buffer;
+                fs::path absPath;
                 for (auto& dir : searchDirectories) {
                     fs::path path(dir);
                     path /= name;
 
                     for (auto& ext : searchExtensions) {
                         path.replace_extension(ext);
-                        if (!sourceManager.isCached(path)) {
+                        if (!isLoaded(path)) {
+                            // Trees can only be reused if they don't depend on
+                            // macros inherited from the main compilation unit.
+                            if (treeCache && inheritedMacros.empty()) {
+                                absPath = absolutePath(path);
+                                tree = treeCache->find(absPath, treeCacheOptionsKey);
+                                if (tree && &tree->sourceManager() == &sourceManager) {
+                                    loadedPaths.emplace(absPath);
+                                    break;
+                                }
+                                tree = nullptr;
+                            }
+
                             // This file is never part of a library because if
                             // it was we would have already loaded it earlier.
                             auto readResult = sourceManager.readSource(path, /* library */ nullptr);
                             if (readResult) {
                                 buffer = *readResult;
+                                if (treeCache)
+                                    loadedPaths.emplace(absolutePath(path));
                                 break;
                             }
                         }
                     }
 
-                    if (buffer)
+                    if (tree || buffer)
                         break;
                 }
 
                 if (buffer) {
-                    auto tree = SyntaxTree::fromBuffer(buffer, sourceManager, optionBag,
-                                                       inheritedMacros);
+                    tree = SyntaxTree::fromBuffer(buffer, sourceManager, optionBag,
+                                                  inheritedMacros);
+                    if (treeCache && inheritedMacros.empty())
+                        addToTreeCache(absPath, buffer, tree);
+                }
+
+                if (tree) {
                     tree->isLibraryUnit = true;
                     syntaxTrees.emplace_back(tree);
 
@@ -422,6 +541,12 @@ SourceLoader::SyntaxTreeList SourceLoader::loadAndParseSources(const Bag& option
         }
     }
 
+    if (parseCacheWritten.exchange(false)) {
+        pruneParseCache(srcOptions.parseCacheDir,
+                        srcOptions.parseCacheMaxSize.value_or(
+                            SourceOptions::DefaultParseCacheMaxSize));
+    }
+
     return syntaxTrees;
 }
 
@@ -431,8 +556,12 @@ SourceLibrary* SourceLoader::getOrAddLibrary(std::string_view name) {
 
     auto nameStr = std::string(name);
     auto& lib = libraries[nameStr];
-    if (!lib)
-        lib = std::make_unique<SourceLibrary>(std::move(nameStr), (int)libraries.size());
+    if (!lib) {
+        if (treeCache)
+            lib = treeCache->getOrAddLibrary(nameStr, (int)libraries.size());
+        else
+            lib = std::make_shared<SourceLibrary>(std::move(nameStr), (int)libraries.size());
+    }
 
     return lib.get();
 }
@@ -527,10 +656,38 @@ SourceLoader::LoadResult SourceLoader::loadAndParse(const FileEntry& entry, cons
                                                     uint64_t fileSortKey) {
     // TODO: error if secondLib is set
 
+    // Files that get parsed on their own can be reused from the tree cache,
+    // which avoids even creating a new buffer for them. Files that belong to
+    // a library aren't cached since their parse depends on the library's
+    // include directories, which can change from one loader to the next.
+    const bool parseNow = !entry.unit && (entry.isLibraryFile || !srcOptions.singleUnit) &&
+                          !srcOptions.librariesInheritMacros;
+    const bool useTreeCache = treeCache && parseNow && !entry.library;
+
+    fs::path absPath;
+    if (useTreeCache) {
+        std::error_code ec;
+        absPath = fs::absolute(entry.path, ec).lexically_normal();
+        if (!ec) {
+            auto tree = treeCache->find(absPath, treeCacheOptionsKey);
+            if (tree && &tree->sourceManager() == &sourceManager) {
+                if (entry.isLibraryFile || srcOptions.onlyLint)
+                    tree->isLibraryUnit = true;
+                return tree;
+            }
+        }
+        else {
+            absPath.clear();
+        }
+    }
+
     auto buffer = sourceManager.readSource(entry.path, entry.library, fileSortKey);
     if (!buffer)
         return std::pair{&entry, buffer.error()};
 
+    if (srcOptions.precomputeLineOffsets)
+        sourceManager.precomputeLineOffsets(buffer->id);
+
     if (entry.unit) {
         return std::pair{*buffer, entry.unit};
     }
@@ -548,11 +705,182 @@ SourceLoader::LoadResult SourceLoader::loadAndParse(const FileEntry& entry, cons
     }
     else {
         // Otherwise we can parse right away.
-        auto tree = SyntaxTree::fromBuffer(*buffer, sourceManager, optionBag);
+        std::shared_ptr<SyntaxTree> tree;
+        if (!srcOptions.parseCacheDir.empty())
+            tree = parseCached(*buffer, optionBag, srcOptions.parseCacheDir);
+        else
+            tree = SyntaxTree::fromBuffer(*buffer, sourceManager, optionBag);
+
         if (entry.isLibraryFile || srcOptions.onlyLint)
             tree->isLibraryUnit = true;
 
+        if (useTreeCache)
+            addToTreeCache(absPath, *buffer, tree);
+
+        return tree;
+    }
+}
+
+void SourceLoader::addToTreeCache(const fs::path& absPath, const SourceBuffer& buffer,
+                                  const std::shared_ptr<SyntaxTree>& tree) {
+    if (absPath.empty())
+        return;
+
+    // Trees with errors aren't cached; their diagnostics can depend
+    // on files that couldn't be found but may show up later.
+    for (auto& diag : tree->diagnostics()) {
+        if (diag.isError())
+            return;
+    }
+
+    treeCache->insert(absPath, sourceManager.getFullPath(buffer.id), treeCacheOptionsKey, tree);
+}
+
+std::string SourceLoader::getParseOptionsKey(const Bag& optionBag) {
+    using namespace parsing;
+
+    auto ppOptions = optionBag.getOrDefault<PreprocessorOptions>();
+    auto lexerOptions = optionBag.getOrDefault<LexerOptions>();
+    auto parserOptions = optionBag.getOrDefault<ParserOptions>();
+
+    std::string key = fmt::format("pp:{}:{}:{}\n", ppOptions.maxIncludeDepth,
+                                  int(ppOptions.languageVersion), ppOptions.predefineSource);
+    for (auto& define : ppOptions.predefines)
+        key += fmt::format("D{}\n", define);
+    for (auto& undef : ppOptions.undefines)
+        key += fmt::format("U{}\n", undef);
+    for (auto& path : ppOptions.additionalIncludePaths)
+        key += fmt::format("I{}\n", getU8Str(path));
+
+    std::vector<std::string_view> ignored(ppOptions.ignoreDirectives.begin(),
+                                          ppOptions.ignoreDirectives.end());
+    std::ranges::sort(ignored);
+    for (auto name : ignored)
+        key += fmt::format("X{}\n", name);
+
+    key += fmt::format("lex:{}:{}:{}:{}\n", lexerOptions.maxErrors,
+                       int(lexerOptions.languageVersion), lexerOptions.enableLegacyProtect,
+                       lexerOptions.discardTrivia);
+    key += fmt::format("parse:{}:{}\n", parserOptions.maxRecursionDepth,
+                       int(parserOptions.languageVersion));
+    return key;
+}
+
+std::shared_ptr<SyntaxTree> SourceLoader::parseCached(const SourceBuffer& buffer,
+                                                      const Bag& optionBag,
+                                                      const fs::path& cacheDir) {
+    // The cache key covers the file's contents and every option that can change
+    // the result of parsing it. The contents of included files aren't known until
+    // the file is preprocessed, so those are checked when the cached tree is loaded.
+    auto text = sourceManager.getSourceText(buffer.id);
+    std::string key = fmt::format("{}:{:016x}\n{}\n{}:{:016x}\n", SyntaxSerializer::FormatVersion,
+                                  SyntaxSerializer::getFormatHash(),
+                                  getU8Str(sourceManager.getFullPath(buffer.id)), text.size(),
+                                  slang::detail::hashing::hash(text.data(), text.size()));
+    key += getParseOptionsKey(optionBag);
+
+    auto keyHash = slang::detail::hashing::hash(key.data(), key.size());
+    auto cachePath = cacheDir / fmt::format("{:016x}.slcache", keyHash);
+
+    // Each cache file holds the full key, to guard against hash collisions,
+    // followed by a null terminator and then the serialized tree.
+    {
+        std::ifstream file(cachePath, std::ios::binary);
+        if (file) {
+            std::vector<char> data((std::istreambuf_iterator<char>(file)),
+                                   std::istreambuf_iterator<char>());
+            if (data.size() > key.size() && data[key.size()] == '\0' &&
+                std::string_view(data.data(), key.size()) == key) {
+                auto payload = std::span<const char>(data).subspan(key.size() + 1);
+                if (auto tree = SyntaxSerializer::deserialize(payload, sourceManager, {&buffer, 1},
+                                                              optionBag)) {
+                    // Bump the modification time so that pruning treats
+                    // the entry as recently used.
+                    std::error_code ec;
+                    fs::last_write_time(cachePath, fs::file_time_type::clock::now(), ec);
+                    return tree;
+                }
+            }
+        }
+    }
+
+    auto tree = SyntaxTree::fromBuffer(buffer, sourceManager, optionBag);
+
+    // Trees with errors aren't worth caching; they need to be fixed and
+    // reparsed anyway, and their diagnostics can depend on files that
+    // couldn't be found.
+    for (auto& diag : tree->diagnostics()) {
+        if (diag.isError())
+            return tree;
+    }
+
+    auto data = SyntaxSerializer::serialize(*tree);
+    if (!data)
         return tree;
+
+    // Write to a temporary file first so that other processes
+    // never see a partially written cache entry.
+    auto tempPath = cachePath;
+    tempPath += fmt::format(".{:08x}.tmp", std::random_device()());
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return tree;
+
+        file.write(key.data(), std::streamsize(key.size() + 1));
+        file.write(data->data(), std::streamsize(data->size()));
+        if (!file)
+            return tree;
+    }
+
+    std::error_code ec;
+    fs::rename(tempPath, cachePath, ec);
+    if (ec)
+        fs::remove(tempPath, ec);
+    else
+        parseCacheWritten = true;
+
+    return tree;
+}
+
+void SourceLoader::pruneParseCache(const fs::path& cacheDir, uint64_t maxSize) {
+    struct Entry {
+        fs::path path;
+        fs::file_time_type time;
+        uint64_t size;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t totalSize = 0;
+    std::error_code ec;
+    for (auto& dirEntry : fs::directory_iterator(cacheDir, ec)) {
+        if (dirEntry.path().extension() != ".slcache")
+            continue;
+
+        auto size = dirEntry.file_size(ec);
+        if (ec)
+            continue;
+
+        auto time = dirEntry.last_write_time(ec);
+        if (ec)
+            continue;
+
+        entries.push_back({dirEntry.path(), time, size});
+        totalSize += size;
+    }
+
+    if (totalSize <= maxSize)
+        return;
+
+    // Remove the least recently used entries first. Other processes may be
+    // removing the same files concurrently, which is fine.
+    std::ranges::sort(entries, {}, &Entry::time);
+    for (auto& entry : entries) {
+        if (totalSize <= maxSize)
+            break;
+
+        fs::remove(entry.path, ec);
+        totalSize -= entry.size;
     }
 }
 
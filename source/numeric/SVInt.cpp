@@ -254,14 +254,81 @@ SVInt SVInt::fromDigits(bitwidth_t bits, LiteralBase base, bool isSigned, bool a
     return fromPow2Digits(bits, isSigned, anyUnknown, radix, shift, digits);
 }
 
+// Decimal strings longer than this are converted by splitting them in half recursively,
+// so that most of the work happens in a few large subquadratic multiplies and divides.
+static constexpr uint32_t DecimalChunkDigits = 512;
+
+// Parsing a decimal string one word at a time is quadratic but has a very cheap inner
+// loop, so it stays faster than splitting up to much longer strings than printing does.
+static constexpr size_t DecimalParseSplitDigits = 40000;
+
+// Builds the table of powers used to split values of up to the given number of decimal
+// digits, where entry k holds 10^(DecimalChunkDigits * 2^k).
+static SmallVector<SVInt> decimalSplitPowers(size_t maxDigits) {
+    SmallVector<SVInt> powers;
+    if (maxDigits <= DecimalChunkDigits)
+        return powers;
+
+    SVInt power(bitwidth_t(ceil(DecimalChunkDigits * log2_10)) + 1, 10, false);
+    power = power.pow(DecimalChunkDigits);
+    powers.push_back(power.trunc(power.getActiveBits()));
+
+    while ((size_t(DecimalChunkDigits) << powers.size()) < maxDigits) {
+        const SVInt& last = powers.back();
+        SVInt square = last.zext(last.getBitWidth() * 2);
+        square *= last;
+        square = square.trunc(square.getActiveBits());
+        powers.push_back(std::move(square));
+    }
+    return powers;
+}
+
 SVInt SVInt::fromDecimalDigits(bitwidth_t bits, bool isSigned, std::span<logic_t const> digits) {
-    SVInt result = allocZeroed(bits, isSigned, false);
+    SmallVector<SVInt> powers;
+    if (digits.size() > DecimalParseSplitDigits)
+        powers = decimalSplitPowers(digits.size());
+
+    SVInt result = decimalDigitsToValue(digits, powers, bits);
+
+    // If the user specified a number too large to fit in the number of bits specified,
+    // the spec says to truncate from the left.
+    if (result.bitWidth != bits)
+        result = result.trunc(bits);
+
+    result.setSigned(isSigned);
+    return result;
+}
+
+SVInt SVInt::decimalDigitsToValue(std::span<logic_t const> digits, std::span<const SVInt> powers,
+                                  bitwidth_t minBits) {
+    if (!powers.empty()) {
+        // Convert the low digits and the high digits separately and then combine them
+        // by scaling the high part by the matching power of ten.
+        const SVInt& power = powers.back();
+        powers = powers.first(powers.size() - 1);
+
+        size_t lowDigits = size_t(DecimalChunkDigits) << powers.size();
+        if (digits.size() <= lowDigits)
+            return decimalDigitsToValue(digits, powers, minBits);
+
+        SVInt high = decimalDigitsToValue(digits.first(digits.size() - lowDigits), powers, 0);
+        SVInt low = decimalDigitsToValue(digits.last(lowDigits), powers, 0);
+
+        SVInt result = high.zext(std::max(minBits, high.getBitWidth() + power.getBitWidth()));
+        result *= power;
+        result += low;
+        return result;
+    }
+
+    bitwidth_t bits = bitwidth_t(ceil(double(digits.size()) * log2_10)) + 1;
+    SVInt result(std::max(bits, minBits), 0, false);
 
     constexpr int charsPerWord = 18; // 18 decimal digits can fit in a 64-bit word
     const logic_t* d = digits.data();
     uint64_t maxWord = (uint64_t)std::pow(10, charsPerWord);
     uint32_t count = 0;
     uint64_t word;
+    uint64_t* data = result.getRawData();
 
     auto nextDigit = [&]() {
         uint8_t v = d->value;
@@ -276,13 +343,13 @@ SVInt SVInt::fromDecimalDigits(bitwidth_t bits, bool isSigned, std::span<logic_t
     auto writeWord = [&]() {
         if (!count) {
             if (word)
-                result.pVal[count++] = word;
+                data[count++] = word;
         }
         else {
-            uint64_t carry = mulOne(result.pVal, result.pVal, count, maxWord);
-            carry += addOne(result.pVal, result.pVal, count, word);
+            uint64_t carry = mulOne(data, data, count, maxWord);
+            carry += addOne(data, data, count, word);
             if (carry)
-                result.pVal[count++] = carry;
+                data[count++] = carry;
         }
     };
 
@@ -317,7 +384,7 @@ SVInt SVInt::fromPow2Digits(bitwidth_t bits, bool isSigned, bool anyUnknown, uin
     uint32_t ones = (1 << shift) - 1;
     uint64_t word = 0;
     uint64_t unknownWord = 0;
-    uint64_t* dest = result.pVal;
+    uint64_t* dest = result.getRawData();
     uint64_t* endPtr = dest + numWords;
     uint32_t bitPos = 0;
 
@@ -382,18 +449,19 @@ SVInt SVInt::fromPow2Digits(bitwidth_t bits, bool isSigned, bool anyUnknown, uin
             mask = 0;
         }
 
+        uint64_t* data = result.getRawData();
         uint32_t topWord = numWords + wordOffset;
-        if (result.pVal[topWord] >> (wordBits - 1)) {
+        if (data[topWord] >> (wordBits - 1)) {
             // Unknown bit was set, so now do the extension.
-            result.pVal[topWord] |= mask;
+            data[topWord] |= mask;
             for (topWord++; topWord < numWords * 2; topWord++)
-                result.pVal[topWord] = UINT64_MAX;
+                data[topWord] = UINT64_MAX;
 
-            if (result.pVal[wordOffset] >> (wordBits - 1)) {
+            if (data[wordOffset] >> (wordBits - 1)) {
                 // The Z bit was set as well, so handle that too.
-                result.pVal[wordOffset] |= mask;
+                data[wordOffset] |= mask;
                 for (wordOffset++; wordOffset < numWords; wordOffset++)
-                    result.pVal[wordOffset] = UINT64_MAX;
+                    data[wordOffset] = UINT64_MAX;
             }
             result.clearUnusedBits();
         }
@@ -424,58 +492,45 @@ void SVInt::setAllZeros() {
     else if (unknownFlag)
         *this = SVInt(bitWidth, 0, signFlag);
     else
-        memset(pVal, 0, getNumWords() * WORD_SIZE);
+        memset(getRawData(), 0, getNumWords() * WORD_SIZE);
 }
 
 void SVInt::setAllOnes() {
     // we don't have unknown digits anymore, so reallocate if necessary
-    if (unknownFlag) {
-        unknownFlag = false;
-        delete[] pVal;
-        if (getNumWords() > 1)
-            pVal = new uint64_t[getNumWords()];
-    }
+    if (unknownFlag)
+        reallocate(false);
 
     if (isSingleWord())
         val = UINT64_MAX;
     else {
+        uint64_t* data = getRawData();
         for (uint32_t i = 0; i < getNumWords(); i++)
-            pVal[i] = UINT64_MAX;
+            data[i] = UINT64_MAX;
     }
     clearUnusedBits();
 }
 
 void SVInt::setAllX() {
-    // first set low half to zero (for X)
-    uint32_t words = getNumWords(bitWidth, false);
-    if (unknownFlag)
-        memset(pVal, 0, words * WORD_SIZE);
-    else {
-        if (!isSingleWord())
-            delete[] pVal;
-
-        unknownFlag = true;
-        pVal = new uint64_t[words * 2]();
-    }
+    if (!unknownFlag)
+        reallocate(true);
 
-    // now set upper half to ones (for unknown)
+    // set low half to zero (for X) and upper half to ones (for unknown)
+    uint32_t words = getNumWords(bitWidth, false);
+    uint64_t* data = getRawData();
+    memset(data, 0, words * WORD_SIZE);
     for (uint32_t i = words; i < words * 2; i++)
-        pVal[i] = UINT64_MAX;
+        data[i] = UINT64_MAX;
     clearUnusedBits();
 }
 
 void SVInt::setAllZ() {
-    if (!unknownFlag) {
-        if (!isSingleWord())
-            delete[] pVal;
-
-        unknownFlag = true;
-        pVal = new uint64_t[getNumWords()];
-    }
+    if (!unknownFlag)
+        reallocate(true);
 
     // everything set to 1 (for Z in the low half and for unknown in the upper half)
+    uint64_t* data = getRawData();
     for (uint32_t i = 0; i < getNumWords(); i++)
-        pVal[i] = UINT64_MAX;
+        data[i] = UINT64_MAX;
     clearUnusedBits();
 }
 
@@ -484,9 +539,10 @@ void SVInt::flattenUnknowns() {
         return;
 
     uint32_t words = getNumWords(bitWidth, false);
+    uint64_t* data = getRawData();
     for (uint32_t i = 0; i < words; i++) {
-        pVal[i] &= ~pVal[i + words];
-        pVal[i + words] = 0;
+        data[i] &= ~data[i + words];
+        data[i + words] = 0;
     }
 
     checkUnknown();
@@ -528,12 +584,11 @@ SVInt SVInt::shl(bitwidth_t amount) const {
 
     // handle the small shift case
     SVInt result = allocUninitialized(bitWidth, signFlag, unknownFlag);
+    uint64_t* dst = result.getRawData();
+    const uint64_t* src = getRawData();
     if (amount < BITS_PER_WORD && !unknownFlag) {
-        uint64_t carry = 0;
-        for (uint32_t i = 0; i < getNumWords(); i++) {
-            result.pVal[i] = pVal[i] << amount | carry;
-            carry = pVal[i] >> (BITS_PER_WORD - amount);
-        }
+        dst[0] = src[0] << amount;
+        shiftLeftWords(dst + 1, src + 1, getNumWords() - 1, amount);
     }
     else {
         // otherwise do a full shift
@@ -542,9 +597,9 @@ SVInt SVInt::shl(bitwidth_t amount) const {
         uint32_t offset = amount / BITS_PER_WORD;
 
         // also handle shifting the unknown bits if necessary
-        shlFar(result.pVal, pVal, wordShift, offset, 0, numWords);
+        shlFar(dst, src, wordShift, offset, 0, numWords);
         if (unknownFlag)
-            shlFar(result.pVal, pVal, wordShift, offset, numWords, numWords);
+            shlFar(dst, src, wordShift, offset, numWords, numWords);
     }
 
     result.clearUnusedBits();
@@ -571,8 +626,10 @@ SVInt SVInt::lshr(bitwidth_t amount) const {
 
     // handle the small shift case
     SVInt result = allocZeroed(bitWidth, signFlag, unknownFlag);
+    uint64_t* dst = result.getRawData();
+    const uint64_t* src = getRawData();
     if (amount < BITS_PER_WORD && !unknownFlag)
-        lshrNear(result.pVal, pVal, getNumWords(), amount);
+        lshrNear(dst, src, getNumWords(), amount);
     else {
         // otherwise do a full shift
         uint32_t numWords = getNumWords(bitWidth, false);
@@ -580,9 +637,9 @@ SVInt SVInt::lshr(bitwidth_t amount) const {
         uint32_t offset = amount / BITS_PER_WORD;
 
         // also handle shifting the unknown bits if necessary
-        lshrFar(result.pVal, pVal, wordShift, offset, 0, numWords);
+        lshrFar(dst, src, wordShift, offset, 0, numWords);
         if (unknownFlag)
-            lshrFar(result.pVal, pVal, wordShift, offset, numWords, numWords);
+            lshrFar(dst, src, wordShift, offset, numWords, numWords);
     }
 
     result.checkUnknown();
@@ -732,24 +789,25 @@ void SVInt::writeTo(SmallVectorBase<char>& buffer, LiteralBase base, bool includ
             uint64_t mask;
             bitwidth_t bitsInMsw;
             uint32_t words = getNumWords(bitWidth, false);
+            const uint64_t* data = getRawData();
             getTopWordMask(bitsInMsw, mask);
 
             auto all = [&](uint32_t start, uint64_t v) {
                 for (uint32_t i = 0; i < words - 1; i++) {
-                    if (pVal[start + i] != v)
+                    if (data[start + i] != v)
                         return false;
                 }
 
-                return pVal[start + words - 1] == (mask & v);
+                return data[start + words - 1] == (mask & v);
             };
 
             auto anyXs = [&]() {
                 for (uint32_t i = 0; i < words - 1; i++) {
-                    if ((~pVal[i] & pVal[i + words]) != 0)
+                    if ((~data[i] & data[i + words]) != 0)
                         return true;
                 }
 
-                return (~pVal[words - 1] & mask & pVal[words * 2 - 1]) != 0;
+                return (~data[words - 1] & mask & data[words * 2 - 1]) != 0;
             };
 
             bool upperOnes = all(words, UINT64_MAX);
@@ -777,18 +835,8 @@ void SVInt::writeTo(SmallVectorBase<char>& buffer, LiteralBase base, bool includ
                 tmp = quotient;
             }
 
-            // repeatedly divide by 10 to get each digit
-            SVInt divisor(4, 10, false);
-            while (tmp != 0) {
-                SVInt remainder;
-                SVInt quotient;
-                divide(tmp, tmp.getNumWords(), divisor, divisor.getNumWords(), &quotient,
-                       &remainder);
-                uint64_t digit = remainder.as<uint64_t>().value();
-                SLANG_ASSERT(digit < 10);
-                buffer.push_back(Digits[digit]);
-                tmp = quotient;
-            }
+            auto powers = decimalSplitPowers(size_t(ceil(tmp.getActiveBits() / log2_10)));
+            writeDecimalDigits(buffer, tmp, powers, 0);
         }
     }
     else {
@@ -812,19 +860,41 @@ void SVInt::writeTo(SmallVectorBase<char>& buffer, LiteralBase base, bool includ
                 SLANG_UNREACHABLE;
         }
 
-        // if we have unknown values here, the comparison will return X
-        // we want to keep going so that we print the unknowns
-        int bitsLeft = int(tmp.getBitWidth());
-        logic_t x = tmp != 0;
-        while (x || x.isUnknown()) {
-            if (bitsLeft < int(shiftAmount))
-                maskAmount = (1 << bitsLeft) - 1;
+        // Each digit maps directly onto a group of bits, so pull them straight out of
+        // the value and unknown words. Digits above the highest set or unknown bit are
+        // leading zeros and aren't printed.
+        const uint32_t words = getNumWords(bitWidth, false);
+        const uint64_t* data = tmp.getRawData();
+        const uint64_t* unknowns = tmp.unknownFlag ? data + words : nullptr;
+
+        bitwidth_t usedBits = 0;
+        for (uint32_t i = words; i > 0; i--) {
+            uint64_t word = data[i - 1] | (unknowns ? unknowns[i - 1] : 0);
+            if (word) {
+                usedBits = (i - 1) * BITS_PER_WORD + (bitwidth_t)std::bit_width(word);
+                break;
+            }
+        }
 
-            uint32_t digit = uint32_t(tmp.getRawData()[0]) & maskAmount;
-            if (!tmp.unknownFlag)
+        auto getDigit = [&](const uint64_t* src, bitwidth_t bitPos) {
+            uint32_t word = whichWord(bitPos);
+            uint32_t bit = whichBit(bitPos);
+            uint64_t bits = src[word] >> bit;
+            if (bit + shiftAmount > BITS_PER_WORD && word + 1 < words)
+                bits |= src[word + 1] << (BITS_PER_WORD - bit);
+            return uint32_t(bits) & maskAmount;
+        };
+
+        bitwidth_t bitPos = 0;
+        for (; bitPos < usedBits; bitPos += shiftAmount) {
+            if (bitWidth - bitPos < shiftAmount)
+                maskAmount = (1 << (bitWidth - bitPos)) - 1;
+
+            uint32_t digit = getDigit(data, bitPos);
+            if (!unknowns)
                 buffer.push_back(Digits[digit]);
             else {
-                uint32_t u = uint32_t(tmp.pVal[getNumWords(bitWidth, false)]) & maskAmount;
+                uint32_t u = getDigit(unknowns, bitPos);
                 if (!u)
                     buffer.push_back(Digits[digit]);
                 else if (u == maskAmount && (digit & maskAmount) == 0)
@@ -836,17 +906,12 @@ void SVInt::writeTo(SmallVectorBase<char>& buffer, LiteralBase base, bool includ
                 else
                     buffer.push_back('Z');
             }
-            // this shift might shift away the unknown digits, at which point
-            // it converts back to being a normal 2-state value
-            tmp = tmp.lshr(shiftAmount);
-            bitsLeft -= int(shiftAmount);
-            x = tmp != 0;
         }
 
         // If there are bits left over and the last digit we pushed was
         // an unknown we need to insert an extra 0 to indicate that the
         // leading bits are actually zeroes and not extended unknowns.
-        if (bitsLeft > 0 && !buffer.empty() && (buffer.back() == 'x' || buffer.back() == 'z'))
+        if (bitPos < bitWidth && !buffer.empty() && (buffer.back() == 'x' || buffer.back() == 'z'))
             buffer.push_back('0');
     }
 
@@ -863,6 +928,61 @@ void SVInt::writeTo(SmallVectorBase<char>& buffer, LiteralBase base, bool includ
     }
 }
 
+void SVInt::writeDecimalDigits(SmallVectorBase<char>& buffer, const SVInt& value,
+                               std::span<const SVInt> powers, size_t minDigits) {
+    bitwidth_t activeBits = value.getActiveBits();
+    uint32_t valueWords = !activeBits ? 0 : whichWord(activeBits - 1) + 1;
+    size_t startOffset = buffer.size();
+
+    if (powers.empty()) {
+        // The value is small enough to convert directly, nine digits at a time.
+        TempBuffer<uint64_t, 32> scratch(valueWords);
+        uint64_t* data = scratch.get();
+        std::ranges::copy(std::span(value.getRawData(), valueWords), data);
+
+        while (valueWords) {
+            uint32_t chunk = divOne(data, valueWords, 1'000'000'000);
+            while (valueWords && !data[valueWords - 1])
+                valueWords--;
+
+            for (int i = 0; i < 9 && (chunk || valueWords); i++) {
+                buffer.push_back(char('0' + chunk % 10));
+                chunk /= 10;
+            }
+        }
+
+        if (buffer.size() - startOffset < minDigits)
+            buffer.append(minDigits - (buffer.size() - startOffset), '0');
+        return;
+    }
+
+    // Split the value at the largest power of ten and convert each half separately.
+    // The table is built such that both halves can be converted by its remaining entries.
+    const SVInt& divisor = powers.back();
+    powers = powers.first(powers.size() - 1);
+
+    uint32_t divisorWords = divisor.getNumWords();
+    if (valueWords < divisorWords) {
+        writeDecimalDigits(buffer, value, powers, minDigits);
+        return;
+    }
+
+    SVInt quotient;
+    SVInt remainder;
+    divide(value, valueWords, divisor, divisorWords, &quotient, &remainder);
+
+    // The low half needs all of its leading zeros unless it's the top of the number.
+    size_t lowDigits = size_t(DecimalChunkDigits) << powers.size();
+    bitwidth_t quotientBits = quotient.getActiveBits();
+    bool hasHigh = quotientBits || minDigits > lowDigits;
+    writeDecimalDigits(buffer, remainder, powers, hasHigh ? lowDigits : minDigits);
+
+    if (hasHigh) {
+        writeDecimalDigits(buffer, quotient.trunc(std::max(quotientBits, 1u)), powers,
+                           minDigits > lowDigits ? minDigits - lowDigits : 0);
+    }
+}
+
 SVInt SVInt::pow(const SVInt& rhs) const {
     // ignore unknowns
     if (unknownFlag || rhs.unknownFlag)
@@ -923,13 +1043,12 @@ logic_t SVInt::reductionAnd() const {
     bitwidth_t bitsInMsw;
     getTopWordMask(bitsInMsw, mask);
 
+    const uint64_t* data = getRawData();
     if (unknownFlag) {
         uint32_t words = getNumWords(bitWidth, false);
-        for (uint32_t i = 0; i < words - 1; i++) {
-            if ((pVal[i] | pVal[i + words]) != UINT64_MAX)
-                return logic_t(false);
-        }
-        if ((pVal[words - 1] | pVal[words * 2 - 1]) != mask)
+        if (!allWordsSet(data, data + words, words - 1))
+            return logic_t(false);
+        if ((data[words - 1] | data[words * 2 - 1]) != mask)
             return logic_t(false);
         return logic_t::x;
     }
@@ -937,33 +1056,23 @@ logic_t SVInt::reductionAnd() const {
     if (isSingleWord())
         return logic_t(val == mask);
     else {
-        for (uint32_t i = 0; i < getNumWords() - 1; i++) {
-            if (pVal[i] != UINT64_MAX)
-                return logic_t(false);
-        }
-        return logic_t(pVal[getNumWords() - 1] == mask);
+        uint32_t words = getNumWords();
+        return logic_t(allWordsSet(data, nullptr, words - 1) && data[words - 1] == mask);
     }
 }
 
 logic_t SVInt::reductionOr() const {
+    const uint64_t* data = getRawData();
     if (unknownFlag) {
         uint32_t words = getNumWords(bitWidth, false);
-        for (uint32_t i = 0; i < words; i++) {
-            if (pVal[i] & ~pVal[i + words])
-                return logic_t(true);
-        }
+        if (anyKnownOne(data, data + words, words))
+            return logic_t(true);
         return logic_t::x;
     }
 
     if (isSingleWord())
         return logic_t(val != 0);
-    else {
-        for (uint32_t i = 0; i < getNumWords(); i++) {
-            if (pVal[i] != 0)
-                return logic_t(true);
-        }
-    }
-    return logic_t(false);
+    return logic_t(anyKnownOne(data, nullptr, getNumWords()));
 }
 
 logic_t SVInt::reductionXor() const {
@@ -971,12 +1080,10 @@ logic_t SVInt::reductionXor() const {
         return logic_t::x;
 
     // reduction xor basically determines whether the number of set
-    // bits in the number is even or odd
-    uint32_t count = countOnes();
-    if (count % 2 == 0)
-        return logic_t(0);
-
-    return logic_t(1);
+    // bits in the number is even or odd, which is the same as the parity
+    // of all of the words xored together
+    uint64_t folded = xorFoldWords(getRawData(), getNumWords());
+    return logic_t(std::popcount(folded) % 2 != 0);
 }
 
 SVInt SVInt::operator-() const {
@@ -989,20 +1096,10 @@ SVInt SVInt::operator~() const {
     SVInt result(*this);
     uint32_t words = getNumWords(bitWidth, false);
 
-    // just use xor to quickly flip everything
-    if (isSingleWord())
-        result.val ^= UINT64_MAX;
-    else {
-        for (uint32_t i = 0; i < words; i++)
-            result.pVal[i] ^= UINT64_MAX;
-    }
-
-    if (unknownFlag) {
-        // any unknown bits are still unknown, but we need to make sure
-        // any high impedance values become X's
-        for (uint32_t i = 0; i < words; i++)
-            result.pVal[i] &= ~result.pVal[i + words];
-    }
+    // any unknown bits are still unknown, but we need to make sure
+    // any high impedance values become X's
+    uint64_t* data = result.getRawData();
+    bitwiseNotWords(data, unknownFlag ? data + words : nullptr, words);
 
     result.clearUnusedBits();
     return result;
@@ -1014,7 +1111,7 @@ SVInt& SVInt::operator++() {
     else if (unknownFlag)
         setAllX();
     else
-        addOne(pVal, pVal, getNumWords(), 1);
+        addOne(getRawData(), getRawData(), getNumWords(), 1);
     clearUnusedBits();
     return *this;
 }
@@ -1025,7 +1122,7 @@ SVInt& SVInt::operator--() {
     else if (unknownFlag)
         setAllX();
     else
-        subOne(pVal, pVal, getNumWords(), 1);
+        subOne(getRawData(), getRawData(), getNumWords(), 1);
     clearUnusedBits();
     return *this;
 }
@@ -1044,7 +1141,7 @@ SVInt& SVInt::operator+=(const SVInt& rhs) {
         if (isSingleWord())
             val += rhs.val;
         else
-            addGeneral(pVal, pVal, rhs.pVal, getNumWords());
+            addGeneral(getRawData(), getRawData(), rhs.getRawData(), getNumWords());
         clearUnusedBits();
     }
     return *this;
@@ -1065,7 +1162,7 @@ SVInt& SVInt::operator-=(const SVInt& rhs) {
         if (isSingleWord())
             val -= rhs.val;
         else
-            subGeneral(pVal, pVal, rhs.pVal, getNumWords());
+            subGeneral(getRawData(), getRawData(), rhs.getRawData(), getNumWords());
         clearUnusedBits();
     }
     return *this;
@@ -1101,12 +1198,12 @@ SVInt& SVInt::operator*=(const SVInt& rhs) {
             // allocate result space and do the multiply
             uint32_t destWords = lhsWords + rhsWords;
             TempBuffer<uint64_t, 128> dst(destWords);
-            mul(dst.get(), pVal, lhsWords, rhs.pVal, rhsWords);
+            mul(dst.get(), getRawData(), lhsWords, rhs.getRawData(), rhsWords);
 
             // copy the result back into *this
             setAllZeros();
             uint32_t wordsToCopy = destWords >= getNumWords() ? getNumWords() : destWords;
-            memcpy(pVal, dst.get(), wordsToCopy * WORD_SIZE);
+            memcpy(getRawData(), dst.get(), wordsToCopy * WORD_SIZE);
         }
         clearUnusedBits();
     }
@@ -1139,31 +1236,14 @@ SVInt& SVInt::operator&=(const SVInt& rhs) {
         val &= rhs.val;
     else {
         uint32_t words = getNumWords(bitWidth, false);
+        uint64_t* data = getRawData();
+        const uint64_t* rhsData = rhs.getRawData();
         if (unknownFlag) {
-            if (rhs.isSingleWord()) {
-                pVal[1] &= rhs.val;
-                pVal[0] = ~pVal[1] & pVal[0] & rhs.val;
-            }
-            else {
-                if (rhs.hasUnknown()) {
-                    for (uint32_t i = 0; i < words; i++) {
-                        pVal[i + words] = (pVal[i + words] | rhs.pVal[i + words]) &
-                                          (pVal[i + words] | pVal[i]) &
-                                          (rhs.pVal[i + words] | rhs.pVal[i]);
-                    }
-                }
-                else {
-                    for (uint32_t i = 0; i < words; i++)
-                        pVal[i + words] &= rhs.pVal[i];
-                }
-
-                for (uint32_t i = 0; i < words; i++)
-                    pVal[i] = ~pVal[i + words] & pVal[i] & rhs.pVal[i];
-            }
+            bitwiseWords4State<BitOp::And>(data, data + words, rhsData,
+                                           rhs.unknownFlag ? rhsData + words : nullptr, words);
         }
         else {
-            for (uint32_t i = 0; i < words; i++)
-                pVal[i] &= rhs.pVal[i];
+            bitwiseWords<BitOp::And>(data, rhsData, words);
         }
     }
     clearUnusedBits();
@@ -1187,30 +1267,14 @@ SVInt& SVInt::operator|=(const SVInt& rhs) {
         val |= rhs.val;
     else {
         uint32_t words = getNumWords(bitWidth, false);
+        uint64_t* data = getRawData();
+        const uint64_t* rhsData = rhs.getRawData();
         if (unknownFlag) {
-            if (rhs.isSingleWord()) {
-                pVal[1] &= ~rhs.val;
-                pVal[0] = ~pVal[1] & (pVal[0] | rhs.val);
-            }
-            else {
-                if (rhs.hasUnknown()) {
-                    for (uint32_t i = 0; i < words; i++) {
-                        pVal[i + words] = (pVal[i + words] & (rhs.pVal[i + words] | ~rhs.pVal[i])) |
-                                          (~pVal[i] & rhs.pVal[i + words]);
-                    }
-                }
-                else {
-                    for (uint32_t i = 0; i < words; i++)
-                        pVal[i + words] &= ~rhs.pVal[i];
-                }
-
-                for (uint32_t i = 0; i < words; i++)
-                    pVal[i] = ~pVal[i + words] & (pVal[i] | rhs.pVal[i]);
-            }
+            bitwiseWords4State<BitOp::Or>(data, data + words, rhsData,
+                                          rhs.unknownFlag ? rhsData + words : nullptr, words);
         }
         else {
-            for (uint32_t i = 0; i < words; i++)
-                pVal[i] |= rhs.pVal[i];
+            bitwiseWords<BitOp::Or>(data, rhsData, words);
         }
     }
     clearUnusedBits();
@@ -1234,22 +1298,14 @@ SVInt& SVInt::operator^=(const SVInt& rhs) {
         val ^= rhs.val;
     else {
         uint32_t words = getNumWords(bitWidth, false);
+        uint64_t* data = getRawData();
+        const uint64_t* rhsData = rhs.getRawData();
         if (unknownFlag) {
-            if (rhs.isSingleWord())
-                pVal[0] = ~pVal[1] & (pVal[0] ^ rhs.val);
-            else {
-                if (rhs.hasUnknown()) {
-                    for (uint32_t i = 0; i < words; i++)
-                        pVal[i + words] |= rhs.pVal[i + words];
-                }
-
-                for (uint32_t i = 0; i < words; i++)
-                    pVal[i] = ~pVal[i + words] & (pVal[i] ^ rhs.pVal[i]);
-            }
+            bitwiseWords4State<BitOp::Xor>(data, data + words, rhsData,
+                                           rhs.unknownFlag ? rhsData + words : nullptr, words);
         }
         else {
-            for (uint32_t i = 0; i < words; i++)
-                pVal[i] ^= rhs.pVal[i];
+            bitwiseWords<BitOp::Xor>(data, rhsData, words);
         }
     }
     clearUnusedBits();
@@ -1273,22 +1329,14 @@ SVInt SVInt::xnor(const SVInt& rhs) const {
         result.val = ~(result.val ^ rhs.val);
     else {
         uint32_t words = getNumWords(bitWidth, false);
+        uint64_t* data = result.getRawData();
+        const uint64_t* rhsData = rhs.getRawData();
         if (result.hasUnknown()) {
-            if (rhs.isSingleWord())
-                result.pVal[0] = ~result.pVal[1] & ~(result.pVal[0] ^ rhs.val);
-            else {
-                if (rhs.hasUnknown()) {
-                    for (uint32_t i = 0; i < words; i++)
-                        result.pVal[i + words] |= rhs.pVal[i + words];
-                }
-
-                for (uint32_t i = 0; i < words; i++)
-                    result.pVal[i] = ~result.pVal[i + words] & ~(result.pVal[i] ^ rhs.pVal[i]);
-            }
+            bitwiseWords4State<BitOp::Xnor>(data, data + words, rhsData,
+                                            rhs.unknownFlag ? rhsData + words : nullptr, words);
         }
         else {
-            for (uint32_t i = 0; i < words; i++)
-                result.pVal[i] = ~(result.pVal[i] ^ rhs.pVal[i]);
+            bitwiseWords<BitOp::Xnor>(data, rhsData, words);
         }
     }
     result.clearUnusedBits();
@@ -1420,10 +1468,12 @@ logic_t SVInt::operator<(const SVInt& rhs) const {
 
     // same number of words, compare each one until there's no match
     uint32_t top = whichWord(a1 - 1);
+    const uint64_t* lval = getRawData();
+    const uint64_t* rval = rhs.getRawData();
     for (int i = int(top); i >= 0; i--) {
-        if (pVal[i] > rhs.pVal[i])
+        if (lval[i] > rval[i])
             return logic_t(false);
-        if (pVal[i] < rhs.pVal[i])
+        if (lval[i] < rval[i])
             return logic_t(true);
     }
     return logic_t(false);
@@ -1442,11 +1492,12 @@ logic_t SVInt::operator[](int32_t index) const {
     if (index < 0 || bi >= bitWidth)
         return logic_t::x;
 
-    bool bit = (maskBit(bi) & (isSingleWord() ? val : pVal[whichWord(bi)])) != 0;
+    const uint64_t* data = getRawData();
+    bool bit = (maskBit(bi) & data[whichWord(bi)]) != 0;
     if (!unknownFlag)
         return logic_t(bit);
 
-    bool unknownBit = (maskBit(bi) & pVal[whichWord(bi) + getNumWords(bitWidth, false)]) != 0;
+    bool unknownBit = (maskBit(bi) & data[whichWord(bi) + getNumWords(bitWidth, false)]) != 0;
     if (!unknownBit)
         return logic_t(bit);
 
@@ -1486,8 +1537,8 @@ SVInt SVInt::slice(int32_t msb, int32_t lsb) const {
     if (unknownFlag) {
         // copy over preexisting unknown data
         uint32_t words = getNumWords(selectWidth, false);
-        bitcpy(result.getRawData() + words, frontOOB, pVal + getNumWords() / 2, validSelectWidth,
-               frontOOB ? 0 : uint32_t(lsb));
+        bitcpy(result.getRawData() + words, frontOOB, getRawData() + getNumWords() / 2,
+               validSelectWidth, frontOOB ? 0 : uint32_t(lsb));
     }
 
     // If we had any out of bounds accesses, fill them with x's.
@@ -1514,16 +1565,8 @@ void SVInt::set(int32_t msb, int32_t lsb, const SVInt& value) {
     uint32_t backOOB = bitwidth_t(msb) >= bitWidth ? bitwidth_t(msb - int32_t(bitWidth) + 1) : 0;
     uint32_t validSelectWidth = selectWidth - frontOOB - backOOB;
 
-    if (!hasUnknown() && value.hasUnknown()) {
-        uint64_t* newData = new uint64_t[getNumWords(bitWidth, true)]();
-        memcpy(newData, getRawData(), getNumWords());
-
-        if (!isSingleWord())
-            delete[] pVal;
-
-        unknownFlag = true;
-        pVal = newData;
-    }
+    if (!hasUnknown() && value.hasUnknown())
+        makeUnknown();
 
     bitcpy(getRawData(), (uint32_t)std::max(lsb, 0), value.getRawData(), validSelectWidth,
            frontOOB);
@@ -1555,10 +1598,12 @@ SVInt SVInt::sext(bitwidth_t bits) const {
     SVInt result = SVInt::allocUninitialized(bits, signFlag, unknownFlag);
     uint32_t oldWords = SVInt::getNumWords(bitWidth, false);
     uint32_t newWords = SVInt::getNumWords(bits, false);
-    signExtendCopy(result.pVal, getRawData(), bitWidth, oldWords, newWords);
+    uint64_t* dst = result.getRawData();
+    const uint64_t* src = getRawData();
+    signExtendCopy(dst, src, bitWidth, oldWords, newWords);
 
     if (unknownFlag)
-        signExtendCopy(result.pVal + newWords, pVal + oldWords, bitWidth, oldWords, newWords);
+        signExtendCopy(dst + newWords, src + oldWords, bitWidth, oldWords, newWords);
 
     result.clearUnusedBits();
     return result;
@@ -1580,14 +1625,15 @@ bool SVInt::isSignExtendedFrom(bitwidth_t msb) const {
     auto bit = whichBit(msb);
     auto word = whichWord(msb);
     auto numWords = getNumWords(bitWidth, false);
+    const uint64_t* data = getRawData();
 
-    if (!isSignExtended(pVal, numWords, word, bit, maskMsw))
+    if (!isSignExtended(data, numWords, word, bit, maskMsw))
         return false;
 
     if (!unknownFlag)
         return true;
 
-    return isSignExtended(pVal + numWords, numWords, word, bit, maskMsw);
+    return isSignExtended(data + numWords, numWords, word, bit, maskMsw);
 }
 
 void SVInt::signExtendFrom(bitwidth_t msb) {
@@ -1607,9 +1653,10 @@ void SVInt::signExtendFrom(bitwidth_t msb) {
     auto word = whichWord(msb);
     auto numWords = getNumWords(bitWidth, false);
 
-    signExtend(pVal, numWords, word, bit, maskMsw);
+    uint64_t* data = getRawData();
+    signExtend(data, numWords, word, bit, maskMsw);
     if (unknownFlag)
-        signExtend(pVal + numWords, numWords, word, bit, maskMsw);
+        signExtend(data + numWords, numWords, word, bit, maskMsw);
 }
 
 SVInt SVInt::zext(bitwidth_t bits) const {
@@ -1620,14 +1667,16 @@ SVInt SVInt::zext(bitwidth_t bits) const {
 
     SVInt result = allocZeroed(bits, signFlag, unknownFlag);
 
+    uint64_t* dst = result.getRawData();
+    const uint64_t* src = getRawData();
     uint32_t valueWords = SVInt::getNumWords(bitWidth, false);
     for (uint32_t i = 0; i < valueWords; i++)
-        result.pVal[i] = getRawData()[i];
+        dst[i] = src[i];
 
     if (unknownFlag) {
         uint32_t newWords = SVInt::getNumWords(bits, false);
         for (uint32_t i = 0; i < valueWords; i++)
-            result.pVal[i + newWords] = getRawData()[i + valueWords];
+            dst[i + newWords] = src[i + valueWords];
     }
 
     return result;
@@ -1656,7 +1705,7 @@ SVInt SVInt::trunc(bitwidth_t bits) const {
     if (unknownFlag) {
         // copy over preexisting unknown data
         uint32_t words = getNumWords(bits, false);
-        bitcpy(result.getRawData() + words, 0, pVal + getNumWords() / 2, bits, 0);
+        bitcpy(result.getRawData() + words, 0, getRawData() + getNumWords() / 2, bits, 0);
     }
 
     result.clearUnusedBits();
@@ -1721,14 +1770,15 @@ SVInt SVInt::conditional(const SVInt& condition, const SVInt& lhs, const SVInt&
 
     SVInt result = SVInt::allocUninitialized(lhs.bitWidth, bothSigned, true);
     uint32_t words = getNumWords(lhs.bitWidth, false);
+    uint64_t* data = result.getRawData();
+    const uint64_t* lp = lhs.getRawData();
+    const uint64_t* rp = rhs.getRawData();
 
     for (uint32_t i = 0; i < words; i++) {
         // Unknown if either bit is unknown or bits differ.
-        const uint64_t* lp = lhs.getRawData();
-        const uint64_t* rp = rhs.getRawData();
-        result.pVal[i + words] = (lhs.unknownFlag ? lp[i + words] : 0) |
-                                 (rhs.unknownFlag ? rp[i + words] : 0) | (lp[i] ^ rp[i]);
-        result.pVal[i] = ~result.pVal[i + words] & lp[i] & rp[i];
+        data[i + words] = (lhs.unknownFlag ? lp[i + words] : 0) |
+                          (rhs.unknownFlag ? rp[i + words] : 0) | (lp[i] ^ rp[i]);
+        data[i] = ~data[i + words] & lp[i] & rp[i];
     }
 
     result.clearUnusedBits();
@@ -1768,12 +1818,12 @@ SVInt SVInt::concat(std::span<SVInt const> operands) {
     SVInt result = SVInt::allocZeroed(bits, false, isUnknown);
 
     bitwidth_t offset = 0;
+    uint64_t* dst = result.getRawData();
     for (auto it = operands.rbegin(); it != operands.rend(); it++) {
-        bitcpy(result.getRawData(), offset, it->getRawData(), it->bitWidth);
-        if (it->unknownFlag) {
-            bitcpy(result.getRawData() + words / 2, offset, it->pVal + it->getNumWords() / 2,
-                   it->bitWidth);
-        }
+        const uint64_t* src = it->getRawData();
+        bitcpy(dst, offset, src, it->bitWidth);
+        if (it->unknownFlag)
+            bitcpy(dst + words / 2, offset, src + it->getNumWords() / 2, it->bitWidth);
         offset += it->bitWidth;
     }
 
@@ -1782,30 +1832,43 @@ SVInt SVInt::concat(std::span<SVInt const> operands) {
 
 SVInt SVInt::allocUninitialized(bitwidth_t bits, bool signFlag, bool unknownFlag) {
     SLANG_ASSERT(bits && (bits > 64 || unknownFlag));
+    if (getNumWords(bits, unknownFlag) <= INLINE_WORDS)
+        return allocZeroed(bits, signFlag, unknownFlag);
     return SVInt(new uint64_t[getNumWords(bits, unknownFlag)], bits, signFlag, unknownFlag);
 }
 
 SVInt SVInt::allocZeroed(bitwidth_t bits, bool signFlag, bool unknownFlag) {
     SLANG_ASSERT(bits && (bits > 64 || unknownFlag));
+    if (getNumWords(bits, unknownFlag) <= INLINE_WORDS) {
+        // inline words are zero cleared by the constructor
+        SVInt result;
+        result.bitWidth = bits;
+        result.signFlag = signFlag;
+        result.unknownFlag = unknownFlag;
+        return result;
+    }
     return SVInt(new uint64_t[getNumWords(bits, unknownFlag)](), bits, signFlag, unknownFlag);
 }
 
 void SVInt::initSlowCase(logic_t bit) {
-    pVal = new uint64_t[getNumWords()](); // allocation is zero cleared
-    pVal[1] = 1;
+    // a single unknown bit always fits inline, which is zero cleared
+    inlineVal[1] = 1;
     if (exactlyEqual(bit, logic_t::z))
-        pVal[0] = 1;
+        inlineVal[0] = 1;
 }
 
 void SVInt::initSlowCase(uint64_t value) {
     uint32_t words = getNumWords();
-    pVal = new uint64_t[words](); // allocation is zero cleared
-    pVal[0] = value;
+    if (!isInline())
+        pVal = new uint64_t[words](); // allocation is zero cleared
+
+    uint64_t* data = getRawData();
+    data[0] = value;
 
     // sign extend if necessary
     if (signFlag && int64_t(value) < 0) {
         for (uint32_t i = 1; i < words; i++)
-            pVal[i] = (uint64_t)(-1);
+            data[i] = (uint64_t)(-1);
     }
 }
 
@@ -1816,8 +1879,9 @@ void SVInt::initSlowCase(std::span<const byte> bytes) {
     }
     else {
         uint32_t words = getNumWords();
-        pVal = new uint64_t[words](); // allocation is zero cleared
-        memcpy(pVal, bytes.data(), std::min<size_t>(words * WORD_SIZE, bytes.size()));
+        if (!isInline())
+            pVal = new uint64_t[words](); // allocation is zero cleared
+        memcpy(getRawData(), bytes.data(), std::min<size_t>(words * WORD_SIZE, bytes.size()));
     }
     clearUnusedBits();
 }
@@ -1832,12 +1896,13 @@ SVInt& SVInt::assignSlowCase(const SVInt& rhs) {
     if (this == &rhs)
         return *this;
 
-    if (rhs.isSingleWord()) {
-        delete[] pVal;
-        val = rhs.val;
+    if (rhs.isInline()) {
+        if (!isInline())
+            delete[] pVal;
+        copyInline(rhs);
     }
     else {
-        if (isSingleWord()) {
+        if (isInline()) {
             pVal = new uint64_t[rhs.getNumWords()];
         }
         else if (getNumWords() != rhs.getNumWords()) {
@@ -1856,27 +1921,30 @@ logic_t SVInt::equalsSlowCase(const SVInt& rhs) const {
     if (unknownFlag || rhs.unknownFlag) {
         // We can't know whether the numbers are definitely equal, but if there is a 0/1 pair, it is
         // definitely not equal. xor detects 0/1 pairs for each bit and !reductionOr collects all
-        // pairs.
-        return !(*this ^ rhs).reductionOr();
+        // pairs. For equal widths we can look for such a pair directly without building the xor.
+        if (bitWidth != rhs.bitWidth)
+            return !(*this ^ rhs).reductionOr();
+
+        uint32_t words = getNumWords(bitWidth, false);
+        const uint64_t* lval = getRawData();
+        const uint64_t* rval = rhs.getRawData();
+        if (anyKnownDifference(lval, unknownFlag ? lval + words : nullptr, rval,
+                               rhs.unknownFlag ? rval + words : nullptr, words)) {
+            return logic_t(false);
+        }
+        return logic_t::x;
     }
 
     // handle unequal bit widths; spec says that if both values are signed, then do sign
     // extension
-    const uint64_t* lval = pVal;
-    const uint64_t* rval = rhs.pVal;
-
-    if (bitWidth != rhs.bitWidth) {
-        if (signFlag && rhs.signFlag) {
-            if (bitWidth < rhs.bitWidth)
-                return sext(rhs.bitWidth).equalsSlowCase(rhs);
-            else
-                return rhs.sext(bitWidth).equalsSlowCase(*this);
-        }
+    const uint64_t* lval = getRawData();
+    const uint64_t* rval = rhs.getRawData();
 
-        if (isSingleWord())
-            lval = &val;
-        if (rhs.isSingleWord())
-            rval = &rhs.val;
+    if (bitWidth != rhs.bitWidth && signFlag && rhs.signFlag) {
+        if (bitWidth < rhs.bitWidth)
+            return sext(rhs.bitWidth).equalsSlowCase(rhs);
+        else
+            return rhs.sext(bitWidth).equalsSlowCase(*this);
     }
 
     bitwidth_t a1 = getActiveBits();
@@ -1913,17 +1981,18 @@ bitwidth_t SVInt::countLeadingZerosSlowCase() const {
     bitwidth_t bitsInMsw;
     getTopWordMask(bitsInMsw, mask);
 
+    const uint64_t* data = getRawData();
     uint32_t i = getNumWords();
-    uint64_t part = pVal[i - 1] & mask;
+    uint64_t part = data[i - 1] & mask;
     if (part)
         return (bitwidth_t)std::countl_zero(part) - (BITS_PER_WORD - bitsInMsw);
 
     bitwidth_t count = bitsInMsw;
     for (--i; i > 0; --i) {
-        if (pVal[i - 1] == 0)
+        if (data[i - 1] == 0)
             count += BITS_PER_WORD;
         else {
-            count += (bitwidth_t)std::countl_zero(pVal[i - 1]);
+            count += (bitwidth_t)std::countl_zero(data[i - 1]);
             break;
         }
     }
@@ -1938,14 +2007,15 @@ bitwidth_t SVInt::countLeadingOnesSlowCase() const {
     else
         shift = BITS_PER_WORD - bitsInMsw;
 
+    const uint64_t* data = getRawData();
     int i = int(getNumWords() - 1);
-    bitwidth_t count = (bitwidth_t)std::countl_one(pVal[i] << shift);
+    bitwidth_t count = (bitwidth_t)std::countl_one(data[i] << shift);
     if (count == bitsInMsw) {
         for (i--; i >= 0; i--) {
-            if (pVal[i] == UINT64_MAX)
+            if (data[i] == UINT64_MAX)
                 count += BITS_PER_WORD;
             else {
-                count += (bitwidth_t)std::countl_one(pVal[i]);
+                count += (bitwidth_t)std::countl_one(data[i]);
                 break;
             }
         }
@@ -1959,14 +2029,15 @@ bitwidth_t SVInt::countOnes() const {
         return (bitwidth_t)std::popcount(val);
 
     bitwidth_t count = 0;
+    const uint64_t* data = getRawData();
     if (!unknownFlag) {
         for (uint32_t i = 0; i < getNumWords(); i++)
-            count += (bitwidth_t)std::popcount(pVal[i]);
+            count += (bitwidth_t)std::popcount(data[i]);
     }
     else {
         uint32_t words = getNumWords(bitWidth, false);
         for (uint32_t i = 0; i < words; i++)
-            count += (bitwidth_t)std::popcount(pVal[i] & ~pVal[i + words]);
+            count += (bitwidth_t)std::popcount(data[i] & ~data[i + words]);
     }
 
     return count;
@@ -1977,14 +2048,15 @@ bitwidth_t SVInt::countZeros() const {
         return bitWidth - (bitwidth_t)std::popcount(val);
 
     bitwidth_t count = 0;
+    const uint64_t* data = getRawData();
     if (!unknownFlag) {
         for (uint32_t i = 0; i < getNumWords(); i++)
-            count += (bitwidth_t)std::popcount(~pVal[i]);
+            count += (bitwidth_t)std::popcount(~data[i]);
     }
     else {
         uint32_t words = getNumWords(bitWidth, false);
         for (uint32_t i = 0; i < words; i++)
-            count += (bitwidth_t)std::popcount(~pVal[i] & ~pVal[i + words]);
+            count += (bitwidth_t)std::popcount(~data[i] & ~data[i + words]);
     }
 
     uint32_t wordBits = bitWidth % BITS_PER_WORD;
@@ -2000,8 +2072,9 @@ bitwidth_t SVInt::countXs() const {
 
     bitwidth_t count = 0;
     uint32_t words = getNumWords(bitWidth, false);
+    const uint64_t* data = getRawData();
     for (uint32_t i = 0; i < words; i++)
-        count += (bitwidth_t)std::popcount(~pVal[i] & pVal[i + words]);
+        count += (bitwidth_t)std::popcount(~data[i] & data[i + words]);
 
     return count;
 }
@@ -2012,8 +2085,9 @@ bitwidth_t SVInt::countZs() const {
 
     bitwidth_t count = 0;
     uint32_t words = getNumWords(bitWidth, false);
+    const uint64_t* data = getRawData();
     for (uint32_t i = 0; i < words; i++)
-        count += (bitwidth_t)std::popcount(pVal[i] & pVal[i + words]);
+        count += (bitwidth_t)std::popcount(data[i] & data[i + words]);
 
     return count;
 }
@@ -2028,9 +2102,10 @@ void SVInt::clearUnusedBits() {
     if (isSingleWord())
         val &= mask;
     else {
-        pVal[getNumWords() - 1] &= mask;
+        uint64_t* data = getRawData();
+        data[getNumWords() - 1] &= mask;
         if (unknownFlag)
-            pVal[getNumWords(bitWidth, false) - 1] &= mask;
+            data[getNumWords(bitWidth, false) - 1] &= mask;
     }
 }
 
@@ -2040,39 +2115,41 @@ void SVInt::checkUnknown() {
     if (!unknownFlag || countLeadingZeros() < bitWidth)
         return;
 
-    unknownFlag = false;
-    uint32_t words = getNumWords();
-    if (words == 1) {
-        uint64_t newVal = pVal[0];
-        delete[] pVal;
-        val = newVal;
-    }
-    else {
-        uint64_t* newMem = new uint64_t[words];
-        memcpy(newMem, pVal, words * WORD_SIZE);
-        delete[] pVal;
-        pVal = newMem;
-    }
+    reallocate(false);
 }
 
 void SVInt::makeUnknown() {
     if (unknownFlag)
         return;
 
-    uint32_t words = getNumWords();
-    unknownFlag = true;
-    if (words == 1) {
-        auto value = val;
-        pVal = new uint64_t[2];
-        pVal[0] = value;
-        pVal[1] = 0;
-    }
-    else {
-        uint64_t* newMem = new uint64_t[words * 2]();
-        memcpy(newMem, pVal, words * WORD_SIZE);
-        delete[] pVal;
-        pVal = newMem;
+    reallocate(true);
+}
+
+void SVInt::reallocate(bool newUnknownFlag) {
+    const uint32_t valueWords = getNumWords(bitWidth, false);
+    const bool wasInline = isInline();
+    uint64_t* oldData = wasInline ? nullptr : pVal;
+
+    unknownFlag = newUnknownFlag;
+    if (isInline()) {
+        if (wasInline) {
+            for (uint32_t i = valueWords; i < INLINE_WORDS; i++)
+                inlineVal[i] = 0;
+        }
+        else {
+            uint64_t words[INLINE_WORDS] = {};
+            memcpy(words, oldData, valueWords * WORD_SIZE);
+            delete[] oldData;
+            memcpy(inlineVal, words, sizeof(words));
+        }
+        return;
     }
+
+    uint64_t* newMem = new uint64_t[getNumWords()](); // allocation is zero cleared
+    memcpy(newMem, wasInline ? inlineVal : oldData, valueWords * WORD_SIZE);
+    if (!wasInline)
+        delete[] oldData;
+    pVal = newMem;
 }
 
 SVInt SVInt::createFillX(bitwidth_t bitWidth, bool isSigned) {
@@ -2106,9 +2183,9 @@ void SVInt::buildDivideResult(SVInt* result, uint32_t* value, bitwidth_t bitWidt
     }
     else {
         *result = SVInt(bitWidth, 0, signFlag);
+        uint64_t* data = result->getRawData();
         for (uint32_t i = 0; i < numWords; i++)
-            result->pVal[i] = uint64_t(value[i * 2]) |
-                              (uint64_t(value[i * 2 + 1]) << (BITS_PER_WORD / 2));
+            data[i] = uint64_t(value[i * 2]) | (uint64_t(value[i * 2 + 1]) << (BITS_PER_WORD / 2));
     }
 }
 
@@ -2117,6 +2194,28 @@ void SVInt::divide(const SVInt& lhs, uint32_t lhsWords, const SVInt& rhs, uint32
                    SVInt* quotient, SVInt* remainder) {
     SLANG_ASSERT(lhsWords >= rhsWords);
 
+    // Knuth's algorithm is quadratic, so wide values with a wide quotient
+    // use the recursive algorithm instead.
+    uint32_t xlen = lhsWords;
+    uint32_t ylen = rhsWords;
+    while (xlen > 0 && lhs.getRawData()[xlen - 1] == 0)
+        xlen--;
+    while (ylen > 0 && rhs.getRawData()[ylen - 1] == 0)
+        ylen--;
+
+    if (ylen >= BurnikelZieglerThreshold && xlen >= ylen + BurnikelZieglerThreshold) {
+        bool bothSigned = lhs.signFlag && rhs.signFlag;
+        if (quotient)
+            *quotient = SVInt(lhs.bitWidth, 0, bothSigned);
+        if (remainder)
+            *remainder = SVInt(rhs.bitWidth, 0, bothSigned);
+
+        divRecursive(quotient ? quotient->getRawData() : nullptr,
+                     remainder ? remainder->getRawData() : nullptr, lhs.getRawData(), xlen,
+                     rhs.getRawData(), ylen);
+        return;
+    }
+
     // The Knuth algorithm requires arrays of 32-bit words (because results of operations
     // need to fit natively into 64 bits). Allocate space for the backing memory, either on
     // the stack if it's small or on the heap if it's not.
@@ -2215,7 +2314,7 @@ SVInt SVInt::udiv(const SVInt& lhs, const SVInt& rhs, bool bothSigned) {
         return SVInt(lhs.bitWidth, 0, bothSigned);
     // X and Y are actually a single word
     if (lhsWords == 1 && rhsWords == 1)
-        return SVInt(lhs.bitWidth, lhs.pVal[0] / rhs.pVal[0], bothSigned);
+        return SVInt(lhs.bitWidth, lhs.getRawData()[0] / rhs.getRawData()[0], bothSigned);
 
     // compute it the hard way with the Knuth algorithm
     SVInt quotient;
@@ -2245,7 +2344,7 @@ SVInt SVInt::urem(const SVInt& lhs, const SVInt& rhs, bool bothSigned) {
         return lhs;
     // X and Y are actually a single word
     if (lhsWords == 1)
-        return SVInt(lhs.bitWidth, lhs.pVal[0] % rhs.pVal[0], bothSigned);
+        return SVInt(lhs.bitWidth, lhs.getRawData()[0] % rhs.getRawData()[0], bothSigned);
 
     // compute it the hard way with the Knuth algorithm
     SVInt remainder;
@@ -2331,7 +2430,7 @@ bool exactlyEqual(const SVInt& lhs, const SVInt& rhs) {
     }
 
     // ok, equal widths, and they both have unknown values, do a straight memory compare
-    return memcmp(lhs.pVal, rhs.pVal, lhs.getNumWords() * SVInt::WORD_SIZE) == 0;
+    return memcmp(lhs.getRawData(), rhs.getRawData(), lhs.getNumWords() * SVInt::WORD_SIZE) == 0;
 }
 
 logic_t condWildcardEqual(const SVInt& lhs, const SVInt& rhs) {
@@ -2348,14 +2447,16 @@ logic_t condWildcardEqual(const SVInt& lhs, const SVInt& rhs) {
             return condWildcardEqual(lhs, rhs.extend(lhs.bitWidth, bothSigned));
     }
 
+    const uint64_t* lval = lhs.getRawData();
+    const uint64_t* rval = rhs.getRawData();
     uint32_t words = SVInt::getNumWords(rhs.bitWidth, false);
     for (uint32_t i = 0; i < words; ++i) {
         // bitmask to avoid comparing the bits unknown on the rhs
-        uint64_t mask = ~rhs.pVal[i + words];
-        if (lhs.unknownFlag && (lhs.getRawData()[i + words] & mask) != 0)
+        uint64_t mask = ~rval[i + words];
+        if (lhs.unknownFlag && (lval[i + words] & mask) != 0)
             return logic_t::x;
 
-        if ((lhs.getRawData()[i] & mask) != (rhs.pVal[i] & mask))
+        if ((lval[i] & mask) != (rval[i] & mask))
             return logic_t(false);
     }
 
@@ -2376,16 +2477,18 @@ bool caseXWildcardEqual(const SVInt& lhs, const SVInt& rhs) {
             return caseXWildcardEqual(lhs, rhs.extend(lhs.bitWidth, bothSigned));
     }
 
+    const uint64_t* lval = lhs.getRawData();
+    const uint64_t* rval = rhs.getRawData();
     uint32_t words = SVInt::getNumWords(rhs.bitWidth, false);
     for (uint32_t i = 0; i < words; ++i) {
         // bitmask to avoid comparing the unknown bits on either side
         uint64_t mask = UINT64_MAX;
         if (lhs.unknownFlag)
-            mask &= ~lhs.pVal[i + words];
+            mask &= ~lval[i + words];
         if (rhs.unknownFlag)
-            mask &= ~rhs.pVal[i + words];
+            mask &= ~rval[i + words];
 
-        if ((lhs.getRawData()[i] & mask) != (rhs.getRawData()[i] & mask))
+        if ((lval[i] & mask) != (rval[i] & mask))
             return false;
     }
 
@@ -2406,6 +2509,8 @@ bool caseZWildcardEqual(const SVInt& lhs, const SVInt& rhs) {
             return caseZWildcardEqual(lhs, rhs.extend(lhs.bitWidth, bothSigned));
     }
 
+    const uint64_t* lval = lhs.getRawData();
+    const uint64_t* rval = rhs.getRawData();
     uint32_t words = SVInt::getNumWords(rhs.bitWidth, false);
     for (uint32_t i = 0; i < words; ++i) {
         // bitmask to avoid comparing the Z bits on either side
@@ -2413,17 +2518,17 @@ bool caseZWildcardEqual(const SVInt& lhs, const SVInt& rhs) {
 
         uint64_t lunknown = 0;
         if (lhs.unknownFlag) {
-            lunknown = lhs.pVal[i + words] & ~lhs.pVal[i];
-            mask &= ~(lhs.pVal[i + words] & lhs.pVal[i]);
+            lunknown = lval[i + words] & ~lval[i];
+            mask &= ~(lval[i + words] & lval[i]);
         }
 
         uint64_t runknown = 0;
         if (rhs.unknownFlag) {
-            runknown = rhs.pVal[i + words] & ~rhs.pVal[i];
-            mask &= ~(rhs.pVal[i + words] & rhs.pVal[i]);
+            runknown = rval[i + words] & ~rval[i];
+            mask &= ~(rval[i + words] & rval[i]);
         }
 
-        if ((lhs.getRawData()[i] & mask) != (rhs.getRawData()[i] & mask) ||
+        if ((lval[i] & mask) != (rval[i] & mask) ||
             (lunknown & mask) != (runknown & mask)) {
             return false;
         }
@@ -7,6 +7,7 @@
 //------------------------------------------------------------------------------
 #pragma once
 
+#include "SVIntKernels.h"
 #include <bit>
 #include <cstdint>
 #include <cstring>
@@ -101,17 +102,13 @@ private:
     alignas(T) char stackBase[StackCount * sizeof(T)];
 };
 
-static void lshrNear(uint64_t* dst, uint64_t* src, uint32_t words, uint32_t amount) {
+static void lshrNear(uint64_t* dst, const uint64_t* src, uint32_t words, uint32_t amount) {
     // fast case for logical right shift of a small amount (less than 64 bits)
-    uint64_t carry = 0;
-    for (int i = int(words - 1); i >= 0; i--) {
-        uint64_t temp = src[i];
-        dst[i] = (temp >> amount) | carry;
-        carry = temp << (64 - amount);
-    }
+    shiftRightWords(dst, src, words - 1, amount);
+    dst[words - 1] = src[words - 1] >> amount;
 }
 
-static void lshrFar(uint64_t* dst, uint64_t* src, uint32_t wordShift, uint32_t offset,
+static void lshrFar(uint64_t* dst, const uint64_t* src, uint32_t wordShift, uint32_t offset,
                     uint32_t start, uint32_t numWords) {
     // this function is split out so that if we have an unknown value we can reuse the code
     // optimization: move whole words
@@ -122,17 +119,14 @@ static void lshrFar(uint64_t* dst, uint64_t* src, uint32_t wordShift, uint32_t o
     else {
         // shift low order words
         uint32_t breakWord = start + numWords - offset - 1;
-        for (uint32_t i = start; i < breakWord; i++) {
-            dst[i] = (src[i + offset] >> wordShift) |
-                     (src[i + offset + 1] << (SVInt::BITS_PER_WORD - wordShift));
-        }
+        shiftRightWords(dst + start, src + start + offset, breakWord - start, wordShift);
 
         // shift the "break" word
         dst[breakWord] = src[breakWord + offset] >> wordShift;
     }
 }
 
-static void shlFar(uint64_t* dst, uint64_t* src, uint32_t wordShift, uint32_t offset,
+static void shlFar(uint64_t* dst, const uint64_t* src, uint32_t wordShift, uint32_t offset,
                    uint32_t start, uint32_t numWords) {
     // optimization: move whole words
     if (wordShift == 0) {
@@ -140,10 +134,8 @@ static void shlFar(uint64_t* dst, uint64_t* src, uint32_t wordShift, uint32_t of
             dst[i] = src[i - offset];
     }
     else {
-        for (uint32_t i = start + numWords - 1; i > start + offset; i--) {
-            dst[i] = src[i - offset] << wordShift |
-                     src[i - offset - 1] >> (SVInt::BITS_PER_WORD - wordShift);
-        }
+        shiftLeftWords(dst + start + offset + 1, src + start + 1, numWords - offset - 1,
+                       wordShift);
         dst[start + offset] = src[start] << wordShift;
     }
 
@@ -290,17 +282,26 @@ static uint64_t mulOne(uint64_t* dst, const uint64_t* x, uint32_t len, uint64_t
     return carry;
 }
 
-static void mulKaratsuba(uint64_t* dst, const uint64_t* x, uint32_t xlen, const uint64_t* y,
-                         uint32_t ylen);
-
-// Generalized multiplier
-SLANG_NO_SANITIZE("unsigned-integer-overflow")
-static void mul(uint64_t* dst, const uint64_t* x, uint32_t xlen, const uint64_t* y, uint32_t ylen) {
-    if (xlen > 7 && ylen > 7) {
-        mulKaratsuba(dst, x, xlen, y, ylen);
-        return;
+// Divide an integer array in place by a single uint32, returning the remainder
+static uint32_t divOne(uint64_t* x, uint32_t len, uint32_t y) {
+    uint64_t rem = 0;
+    for (uint32_t i = len; i > 0; i--) {
+        uint64_t hi = (rem << 32) | (x[i - 1] >> 32);
+        uint64_t lo = ((hi % y) << 32) | uint32_t(x[i - 1]);
+        x[i - 1] = ((hi / y) << 32) | (lo / y);
+        rem = lo % y;
     }
+    return uint32_t(rem);
+}
+
+// Multiplies operands that are both at least this many words long with the
+// Karatsuba algorithm instead of the schoolbook method.
+static constexpr uint32_t KaratsubaThreshold = 32;
 
+// Schoolbook multiplier
+SLANG_NO_SANITIZE("unsigned-integer-overflow")
+static void mulSchoolbook(uint64_t* dst, const uint64_t* x, uint32_t xlen, const uint64_t* y,
+                          uint32_t ylen) {
     dst[xlen] = mulOne(dst, x, xlen, y[0]);
     for (uint32_t i = 1; i < ylen; i++) {
         uint64_t carry = 0;
@@ -315,74 +316,125 @@ static void mul(uint64_t* dst, const uint64_t* x, uint32_t xlen, const uint64_t*
     }
 }
 
-static void unevenAdd(uint64_t* dst, const uint64_t* x, uint32_t xlen, const uint64_t* y,
-                      uint32_t ylen) {
-    if (xlen < ylen) {
-        std::swap(xlen, ylen);
-        std::swap(x, y);
-    }
-
-    uint32_t i;
+// Adds y into x in place, propagating the carry through the remaining words of x.
+SLANG_NO_SANITIZE("unsigned-integer-overflow")
+static bool addInPlace(uint64_t* x, uint32_t xlen, const uint64_t* y, uint32_t ylen) {
+    SLANG_ASSERT(xlen >= ylen);
     uint8_t carry = 0;
-    for (i = 0; i < ylen; ++i) {
+    uint32_t i = 0;
+    for (; i < ylen; i++) {
         calc_out_t result;
         carry = addcarry64(carry, x[i], y[i], &result);
-        dst[i] = result;
+        x[i] = result;
     }
-    for (; i < xlen; ++i) {
+    for (; carry && i < xlen; i++) {
         calc_out_t result;
         carry = addcarry64(carry, x[i], 0, &result);
-        dst[i] = result;
+        x[i] = result;
     }
-    dst[i] = carry;
+    return carry;
 }
 
-static void mulKaratsuba(uint64_t* dst, const uint64_t* x, uint32_t xlen, const uint64_t* y,
-                         uint32_t ylen) {
-    if (xlen > ylen) {
-        std::swap(x, y);
-        std::swap(xlen, ylen);
+// Subtracts y from x in place, propagating the borrow through the remaining words of x.
+SLANG_NO_SANITIZE("unsigned-integer-overflow")
+static bool subInPlace(uint64_t* x, uint32_t xlen, const uint64_t* y, uint32_t ylen) {
+    SLANG_ASSERT(xlen >= ylen);
+    uint8_t borrow = 0;
+    uint32_t i = 0;
+    for (; i < ylen; i++) {
+        calc_out_t result;
+        borrow = subborrow64(borrow, x[i], y[i], &result);
+        x[i] = result;
     }
+    for (; borrow && i < xlen; i++) {
+        calc_out_t result;
+        borrow = subborrow64(borrow, x[i], 0, &result);
+        x[i] = result;
+    }
+    return borrow;
+}
 
-    uint32_t shift = ylen >> 1;
-
-    uint32_t xlSize = std::min(xlen, shift);
-    uint32_t xhSize = xlen - xlSize;
-    const uint64_t* xl = x;
-    const uint64_t* xh = x + xlSize;
-
-    uint32_t ylSize = std::min(ylen, shift);
-    uint32_t yhSize = ylen - ylSize;
-    const uint64_t* yl = y;
-    const uint64_t* yh = y + ylSize;
+// The number of scratch words needed by mulKaratsuba for operands of n words.
+static uint32_t karatsubaScratchSize(uint32_t n) {
+    uint32_t size = 0;
+    while (n >= KaratsubaThreshold) {
+        n = n - n / 2 + 1;
+        size += 4 * n;
+    }
+    return size;
+}
 
-    TempBuffer<uint64_t, 128> t1(xlen + ylen);
-    t1.fill(0);
-    mul(t1.get(), xh, xhSize, yh, yhSize);
-    memset(dst, 0, (xlen + ylen) * sizeof(uint64_t));
-    memcpy(dst + 2 * shift, t1.get(), (xhSize + yhSize) * sizeof(uint64_t));
+// Multiplies two operands of n words each into the 2n words at dst, using
+// the scratch space to hold the middle term of each level of recursion.
+SLANG_NO_SANITIZE("unsigned-integer-overflow")
+static void mulKaratsuba(uint64_t* dst, const uint64_t* x, const uint64_t* y, uint32_t n,
+                         uint64_t* scratch) {
+    if (n < KaratsubaThreshold) {
+        mulSchoolbook(dst, x, n, y, n);
+        return;
+    }
 
-    TempBuffer<uint64_t, 128> t2(xlen + ylen);
-    t2.fill(0);
-    mul(t2.get(), xl, xlSize, yl, ylSize);
-    memcpy(dst, t2.get(), (xlSize + ylSize) * sizeof(uint64_t));
+    // Split the operands into low halves of lo words and high halves of hi words:
+    //   x * y = z2 * B^(2*lo) + z1 * B^lo + z0
+    // where z0 = x0 * y0, z2 = x1 * y1, and z1 = (x0 + x1) * (y0 + y1) - z0 - z2.
+    const uint32_t lo = n / 2;
+    const uint32_t hi = n - lo;
+    uint64_t* sx = scratch;
+    uint64_t* sy = sx + hi + 1;
+    uint64_t* z1 = sy + hi + 1;
+    uint64_t* next = z1 + 2 * (hi + 1);
+
+    mulKaratsuba(dst, x, y, lo, next);
+    mulKaratsuba(dst + 2 * lo, x + lo, y + lo, hi, next);
+
+    memcpy(sx, x + lo, hi * sizeof(uint64_t));
+    sx[hi] = addInPlace(sx, hi, x, lo);
+    memcpy(sy, y + lo, hi * sizeof(uint64_t));
+    sy[hi] = addInPlace(sy, hi, y, lo);
+    mulKaratsuba(z1, sx, sy, hi + 1, next);
+
+    subInPlace(z1, 2 * (hi + 1), dst, 2 * lo);
+    subInPlace(z1, 2 * (hi + 1), dst + 2 * lo, 2 * hi);
+    addInPlace(dst + lo, 2 * n - lo, z1, std::min(2 * (hi + 1), 2 * n - lo));
+}
 
-    uint32_t remaining = xlen + ylen - shift;
-    subGeneral(dst + shift, dst + shift, t2.get(), remaining);
-    subGeneral(dst + shift, dst + shift, t1.get(), remaining);
+// Generalized multiplier
+SLANG_NO_SANITIZE("unsigned-integer-overflow")
+static void mul(uint64_t* dst, const uint64_t* x, uint32_t xlen, const uint64_t* y, uint32_t ylen) {
+    if (xlen < ylen) {
+        std::swap(x, y);
+        std::swap(xlen, ylen);
+    }
 
-    t1.fill(0);
-    unevenAdd(t1.get(), xh, xhSize, xl, xlSize);
-    t2.fill(0);
-    unevenAdd(t2.get(), yh, yhSize, yl, ylSize);
+    if (ylen < KaratsubaThreshold) {
+        mulSchoolbook(dst, x, xlen, y, ylen);
+        return;
+    }
 
-    SLANG_ASSERT(std::max(xlSize, xhSize) + 1 + std::max(ylSize, yhSize) + 1 < xlen + ylen);
+    TempBuffer<uint64_t, 128> scratch(karatsubaScratchSize(ylen) + 2 * ylen);
+    if (xlen == ylen) {
+        mulKaratsuba(dst, x, y, ylen, scratch.get());
+        return;
+    }
 
-    TempBuffer<uint64_t, 128> t3(xlen + ylen);
-    t3.fill(0);
-    mul(t3.get(), t1.get(), std::max(xlSize, xhSize) + 1, t2.get(), std::max(ylSize, yhSize) + 1);
+    // For unbalanced operands, multiply the shorter one by each chunk of
+    // the longer one that is the same length and accumulate the results.
+    uint64_t* partial = scratch.get();
+    uint64_t* next = partial + 2 * ylen;
+    const uint32_t dstLen = xlen + ylen;
+    memset(dst, 0, dstLen * sizeof(uint64_t));
+
+    uint32_t offset = 0;
+    for (; offset + ylen <= xlen; offset += ylen) {
+        mulKaratsuba(partial, x + offset, y, ylen, next);
+        addInPlace(dst + offset, dstLen - offset, partial, 2 * ylen);
+    }
 
-    addGeneral(dst + shift, dst + shift, t3.get(), remaining);
+    if (offset < xlen) {
+        const uint32_t rest = xlen - offset;
+        mul(partial, y, ylen, x + offset, rest);
+        addInPlace(dst + offset, dstLen - offset, partial, ylen + rest);
+    }
 }
 
 // Implementation of Knuth's Algorithm D (Division of nonnegative integers)
@@ -508,6 +560,183 @@ static void knuthDiv(uint32_t* u, uint32_t* v, uint32_t* q, uint32_t* r, uint32_
     }
 }
 
+// Divides using the Burnikel-Ziegler recursive algorithm when both the divisor
+// and the quotient are at least this many words long.
+static constexpr uint32_t BurnikelZieglerThreshold = 24;
+
+// Divides the 2n-word value a by the normalized n-word value b, where the base case
+// falls back to Knuth's algorithm on 32-bit digits. Requires a < b * B^n.
+SLANG_NO_SANITIZE("unsigned-integer-overflow")
+static void div2n1nBase(uint64_t* q, uint64_t* r, const uint64_t* a, const uint64_t* b,
+                        uint32_t n) {
+    TempBuffer<uint32_t, 1024> scratch(10 * n + 2);
+    uint32_t* u = scratch.get();
+    uint32_t* v = u + 4 * n + 1;
+    uint32_t* qd = v + 2 * n;
+    uint32_t* rd = qd + 2 * n + 1;
+
+    for (uint32_t i = 0; i < 2 * n; i++) {
+        u[i * 2] = uint32_t(a[i]);
+        u[i * 2 + 1] = uint32_t(a[i] >> 32);
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        v[i * 2] = uint32_t(b[i]);
+        v[i * 2 + 1] = uint32_t(b[i] >> 32);
+    }
+
+    knuthDiv(u, v, qd, rd, 2 * n, 2 * n);
+
+    for (uint32_t i = 0; i < n; i++) {
+        q[i] = uint64_t(qd[i * 2]) | (uint64_t(qd[i * 2 + 1]) << 32);
+        r[i] = uint64_t(rd[i * 2]) | (uint64_t(rd[i * 2 + 1]) << 32);
+    }
+}
+
+// The number of scratch words needed by div2n1n for a divisor of n words.
+static uint32_t div2n1nScratchSize(uint32_t n) {
+    uint32_t size = 0;
+    while (n > BurnikelZieglerThreshold && n % 2 == 0) {
+        n /= 2;
+        size += 7 * n + 1;
+    }
+    return size;
+}
+
+static void div3n2n(uint64_t* q, uint64_t* r, const uint64_t* a, const uint64_t* b, uint32_t h,
+                    uint64_t* scratch);
+
+// Divides the 2n-word value a by the normalized n-word value b, producing an n-word
+// quotient and an n-word remainder. Requires a < b * B^n.
+static void div2n1n(uint64_t* q, uint64_t* r, const uint64_t* a, const uint64_t* b, uint32_t n,
+                    uint64_t* scratch) {
+    if (n <= BurnikelZieglerThreshold || n % 2 != 0) {
+        div2n1nBase(q, r, a, b, n);
+        return;
+    }
+
+    // Treat a as four half-size digits [A1 A2 A3 A4] and divide in two steps,
+    // first [A1 A2 A3] / b and then [R A4] / b where R is the first remainder.
+    const uint32_t h = n / 2;
+    uint64_t* t = scratch;
+    memcpy(t, a, h * sizeof(uint64_t));
+    div3n2n(q + h, t + h, a + h, b, h, t + 3 * h);
+    div3n2n(q, r, t, b, h, t + 3 * h);
+}
+
+// Divides the 3h-word value a by the normalized 2h-word value b, producing an h-word
+// quotient and a 2h-word remainder. Requires a < b * B^h.
+SLANG_NO_SANITIZE("unsigned-integer-overflow")
+static void div3n2n(uint64_t* q, uint64_t* r, const uint64_t* a, const uint64_t* b, uint32_t h,
+                    uint64_t* scratch) {
+    // With a = [A1 A2 A3] and b = [B1 B2], estimate the quotient from the top
+    // digits as [A1 A2] / B1, which is never too small and at most two too large.
+    uint64_t* rem = scratch;
+    uint64_t* d = rem + 2 * h + 1;
+    uint64_t* next = d + 2 * h;
+
+    const uint64_t* a1 = a + 2 * h;
+    const uint64_t* b1 = b + h;
+    memcpy(rem, a, h * sizeof(uint64_t));
+    rem[2 * h] = 0;
+
+    bool a1Less = false;
+    for (uint32_t i = h; i > 0; i--) {
+        if (a1[i - 1] != b1[i - 1]) {
+            a1Less = a1[i - 1] < b1[i - 1];
+            break;
+        }
+    }
+
+    if (a1Less) {
+        div2n1n(q, rem + h, a + h, b1, h, next);
+    }
+    else {
+        // A1 == B1, so the estimate is B^h - 1 with a remainder of A2 + B1.
+        memset(q, 0xff, h * sizeof(uint64_t));
+        memcpy(rem + h, a + h, h * sizeof(uint64_t));
+        rem[2 * h] = addInPlace(rem + h, h, b1, h);
+    }
+
+    // Subtract the estimate times B2 from [R1 A3] and add b back
+    // until the remainder is no longer negative.
+    mul(d, q, h, b, h);
+    bool negative = subInPlace(rem, 2 * h + 1, d, 2 * h);
+    while (negative) {
+        negative = !addInPlace(rem, 2 * h + 1, b, 2 * h);
+        subOne(q, q, h, 1);
+    }
+
+    memcpy(r, rem, 2 * h * sizeof(uint64_t));
+}
+
+// Divides the xlen-word value x by the ylen-word value y using the Burnikel-Ziegler
+// algorithm. The top words of both values must be nonzero. Writes xlen words of quotient
+// to q and ylen words of remainder to r, if they are not null.
+SLANG_NO_SANITIZE("unsigned-integer-overflow")
+static void divRecursive(uint64_t* q, uint64_t* r, const uint64_t* x, uint32_t xlen,
+                         const uint64_t* y, uint32_t ylen) {
+    SLANG_ASSERT(xlen >= ylen && x[xlen - 1] && y[ylen - 1]);
+
+    // Pad the divisor to n = j * 2^k words, where j is no larger than the threshold,
+    // so that it splits in half evenly all the way down to the base case.
+    uint32_t m = 1;
+    while (m * BurnikelZieglerThreshold < ylen)
+        m *= 2;
+    const uint32_t n = (ylen + m - 1) / m * m;
+
+    // Normalize both values by shifting the divisor up until its top bit is set.
+    // The dividend gets an extra word so that its top block is smaller than the divisor.
+    const uint32_t wordShift = n - ylen;
+    const uint32_t bitShift = (uint32_t)std::countl_zero(y[ylen - 1]);
+    const uint32_t alen = xlen + wordShift + 1;
+    const uint32_t t = std::max(2u, (alen + n - 1) / n);
+
+    TempBuffer<uint64_t, 128> buffer(t * n + n + 2 * n + (t - 1) * n + div2n1nScratchSize(n));
+    uint64_t* a = buffer.get();
+    uint64_t* b = a + t * n;
+    uint64_t* z = b + n;
+    uint64_t* quot = z + 2 * n;
+    uint64_t* scratch = quot + (t - 1) * n;
+
+    auto shiftInto = [&](uint64_t* dst, uint32_t dstLen, const uint64_t* src, uint32_t srcLen) {
+        memset(dst, 0, dstLen * sizeof(uint64_t));
+        uint64_t carry = 0;
+        for (uint32_t i = 0; i < srcLen; i++) {
+            dst[i + wordShift] = (src[i] << bitShift) | carry;
+            carry = bitShift ? src[i] >> (SVInt::BITS_PER_WORD - bitShift) : 0;
+        }
+        if (srcLen + wordShift < dstLen)
+            dst[srcLen + wordShift] = carry;
+    };
+    shiftInto(a, t * n, x, xlen);
+    shiftInto(b, n, y, ylen);
+
+    // Divide one n-word block at a time, carrying the remainder into the next step.
+    memcpy(z, a + (t - 2) * n, 2 * n * sizeof(uint64_t));
+    for (uint32_t i = t - 1; i > 0; i--) {
+        div2n1n(quot + (i - 1) * n, z + n, z, b, n, scratch);
+        if (i > 1)
+            memcpy(z, a + (i - 2) * n, n * sizeof(uint64_t));
+    }
+
+    if (q) {
+        memset(q, 0, xlen * sizeof(uint64_t));
+        memcpy(q, quot, std::min(xlen, (t - 1) * n) * sizeof(uint64_t));
+    }
+
+    if (r) {
+        // The remainder is in the top half of z; undo the normalization shift.
+        const uint64_t* rem = z + n;
+        for (uint32_t i = 0; i < ylen; i++) {
+            uint64_t lo = rem[i + wordShift] >> bitShift;
+            uint64_t hi = 0;
+            if (bitShift && i + wordShift + 1 < n)
+                hi = rem[i + wordShift + 1] << (SVInt::BITS_PER_WORD - bitShift);
+            r[i] = lo | hi;
+        }
+    }
+}
+
 // Does a word-by-word copy, but using bit offsets and lengths.
 static void bitcpy(uint64_t* dest, uint32_t destOffset, const uint64_t* src, uint32_t length,
                    uint32_t srcOffset = 0) {
@@ -0,0 +1,531 @@
+//------------------------------------------------------------------------------
+// SVIntKernels.h
+// Vectorized word array routines for SVInt bitwise operations
+//
+// SPDX-FileCopyrightText: Michael Popoloski
+// SPDX-License-Identifier: MIT
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+#include "slang/util/CpuFeatures.h"
+
+#if defined(SLANG_SIMD_X86)
+#    include <immintrin.h>
+#endif
+
+namespace slang {
+
+// All of the routines in this file operate on arrays of 64-bit words. The value
+// and unknown words of 4-state operands are passed as separate pointers; a null
+// unknown pointer means the operand has no unknown bits. Bits in the result that
+// are unknown always end up as X, with the corresponding value bit cleared.
+
+/// Bitwise operators that have vectorized implementations.
+enum class BitOp { And, Or, Xor, Xnor };
+
+template<BitOp Op>
+static inline uint64_t bitOp(uint64_t a, uint64_t b) {
+    if constexpr (Op == BitOp::And)
+        return a & b;
+    else if constexpr (Op == BitOp::Or)
+        return a | b;
+    else if constexpr (Op == BitOp::Xor)
+        return a ^ b;
+    else
+        return ~(a ^ b);
+}
+
+template<BitOp Op>
+static inline void bitOp4State(uint64_t& lv, uint64_t& lu, uint64_t rv, uint64_t ru) {
+    if constexpr (Op == BitOp::And)
+        lu = (lu | ru) & (lu | lv) & (ru | rv);
+    else if constexpr (Op == BitOp::Or)
+        lu = (lu & (ru | ~rv)) | (~lv & ru);
+    else
+        lu |= ru;
+    lv = ~lu & bitOp<Op>(lv, rv);
+}
+
+#if defined(SLANG_SIMD_X86)
+
+// Each vector routine below processes as many whole vectors of words as it can
+// and returns the index of the first word it did not handle. Routines that search
+// for a word stop at the start of the first vector containing a match. Either way
+// the caller finishes up with scalar code from the returned index.
+
+static inline __m128i loadSSE2(const uint64_t* ptr) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+}
+
+static inline void storeSSE2(uint64_t* ptr, __m128i v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), v);
+}
+
+static inline bool isZeroSSE2(__m128i v) {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) == 0xffff;
+}
+
+template<BitOp Op>
+static inline __m128i bitOpSSE2(__m128i a, __m128i b) {
+    if constexpr (Op == BitOp::And)
+        return _mm_and_si128(a, b);
+    else if constexpr (Op == BitOp::Or)
+        return _mm_or_si128(a, b);
+    else if constexpr (Op == BitOp::Xor)
+        return _mm_xor_si128(a, b);
+    else
+        return _mm_xor_si128(_mm_xor_si128(a, b), _mm_set1_epi32(-1));
+}
+
+template<BitOp Op>
+static inline void bitOp4StateSSE2(__m128i& lv, __m128i& lu, __m128i rv, __m128i ru) {
+    if constexpr (Op == BitOp::And) {
+        lu = _mm_and_si128(_mm_and_si128(_mm_or_si128(lu, ru), _mm_or_si128(lu, lv)),
+                           _mm_or_si128(ru, rv));
+    }
+    else if constexpr (Op == BitOp::Or) {
+        lu = _mm_or_si128(_mm_andnot_si128(_mm_andnot_si128(ru, rv), lu),
+                          _mm_andnot_si128(lv, ru));
+    }
+    else {
+        lu = _mm_or_si128(lu, ru);
+    }
+    lv = _mm_andnot_si128(lu, bitOpSSE2<Op>(lv, rv));
+}
+
+template<BitOp Op>
+static uint32_t bitwiseSSE2(uint64_t* dst, const uint64_t* src, uint32_t words) {
+    uint32_t i = 0;
+    for (; i + 2 <= words; i += 2)
+        storeSSE2(dst + i, bitOpSSE2<Op>(loadSSE2(dst + i), loadSSE2(src + i)));
+    return i;
+}
+
+template<BitOp Op, bool RhsUnknown>
+static uint32_t bitwise4StateSSE2(uint64_t* lv, uint64_t* lu, const uint64_t* rv,
+                                  const uint64_t* ru, uint32_t words) {
+    uint32_t i = 0;
+    for (; i + 2 <= words; i += 2) {
+        __m128i v = loadSSE2(lv + i);
+        __m128i u = loadSSE2(lu + i);
+        bitOp4StateSSE2<Op>(v, u, loadSSE2(rv + i),
+                            RhsUnknown ? loadSSE2(ru + i) : _mm_setzero_si128());
+        storeSSE2(lv + i, v);
+        storeSSE2(lu + i, u);
+    }
+    return i;
+}
+
+template<bool Unknown>
+static uint32_t bitwiseNotSSE2(uint64_t* v, const uint64_t* u, uint32_t words) {
+    uint32_t i = 0;
+    for (; i + 2 <= words; i += 2) {
+        __m128i val = loadSSE2(v + i);
+        if constexpr (Unknown)
+            val = _mm_or_si128(val, loadSSE2(u + i));
+        storeSSE2(v + i, _mm_xor_si128(val, _mm_set1_epi32(-1)));
+    }
+    return i;
+}
+
+template<bool Unknown>
+static uint32_t findNotAllSetSSE2(const uint64_t* v, const uint64_t* u, uint32_t words) {
+    uint32_t i = 0;
+    for (; i + 2 <= words; i += 2) {
+        __m128i val = loadSSE2(v + i);
+        if constexpr (Unknown)
+            val = _mm_or_si128(val, loadSSE2(u + i));
+        if (!isZeroSSE2(_mm_xor_si128(val, _mm_set1_epi32(-1))))
+            break;
+    }
+    return i;
+}
+
+template<bool Unknown>
+static uint32_t findKnownOneSSE2(const uint64_t* v, const uint64_t* u, uint32_t words) {
+    uint32_t i = 0;
+    for (; i + 2 <= words; i += 2) {
+        __m128i val = loadSSE2(v + i);
+        if constexpr (Unknown)
+            val = _mm_andnot_si128(loadSSE2(u + i), val);
+        if (!isZeroSSE2(val))
+            break;
+    }
+    return i;
+}
+
+template<bool LhsUnknown, bool RhsUnknown>
+static uint32_t findKnownDifferenceSSE2(const uint64_t* lv, const uint64_t* lu,
+                                        const uint64_t* rv, const uint64_t* ru,
+                                        uint32_t words) {
+    uint32_t i = 0;
+    for (; i + 2 <= words; i += 2) {
+        __m128i diff = _mm_xor_si128(loadSSE2(lv + i), loadSSE2(rv + i));
+        if constexpr (LhsUnknown)
+            diff = _mm_andnot_si128(loadSSE2(lu + i), diff);
+        if constexpr (RhsUnknown)
+            diff = _mm_andnot_si128(loadSSE2(ru + i), diff);
+        if (!isZeroSSE2(diff))
+            break;
+    }
+    return i;
+}
+
+static uint32_t xorFoldSSE2(const uint64_t* v, uint32_t words, uint64_t& result) {
+    __m128i acc = _mm_setzero_si128();
+    uint32_t i = 0;
+    for (; i + 2 <= words; i += 2)
+        acc = _mm_xor_si128(acc, loadSSE2(v + i));
+
+    acc = _mm_xor_si128(acc, _mm_unpackhi_epi64(acc, acc));
+    result ^= uint64_t(_mm_cvtsi128_si64(acc));
+    return i;
+}
+
+static uint32_t shiftRightSSE2(uint64_t* dst, const uint64_t* src, uint32_t words,
+                               uint32_t amount) {
+    __m128i right = _mm_cvtsi32_si128(int(amount));
+    __m128i left = _mm_cvtsi32_si128(int(64 - amount));
+    uint32_t i = 0;
+    for (; i + 2 <= words; i += 2) {
+        storeSSE2(dst + i, _mm_or_si128(_mm_srl_epi64(loadSSE2(src + i), right),
+                                        _mm_sll_epi64(loadSSE2(src + i + 1), left)));
+    }
+    return i;
+}
+
+static uint32_t shiftLeftSSE2(uint64_t* dst, const uint64_t* src, uint32_t words,
+                              uint32_t amount) {
+    __m128i left = _mm_cvtsi32_si128(int(amount));
+    __m128i right = _mm_cvtsi32_si128(int(64 - amount));
+    const uint64_t* prev = src - 1;
+    uint32_t i = 0;
+    for (; i + 2 <= words; i += 2) {
+        storeSSE2(dst + i, _mm_or_si128(_mm_sll_epi64(loadSSE2(src + i), left),
+                                        _mm_srl_epi64(loadSSE2(prev + i), right)));
+    }
+    return i;
+}
+
+SLANG_TARGET_AVX2 static inline __m256i loadAVX2(const uint64_t* ptr) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+}
+
+SLANG_TARGET_AVX2 static inline void storeAVX2(uint64_t* ptr, __m256i v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), v);
+}
+
+SLANG_TARGET_AVX2 static inline bool isZeroAVX2(__m256i v) {
+    return _mm256_testz_si256(v, v) != 0;
+}
+
+template<BitOp Op>
+SLANG_TARGET_AVX2 static inline __m256i bitOpAVX2(__m256i a, __m256i b) {
+    if constexpr (Op == BitOp::And)
+        return _mm256_and_si256(a, b);
+    else if constexpr (Op == BitOp::Or)
+        return _mm256_or_si256(a, b);
+    else if constexpr (Op == BitOp::Xor)
+        return _mm256_xor_si256(a, b);
+    else
+        return _mm256_xor_si256(_mm256_xor_si256(a, b), _mm256_set1_epi32(-1));
+}
+
+template<BitOp Op>
+SLANG_TARGET_AVX2 static inline void bitOp4StateAVX2(__m256i& lv, __m256i& lu, __m256i rv,
+                                                     __m256i ru) {
+    if constexpr (Op == BitOp::And) {
+        lu = _mm256_and_si256(_mm256_and_si256(_mm256_or_si256(lu, ru), _mm256_or_si256(lu, lv)),
+                              _mm256_or_si256(ru, rv));
+    }
+    else if constexpr (Op == BitOp::Or) {
+        lu = _mm256_or_si256(_mm256_andnot_si256(_mm256_andnot_si256(ru, rv), lu),
+                             _mm256_andnot_si256(lv, ru));
+    }
+    else {
+        lu = _mm256_or_si256(lu, ru);
+    }
+    lv = _mm256_andnot_si256(lu, bitOpAVX2<Op>(lv, rv));
+}
+
+template<BitOp Op>
+SLANG_TARGET_AVX2 static uint32_t bitwiseAVX2(uint64_t* dst, const uint64_t* src,
+                                              uint32_t words) {
+    uint32_t i = 0;
+    for (; i + 4 <= words; i += 4)
+        storeAVX2(dst + i, bitOpAVX2<Op>(loadAVX2(dst + i), loadAVX2(src + i)));
+    return i;
+}
+
+template<BitOp Op, bool RhsUnknown>
+SLANG_TARGET_AVX2 static uint32_t bitwise4StateAVX2(uint64_t* lv, uint64_t* lu,
+                                                    const uint64_t* rv, const uint64_t* ru,
+                                                    uint32_t words) {
+    uint32_t i = 0;
+    for (; i + 4 <= words; i += 4) {
+        __m256i v = loadAVX2(lv + i);
+        __m256i u = loadAVX2(lu + i);
+        bitOp4StateAVX2<Op>(v, u, loadAVX2(rv + i),
+                            RhsUnknown ? loadAVX2(ru + i) : _mm256_setzero_si256());
+        storeAVX2(lv + i, v);
+        storeAVX2(lu + i, u);
+    }
+    return i;
+}
+
+template<bool Unknown>
+SLANG_TARGET_AVX2 static uint32_t bitwiseNotAVX2(uint64_t* v, const uint64_t* u,
+                                                 uint32_t words) {
+    uint32_t i = 0;
+    for (; i + 4 <= words; i += 4) {
+        __m256i val = loadAVX2(v + i);
+        if constexpr (Unknown)
+            val = _mm256_or_si256(val, loadAVX2(u + i));
+        storeAVX2(v + i, _mm256_xor_si256(val, _mm256_set1_epi32(-1)));
+    }
+    return i;
+}
+
+template<bool Unknown>
+SLANG_TARGET_AVX2 static uint32_t findNotAllSetAVX2(const uint64_t* v, const uint64_t* u,
+                                                    uint32_t words) {
+    uint32_t i = 0;
+    for (; i + 4 <= words; i += 4) {
+        __m256i val = loadAVX2(v + i);
+        if constexpr (Unknown)
+            val = _mm256_or_si256(val, loadAVX2(u + i));
+        if (!_mm256_testc_si256(val, _mm256_set1_epi32(-1)))
+            break;
+    }
+    return i;
+}
+
+template<bool Unknown>
+SLANG_TARGET_AVX2 static uint32_t findKnownOneAVX2(const uint64_t* v, const uint64_t* u,
+                                                   uint32_t words) {
+    uint32_t i = 0;
+    for (; i + 4 <= words; i += 4) {
+        __m256i val = loadAVX2(v + i);
+        if constexpr (Unknown)
+            val = _mm256_andnot_si256(loadAVX2(u + i), val);
+        if (!isZeroAVX2(val))
+            break;
+    }
+    return i;
+}
+
+template<bool LhsUnknown, bool RhsUnknown>
+SLANG_TARGET_AVX2 static uint32_t findKnownDifferenceAVX2(const uint64_t* lv, const uint64_t* lu,
+                                                          const uint64_t* rv, const uint64_t* ru,
+                                                          uint32_t words) {
+    uint32_t i = 0;
+    for (; i + 4 <= words; i += 4) {
+        __m256i diff = _mm256_xor_si256(loadAVX2(lv + i), loadAVX2(rv + i));
+        if constexpr (LhsUnknown)
+            diff = _mm256_andnot_si256(loadAVX2(lu + i), diff);
+        if constexpr (RhsUnknown)
+            diff = _mm256_andnot_si256(loadAVX2(ru + i), diff);
+        if (!isZeroAVX2(diff))
+            break;
+    }
+    return i;
+}
+
+SLANG_TARGET_AVX2 static uint32_t xorFoldAVX2(const uint64_t* v, uint32_t words,
+                                              uint64_t& result) {
+    __m256i acc = _mm256_setzero_si256();
+    uint32_t i = 0;
+    for (; i + 4 <= words; i += 4)
+        acc = _mm256_xor_si256(acc, loadAVX2(v + i));
+
+    __m128i half = _mm_xor_si128(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    half = _mm_xor_si128(half, _mm_unpackhi_epi64(half, half));
+    result ^= uint64_t(_mm_cvtsi128_si64(half));
+    return i;
+}
+
+SLANG_TARGET_AVX2 static uint32_t shiftRightAVX2(uint64_t* dst, const uint64_t* src,
+                                                 uint32_t words, uint32_t amount) {
+    __m128i right = _mm_cvtsi32_si128(int(amount));
+    __m128i left = _mm_cvtsi32_si128(int(64 - amount));
+    uint32_t i = 0;
+    for (; i + 4 <= words; i += 4) {
+        storeAVX2(dst + i, _mm256_or_si256(_mm256_srl_epi64(loadAVX2(src + i), right),
+                                           _mm256_sll_epi64(loadAVX2(src + i + 1), left)));
+    }
+    return i;
+}
+
+SLANG_TARGET_AVX2 static uint32_t shiftLeftAVX2(uint64_t* dst, const uint64_t* src,
+                                                uint32_t words, uint32_t amount) {
+    __m128i left = _mm_cvtsi32_si128(int(amount));
+    __m128i right = _mm_cvtsi32_si128(int(64 - amount));
+    const uint64_t* prev = src - 1;
+    uint32_t i = 0;
+    for (; i + 4 <= words; i += 4) {
+        storeAVX2(dst + i, _mm256_or_si256(_mm256_sll_epi64(loadAVX2(src + i), left),
+                                           _mm256_srl_epi64(loadAVX2(prev + i), right)));
+    }
+    return i;
+}
+
+#    define SVINT_VECTORIZED(index, kernel, ...)         \
+        switch (getSimdLevel()) {                        \
+            case SimdLevel::AVX2:                        \
+                index = kernel##AVX2 __VA_ARGS__;        \
+                break;                                   \
+            case SimdLevel::SSE2:                        \
+                index = kernel##SSE2 __VA_ARGS__;        \
+                break;                                   \
+            default:                                     \
+                break;                                   \
+        }
+#else
+#    define SVINT_VECTORIZED(index, kernel, ...)
+#endif
+
+// Applies a bitwise operator to 2-state words: dst = dst op src.
+template<BitOp Op>
+static void bitwiseWords(uint64_t* dst, const uint64_t* src, uint32_t words) {
+    uint32_t i = 0;
+    SVINT_VECTORIZED(i, bitwise, <Op>(dst, src, words))
+    for (; i < words; i++)
+        dst[i] = bitOp<Op>(dst[i], src[i]);
+}
+
+// Applies a bitwise operator to 4-state words, where the left hand side
+// is known to have unknown words and the right hand side may not.
+template<BitOp Op>
+static void bitwiseWords4State(uint64_t* lv, uint64_t* lu, const uint64_t* rv,
+                               const uint64_t* ru, uint32_t words) {
+    uint32_t i = 0;
+    if (ru) {
+        SVINT_VECTORIZED(i, bitwise4State, <Op, true>(lv, lu, rv, ru, words))
+        for (; i < words; i++)
+            bitOp4State<Op>(lv[i], lu[i], rv[i], ru[i]);
+    }
+    else {
+        SVINT_VECTORIZED(i, bitwise4State, <Op, false>(lv, lu, rv, ru, words))
+        for (; i < words; i++)
+            bitOp4State<Op>(lv[i], lu[i], rv[i], 0);
+    }
+}
+
+// Inverts each word in place, turning any unknown bits into X.
+static void bitwiseNotWords(uint64_t* v, const uint64_t* u, uint32_t words) {
+    uint32_t i = 0;
+    if (u) {
+        SVINT_VECTORIZED(i, bitwiseNot, <true>(v, u, words))
+        for (; i < words; i++)
+            v[i] = ~(v[i] | u[i]);
+    }
+    else {
+        SVINT_VECTORIZED(i, bitwiseNot, <false>(v, u, words))
+        for (; i < words; i++)
+            v[i] = ~v[i];
+    }
+}
+
+// Checks whether every bit is either set or unknown.
+static bool allWordsSet(const uint64_t* v, const uint64_t* u, uint32_t words) {
+    uint32_t i = 0;
+    if (u) {
+        SVINT_VECTORIZED(i, findNotAllSet, <true>(v, u, words))
+        for (; i < words; i++) {
+            if ((v[i] | u[i]) != UINT64_MAX)
+                return false;
+        }
+    }
+    else {
+        SVINT_VECTORIZED(i, findNotAllSet, <false>(v, u, words))
+        for (; i < words; i++) {
+            if (v[i] != UINT64_MAX)
+                return false;
+        }
+    }
+    return true;
+}
+
+// Checks whether any bit is a known one.
+static bool anyKnownOne(const uint64_t* v, const uint64_t* u, uint32_t words) {
+    uint32_t i = 0;
+    if (u) {
+        SVINT_VECTORIZED(i, findKnownOne, <true>(v, u, words))
+        for (; i < words; i++) {
+            if (v[i] & ~u[i])
+                return true;
+        }
+    }
+    else {
+        SVINT_VECTORIZED(i, findKnownOne, <false>(v, u, words))
+        for (; i < words; i++) {
+            if (v[i])
+                return true;
+        }
+    }
+    return false;
+}
+
+// Checks whether there is any bit position where both sides are known but differ.
+static bool anyKnownDifference(const uint64_t* lv, const uint64_t* lu, const uint64_t* rv,
+                               const uint64_t* ru, uint32_t words) {
+    uint32_t i = 0;
+    if (lu && ru) {
+        SVINT_VECTORIZED(i, findKnownDifference, <true, true>(lv, lu, rv, ru, words))
+    }
+    else if (lu) {
+        SVINT_VECTORIZED(i, findKnownDifference, <true, false>(lv, lu, rv, ru, words))
+    }
+    else if (ru) {
+        SVINT_VECTORIZED(i, findKnownDifference, <false, true>(lv, lu, rv, ru, words))
+    }
+
+    for (; i < words; i++) {
+        uint64_t unknown = (lu ? lu[i] : 0) | (ru ? ru[i] : 0);
+        if ((lv[i] ^ rv[i]) & ~unknown)
+            return true;
+    }
+    return false;
+}
+
+// Computes the exclusive or of all of the given words.
+static uint64_t xorFoldWords(const uint64_t* v, uint32_t words) {
+    uint64_t result = 0;
+    uint32_t i = 0;
+    SVINT_VECTORIZED(i, xorFold, (v, words, result))
+    for (; i < words; i++)
+        result ^= v[i];
+    return result;
+}
+
+// Shifts words right by an amount less than a word, pulling bits in from the
+// next word up: dst[i] = src[i] >> amount | src[i + 1] << (64 - amount).
+// Reads one word past the end of src.
+static void shiftRightWords(uint64_t* dst, const uint64_t* src, uint32_t words,
+                            uint32_t amount) {
+    SLANG_ASSERT(amount > 0 && amount < 64);
+    uint32_t i = 0;
+    SVINT_VECTORIZED(i, shiftRight, (dst, src, words, amount))
+    for (; i < words; i++)
+        dst[i] = (src[i] >> amount) | (src[i + 1] << (64 - amount));
+}
+
+// Shifts words left by an amount less than a word, pulling bits in from the
+// next word down: dst[i] = src[i] << amount | src[i - 1] >> (64 - amount).
+// Reads one word before the start of src.
+static void shiftLeftWords(uint64_t* dst, const uint64_t* src, uint32_t words, uint32_t amount) {
+    SLANG_ASSERT(amount > 0 && amount < 64);
+    uint32_t i = 0;
+    SVINT_VECTORIZED(i, shiftLeft, (dst, src, words, amount))
+
+    const uint64_t* prev = src - 1;
+    for (; i < words; i++)
+        dst[i] = (src[i] << amount) | (prev[i] >> (64 - amount));
+}
+
+#undef SVINT_VECTORIZED
+
+} // namespace slang
@@ -0,0 +1,72 @@
+//------------------------------------------------------------------------------
+// IncludeTokenCache.cpp
+// Thread-safe cache of lexed include files
+//
+// SPDX-FileCopyrightText: Michael Popoloski
+// SPDX-License-Identifier: MIT
+//------------------------------------------------------------------------------
+#include "slang/parsing/IncludeTokenCache.h"
+
+#include <mutex>
+
+namespace slang::parsing {
+
+bool IncludeTokenCache::matches(const Entry& entry, KeywordVersion keywordVersion,
+                                const LexerOptions& options) {
+    return entry.keywordVersion == keywordVersion &&
+           entry.options.languageVersion == options.languageVersion &&
+           entry.options.maxErrors == options.maxErrors &&
+           entry.options.enableLegacyProtect == options.enableLegacyProtect &&
+           entry.options.discardTrivia == options.discardTrivia;
+}
+
+const IncludeTokenCache::Entry* IncludeTokenCache::find(const char* text,
+                                                        KeywordVersion keywordVersion,
+                                                        const LexerOptions& options) {
+    std::shared_lock lock(mutex);
+    if (auto it = entries.find(text); it != entries.end()) {
+        for (auto& entry : it->second) {
+            if (matches(*entry, keywordVersion, options)) {
+                hits.fetch_add(1, std::memory_order_relaxed);
+                return entry.get();
+            }
+        }
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+void IncludeTokenCache::insert(const char* text, KeywordVersion keywordVersion,
+                               const LexerOptions& options, std::span<const Token> tokens,
+                               std::vector<LexerDiag> diagnostics) {
+    std::unique_lock lock(mutex);
+    auto& list = entries[text];
+    for (auto& entry : list) {
+        if (matches(*entry, keywordVersion, options))
+            return;
+    }
+
+    // The tokens were allocated by whichever preprocessor lexed them,
+    // so copy them into our own storage to keep them alive.
+    SmallVector<Token> copied(tokens.size(), UninitializedTag());
+    for (auto token : tokens)
+        copied.push_back(token.deepClone(alloc));
+
+    auto entry = std::make_unique<Entry>();
+    entry->tokens = copied.copy(alloc);
+    entry->diagnostics = std::move(diagnostics);
+    entry->keywordVersion = keywordVersion;
+    entry->options = options;
+    list.emplace_back(std::move(entry));
+}
+
+size_t IncludeTokenCache::size() const {
+    std::shared_lock lock(mutex);
+    size_t count = 0;
+    for (auto& [_, list] : entries)
+        count += list.size();
+    return count;
+}
+
+} // namespace slang::parsing
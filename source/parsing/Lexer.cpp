@@ -43,7 +43,8 @@ Lexer::Lexer(BufferID bufferId, std::string_view source, const char* startPtr, B
              Diagnostics& diagnostics, LexerOptions options) :
     alloc(alloc), diagnostics(diagnostics), options(options), bufferId(bufferId),
     originalBegin(source.data()), sourceBuffer(startPtr),
-    sourceEnd(source.data() + source.length()), marker(nullptr) {
+    sourceEnd(source.data() + source.length()), marker(nullptr),
+    discardTrivia(options.discardTrivia) {
     ptrdiff_t count = sourceEnd - sourceBuffer;
     SLANG_ASSERT(count);
     SLANG_ASSERT(sourceEnd[-1] == '\0');
@@ -228,6 +229,21 @@ Token Lexer::lex() {
 
 Token Lexer::lex(KeywordVersion keywordVersion) {
     triviaBuffer.clear();
+    return lexTokenAndTrivia(keywordVersion);
+}
+
+Token Lexer::lexInactive(KeywordVersion keywordVersion) {
+    triviaBuffer.clear();
+
+    mark();
+    sourceBuffer = scanInactiveText();
+    if (sourceBuffer != marker)
+        addTrivia(TriviaKind::DisabledText);
+
+    return lexTokenAndTrivia(keywordVersion);
+}
+
+Token Lexer::lexTokenAndTrivia(KeywordVersion keywordVersion) {
     lexTrivia<false>();
 
     // lex the next token
@@ -280,6 +296,11 @@ bool Lexer::isNextTokenOnSameLine() {
     }
 }
 
+void Lexer::seek(size_t offset) {
+    SLANG_ASSERT(originalBegin + offset < sourceEnd);
+    sourceBuffer = originalBegin + offset;
+}
+
 Token Lexer::lexEncodedText(ProtectEncoding encoding, uint32_t expectedBytes, bool singleLine,
                             bool legacyProtectedMode) {
     triviaBuffer.clear();
@@ -1170,31 +1191,144 @@ void Lexer::lexTrivia() {
     }
 }
 
-void Lexer::scanIdentifier() {
+const char* Lexer::scanInactiveText() const {
+    // Skips ahead to the next conditional directive, stepping over comments and
+    // string literals that might contain text that looks like one. Anything that
+    // the lexer would issue a diagnostic for, or that is too unusual to be worth
+    // handling here, stops the scan so that it gets lexed normally instead.
+    // Note that we always stop somewhere that the lexer would start a new token.
+    static constexpr size_t MaxRunLength = SVInt::MAX_BITS / 4;
+
+    const char* ptr = sourceBuffer;
     while (true) {
-        char c = peek();
-        if (isAlphaNumeric(c) || c == '_' || c == '$')
-            advance();
-        else
-            return;
-    }
-}
+        // Runs of plain text are searched a window at a time. A window with no break
+        // in it is skipped up to its last whitespace and the search continues from
+        // there; if it has no whitespace either it could be a run of digits long
+        // enough to be diagnosed as too large of a literal, so we stop.
+        auto limit = size_t(sourceEnd - ptr) > MaxRunLength ? ptr + MaxRunLength : sourceEnd;
+        auto next = findInactiveTextBreak(ptr, limit);
+        if (next == limit && limit != sourceEnd) {
+            auto curr = limit;
+            while (curr != ptr && !isWhitespace(curr[-1]))
+                curr--;
+            while (curr != ptr && isWhitespace(curr[-1]))
+                curr--;
+
+            if (curr == ptr)
+                return ptr;
+
+            ptr = curr;
+            continue;
+        }
 
-void Lexer::scanWhitespace() {
-    bool done = false;
-    while (!done) {
-        switch (peek()) {
-            case ' ':
-            case '\t':
-            case '\v':
-            case '\f':
-                advance();
+        ptr = next;
+        switch (*ptr) {
+            case '`': {
+                if (ptr[1] == '`') {
+                    ptr += 2;
+                    break;
+                }
+
+                if (ptr[1] == '"' || ptr[1] == '\\')
+                    return ptr;
+
+                auto nameEnd = skipIdentifierChars(ptr + 1, sourceEnd);
+                std::string_view name(ptr + 1, size_t(nameEnd - ptr - 1));
+                switch (LF::getDirectiveKind(name, options.enableLegacyProtect)) {
+                    case SyntaxKind::IfDefDirective:
+                    case SyntaxKind::IfNDefDirective:
+                    case SyntaxKind::ElsIfDirective:
+                    case SyntaxKind::ElseDirective:
+                    case SyntaxKind::EndIfDirective:
+                        return ptr;
+                    default:
+                        ptr = std::max(nameEnd, ptr + 1);
+                        break;
+                }
                 break;
-            default:
-                done = true;
+            }
+            case '"': {
+                // Triple quoted strings can span lines; leave those to the lexer.
+                if (ptr[1] == '"' && ptr[2] == '"')
+                    return ptr;
+
+                auto curr = ptr + 1;
+                while (*curr != '"') {
+                    char c = *curr;
+                    if (c == '\\') {
+                        switch (curr[1]) {
+                            case 'n':
+                            case 't':
+                            case '\\':
+                            case '"':
+                            case 'v':
+                            case 'f':
+                            case 'a':
+                                curr += 2;
+                                break;
+                            default:
+                                return ptr;
+                        }
+                    }
+                    else if (!isPrintableASCII(c) && c != '\t') {
+                        return ptr;
+                    }
+                    else {
+                        curr++;
+                    }
+                }
+                ptr = curr + 1;
+                break;
+            }
+            case '/':
+                if (ptr[1] == '/') {
+                    auto curr = ptr + 2;
+                    if (options.enableLegacyProtect) {
+                        while (*curr == ' ')
+                            curr++;
+                        if (std::string_view(curr, size_t(sourceEnd - curr))
+                                .starts_with(PragmaBeginProtected)) {
+                            return ptr;
+                        }
+                    }
+
+                    curr = findLineCommentBreak(curr, sourceEnd);
+                    if (!isNewline(*curr))
+                        return ptr;
+                    ptr = curr;
+                }
+                else if (ptr[1] == '*') {
+                    auto curr = ptr + 2;
+                    while (true) {
+                        curr = findBlockCommentBreak(curr, sourceEnd);
+                        if (curr[0] == '*' && curr[1] == '/')
+                            break;
+                        if (curr[0] == '/' && curr[1] == '*')
+                            return ptr;
+                        if (curr[0] != '*' && curr[0] != '/')
+                            return ptr;
+                        curr++;
+                    }
+                    ptr = curr + 2;
+                }
+                else {
+                    ptr++;
+                }
                 break;
+            default:
+                // Backslashes, nulls, other control characters,
+                // and non-ASCII text all get lexed normally.
+                return ptr;
         }
     }
+}
+
+void Lexer::scanIdentifier() {
+    sourceBuffer = skipIdentifierChars(sourceBuffer, sourceEnd);
+}
+
+void Lexer::scanWhitespace() {
+    sourceBuffer = skipHorizontalWhitespace(sourceBuffer, sourceEnd);
     addTrivia(TriviaKind::Whitespace);
 }
 
@@ -1222,20 +1356,27 @@ void Lexer::scanLineComment() {
 
     bool sawUTF8Error = false;
     while (true) {
+        // Skip quickly over the plain ASCII text of the comment; we'll
+        // only stop on newlines, nulls, and non-ASCII characters.
+        auto next = findLineCommentBreak(sourceBuffer, sourceEnd);
+        if (next != sourceBuffer) {
+            sawUTF8Error = false;
+            sourceBuffer = next;
+        }
+
         char c = peek();
         if (isASCII(c)) {
             if (isNewline(c))
                 break;
 
+            SLANG_ASSERT(c == '\0');
             sawUTF8Error = false;
-            if (c == '\0') {
-                if (reallyAtEnd())
-                    break;
+            if (reallyAtEnd())
+                break;
 
-                // otherwise just error and ignore
-                errorCount++;
-                addDiag(diag::EmbeddedNull, currentOffset());
-            }
+            // otherwise just error and ignore
+            errorCount++;
+            addDiag(diag::EmbeddedNull, currentOffset());
             advance();
         }
         else {
@@ -1248,6 +1389,15 @@ void Lexer::scanLineComment() {
 void Lexer::scanBlockComment() {
     bool sawUTF8Error = false;
     while (true) {
+        // Skip quickly over the plain ASCII text of the comment; we'll only
+        // stop on characters that could end or nest a comment, nulls, and
+        // non-ASCII characters.
+        auto next = findBlockCommentBreak(sourceBuffer, sourceEnd);
+        if (next != sourceBuffer) {
+            sawUTF8Error = false;
+            sourceBuffer = next;
+        }
+
         char c = peek();
         if (isASCII(c)) {
             sawUTF8Error = false;
@@ -1523,10 +1673,55 @@ void Lexer::scanProtectComment() {
 template<typename... Args>
 Token Lexer::create(TokenKind kind, Args&&... args) {
     SourceLocation location(bufferId, size_t(marker - originalBegin));
+
+    // Directives and the end of the file keep their full trivia, since the
+    // preprocessor looks at it to find things like include guards.
+    if (discardTrivia && kind != TokenKind::Directive && kind != TokenKind::EndOfFile) {
+        if (auto trivia = condenseTrivia(triviaBuffer)) {
+            return Token(alloc, kind, *trivia, lexeme(), location,
+                         std::forward<Args>(args)...);
+        }
+    }
+
     return Token(alloc, kind, triviaBuffer.copy(alloc), lexeme(), location,
                  std::forward<Args>(args)...);
 }
 
+std::optional<std::span<Trivia const>> Lexer::condenseTrivia(std::span<Trivia const> trivia) {
+    // Each stand-in has the same effect on Token::isOnSameLine and on checks
+    // for tokens being directly adjacent as the trivia it replaces.
+    static const Trivia space[] = {Trivia(TriviaKind::Whitespace, " "sv)};
+    static const Trivia newline[] = {Trivia(TriviaKind::EndOfLine, "\n"sv)};
+    static const Trivia multilineComment[] = {Trivia(TriviaKind::BlockComment, "/*\n*/"sv)};
+
+    bool anyNewline = false;
+    bool anyMultilineComment = false;
+    for (auto& t : trivia) {
+        switch (t.kind) {
+            case TriviaKind::Whitespace:
+                break;
+            case TriviaKind::EndOfLine:
+            case TriviaKind::LineComment:
+                anyNewline = true;
+                break;
+            case TriviaKind::BlockComment:
+                if (t.getRawText().find_first_of("\r\n"sv) != std::string_view::npos)
+                    anyMultilineComment = true;
+                break;
+            default:
+                return std::nullopt;
+        }
+    }
+
+    if (anyNewline)
+        return newline;
+    if (anyMultilineComment)
+        return multilineComment;
+    if (trivia.empty())
+        return std::span<Trivia const>();
+    return space;
+}
+
 void Lexer::addTrivia(TriviaKind kind) {
     triviaBuffer.emplace_back(kind, lexeme());
 }
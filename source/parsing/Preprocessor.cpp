@@ -98,7 +98,135 @@ void Preprocessor::pushSource(std::string_view source, std::string_view name) {
 void Preprocessor::pushSource(SourceBuffer buffer) {
     SLANG_ASSERT(buffer.id);
 
-    lexerStack.emplace_back(std::make_unique<Lexer>(buffer, alloc, diagnostics, lexerOptions));
+    auto& source = lexerStack.emplace_back();
+    source.lexer = std::make_unique<Lexer>(buffer, alloc, diagnostics, lexerOptions);
+    source.buffer = buffer.id;
+    source.text = buffer.data.data();
+}
+
+void Preprocessor::pushIncludeSource(SourceBuffer buffer) {
+    pushSource(buffer);
+
+    auto& source = lexerStack.back();
+    source.guardState = LexerSource::GuardState::Start;
+
+    auto cache = options.includeTokenCache;
+    if (!cache)
+        return;
+
+    // Included files share their text buffer with all other includes of the same file,
+    // so we can key the cache on it and replay tokens lexed for an earlier include.
+    source.keywordVersion = keywordVersionStack.back();
+    source.replay = cache->find(source.text, source.keywordVersion, lexerOptions);
+    source.recording = !source.replay;
+}
+
+Token Preprocessor::lexSource(LexerSource& source, bool inactive) {
+    auto token = lexSourceToken(source, inactive);
+    if (token.kind == TokenKind::EndOfFile &&
+        source.guardState == LexerSource::GuardState::Closed) {
+        checkIncludeGuardEnd(source, token);
+    }
+    return token;
+}
+
+Token Preprocessor::lexSourceToken(LexerSource& source, bool inactive) {
+    auto keywordVersion = keywordVersionStack.back();
+    if (source.replay) {
+        if (keywordVersion == source.keywordVersion)
+            return replayToken(source);
+
+        // The keyword version changed partway through the file (which can happen if
+        // a `begin_keywords directive is conditionally enabled) so the cached tokens
+        // are no longer valid. Switch over to lexing the rest of the file directly.
+        getActiveLexer();
+    }
+
+    // Tokens that are part of a directive keep their full trivia, since macro
+    // stringification, include file names, and so on depend on its exact text.
+    if (lexerOptions.discardTrivia)
+        source.lexer->setDiscardTrivia(!inDirective);
+
+    // Inactive regions can be skipped over quickly, unless we're recording tokens
+    // for the include cache, since the region might be active for later includes.
+    if (!source.recording) {
+        if (inactive)
+            return source.lexer->lexInactive(keywordVersion);
+        return source.lexer->lex(keywordVersion);
+    }
+
+    if (keywordVersion != source.keywordVersion) {
+        source.recording = false;
+        return source.lexer->lex(keywordVersion);
+    }
+
+    auto diagIndex = diagnostics.size();
+    auto token = source.lexer->lex(keywordVersion);
+
+    auto tokenIndex = uint32_t(source.recordedTokens.size());
+    for (size_t i = diagIndex; i < diagnostics.size(); i++)
+        source.recordedDiags.push_back({tokenIndex, diagnostics[i]});
+    source.recordedTokens.push_back(token);
+
+    if (token.kind == TokenKind::EndOfFile) {
+        options.includeTokenCache->insert(source.text, source.keywordVersion, lexerOptions,
+                                          source.recordedTokens,
+                                          std::move(source.recordedDiags));
+        source.recording = false;
+    }
+
+    return token;
+}
+
+Token Preprocessor::replayToken(LexerSource& source) {
+    auto& entry = *source.replay;
+    auto index = std::min(source.replayIndex, uint32_t(entry.tokens.size() - 1));
+    if (source.replayIndex < entry.tokens.size())
+        source.replayIndex++;
+
+    auto relocate = [&](SourceLocation loc) {
+        return loc.buffer() ? SourceLocation(source.buffer, loc.offset()) : loc;
+    };
+
+    for (; source.replayDiagIndex < entry.diagnostics.size(); source.replayDiagIndex++) {
+        auto& [tokenIndex, diag] = entry.diagnostics[source.replayDiagIndex];
+        if (tokenIndex != index)
+            break;
+
+        auto& newDiag = diagnostics.emplace_back(diag);
+        newDiag.location = relocate(diag.location);
+        for (auto& range : newDiag.ranges)
+            range = SourceRange(relocate(range.start()), relocate(range.end()));
+    }
+
+    // The cached token may have been lexed as part of a directive, in which
+    // case its trivia wasn't discarded at the time.
+    auto token = entry.tokens[index];
+    auto location = relocate(token.location());
+    if (lexerOptions.discardTrivia && !inDirective && token.kind != TokenKind::Directive &&
+        token.kind != TokenKind::EndOfFile) {
+        if (auto trivia = Lexer::condenseTrivia(token.trivia()))
+            return token.clone(alloc, *trivia, token.rawText(), location);
+    }
+
+    return token.withLocation(alloc, location);
+}
+
+Lexer& Preprocessor::getActiveLexer() {
+    // Callers want to work with the source text directly, so any replaying
+    // from or recording into the include token cache has to stop here.
+    auto& source = lexerStack.back();
+    if (source.replay) {
+        if (source.replayIndex) {
+            auto token = source.replay->tokens[source.replayIndex - 1];
+            source.lexer->seek(token.location().offset() + token.rawText().size());
+        }
+        source.replay = nullptr;
+    }
+
+    source.recording = false;
+    source.lexer->setDiscardTrivia(false);
+    return *source.lexer;
 }
 
 void Preprocessor::popSource() {
@@ -179,7 +307,11 @@ void Preprocessor::undefineAll() {
 }
 
 bool Preprocessor::isDefined(std::string_view name) {
-    return !name.empty() && macros.find(name) != macros.end();
+    if (name.empty())
+        return false;
+
+    traceMacroRead(name);
+    return macros.find(name) != macros.end();
 }
 
 void Preprocessor::setKeywordVersion(KeywordVersion version) {
@@ -194,7 +326,7 @@ void Preprocessor::resetAllDirectives() {
 }
 
 const SourceLibrary* Preprocessor::getCurrentLibrary() const {
-    return lexerStack.empty() ? nullptr : lexerStack.back()->getLibrary();
+    return lexerStack.empty() ? nullptr : lexerStack.back().lexer->getLibrary();
 }
 
 std::vector<const DefineDirectiveSyntax*> Preprocessor::getDefinedMacros() const {
@@ -210,6 +342,257 @@ std::vector<const DefineDirectiveSyntax*> Preprocessor::getDefinedMacros() const
     return results;
 }
 
+PreprocessorUnitState Preprocessor::getUnitState() const {
+    PreprocessorUnitState state;
+    for (auto& [name, def] : macros) {
+        if (def.syntax && !def.builtIn)
+            state.macros.emplace(name, PreprocessorUnitState::Macro{def.syntax, def.commandLine});
+    }
+
+    state.includeOnceHeaders = includeOnceHeaders;
+    state.includeGuards = includeGuards;
+    state.keywordVersionStack.append_range(keywordVersionStack);
+    state.timeScale = activeTimeScale;
+    state.defaultNetType = defaultNetType;
+    state.unconnectedDrive = unconnectedDrive;
+    return state;
+}
+
+void Preprocessor::setUnitState(const PreprocessorUnitState& state, PreprocessorUnitTrace* trace) {
+    erase_if(macros, [](auto& pair) { return !pair.second.builtIn; });
+    for (auto& [name, macro] : state.macros) {
+        MacroDef def(macro.syntax);
+        def.commandLine = macro.commandLine;
+        macros.emplace(name, def);
+    }
+
+    includeOnceHeaders = state.includeOnceHeaders;
+    includeGuards = state.includeGuards;
+    keywordVersionStack.assign(state.keywordVersionStack.begin(), state.keywordVersionStack.end());
+    activeTimeScale = state.timeScale;
+    defaultNetType = state.defaultNetType;
+    unconnectedDrive = state.unconnectedDrive;
+
+    unitTrace = trace;
+    if (unitTrace) {
+        auto& incoming = unitTrace->incoming;
+        incoming.keywordVersionStack = state.keywordVersionStack;
+        incoming.timeScale = state.timeScale;
+        incoming.defaultNetType = state.defaultNetType;
+        incoming.unconnectedDrive = state.unconnectedDrive;
+        unitTrace->outgoing = incoming;
+    }
+}
+
+void Preprocessor::traceMacroRead(std::string_view name) const {
+    if (!unitTrace || unitTrace->undefinedAll || unitTrace->macroChanges.contains(name))
+        return;
+
+    PreprocessorUnitTrace::MacroValue value;
+    if (auto it = macros.find(name); it != macros.end()) {
+        // Built-in macros are the same everywhere so there's no need to track them.
+        if (it->second.builtIn)
+            return;
+        value = PreprocessorUnitState::Macro{it->second.syntax, it->second.commandLine};
+    }
+    unitTrace->macroDeps.try_emplace(name, value);
+}
+
+void Preprocessor::traceMacroWrite(std::string_view name) {
+    if (!unitTrace)
+        return;
+
+    PreprocessorUnitTrace::MacroValue value;
+    if (auto it = macros.find(name); it != macros.end())
+        value = PreprocessorUnitState::Macro{it->second.syntax, it->second.commandLine};
+    unitTrace->macroChanges[name] = value;
+}
+
+void Preprocessor::traceDirectiveWrite(uint8_t flags) {
+    if (!unitTrace)
+        return;
+
+    auto& outgoing = unitTrace->outgoing;
+    outgoing.keywordVersionStack.clear();
+    outgoing.keywordVersionStack.append_range(keywordVersionStack);
+    outgoing.timeScale = activeTimeScale;
+    outgoing.defaultNetType = defaultNetType;
+    outgoing.unconnectedDrive = unconnectedDrive;
+    unitTrace->directivesWritten |= flags;
+}
+
+bool Preprocessor::isIncludeOnceHeader(const char* text) {
+    bool result = includeOnceHeaders.contains(text);
+    if (unitTrace && std::ranges::find(unitTrace->includeOnceAdded, text) ==
+                         unitTrace->includeOnceAdded.end()) {
+        unitTrace->includeOnceDeps.try_emplace(text, result);
+    }
+    return result;
+}
+
+const std::string_view* Preprocessor::findIncludeGuard(const char* text) {
+    auto it = includeGuards.find(text);
+    const std::string_view* result = it == includeGuards.end() ? nullptr : &it->second;
+    if (unitTrace && std::ranges::find(unitTrace->includeGuardsAdded, text,
+                                       &std::pair<const char*, std::string_view>::first) ==
+                         unitTrace->includeGuardsAdded.end()) {
+        unitTrace->includeGuardDeps.try_emplace(text, result != nullptr);
+    }
+    return result;
+}
+
+void Preprocessor::checkIncludeGuardStart(Token directive,
+                                          const ConditionalDirectiveExpressionSyntax& expr) {
+    auto& source = lexerStack.back();
+    if (source.guardState != LexerSource::GuardState::Start)
+        return;
+
+    // The `ifndef must be the very first thing in the file, with nothing
+    // but whitespace and comments before it.
+    source.guardState = LexerSource::GuardState::None;
+    auto loc = directive.location();
+    if (loc.buffer() != source.buffer ||
+        expr.kind != SyntaxKind::NamedConditionalDirectiveExpression) {
+        return;
+    }
+
+    size_t triviaLength = 0;
+    for (auto& trivia : directive.trivia())
+        triviaLength += trivia.getRawText().size();
+
+    if (triviaLength == loc.offset()) {
+        source.guardState = LexerSource::GuardState::Open;
+        source.guardName = expr.as<NamedConditionalDirectiveExpressionSyntax>().name.valueText();
+        source.guardDepth = branchStack.size() - 1;
+    }
+}
+
+void Preprocessor::checkIncludeGuardBranch(Token directive, bool isEnd) {
+    // Called for `else, `elsif and `endif directives, before the branch stack is updated.
+    // Note that the directive could come from a nested include, since the branch stack
+    // is shared by all files on the include stack.
+    auto loc = directive.location();
+    for (auto& source : lexerStack) {
+        if (source.guardState != LexerSource::GuardState::Open ||
+            branchStack.size() != source.guardDepth + 1) {
+            continue;
+        }
+
+        // Any other branch of the guard conditional means the file has contents
+        // that are included even when the guard macro is defined.
+        if (isEnd && loc.buffer() == source.buffer) {
+            source.guardState = LexerSource::GuardState::Closed;
+            source.guardEnd = loc.offset() + directive.rawText().size();
+        }
+        else {
+            source.guardState = LexerSource::GuardState::None;
+        }
+    }
+}
+
+void Preprocessor::checkIncludeGuardEnd(LexerSource& source, Token eof) {
+    // The `endif that closes the guard must be the last thing in
+    // the file, with nothing but whitespace and comments after it.
+    source.guardState = LexerSource::GuardState::None;
+
+    size_t triviaLength = 0;
+    for (auto& trivia : eof.trivia()) {
+        switch (trivia.kind) {
+            case TriviaKind::Whitespace:
+            case TriviaKind::EndOfLine:
+            case TriviaKind::LineComment:
+            case TriviaKind::BlockComment:
+                triviaLength += trivia.getRawText().size();
+                break;
+            default:
+                return;
+        }
+    }
+
+    if (source.guardEnd + triviaLength != eof.location().offset())
+        return;
+
+    if (includeGuards.emplace(source.text, source.guardName).second && unitTrace)
+        unitTrace->includeGuardsAdded.emplace_back(source.text, source.guardName);
+}
+
+bool PreprocessorUnitTrace::isValidFor(const PreprocessorUnitState& state) const {
+    using DT = DefineDirectiveSyntax;
+
+    // Macros defined in different places are never considered the same, even if they
+    // are token-for-token identical, since their expansions would have different locations.
+    auto sameMacro = [](const PreprocessorUnitState::Macro& a,
+                        const PreprocessorUnitState::Macro& b) {
+        if (a.commandLine != b.commandLine)
+            return false;
+        if (a.syntax == b.syntax)
+            return true;
+
+        const DT& l = *a.syntax;
+        const DT& r = *b.syntax;
+        return l.directive.location() == r.directive.location() &&
+               l.name.location() == r.name.location() && Preprocessor::isSameMacro(l, r);
+    };
+
+    for (auto& [name, value] : macroDeps) {
+        auto it = state.macros.find(name);
+        if (it == state.macros.end()) {
+            if (value)
+                return false;
+        }
+        else if (!value || !sameMacro(*value, it->second)) {
+            return false;
+        }
+    }
+
+    for (auto& [file, wasIncluded] : includeOnceDeps) {
+        if (state.includeOnceHeaders.contains(file) != wasIncluded)
+            return false;
+    }
+
+    for (auto& [file, wasKnown] : includeGuardDeps) {
+        if (state.includeGuards.contains(file) != wasKnown)
+            return false;
+    }
+
+    if (!std::ranges::equal(incoming.keywordVersionStack, state.keywordVersionStack))
+        return false;
+
+    if ((directivesRead & TimeScaleFlag) && incoming.timeScale != state.timeScale)
+        return false;
+    if ((directivesRead & DefaultNetTypeFlag) && incoming.defaultNetType != state.defaultNetType)
+        return false;
+    if ((directivesRead & UnconnectedDriveFlag) &&
+        incoming.unconnectedDrive != state.unconnectedDrive) {
+        return false;
+    }
+
+    return true;
+}
+
+void PreprocessorUnitTrace::applyTo(PreprocessorUnitState& state) const {
+    if (undefinedAll)
+        state.macros.clear();
+
+    for (auto& [name, value] : macroChanges) {
+        if (value)
+            state.macros[name] = *value;
+        else
+            state.macros.erase(name);
+    }
+
+    state.includeOnceHeaders.insert(includeOnceAdded.begin(), includeOnceAdded.end());
+    state.includeGuards.insert(includeGuardsAdded.begin(), includeGuardsAdded.end());
+
+    state.keywordVersionStack = outgoing.keywordVersionStack;
+    if (directivesWritten & TimeScaleFlag)
+        state.timeScale = outgoing.timeScale;
+    if (directivesWritten & DefaultNetTypeFlag)
+        state.defaultNetType = outgoing.defaultNetType;
+    if (directivesWritten & UnconnectedDriveFlag)
+        state.unconnectedDrive = outgoing.unconnectedDrive;
+}
+
 Token Preprocessor::next() {
     return consume();
 }
@@ -259,6 +642,9 @@ Token Preprocessor::nextProcessed() {
 }
 
 Token Preprocessor::handleDirectives(Token token) {
+    auto savedInDirective = std::exchange(inDirective, true);
+    auto guard = ScopeGuard([this, savedInDirective] { inDirective = savedInDirective; });
+
     // burn through any preprocessor directives we find and convert them to trivia
     SmallVector<Trivia, 8> trivia;
     while (true) {
@@ -395,7 +781,7 @@ Token Preprocessor::handleDirectives(Token token) {
     }
 }
 
-Token Preprocessor::nextRaw() {
+Token Preprocessor::nextRaw(bool inactive) {
     // it's possible we have a token buffered from looking ahead when handling a directive
     if (currentToken)
         return std::exchange(currentToken, Token());
@@ -416,14 +802,19 @@ Token Preprocessor::nextRaw() {
 
     // Pull the next token from the active source.
     // This is the common case.
-    auto& source = lexerStack.back();
-    auto token = source->lex(keywordVersionStack.back());
+    auto token = lexSource(lexerStack.back(), inactive);
     if (token.kind != TokenKind::EndOfFile)
         return token;
 
     auto checkBranchStack = [&] {
         if (!branchStack.empty())
             addDiag(diag::MissingEndIfDirective, branchStack.back().directive.range());
+
+        if (unitTrace) {
+            unitTrace->hasOpenState = !branchStack.empty() || protectEncryptDepth ||
+                                      protectDecryptDepth || protectLineLength ||
+                                      protectBytes || protectEncoding != ProtectEncoding::Raw;
+        }
     };
 
     // don't return EndOfFile tokens for included files, fall
@@ -446,8 +837,7 @@ Token Preprocessor::nextRaw() {
     appendTrivia(token);
 
     while (true) {
-        auto& nextSource = lexerStack.back();
-        token = nextSource->lex(keywordVersionStack.back());
+        token = lexSource(lexerStack.back());
         appendTrivia(token);
         if (token.kind != TokenKind::EndOfFile)
             break;
@@ -544,9 +934,14 @@ Trivia Preprocessor::handleIncludeDirective(Token directive) {
         else if (includeDepth >= options.maxIncludeDepth) {
             addDiag(diag::ExceededMaxIncludeDepth, fileName.range());
         }
-        else if (includeOnceHeaders.find(buffer->data.data()) == includeOnceHeaders.end()) {
-            includeDepth++;
-            pushSource(*buffer);
+        else if (!isIncludeOnceHeader(buffer->data.data())) {
+            // If the file is wrapped in an include guard whose macro is defined,
+            // including it again would produce nothing, so skip it entirely.
+            auto guard = findIncludeGuard(buffer->data.data());
+            if (!guard || !isDefined(*guard)) {
+                includeDepth++;
+                pushIncludeSource(*buffer);
+            }
         }
     }
 
@@ -557,6 +952,9 @@ Trivia Preprocessor::handleIncludeDirective(Token directive) {
 Trivia Preprocessor::handleResetAllDirective(Token directive) {
     checkOutsideDesignElement(directive);
     resetAllDirectives();
+    traceDirectiveWrite(PreprocessorUnitTrace::TimeScaleFlag |
+                        PreprocessorUnitTrace::DefaultNetTypeFlag |
+                        PreprocessorUnitTrace::UnconnectedDriveFlag);
     return createSimpleDirective(directive);
 }
 
@@ -660,6 +1058,7 @@ Trivia Preprocessor::handleDefineDirective(Token directive) {
     auto result = alloc.emplace<DefineDirectiveSyntax>(directive, name, formalArguments,
                                                        scratchTokenBuffer.copy(alloc));
 
+    traceMacroRead(name.valueText());
     if (auto it = macros.find(name.valueText()); it != macros.end()) {
         if (it->second.builtIn) {
             addDiag(diag::InvalidMacroName, name.range());
@@ -674,8 +1073,10 @@ Trivia Preprocessor::handleDefineDirective(Token directive) {
         }
     }
 
-    if (!bad)
+    if (!bad) {
         macros[name.valueText()] = result;
+        traceMacroWrite(name.valueText());
+    }
     return Trivia(TriviaKind::Directive, result);
 }
 
@@ -700,17 +1101,21 @@ Trivia Preprocessor::handleIfDefDirective(Token directive, bool inverted) {
     }
 
     branchStack.emplace_back(BranchEntry(directive, take));
+    if (inverted)
+        checkIncludeGuardStart(directive, expr);
 
     return parseBranchDirective(directive, &expr, take);
 }
 
 Trivia Preprocessor::handleElsIfDirective(Token directive) {
+    checkIncludeGuardBranch(directive, /* isEnd */ false);
     auto& expr = parseConditionalExprTop();
     bool take = shouldTakeElseBranch(directive.location(), &expr);
     return parseBranchDirective(directive, &expr, take);
 }
 
 Trivia Preprocessor::handleElseDirective(Token directive) {
+    checkIncludeGuardBranch(directive, /* isEnd */ false);
     bool take = shouldTakeElseBranch(directive.location(), nullptr);
     return parseBranchDirective(directive, nullptr, take);
 }
@@ -751,7 +1156,7 @@ Trivia Preprocessor::parseBranchDirective(Token directive,
     if (!taken) {
         // skip over everything until we find another conditional compilation directive
         while (true) {
-            auto token = nextRaw();
+            auto token = nextRaw(/* inactive */ true);
 
             // EoF or conditional directive stops the skipping process
             bool done = false;
@@ -801,6 +1206,7 @@ Trivia Preprocessor::handleEndIfDirective(Token directive) {
     if (branchStack.empty())
         addDiag(diag::UnexpectedConditionalDirective, directive.range());
     else {
+        checkIncludeGuardBranch(directive, /* isEnd */ true);
         branchStack.pop_back();
         if (!branchStack.empty() && !branchStack.back().currentActive)
             taken = false;
@@ -871,6 +1277,7 @@ Trivia Preprocessor::handleTimeScaleDirective(Token directive) {
         }
         else {
             activeTimeScale = {unit, precision};
+            traceDirectiveWrite(PreprocessorUnitTrace::TimeScaleFlag);
         }
     }
 
@@ -922,12 +1329,14 @@ Trivia Preprocessor::handleDefaultNetTypeDirective(Token directive) {
         case TokenKind::TriRegKeyword:
             netType = consume();
             defaultNetType = netType.kind;
+            traceDirectiveWrite(PreprocessorUnitTrace::DefaultNetTypeFlag);
             break;
         case TokenKind::Identifier:
             // none isn't a keyword but it's special here
             if (peek().rawText() == "none") {
                 netType = consume();
                 defaultNetType = TokenKind::Unknown;
+                traceDirectiveWrite(PreprocessorUnitTrace::DefaultNetTypeFlag);
             }
             break;
         default:
@@ -949,10 +1358,14 @@ Trivia Preprocessor::handleUndefDirective(Token directive) {
 
     if (!nameToken.isMissing()) {
         std::string_view name = nameToken.valueText();
+        traceMacroRead(name);
+
         auto it = macros.find(name);
         if (it != macros.end()) {
-            if (!it->second.builtIn)
+            if (!it->second.builtIn) {
                 macros.erase(it);
+                traceMacroWrite(name);
+            }
             else
                 addDiag(diag::UndefineBuiltinDirective, nameToken.range());
         }
@@ -964,6 +1377,15 @@ Trivia Preprocessor::handleUndefDirective(Token directive) {
 
 Trivia Preprocessor::handleUndefineAllDirective(Token directive) {
     undefineAll();
+
+    if (unitTrace) {
+        unitTrace->undefinedAll = true;
+        unitTrace->macroChanges.clear();
+        for (auto& [name, def] : macros) {
+            if (!def.builtIn)
+                traceMacroWrite(name);
+        }
+    }
     return createSimpleDirective(directive);
 }
 
@@ -975,8 +1397,10 @@ Trivia Preprocessor::handleBeginKeywordsDirective(Token directive) {
         auto versionOpt = LF::getKeywordVersion(versionToken.valueText());
         if (!versionOpt)
             addDiag(diag::UnrecognizedKeywordVersion, versionToken.range());
-        else
+        else {
             keywordVersionStack.push_back(*versionOpt);
+            traceDirectiveWrite(0);
+        }
     }
 
     auto result = alloc.emplace<BeginKeywordsDirectiveSyntax>(directive, versionToken);
@@ -988,16 +1412,24 @@ Trivia Preprocessor::handleEndKeywordsDirective(Token directive) {
 
     if (keywordVersionStack.size() == 1)
         addDiag(diag::MismatchedEndKeywordsDirective, directive.range());
-    else
+    else {
         keywordVersionStack.pop_back();
+        traceDirectiveWrite(0);
+    }
 
     return createSimpleDirective(directive);
 }
 
 std::pair<Trivia, Trivia> Preprocessor::handlePragmaDirective(Token directive) {
     if (peek().kind != TokenKind::Identifier || !peek().isOnSameLine()) {
-        addDiag(diag::ExpectedPragmaName, directive.location() + directive.rawText().length());
-        return {createSimpleDirective(directive), Trivia()};
+        // Note: this can't be a SimpleDirectiveSyntax because the node
+        // kind for it would be PragmaDirective, which doesn't match.
+        auto loc = directive.location() + directive.rawText().length();
+        addDiag(diag::ExpectedPragmaName, loc);
+
+        auto name = Token::createMissing(alloc, TokenKind::Identifier, loc);
+        auto result = alloc.emplace<PragmaDirectiveSyntax>(directive, name, nullptr);
+        return {Trivia(TriviaKind::Directive, result), Trivia()};
     }
 
     SmallVector<TokenOrSyntax, 4> args;
@@ -1045,9 +1477,9 @@ std::pair<Trivia, Trivia> Preprocessor::handleProtectedDirective(Token directive
     SmallVector<Token, 4> skipped;
     skipMacroTokensBeforeProtectRegion(directive, skipped);
 
-    Token token = lexerStack.back()->lexEncodedText(ProtectEncoding::Raw, 0,
-                                                    /* isSingleLine */ false,
-                                                    /* legacyProtectedMode */ true);
+    Token token = getActiveLexer().lexEncodedText(ProtectEncoding::Raw, 0,
+                                                  /* isSingleLine */ false,
+                                                  /* legacyProtectedMode */ true);
     skipped.push_back(token);
 
     addDiag(diag::ProtectedEnvelope, token.location());
@@ -1068,6 +1500,7 @@ Trivia Preprocessor::handleUnconnectedDriveDirective(Token directive) {
         case TokenKind::Pull1Keyword:
             strength = consume();
             unconnectedDrive = strength.kind;
+            traceDirectiveWrite(PreprocessorUnitTrace::UnconnectedDriveFlag);
             break;
         default:
             break;
@@ -1086,6 +1519,7 @@ Trivia Preprocessor::handleUnconnectedDriveDirective(Token directive) {
 Trivia Preprocessor::handleNoUnconnectedDriveDirective(Token directive) {
     checkOutsideDesignElement(directive);
     unconnectedDrive = TokenKind::Unknown;
+    traceDirectiveWrite(PreprocessorUnitTrace::UnconnectedDriveFlag);
     return createSimpleDirective(directive);
 }
 
@@ -1219,10 +1653,11 @@ bool Preprocessor::evalConditionalExpr(
                     SLANG_UNREACHABLE;
             }
         }
-        case SyntaxKind::NamedConditionalDirectiveExpression:
-            return macros.find(
-                       expr.as<NamedConditionalDirectiveExpressionSyntax>().name.valueText()) !=
-                   macros.end();
+        case SyntaxKind::NamedConditionalDirectiveExpression: {
+            auto name = expr.as<NamedConditionalDirectiveExpressionSyntax>().name.valueText();
+            traceMacroRead(name);
+            return macros.find(name) != macros.end();
+        }
         default:
             SLANG_UNREACHABLE;
     }
@@ -1268,7 +1703,20 @@ bool Preprocessor::peekSameLine() const {
     if (currentMacroToken)
         return currentMacroToken->isOnSameLine();
 
-    return lexerStack.back()->isNextTokenOnSameLine();
+    auto& source = lexerStack.back();
+    if (source.replay) {
+        // When replaying from the cache we can tell from the leading trivia of
+        // the next cached token, which is what the lexer would have scanned.
+        auto& tokens = source.replay->tokens;
+        auto next = tokens[std::min(size_t(source.replayIndex), tokens.size() - 1)];
+        for (auto& trivia : next.trivia()) {
+            if (trivia.kind != TriviaKind::Whitespace && trivia.kind != TriviaKind::BlockComment)
+                return false;
+        }
+        return next.kind != TokenKind::EndOfFile;
+    }
+
+    return source.lexer->isNextTokenOnSameLine();
 }
 
 Diagnostic& Preprocessor::addDiag(DiagCode code, SourceLocation location) {
@@ -24,6 +24,7 @@ Preprocessor::MacroDef Preprocessor::findMacro(Token directive) {
     if (!name.empty() && name[0] == '\\')
         name = name.substr(1);
 
+    traceMacroRead(name);
     auto it = macros.find(name);
     if (it == macros.end())
         return nullptr;
@@ -165,8 +166,8 @@ bool Preprocessor::applyMacroOps(std::span<Token const> tokens, SmallVectorBase<
                 }
                 else if (token.kind == stringify.kind) {
                     // all done stringifying; convert saved tokens to string
-                    newToken = Lexer::stringify(*lexerStack.back(), stringify, stringifyBuffer,
-                                                token);
+                    newToken = Lexer::stringify(*lexerStack.back().lexer, stringify,
+                                                stringifyBuffer, token);
                     stringify = Token();
                 }
                 else if (stringify.kind == TokenKind::MacroTripleQuote) {
@@ -181,8 +182,8 @@ bool Preprocessor::applyMacroOps(std::span<Token const> tokens, SmallVectorBase<
                     // append the essentially empty string literal after it.
                     // This will cause an error down the line since two string literals
                     // next to each other isn't ever valid.
-                    newToken = Lexer::stringify(*lexerStack.back(), stringify, stringifyBuffer,
-                                                token);
+                    newToken = Lexer::stringify(*lexerStack.back().lexer, stringify,
+                                                stringifyBuffer, token);
                     stringify = Token();
                     extraToAppend = Token(alloc, TokenKind::StringLiteral, {}, "\"\"",
                                           token.location() + 2, ""sv);
@@ -328,8 +329,8 @@ bool Preprocessor::applyMacroOps(std::span<Token const> tokens, SmallVectorBase<
 
                     // Note: endToken parameter here doesn't matter,
                     // we know there is no trivia to take.
-                    dest.push_back(
-                        Lexer::stringify(*lexerStack.back(), stringify, stringifyBuffer, Token()));
+                    dest.push_back(Lexer::stringify(*lexerStack.back().lexer, stringify,
+                                                    stringifyBuffer, Token()));
                     stringify = Token();
 
                     // Now we have the unfortunate task of re-lexing the remaining stuff after the
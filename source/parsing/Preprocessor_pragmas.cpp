@@ -237,8 +237,8 @@ void Preprocessor::applyOncePragma(const PragmaDirectiveSyntax& pragma) {
     ensurePragmaArgs(pragma, 0);
 
     auto text = sourceManager.getSourceText(pragma.directive.location().buffer());
-    if (!text.empty())
-        includeOnceHeaders.emplace(text.data());
+    if (!text.empty() && includeOnceHeaders.emplace(text.data()).second && unitTrace)
+        unitTrace->includeOnceAdded.push_back(text.data());
 }
 
 void Preprocessor::applyDiagnosticPragma(const PragmaDirectiveSyntax& pragma) {
@@ -498,8 +498,8 @@ void Preprocessor::handleEncryptedRegion(Token keyword, const PragmaExpressionSy
     ensureNoPragmaArgs(keyword, args);
     skipMacroTokensBeforeProtectRegion(keyword, skippedTokens);
 
-    Token token = lexerStack.back()->lexEncodedText(protectEncoding, protectBytes, isSingleLine,
-                                                    /* legacyProtectedMode */ false);
+    Token token = getActiveLexer().lexEncodedText(protectEncoding, protectBytes, isSingleLine,
+                                                  /* legacyProtectedMode */ false);
     addDiag(diag::ProtectedEnvelope, token.location());
 
     skippedTokens.push_back(token);
@@ -221,8 +221,8 @@ Token::Token(BumpAllocator& alloc, TokenKind kind, std::span<Trivia const> trivi
     init(alloc, kind, trivia, rawText, location);
 
     SVIntStorage storage(value.getBitWidth(), value.isSigned(), value.hasUnknown());
-    if (value.isSingleWord())
-        storage.val = *value.getRawPtr();
+    if (storage.isInline())
+        memcpy(storage.inlineVal, value.getRawPtr(), sizeof(uint64_t) * value.getNumWords());
     else {
         storage.pVal = (uint64_t*)alloc.allocate(sizeof(uint64_t) * value.getNumWords(),
                                                  alignof(uint64_t));
@@ -414,7 +414,36 @@ Token Token::deepClone(BumpAllocator& alloc) const {
     SmallVector<Trivia> triviaBuffer(trivia().size(), UninitializedTag());
     for (const auto& t : trivia())
         triviaBuffer.push_back(t.clone(alloc, true));
-    return clone(alloc, triviaBuffer.copy(alloc), rawText(), location());
+
+    Token result = clone(alloc, triviaBuffer.copy(alloc), rawText(), location());
+
+    // Values that may live in the original allocator need to be copied as well.
+    switch (kind) {
+        case TokenKind::StringLiteral:
+        case TokenKind::IncludeFileName: {
+            auto& text = result.info->stringText();
+            if (!text.empty()) {
+                auto data = (char*)alloc.allocate(text.size(), 1);
+                memcpy(data, text.data(), text.size());
+                text = std::string_view(data, text.size());
+            }
+            break;
+        }
+        case TokenKind::IntegerLiteral: {
+            auto& storage = result.info->integer();
+            if (!storage.isInline()) {
+                SVInt value = intValue();
+                storage.pVal = (uint64_t*)alloc.allocate(sizeof(uint64_t) * value.getNumWords(),
+                                                         alignof(uint64_t));
+                memcpy(storage.pVal, value.getRawPtr(), sizeof(uint64_t) * value.getNumWords());
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    return result;
 }
 
 void Token::init(BumpAllocator& alloc, TokenKind kind_, std::span<Trivia const> trivia,
@@ -11,6 +11,7 @@
 #include "slang/syntax/SyntaxNode.h"
 #include "slang/syntax/SyntaxTree.h"
 #include "slang/text/SourceManager.h"
+#include "slang/util/ScopeGuard.h"
 
 namespace slang::syntax {
 
@@ -22,8 +23,11 @@ SyntaxPrinter::SyntaxPrinter(const SourceManager& sourceManager) : sourceManager
 SyntaxPrinter& SyntaxPrinter::print(Trivia trivia) {
     switch (trivia.kind) {
         case TriviaKind::Directive:
-            if (includeDirectives)
+            if (includeDirectives) {
+                auto guard = ScopeGuard([this, saved = inDirective] { inDirective = saved; });
+                inDirective = true;
                 print(*trivia.syntax());
+            }
             else if (includePreprocessed) {
                 auto nestedTrivia = trivia.syntax()->getFirstToken().trivia();
                 for (const auto& t : nestedTrivia)
@@ -41,7 +45,9 @@ SyntaxPrinter& SyntaxPrinter::print(Trivia trivia) {
             }
             break;
         case TriviaKind::DisabledText:
-            if (includeSkipped)
+            // The text of inactive conditional compilation branches
+            // is considered part of the directives around it.
+            if (includeSkipped || inDirective)
                 append(trivia.getRawText());
             break;
         case TriviaKind::LineComment:
@@ -146,10 +152,8 @@ SyntaxPrinter& SyntaxPrinter::append(std::string_view text) {
             i++;
         }
 
-        for (; i < text.length(); i++) {
-            if (text[i] == '\r' || text[i] == '\n')
-                i++;
-        }
+        while (i < text.length() && (text[i] == '\r' || text[i] == '\n'))
+            i++;
 
         text = text.substr(i);
     }
@@ -0,0 +1,1276 @@
+//------------------------------------------------------------------------------
+// SyntaxSerializer.cpp
+// Binary serialization of syntax trees
+//
+// SPDX-FileCopyrightText: Michael Popoloski
+// SPDX-License-Identifier: MIT
+//------------------------------------------------------------------------------
+#include "slang/syntax/SyntaxSerializer.h"
+
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <utility>
+
+#include "slang/parsing/LexerFacts.h"
+#include "slang/parsing/Preprocessor.h"
+#include "slang/syntax/AllSyntax.h"
+#include "slang/syntax/SyntaxTree.h"
+#include "slang/text/SourceManager.h"
+#include "slang/util/OS.h"
+#include "slang/util/String.h"
+#include "slang/util/VersionInfo.h"
+
+namespace fs = std::filesystem;
+
+namespace slang::syntax {
+
+using namespace parsing;
+
+namespace {
+
+// The layout of serialized data is:
+//   magic, format version, format hash, checksum of the remaining data
+//   string table
+//   buffer table
+//   root node, defined macros, parser metadata, diagnostics
+//
+// Integers are written as LEB128 varints. Nodes are written in preorder and are
+// numbered in the order they are written, which is how the macro list and the
+// parser metadata refer to them. All text that doesn't live in a source buffer
+// is written once to the string table and referred to by index.
+constexpr char Magic[] = {'S', 'L', 'S', 'T'};
+
+// Files written by SyntaxSerializer::writeFile start with the same format version
+// and format hash as serialized trees, followed by a sequence of serialized trees,
+// each preceded by its isLibraryUnit flag, the name of its source library
+// (empty for the default library) and the size of its data.
+constexpr char FileMagic[] = {'S', 'L', 'P', 'K'};
+
+enum class BufferKind : uint8_t { Source, Include, Text, Expansion };
+
+enum class ArgKind : uint8_t { String, SignedInt, UnsignedInt, Char, Integer, Real };
+
+enum TokenFlags : uint8_t {
+    TF_Valid = 1 << 0,
+    TF_Missing = 1 << 1,
+    TF_Trivia = 1 << 2,
+    TF_TextAtLocation = 1 << 3
+};
+
+class ByteWriter {
+public:
+    std::vector<char> data;
+
+    void byte(uint8_t value) { data.push_back(char(value)); }
+
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            byte(uint8_t(value) | 0x80);
+            value >>= 7;
+        }
+        byte(uint8_t(value));
+    }
+
+    void raw(const void* ptr, size_t size) {
+        auto p = static_cast<const char*>(ptr);
+        data.insert(data.end(), p, p + size);
+    }
+
+    template<typename T>
+    void fixed(T value) {
+        raw(&value, sizeof(T));
+    }
+};
+
+class ByteReader {
+public:
+    const char* ptr;
+    const char* end;
+    bool failed = false;
+
+    explicit ByteReader(std::span<const char> data) :
+        ptr(data.data()), end(data.data() + data.size()) {}
+
+    size_t remaining() const { return size_t(end - ptr); }
+
+    uint8_t byte() {
+        if (ptr == end) {
+            failed = true;
+            return 0;
+        }
+        return uint8_t(*ptr++);
+    }
+
+    uint64_t varint() {
+        uint64_t result = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = byte();
+            result |= uint64_t(b & 0x7f) << shift;
+            if ((b & 0x80) == 0)
+                return result;
+        }
+
+        failed = true;
+        return 0;
+    }
+
+    const char* raw(size_t size) {
+        if (remaining() < size) {
+            failed = true;
+            ptr = end;
+            return nullptr;
+        }
+
+        auto result = ptr;
+        ptr += size;
+        return result;
+    }
+
+    template<typename T>
+    T fixed() {
+        T value{};
+        if (auto p = raw(sizeof(T)))
+            memcpy(&value, p, sizeof(T));
+        return value;
+    }
+};
+
+uint64_t hashText(std::string_view text) {
+    return slang::detail::hashing::hash(text.data(), text.size());
+}
+
+class TreeWriter {
+public:
+    bool failed = false;
+
+    explicit TreeWriter(const SourceManager& sourceManager) : sourceManager(sourceManager) {}
+
+    std::vector<char> write(const SyntaxTree& tree) {
+        writeNode(&tree.root());
+
+        auto macros = tree.getDefinedMacros();
+        body.varint(macros.size());
+        for (auto macro : macros) {
+            if (auto it = nodeIndices.find(macro); it != nodeIndices.end()) {
+                body.varint(it->second + 1);
+            }
+            else {
+                // Macros defined outside of the tree itself, such as
+                // on the command line, are written out in full.
+                body.varint(0);
+                writeNode(macro);
+            }
+        }
+
+        writeMetadata(tree.getMetadata());
+
+        // const_cast is safe because we only read the diagnostics.
+        auto& diags = const_cast<SyntaxTree&>(tree).diagnostics();
+        body.varint(diags.size());
+        for (auto& diag : diags)
+            writeDiagnostic(diag);
+
+        // The buffer table can only be written once all of the nodes have been
+        // seen, but it needs to come first when reading, so write it separately.
+        auto nodeData = std::exchange(body, {});
+        writeBuffers();
+        auto bufferTable = std::exchange(body, std::move(nodeData));
+
+        ByteWriter stringTable;
+        stringTable.varint(strings.size());
+        for (auto str : strings) {
+            stringTable.varint(str.size());
+            stringTable.raw(str.data(), str.size());
+        }
+
+        ByteWriter payload;
+        payload.varint(stringTable.data.size());
+        payload.raw(stringTable.data.data(), stringTable.data.size());
+        payload.raw(bufferTable.data.data(), bufferTable.data.size());
+        payload.raw(body.data.data(), body.data.size());
+
+        ByteWriter result;
+        result.raw(Magic, sizeof(Magic));
+        result.varint(SyntaxSerializer::FormatVersion);
+        result.fixed(SyntaxSerializer::getFormatHash());
+        result.fixed(hashText({payload.data.data(), payload.data.size()}));
+        result.raw(payload.data.data(), payload.data.size());
+        return std::move(result.data);
+    }
+
+private:
+    void writeString(std::string_view str) {
+        auto [it, inserted] = stringIndices.try_emplace(str, uint32_t(strings.size()));
+        if (inserted)
+            strings.push_back(str);
+        body.varint(it->second);
+    }
+
+    void writeString(std::string&& str) {
+        // Temporary strings need to be kept alive until the string table is written.
+        writeString(std::string_view(ownedStrings.emplace_back(std::move(str))));
+    }
+
+    static bool isFile(const fs::path& path) {
+        std::error_code ec;
+        return !path.empty() && fs::is_regular_file(path, ec);
+    }
+
+    static bool isTableBuffer(BufferID buffer) {
+        return buffer.valid() && buffer != SourceLocation::NoLocation.buffer() &&
+               buffer != BufferID::getPlaceholder();
+    }
+
+    uint32_t addBuffer(BufferID buffer) {
+        if (auto it = bufferIndices.find(buffer); it != bufferIndices.end())
+            return it->second;
+
+        // Add everything this buffer refers to first so that
+        // the buffers can be recreated in table order.
+        const SourceLocation start(buffer, 0);
+        if (sourceManager.isMacroLoc(start)) {
+            addLocationBuffer(sourceManager.getOriginalLoc(start));
+            auto range = sourceManager.getExpansionRange(start);
+            addLocationBuffer(range.start());
+            addLocationBuffer(range.end());
+        }
+        else {
+            addLocationBuffer(sourceManager.getIncludedFrom(buffer));
+        }
+
+        uint32_t index = uint32_t(buffers.size());
+        bufferIndices.emplace(buffer, index);
+        buffers.push_back(buffer);
+        return index;
+    }
+
+    void addLocationBuffer(SourceLocation loc) {
+        if (isTableBuffer(loc.buffer()))
+            addBuffer(loc.buffer());
+    }
+
+    void writeLocation(SourceLocation loc) {
+        auto buffer = loc.buffer();
+        if (isTableBuffer(buffer)) {
+            body.varint(addBuffer(buffer) + 1);
+        }
+        else {
+            body.varint(0);
+            body.varint(buffer.getId());
+        }
+        body.varint(loc.offset());
+    }
+
+    std::string_view getBufferText(BufferID buffer) {
+        auto [it, inserted] = bufferTexts.try_emplace(buffer);
+        if (inserted && !sourceManager.isMacroLoc(SourceLocation(buffer, 0)))
+            it->second = sourceManager.getSourceText(buffer);
+        return it->second;
+    }
+
+    void writeNode(const SyntaxNode* node) {
+        if (!node) {
+            body.varint(0);
+            return;
+        }
+
+        // Lists can only be written where the reader knows their element type.
+        if (SyntaxListBase::isKind(node->kind)) {
+            failed = true;
+            return;
+        }
+
+        body.varint(uint64_t(node->kind) + 1);
+        nodeIndices.try_emplace(node, nodeCount++);
+
+        if (node->kind == SyntaxKind::IncludeDirective) {
+            auto& include = node->as<IncludeDirectiveSyntax>();
+            includeDirectives.try_emplace(include.directive.location(), &include);
+        }
+
+        // childTokenPtr is only used to tell tokens and nodes apart; nothing is modified.
+        auto& mutableNode = const_cast<SyntaxNode&>(*node);
+        const size_t count = node->getChildCount();
+        for (size_t i = 0; i < count; i++) {
+            if (auto token = mutableNode.childTokenPtr(i)) {
+                writeToken(*token);
+                continue;
+            }
+
+            auto child = node->childNode(i);
+            if (child && SyntaxListBase::isKind(child->kind))
+                writeList(child->as<SyntaxListBase>());
+            else
+                writeNode(child);
+        }
+    }
+
+    void writeList(const SyntaxListBase& list) {
+        const size_t count = list.getChildCount();
+        body.varint(count);
+        for (size_t i = 0; i < count; i++) {
+            auto child = list.getChild(i);
+            if (list.kind == SyntaxKind::SeparatedList && child.isToken() != (i % 2 == 1)) {
+                failed = true;
+                return;
+            }
+
+            if (child.isToken())
+                writeToken(child.token());
+            else
+                writeNode(child.node());
+        }
+    }
+
+    void writeToken(Token token) {
+        if (!token) {
+            body.byte(0);
+            return;
+        }
+
+        auto trivia = token.trivia();
+        auto rawText = token.rawText();
+        auto loc = token.location();
+
+        // Keywords and punctuation don't need their text stored, and most other
+        // tokens can point their text back into the buffer they came from.
+        bool hasKindText = !LexerFacts::getTokenKindText(token.kind).empty();
+        bool textAtLocation = false;
+        if (!hasKindText && isTableBuffer(loc.buffer())) {
+            auto text = getBufferText(loc.buffer());
+            textAtLocation = loc.offset() <= text.size() &&
+                             text.substr(loc.offset(), rawText.size()) == rawText;
+        }
+
+        uint8_t flags = TF_Valid;
+        if (token.isMissing())
+            flags |= TF_Missing;
+        if (!trivia.empty())
+            flags |= TF_Trivia;
+        if (textAtLocation)
+            flags |= TF_TextAtLocation;
+
+        body.byte(flags);
+        body.varint(uint64_t(token.kind));
+        writeLocation(loc);
+
+        if (!trivia.empty()) {
+            body.varint(trivia.size());
+            for (auto& t : trivia)
+                writeTrivia(t);
+        }
+
+        if (textAtLocation)
+            body.varint(rawText.size());
+        else if (!hasKindText)
+            writeString(rawText);
+
+        if (token.isMissing())
+            return;
+
+        switch (token.kind) {
+            case TokenKind::StringLiteral:
+                writeString(token.valueText());
+                break;
+            case TokenKind::IntegerLiteral:
+                writeInteger(token.intValue());
+                break;
+            case TokenKind::RealLiteral:
+            case TokenKind::TimeLiteral:
+                body.fixed(token.realValue());
+                body.byte(token.numericFlags().raw);
+                break;
+            case TokenKind::IntegerBase:
+                body.byte(token.numericFlags().raw);
+                break;
+            case TokenKind::UnbasedUnsizedLiteral:
+                body.byte(token.bitValue().value);
+                break;
+            case TokenKind::Directive:
+            case TokenKind::MacroUsage:
+                body.varint(uint64_t(token.directiveKind()));
+                break;
+            default:
+                break;
+        }
+    }
+
+    void writeTrivia(const Trivia& trivia) {
+        body.byte(uint8_t(trivia.kind));
+        switch (trivia.kind) {
+            case TriviaKind::Directive:
+            case TriviaKind::SkippedSyntax:
+                writeNode(trivia.syntax());
+                break;
+            case TriviaKind::SkippedTokens: {
+                auto tokens = trivia.getSkippedTokens();
+                body.varint(tokens.size());
+                for (auto token : tokens)
+                    writeToken(token);
+                break;
+            }
+            default: {
+                writeString(trivia.getRawText());
+                auto loc = trivia.getExplicitLocation();
+                body.byte(loc ? 1 : 0);
+                if (loc)
+                    writeLocation(*loc);
+                break;
+            }
+        }
+    }
+
+    void writeInteger(const SVInt& value) {
+        body.varint(value.getBitWidth());
+        body.byte(uint8_t(value.isSigned()) | uint8_t(value.hasUnknown() << 1));
+        body.raw(value.getRawPtr(), sizeof(uint64_t) * value.getNumWords());
+    }
+
+    void writeNodeRef(const SyntaxNode* node) {
+        auto it = nodeIndices.find(node);
+        if (it == nodeIndices.end()) {
+            failed = true;
+            body.varint(0);
+        }
+        else {
+            body.varint(it->second);
+        }
+    }
+
+    template<typename T>
+    void writeNodeRefs(const std::vector<T>& nodes) {
+        body.varint(nodes.size());
+        for (auto node : nodes)
+            writeNodeRef(node);
+    }
+
+    void writeMetadata(const ParserMetadata& metadata) {
+        body.varint(metadata.nodeMap.size());
+        for (auto& [node, info] : metadata.nodeMap) {
+            writeNodeRef(node);
+            body.varint(uint64_t(info.defaultNetType));
+            body.varint(uint64_t(info.unconnectedDrive));
+            body.byte(info.timeScale ? 1 : 0);
+            if (auto ts = info.timeScale) {
+                body.byte(uint8_t(ts->base.unit));
+                body.byte(uint8_t(ts->base.magnitude));
+                body.byte(uint8_t(ts->precision.unit));
+                body.byte(uint8_t(ts->precision.magnitude));
+            }
+        }
+
+        body.varint(metadata.globalInstances.size());
+        for (auto name : metadata.globalInstances)
+            writeString(name);
+
+        writeNodeRefs(metadata.classPackageNames);
+        writeNodeRefs(metadata.packageImports);
+        writeNodeRefs(metadata.classDecls);
+        writeNodeRefs(metadata.interfacePorts);
+        writeToken(metadata.eofToken);
+        body.byte(uint8_t(metadata.hasDefparams) | uint8_t(metadata.hasBindDirectives << 1));
+    }
+
+    void writeDiagnostic(const Diagnostic& diag) {
+        if (diag.symbol) {
+            failed = true;
+            return;
+        }
+
+        body.varint(uint64_t(diag.code.getSubsystem()));
+        body.varint(diag.code.getCode());
+        writeLocation(diag.location);
+
+        body.varint(diag.args.size());
+        for (auto& arg : diag.args) {
+            if (auto str = std::get_if<std::string>(&arg)) {
+                body.byte(uint8_t(ArgKind::String));
+                writeString(*str);
+            }
+            else if (auto i = std::get_if<int64_t>(&arg)) {
+                body.byte(uint8_t(ArgKind::SignedInt));
+                body.fixed(*i);
+            }
+            else if (auto u = std::get_if<uint64_t>(&arg)) {
+                body.byte(uint8_t(ArgKind::UnsignedInt));
+                body.varint(*u);
+            }
+            else if (auto c = std::get_if<char>(&arg)) {
+                body.byte(uint8_t(ArgKind::Char));
+                body.byte(uint8_t(*c));
+            }
+            else if (auto cv = std::get_if<ConstantValue>(&arg); cv && cv->isInteger()) {
+                body.byte(uint8_t(ArgKind::Integer));
+                writeInteger(cv->integer());
+            }
+            else if (cv && cv->isReal()) {
+                body.byte(uint8_t(ArgKind::Real));
+                body.fixed(double(cv->real()));
+            }
+            else {
+                failed = true;
+                return;
+            }
+        }
+
+        body.varint(diag.ranges.size());
+        for (auto& range : diag.ranges) {
+            writeLocation(range.start());
+            writeLocation(range.end());
+        }
+
+        body.varint(diag.notes.size());
+        for (auto& note : diag.notes)
+            writeDiagnostic(note);
+
+        body.byte(diag.coalesceCount ? 1 : 0);
+        if (diag.coalesceCount)
+            body.varint(*diag.coalesceCount);
+    }
+
+    void writeBuffers() {
+        flat_hash_map<BufferID, std::vector<SourceManager::DiagnosticDirectiveInfo>> diagDirectives;
+        sourceManager.visitDiagnosticDirectives([&](BufferID buffer, auto& directives) {
+            if (bufferIndices.contains(buffer))
+                diagDirectives[buffer].assign(directives.begin(), directives.end());
+        });
+
+        // All buffers referenced by these entries have already been added
+        // to the table ahead of the buffers that refer to them.
+        body.varint(buffers.size());
+        for (size_t i = 0; i < buffers.size(); i++) {
+            auto buffer = buffers[i];
+            const SourceLocation start(buffer, 0);
+            if (sourceManager.isMacroLoc(start)) {
+                body.byte(uint8_t(BufferKind::Expansion));
+                writeLocation(sourceManager.getOriginalLoc(start));
+
+                auto range = sourceManager.getExpansionRange(start);
+                writeLocation(range.start());
+                writeLocation(range.end());
+
+                bool isMacroArg = sourceManager.isMacroArgLoc(start);
+                body.byte(isMacroArg ? 1 : 0);
+                if (!isMacroArg)
+                    writeString(sourceManager.getMacroName(start));
+                continue;
+            }
+
+            auto text = getBufferText(buffer);
+            auto includedFrom = sourceManager.getIncludedFrom(buffer);
+            auto& fullPath = sourceManager.getFullPath(buffer);
+            if (!isFile(fullPath)) {
+                body.byte(uint8_t(BufferKind::Text));
+                writeLocation(includedFrom);
+                writeString(text);
+            }
+            else {
+                if (includedFrom) {
+                    // Record how the file was named in the include directive so that
+                    // the include search can be repeated when the tree is loaded.
+                    body.byte(uint8_t(BufferKind::Include));
+                    writeLocation(includedFrom);
+
+                    auto it = includeDirectives.find(includedFrom);
+                    auto name = it == includeDirectives.end() ? ""sv
+                                                              : it->second->fileName.valueText();
+                    if (name.length() >= 3) {
+                        body.byte(name[0] == '<' ? 1 : 0);
+                        writeString(name.substr(1, name.length() - 2));
+                    }
+                    else {
+                        body.byte(0);
+                        writeString(getU8Str(fullPath));
+                    }
+                }
+                else {
+                    body.byte(uint8_t(BufferKind::Source));
+                }
+
+                writeString(getU8Str(fullPath));
+                body.varint(text.size());
+                body.fixed(hashText(text));
+            }
+
+            auto lineDirectives = sourceManager.getLineDirectives(buffer);
+            body.varint(lineDirectives.size());
+            for (auto& ld : lineDirectives) {
+                writeString(std::move(ld.name));
+                body.varint(ld.lineInFile);
+                body.varint(ld.lineOfDirective);
+                body.byte(ld.level);
+            }
+
+            auto& directives = diagDirectives[buffer];
+            body.varint(directives.size());
+            for (auto& dd : directives) {
+                writeString(dd.name);
+                body.varint(dd.offset);
+                body.byte(uint8_t(dd.severity));
+            }
+        }
+    }
+
+    const SourceManager& sourceManager;
+    ByteWriter body;
+
+    std::vector<std::string_view> strings;
+    flat_hash_map<std::string_view, uint32_t> stringIndices;
+    std::deque<std::string> ownedStrings;
+
+    std::vector<BufferID> buffers;
+    flat_hash_map<BufferID, uint32_t> bufferIndices;
+    flat_hash_map<BufferID, std::string_view> bufferTexts;
+
+    flat_hash_map<const SyntaxNode*, uint32_t> nodeIndices;
+    uint32_t nodeCount = 0;
+
+    flat_hash_map<SourceLocation, const IncludeDirectiveSyntax*> includeDirectives;
+};
+
+class TreeReader : public detail::SyntaxReader {
+public:
+    struct PendingDirectives {
+        BufferID buffer;
+        std::vector<SourceManager::LineDirectiveInfo> lineDirectives;
+        std::vector<SourceManager::DiagnosticDirectiveInfo> diagDirectives;
+    };
+
+    ByteReader in;
+    std::vector<PendingDirectives> pendingDirectives;
+
+    TreeReader(std::span<const char> data, BumpAllocator& alloc, SourceManager& sourceManager) :
+        SyntaxReader(alloc), in(data), sourceManager(sourceManager) {}
+
+    bool readHeader() {
+        auto magic = in.raw(sizeof(Magic));
+        if (!magic || memcmp(magic, Magic, sizeof(Magic)) != 0)
+            return false;
+
+        if (in.varint() != SyntaxSerializer::FormatVersion ||
+            in.fixed<uint64_t>() != SyntaxSerializer::getFormatHash()) {
+            return false;
+        }
+
+        auto checksum = in.fixed<uint64_t>();
+        return !in.failed && checksum == hashText({in.ptr, in.remaining()});
+    }
+
+    bool readStrings() {
+        // The whole table is copied into the tree's allocator in one go
+        // and the strings are views into that copy.
+        size_t size = in.varint();
+        auto data = in.raw(size);
+        if (!data)
+            return false;
+
+        auto copy = (char*)alloc.allocate(size, 1);
+        memcpy(copy, data, size);
+
+        ByteReader table({copy, size});
+        size_t count = table.varint();
+        if (count > size)
+            return false;
+
+        strings.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            size_t len = table.varint();
+            auto str = table.raw(len);
+            if (!str)
+                return false;
+            strings.emplace_back(str, len);
+        }
+        return !table.failed;
+    }
+
+    bool readBuffers(std::span<const SourceBuffer> sources, const SourceLibrary* library,
+                     std::span<const fs::path> includePaths) {
+        size_t count = this->count();
+        bufferIds.reserve(count);
+        for (size_t i = 0; i < count && !in.failed; i++) {
+            auto kind = BufferKind(in.byte());
+            if (kind == BufferKind::Expansion) {
+                auto originalLoc = location();
+                auto rangeStart = location();
+                auto rangeEnd = location();
+                bool isMacroArg = in.byte() != 0;
+
+                SourceLocation loc;
+                if (isMacroArg) {
+                    loc = sourceManager.createExpansionLoc(originalLoc, {rangeStart, rangeEnd},
+                                                           true);
+                }
+                else {
+                    loc = sourceManager.createExpansionLoc(originalLoc, {rangeStart, rangeEnd},
+                                                           string());
+                }
+
+                bufferIds.push_back(loc.buffer());
+                continue;
+            }
+
+            SourceBuffer buffer;
+            if (kind == BufferKind::Text) {
+                auto includedFrom = location();
+                buffer = sourceManager.assignText(string(), includedFrom, library);
+            }
+            else {
+                SourceLocation includedFrom;
+                std::string_view includeName;
+                bool isSystem = false;
+                if (kind == BufferKind::Include) {
+                    includedFrom = location();
+                    isSystem = in.byte() != 0;
+                    includeName = string();
+                }
+
+                fs::path fullPath(string());
+                size_t size = in.varint();
+                auto hash = in.fixed<uint64_t>();
+                if (in.failed)
+                    return false;
+
+                if (kind == BufferKind::Include) {
+                    auto result = sourceManager.readHeader(includeName, includedFrom, library,
+                                                           isSystem, includePaths);
+                    if (!result)
+                        return false;
+                    buffer = *result;
+                }
+                else {
+                    for (auto& source : sources) {
+                        if (sourceManager.getFullPath(source.id) == fullPath) {
+                            buffer = source;
+                            break;
+                        }
+                    }
+
+                    if (!buffer) {
+                        auto result = sourceManager.readSource(fullPath, library);
+                        if (!result)
+                            return false;
+                        buffer = *result;
+                    }
+                }
+
+                // The file must be found in the same place and have the same
+                // contents as when the tree was serialized.
+                auto text = sourceManager.getSourceText(buffer.id);
+                if (sourceManager.getFullPath(buffer.id) != fullPath || text.size() != size ||
+                    hashText(text) != hash) {
+                    return false;
+                }
+            }
+
+            bufferIds.push_back(buffer.id);
+            bufferTexts.emplace(buffer.id, sourceManager.getSourceText(buffer.id));
+
+            auto& pending = pendingDirectives.emplace_back();
+            pending.buffer = buffer.id;
+
+            size_t numLineDirectives = this->count();
+            for (size_t j = 0; j < numLineDirectives; j++) {
+                std::string name(string());
+                size_t lineInFile = in.varint();
+                size_t lineOfDirective = in.varint();
+                uint8_t level = in.byte();
+                pending.lineDirectives.emplace_back(std::move(name), lineInFile, lineOfDirective,
+                                                    level);
+            }
+
+            size_t numDiagDirectives = this->count();
+            for (size_t j = 0; j < numDiagDirectives; j++) {
+                auto name = string();
+                size_t offset = in.varint();
+                auto severity = DiagnosticSeverity(in.byte());
+                pending.diagDirectives.emplace_back(name, offset, severity);
+            }
+        }
+
+        return !in.failed;
+    }
+
+    void applyDirectives() {
+        for (auto& pending : pendingDirectives) {
+            if (!pending.lineDirectives.empty())
+                sourceManager.addLineDirectives(pending.buffer, pending.lineDirectives);
+
+            for (auto& dd : pending.diagDirectives)
+                sourceManager.addDiagnosticDirective(SourceLocation(pending.buffer, dd.offset),
+                                                     dd.name, dd.severity);
+        }
+    }
+
+    std::string_view string() {
+        size_t index = in.varint();
+        if (index >= strings.size()) {
+            in.failed = true;
+            return {};
+        }
+        return strings[index];
+    }
+
+    SourceLocation location() {
+        size_t index = in.varint();
+        if (index == 0) {
+            auto id = uint32_t(in.varint());
+            return SourceLocation(BufferID(id, ""sv), in.varint());
+        }
+
+        if (index > bufferIds.size()) {
+            in.failed = true;
+            return SourceLocation();
+        }
+
+        return SourceLocation(bufferIds[index - 1], in.varint());
+    }
+
+    size_t count() final {
+        // Every element takes at least one byte, which
+        // guards against bogus counts in malformed data.
+        size_t result = in.varint();
+        if (result > in.remaining()) {
+            in.failed = true;
+            return 0;
+        }
+        return result;
+    }
+
+    SyntaxNode* node() final {
+        size_t kind = in.varint();
+        if (kind == 0 || in.failed)
+            return nullptr;
+
+        size_t index = nodes.size();
+        nodes.push_back(nullptr);
+
+        auto result = detail::deserializeNode(SyntaxKind(kind - 1), *this);
+        if (!result || failed)
+            in.failed = true;
+
+        nodes[index] = result;
+        return result;
+    }
+
+    SyntaxNode* nodeRef() { return nodeRef(in.varint()); }
+
+    SyntaxNode* nodeRef(size_t index) {
+        if (index >= nodes.size() || !nodes[index]) {
+            in.failed = true;
+            return nullptr;
+        }
+        return nodes[index];
+    }
+
+    Token token() final {
+        uint8_t flags = in.byte();
+        if ((flags & TF_Valid) == 0)
+            return Token();
+
+        auto kind = TokenKind(in.varint());
+        auto loc = location();
+
+        std::span<const Trivia> trivia;
+        if (flags & TF_Trivia) {
+            size_t numTrivia = count();
+            SmallVector<Trivia> buffer(numTrivia, UninitializedTag());
+            for (size_t i = 0; i < numTrivia; i++)
+                buffer.push_back(readTrivia());
+            trivia = buffer.copy(alloc);
+        }
+
+        std::string_view rawText = LexerFacts::getTokenKindText(kind);
+        if (rawText.empty()) {
+            if (flags & TF_TextAtLocation) {
+                auto text = getBufferText(loc.buffer());
+                size_t len = in.varint();
+                if (loc.offset() + len > text.size())
+                    in.failed = true;
+                else
+                    rawText = text.substr(loc.offset(), len);
+            }
+            else {
+                rawText = string();
+            }
+        }
+
+        if (flags & TF_Missing)
+            return Token::createMissing(alloc, kind, loc).clone(alloc, trivia, rawText, loc);
+
+        switch (kind) {
+            case TokenKind::StringLiteral:
+                return Token(alloc, kind, trivia, rawText, loc, string());
+            case TokenKind::IntegerLiteral:
+                return Token(alloc, kind, trivia, rawText, loc, integer());
+            case TokenKind::RealLiteral:
+            case TokenKind::TimeLiteral: {
+                auto value = in.fixed<double>();
+                NumericTokenFlags numFlags{in.byte()};
+                std::optional<TimeUnit> unit;
+                if (kind == TokenKind::TimeLiteral)
+                    unit = numFlags.unit();
+                return Token(alloc, kind, trivia, rawText, loc, value, numFlags.outOfRange(),
+                             unit);
+            }
+            case TokenKind::IntegerBase: {
+                NumericTokenFlags numFlags{in.byte()};
+                return Token(alloc, kind, trivia, rawText, loc, numFlags.base(),
+                             numFlags.isSigned());
+            }
+            case TokenKind::UnbasedUnsizedLiteral:
+                return Token(alloc, kind, trivia, rawText, loc, logic_t(in.byte()));
+            case TokenKind::Directive:
+            case TokenKind::MacroUsage:
+                return Token(alloc, kind, trivia, rawText, loc, SyntaxKind(in.varint()));
+            default:
+                return Token(alloc, kind, trivia, rawText, loc);
+        }
+    }
+
+    SVInt integer() {
+        auto bits = bitwidth_t(in.varint());
+        uint8_t flags = in.byte();
+        if (bits == 0 || bits > SVInt::MAX_BITS) {
+            in.failed = true;
+            return SVInt::Zero;
+        }
+
+        SVIntStorage storage(bits, (flags & 1) != 0, (flags & 2) != 0);
+        const size_t numWords = ((bits + 63) / 64) * (storage.unknownFlag ? 2 : 1);
+        auto words = in.raw(sizeof(uint64_t) * numWords);
+        if (!words)
+            return SVInt::Zero;
+
+        if (storage.isInline()) {
+            memcpy(storage.inlineVal, words, sizeof(uint64_t) * numWords);
+            return SVInt(storage);
+        }
+
+        SmallVector<uint64_t> data(numWords, UninitializedTag());
+        data.resize(numWords);
+        memcpy(data.data(), words, sizeof(uint64_t) * numWords);
+
+        storage.pVal = data.data();
+        return SVInt(storage);
+    }
+
+    ParserMetadata metadata() {
+        ParserMetadata result;
+        size_t numNodes = count();
+        result.nodeMap.reserve(numNodes);
+        for (size_t i = 0; i < numNodes; i++) {
+            auto node = nodeRef();
+
+            ParserMetadata::Node info;
+            info.defaultNetType = TokenKind(in.varint());
+            info.unconnectedDrive = TokenKind(in.varint());
+            if (in.byte()) {
+                TimeScale ts;
+                ts.base.unit = TimeUnit(in.byte());
+                ts.base.magnitude = TimeScaleMagnitude(in.byte());
+                ts.precision.unit = TimeUnit(in.byte());
+                ts.precision.magnitude = TimeScaleMagnitude(in.byte());
+                info.timeScale = ts;
+            }
+            result.nodeMap.emplace(node, info);
+        }
+
+        size_t numInstances = count();
+        for (size_t i = 0; i < numInstances; i++)
+            result.globalInstances.emplace(string());
+
+        nodeRefs(result.classPackageNames);
+        nodeRefs(result.packageImports);
+        nodeRefs(result.classDecls);
+        nodeRefs(result.interfacePorts);
+        result.eofToken = token();
+
+        uint8_t flags = in.byte();
+        result.hasDefparams = (flags & 1) != 0;
+        result.hasBindDirectives = (flags & 2) != 0;
+        return result;
+    }
+
+    Diagnostic diagnostic() {
+        auto subsystem = DiagSubsystem(in.varint());
+        auto code = uint16_t(in.varint());
+        Diagnostic diag(DiagCode(subsystem, code), location());
+
+        size_t numArgs = count();
+        for (size_t i = 0; i < numArgs && !in.failed; i++) {
+            switch (ArgKind(in.byte())) {
+                case ArgKind::String:
+                    diag.args.emplace_back(std::string(string()));
+                    break;
+                case ArgKind::SignedInt:
+                    diag.args.emplace_back(in.fixed<int64_t>());
+                    break;
+                case ArgKind::UnsignedInt:
+                    diag.args.emplace_back(uint64_t(in.varint()));
+                    break;
+                case ArgKind::Char:
+                    diag.args.emplace_back(char(in.byte()));
+                    break;
+                case ArgKind::Integer:
+                    diag.args.emplace_back(ConstantValue(integer()));
+                    break;
+                case ArgKind::Real:
+                    diag.args.emplace_back(ConstantValue(real_t(in.fixed<double>())));
+                    break;
+                default:
+                    in.failed = true;
+                    break;
+            }
+        }
+
+        size_t numRanges = count();
+        for (size_t i = 0; i < numRanges; i++) {
+            auto start = location();
+            diag.ranges.emplace_back(start, location());
+        }
+
+        size_t numNotes = count();
+        for (size_t i = 0; i < numNotes && !in.failed; i++)
+            diag.notes.emplace_back(diagnostic());
+
+        if (in.byte())
+            diag.coalesceCount = in.varint();
+
+        return diag;
+    }
+
+private:
+    Trivia readTrivia() {
+        auto kind = TriviaKind(in.byte());
+        switch (kind) {
+            case TriviaKind::Directive:
+            case TriviaKind::SkippedSyntax: {
+                auto syntax = node();
+                if (!syntax) {
+                    in.failed = true;
+                    return Trivia();
+                }
+                return Trivia(kind, syntax);
+            }
+            case TriviaKind::SkippedTokens: {
+                size_t numTokens = count();
+                SmallVector<Token> buffer(numTokens, UninitializedTag());
+                for (size_t i = 0; i < numTokens; i++)
+                    buffer.push_back(token());
+                return Trivia(kind, buffer.copy(alloc));
+            }
+            default: {
+                Trivia result(kind, string());
+                if (in.byte())
+                    result = result.withLocation(alloc, location());
+                return result;
+            }
+        }
+    }
+
+    template<typename T>
+    void nodeRefs(std::vector<const T*>& results) {
+        size_t size = count();
+        results.reserve(size);
+        for (size_t i = 0; i < size; i++) {
+            auto node = nodeRef();
+            if (!node || !T::isKind(node->kind)) {
+                in.failed = true;
+                return;
+            }
+            results.push_back(&node->as<T>());
+        }
+    }
+
+    std::string_view getBufferText(BufferID buffer) {
+        auto it = bufferTexts.find(buffer);
+        return it == bufferTexts.end() ? ""sv : it->second;
+    }
+
+    SourceManager& sourceManager;
+    std::vector<std::string_view> strings;
+    std::vector<BufferID> bufferIds;
+    flat_hash_map<BufferID, std::string_view> bufferTexts;
+    std::vector<SyntaxNode*> nodes;
+};
+
+} // namespace
+
+uint64_t SyntaxSerializer::getFormatHash() {
+    static const uint64_t result = [] {
+        std::string text = std::to_string(FormatVersion);
+        text += ':' + std::to_string(detail::getSyntaxSchemaHash());
+        text += ':' + std::to_string(VersionInfo::getMajor());
+        text += '.' + std::to_string(VersionInfo::getMinor());
+        text += '.' + std::to_string(VersionInfo::getPatch());
+        text += '+';
+        text += VersionInfo::getHash();
+        return hashText(text);
+    }();
+    return result;
+}
+
+std::optional<std::vector<char>> SyntaxSerializer::serialize(const SyntaxTree& tree) {
+    TreeWriter writer(tree.sourceManager());
+    auto result = writer.write(tree);
+    if (writer.failed)
+        return std::nullopt;
+    return result;
+}
+
+std::shared_ptr<SyntaxTree> SyntaxSerializer::deserialize(std::span<const char> data,
+                                                          SourceManager& sourceManager,
+                                                          std::span<const SourceBuffer> buffers,
+                                                          const Bag& options) {
+    const SourceLibrary* library = buffers.empty() ? nullptr : buffers[0].library;
+    return deserialize(data, sourceManager, buffers, library, options);
+}
+
+std::shared_ptr<SyntaxTree> SyntaxSerializer::deserialize(std::span<const char> data,
+                                                          SourceManager& sourceManager,
+                                                          std::span<const SourceBuffer> buffers,
+                                                          const SourceLibrary* library,
+                                                          const Bag& options) {
+    BumpAllocator alloc;
+    TreeReader reader(data, alloc, sourceManager);
+    if (!reader.readHeader() || !reader.readStrings())
+        return nullptr;
+
+    auto ppOptions = options.getOrDefault<PreprocessorOptions>();
+    if (!reader.readBuffers(buffers, library, ppOptions.additionalIncludePaths))
+        return nullptr;
+
+    auto root = reader.node();
+    if (!root || reader.in.failed)
+        return nullptr;
+
+    std::vector<const DefineDirectiveSyntax*> macros;
+    size_t numMacros = reader.count();
+    macros.reserve(numMacros);
+    for (size_t i = 0; i < numMacros; i++) {
+        auto index = reader.in.varint();
+        auto macro = index ? reader.nodeRef(index - 1) : reader.node();
+        if (!macro || macro->kind != SyntaxKind::DefineDirective)
+            return nullptr;
+        macros.push_back(&macro->as<DefineDirectiveSyntax>());
+    }
+
+    auto metadata = reader.metadata();
+
+    Diagnostics diagnostics;
+    size_t numDiags = reader.count();
+    for (size_t i = 0; i < numDiags && !reader.in.failed; i++)
+        diagnostics.emplace_back(reader.diagnostic());
+
+    if (reader.in.failed || reader.in.remaining() != 0)
+        return nullptr;
+
+    reader.applyDirectives();
+
+    return std::shared_ptr<SyntaxTree>(new SyntaxTree(root, library, sourceManager,
+                                                      std::move(alloc), std::move(diagnostics),
+                                                      std::move(metadata), std::move(macros),
+                                                      options));
+}
+
+std::error_code SyntaxSerializer::writeFile(const fs::path& path,
+                                            std::span<const std::shared_ptr<SyntaxTree>> trees) {
+    ByteWriter writer;
+    writer.raw(FileMagic, sizeof(FileMagic));
+    writer.varint(FormatVersion);
+    writer.fixed(getFormatHash());
+    writer.varint(trees.size());
+
+    for (auto& tree : trees) {
+        auto data = serialize(*tree);
+        if (!data)
+            return make_error_code(std::errc::not_supported);
+
+        auto library = tree->getSourceLibrary();
+        std::string_view libraryName = library && !library->isDefault ? library->name : ""sv;
+
+        writer.byte(tree->isLibraryUnit ? 1 : 0);
+        writer.varint(libraryName.size());
+        writer.raw(libraryName.data(), libraryName.size());
+        writer.varint(data->size());
+        writer.raw(data->data(), data->size());
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return std::error_code(errno, std::generic_category());
+
+    file.write(writer.data.data(), std::streamsize(writer.data.size()));
+    file.flush();
+    if (!file)
+        return make_error_code(std::errc::io_error);
+
+    return {};
+}
+
+std::error_code SyntaxSerializer::readFile(const fs::path& path, SourceManager& sourceManager,
+                                           std::vector<std::shared_ptr<SyntaxTree>>& results,
+                                           const Bag& options,
+                                           function_ref<const SourceLibrary*(std::string_view)>
+                                               getLibrary) {
+    // Files that can't be mapped get read into memory instead. Either way
+    // the contents are followed by a null terminator that isn't part of the data.
+    MappedFile mapping;
+    SmallVector<char> buffer;
+    std::span<const char> data;
+    if (auto ec = OS::mapFile(path, mapping); !ec) {
+        data = {mapping.data(), mapping.size() - 1};
+    }
+    else if (ec == std::errc::not_supported) {
+        ec = OS::readFile(path, buffer);
+        if (ec)
+            return ec;
+        data = {buffer.data(), buffer.size() - 1};
+    }
+    else {
+        return ec;
+    }
+
+    ByteReader reader(data);
+    auto magic = reader.raw(sizeof(FileMagic));
+    if (!magic || memcmp(magic, FileMagic, sizeof(FileMagic)) != 0 ||
+        reader.varint() != FormatVersion || reader.fixed<uint64_t>() != getFormatHash()) {
+        return make_error_code(std::errc::invalid_argument);
+    }
+
+    std::vector<std::shared_ptr<SyntaxTree>> trees;
+    size_t count = reader.varint();
+    for (size_t i = 0; i < count && !reader.failed; i++) {
+        bool isLibraryUnit = reader.byte() != 0;
+        size_t nameLength = reader.varint();
+        auto libraryName = reader.raw(nameLength);
+        size_t size = reader.varint();
+        auto treeData = reader.raw(size);
+        if (!libraryName || !treeData)
+            break;
+
+        const SourceLibrary* library = nullptr;
+        if (nameLength) {
+            if (getLibrary)
+                library = getLibrary({libraryName, nameLength});
+            if (!library)
+                return make_error_code(std::errc::invalid_argument);
+        }
+
+        auto tree = deserialize({treeData, size}, sourceManager, {}, library, options);
+        if (!tree)
+            return make_error_code(std::errc::invalid_argument);
+
+        tree->isLibraryUnit = isLibraryUnit;
+        trees.emplace_back(std::move(tree));
+    }
+
+    if (reader.failed || reader.remaining() != 0)
+        return make_error_code(std::errc::invalid_argument);
+
+    results.insert(results.end(), trees.begin(), trees.end());
+    return {};
+}
+
+} // namespace slang::syntax
@@ -10,13 +10,64 @@
 #include "slang/parsing/Parser.h"
 #include "slang/parsing/ParserMetadata.h"
 #include "slang/parsing/Preprocessor.h"
+#include "slang/syntax/AllSyntax.h"
 #include "slang/text/SourceManager.h"
+#include "slang/util/ThreadPool.h"
 #include "slang/util/TimeTrace.h"
 
 namespace slang::syntax {
 
 using namespace parsing;
 
+namespace {
+
+// The number of rounds of re-parsing to try when parsing a unit in parallel
+// before giving up and parsing the remainder of it sequentially.
+constexpr int MaxSpeculationRounds = 4;
+
+// The results of parsing a run of buffers from a compilation unit
+// independently of the rest of the unit.
+struct UnitPiece {
+    BumpAllocator alloc;
+    Diagnostics diagnostics;
+    CompilationUnitSyntax* root = nullptr;
+    ParserMetadata metadata;
+    PreprocessorUnitTrace trace;
+
+    bool hasErrors() const {
+        return std::ranges::any_of(diagnostics, [](auto& diag) { return diag.isError(); });
+    }
+};
+
+std::unique_ptr<UnitPiece> parseUnitPiece(SourceManager& sourceManager,
+                                          std::span<const SourceBuffer> buffers,
+                                          const Bag& options, const PreprocessorUnitState& state) {
+    TimeTraceScope timeScope("parseFile"sv, [&] {
+        if (buffers.size() == 1)
+            return std::string(sourceManager.getRawFileName(buffers[0].id));
+        else
+            return "<multi-buffer>"s;
+    });
+
+    auto piece = std::make_unique<UnitPiece>();
+    Preprocessor preprocessor(sourceManager, piece->alloc, piece->diagnostics, options);
+
+    // Any problems with predefined macros were already reported
+    // when the initial state of the unit was computed.
+    piece->diagnostics.clear();
+    preprocessor.setUnitState(state, &piece->trace);
+
+    for (auto it = buffers.rbegin(); it != buffers.rend(); it++)
+        preprocessor.pushSource(*it);
+
+    Parser parser(preprocessor, options);
+    piece->root = &parser.parseCompilationUnit();
+    piece->metadata = parser.getMetadata();
+    return piece;
+}
+
+} // namespace
+
 SyntaxTree::SyntaxTree(SyntaxNode* root, SourceManager& sourceManager, BumpAllocator&& alloc,
                        const SourceLibrary* library, std::shared_ptr<SyntaxTree> parent) :
     rootNode(root), library(library), sourceMan(sourceManager), alloc(std::move(alloc)) {
@@ -116,6 +167,183 @@ std::shared_ptr<SyntaxTree> SyntaxTree::fromBuffers(std::span<const SourceBuffer
     return create(sourceManager, buffers, options, inheritedMacros, false);
 }
 
+std::shared_ptr<SyntaxTree> SyntaxTree::fromBuffersParallel(std::span<const SourceBuffer> buffers,
+                                                            SourceManager& sourceManager,
+                                                            ThreadPool& threadPool,
+                                                            const Bag& options,
+                                                            MacroList inheritedMacros) {
+    if (buffers.size() < 2 || threadPool.getThreadCount() < 2)
+        return create(sourceManager, buffers, options, inheritedMacros, false);
+
+    const SourceLibrary* library = buffers[0].library;
+    for (auto& buffer : buffers) {
+        if (buffer.library != library) {
+            SLANG_THROW(std::invalid_argument("All sources provided to a single SyntaxTree must be "
+                                              "from the same source library"));
+        }
+    }
+
+    // This preprocessor never sees any source text; it establishes the state at
+    // the start of the unit and owns the built-in macros of the final tree.
+    BumpAllocator alloc;
+    Diagnostics diagnostics;
+    Preprocessor preprocessor(sourceManager, alloc, diagnostics, options, inheritedMacros);
+    const auto initialState = preprocessor.getUnitState();
+
+    auto parseSequentially = [&] {
+        for (auto& buffer : buffers)
+            sourceManager.clearDirectives(buffer.id);
+        return create(sourceManager, buffers, options, inheritedMacros, false);
+    };
+
+    // Start by parsing every buffer on its own, guessing that none of
+    // them change any state that would affect the others.
+    std::vector<std::unique_ptr<UnitPiece>> pieces(buffers.size());
+    threadPool.pushLoop(
+        size_t(0), buffers.size(),
+        [&](size_t start, size_t end) {
+            for (size_t i = start; i < end; i++) {
+                pieces[i] = parseUnitPiece(sourceManager, buffers.subspan(i, 1), options,
+                                           initialState);
+            }
+        },
+        buffers.size());
+    threadPool.waitForAll();
+
+    // Walk the pieces in order to find the ones that were parsed with the wrong
+    // incoming state and parse them again with what we now know about the state
+    // flowing into them. The first wrong piece always gets the correct state, so
+    // each round makes progress; after a few rounds we stop guessing and parse
+    // everything from that point on in one go.
+    std::vector<std::unique_ptr<UnitPiece>> discarded;
+    for (int round = 1;; round++) {
+        std::vector<std::pair<size_t, PreprocessorUnitState>> retries;
+        auto state = initialState;
+        for (size_t i = 0; i < pieces.size(); i++) {
+            auto& trace = pieces[i]->trace;
+            if (trace.hasOpenState && i + 1 < pieces.size())
+                return parseSequentially();
+
+            if (!trace.isValidFor(state))
+                retries.emplace_back(i, state);
+            trace.applyTo(state);
+        }
+
+        if (retries.empty())
+            break;
+
+        if (round == MaxSpeculationRounds) {
+            const size_t first = retries[0].first;
+            for (size_t i = first; i < pieces.size(); i++) {
+                sourceManager.clearDirectives(buffers[i].id);
+                discarded.emplace_back(std::move(pieces[i]));
+            }
+
+            pieces.resize(first);
+            pieces.emplace_back(parseUnitPiece(sourceManager, buffers.subspan(first), options,
+                                               retries[0].second));
+            break;
+        }
+
+        for (auto& [index, _] : retries) {
+            sourceManager.clearDirectives(buffers[index].id);
+            discarded.emplace_back(std::move(pieces[index]));
+        }
+
+        threadPool.pushLoop(
+            size_t(0), retries.size(),
+            [&](size_t start, size_t end) {
+                for (size_t i = start; i < end; i++) {
+                    auto& [index, incoming] = retries[i];
+                    pieces[index] = parseUnitPiece(sourceManager, buffers.subspan(index, 1),
+                                                   options, incoming);
+                }
+            },
+            retries.size());
+        threadPool.waitForAll();
+    }
+
+    // A piece that ends in the middle of a broken construct might have parsed
+    // differently when joined with the piece that follows it, so leave anything
+    // with errors to the sequential parser.
+    if (std::ranges::any_of(pieces, [](auto& piece) { return piece->hasErrors(); }))
+        return parseSequentially();
+
+    // Stitch the pieces together into a single compilation unit. Trivia at the end
+    // of each piece is attached to the first token of the next one, which mirrors
+    // what the preprocessor does when moving from one buffer to the next.
+    SmallVector<MemberSyntax*> members;
+    SmallVector<Trivia, 8> pendingTrivia;
+    ParserMetadata metadata;
+    auto state = initialState;
+    Token eof;
+
+    auto attachPendingTrivia = [&](Token& token) {
+        SmallVector<Trivia, 8> trivia;
+        trivia.append_range(pendingTrivia);
+        trivia.append_range(token.trivia());
+        if (trivia.empty() || trivia.back().kind != TriviaKind::EndOfLine)
+            trivia.push_back(Trivia(TriviaKind::EndOfLine, ""sv));
+
+        token = token.withTrivia(alloc, trivia.copy(alloc));
+        pendingTrivia.clear();
+    };
+
+    for (size_t i = 0; i < pieces.size(); i++) {
+        auto& piece = *pieces[i];
+        auto& root = *piece.root;
+        if (i > 0 && !root.members.empty()) {
+            if (auto token = root.members[0]->getFirstTokenPtr())
+                attachPendingTrivia(*token);
+        }
+        members.append_range(root.members);
+
+        eof = root.endOfFile;
+        if (i + 1 < pieces.size()) {
+            for (auto& trivia : eof.trivia())
+                pendingTrivia.push_back(trivia.withLocation(alloc, eof.location()));
+        }
+        else if (i > 0) {
+            attachPendingTrivia(eof);
+        }
+
+        auto& meta = piece.metadata;
+        metadata.nodeMap.insert(meta.nodeMap.begin(), meta.nodeMap.end());
+        metadata.globalInstances.insert(meta.globalInstances.begin(), meta.globalInstances.end());
+        metadata.classPackageNames.insert(metadata.classPackageNames.end(),
+                                          meta.classPackageNames.begin(),
+                                          meta.classPackageNames.end());
+        metadata.packageImports.insert(metadata.packageImports.end(), meta.packageImports.begin(),
+                                       meta.packageImports.end());
+        metadata.classDecls.insert(metadata.classDecls.end(), meta.classDecls.begin(),
+                                   meta.classDecls.end());
+        metadata.interfacePorts.insert(metadata.interfacePorts.end(), meta.interfacePorts.begin(),
+                                       meta.interfacePorts.end());
+        metadata.hasDefparams |= meta.hasDefparams;
+        metadata.hasBindDirectives |= meta.hasBindDirectives;
+
+        piece.trace.applyTo(state);
+        diagnostics.append_range(piece.diagnostics);
+        alloc.steal(std::move(piece.alloc));
+    }
+
+    // Pieces that were thrown away can still own macro definitions
+    // that the kept pieces refer to, so their memory has to live on.
+    for (auto& piece : discarded)
+        alloc.steal(std::move(piece->alloc));
+
+    metadata.eofToken = eof;
+    auto root = alloc.emplace<CompilationUnitSyntax>(members.copy(alloc), eof);
+
+    preprocessor.setUnitState(state);
+    auto macros = preprocessor.getDefinedMacros();
+
+    return std::shared_ptr<SyntaxTree>(new SyntaxTree(root, library, sourceManager,
+                                                      std::move(alloc), std::move(diagnostics),
+                                                      std::move(metadata), std::move(macros),
+                                                      options));
+}
+
 SourceManager& SyntaxTree::getDefaultSourceManager() {
     static SourceManager instance;
     return instance;
@@ -8,10 +8,16 @@
 #include "slang/text/CharInfo.h"
 
 #include <algorithm>
+#include <bit>
 #include <span>
 
+#include "slang/util/CpuFeatures.h"
 #include "slang/util/Util.h"
 
+#if defined(SLANG_SIMD_X86)
+#    include <immintrin.h>
+#endif
+
 namespace slang {
 
 struct UnicodeCharRange {
@@ -325,4 +331,241 @@ int charWidthUnicode(uint32_t c) {
     return 1;
 }
 
+static constexpr bool isHorizontalWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\v' || c == '\f';
+}
+
+static constexpr bool isIdentifierChar(char c) {
+    return isAlphaNumeric(c) || c == '_' || c == '$';
+}
+
+static constexpr bool isLineCommentBreak(char c) {
+    return !isASCII(c) || c == '\n' || c == '\r' || c == '\0';
+}
+
+static constexpr bool isBlockCommentBreak(char c) {
+    return !isASCII(c) || c == '*' || c == '/' || c == '\0';
+}
+
+static constexpr bool isInactiveTextBreak(char c) {
+    auto u = static_cast<unsigned char>(c);
+    return u >= 0x7f || (u < 0x20 && (u < '\t' || u > '\r')) || c == '`' || c == '"' ||
+           c == '/' || c == '\\';
+}
+
+#if defined(SLANG_SIMD_X86)
+
+// Each of the "stop mask" functions below looks at a full vector's worth of
+// characters and returns a bitmask with a bit set for each position at which
+// the corresponding scan should stop. The scan loops then use the lowest set
+// bit to find the stopping point.
+
+static inline uint32_t wsStopMaskSSE2(const char* ptr) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    __m128i ws = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\v')),
+                     _mm_cmpeq_epi8(v, _mm_set1_epi8('\f'))));
+    return ~uint32_t(_mm_movemask_epi8(ws)) & 0xffff;
+}
+
+static inline uint32_t identStopMaskSSE2(const char* ptr) {
+    // Non-ASCII bytes are negative when treated as signed and so
+    // fail all of the range checks below, as desired.
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                  _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                  _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    __m128i other = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('_')),
+                                 _mm_cmpeq_epi8(v, _mm_set1_epi8('$')));
+    __m128i ident = _mm_or_si128(_mm_or_si128(alpha, digit), other);
+    return ~uint32_t(_mm_movemask_epi8(ident)) & 0xffff;
+}
+
+static inline uint32_t lineCommentStopMaskSSE2(const char* ptr) {
+    // Including the raw bytes in the final mask picks up the
+    // high bit of any non-ASCII characters.
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    __m128i stop = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))),
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_setzero_si128()), v));
+    return uint32_t(_mm_movemask_epi8(stop));
+}
+
+static inline uint32_t inactiveTextStopMaskSSE2(const char* ptr) {
+    // Non-ASCII bytes are negative when treated as signed, so they get picked up
+    // along with the control characters. Tab through carriage return are the
+    // whitespace characters that are allowed through.
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    __m128i ws = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('\t' - 1)),
+                               _mm_cmplt_epi8(v, _mm_set1_epi8('\r' + 1)));
+    __m128i ctrl = _mm_andnot_si128(ws, _mm_cmplt_epi8(v, _mm_set1_epi8(0x20)));
+    __m128i stop = _mm_or_si128(
+        _mm_or_si128(_mm_or_si128(ctrl, _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7f))),
+                     _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('`')),
+                                  _mm_cmpeq_epi8(v, _mm_set1_epi8('"')))),
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('/')),
+                     _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))));
+    return uint32_t(_mm_movemask_epi8(stop));
+}
+
+static inline uint32_t newlineStopMaskSSE2(const char* ptr) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')),
+                                _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+    return uint32_t(_mm_movemask_epi8(stop));
+}
+
+static inline uint32_t blockCommentStopMaskSSE2(const char* ptr) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    __m128i stop = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('*')), _mm_cmpeq_epi8(v, _mm_set1_epi8('/'))),
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_setzero_si128()), v));
+    return uint32_t(_mm_movemask_epi8(stop));
+}
+
+SLANG_TARGET_AVX2 static inline uint32_t wsStopMaskAVX2(const char* ptr) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+    __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                                                 _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+                                 _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\v')),
+                                                 _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\f'))));
+    return ~uint32_t(_mm256_movemask_epi8(ws));
+}
+
+SLANG_TARGET_AVX2 static inline uint32_t identStopMaskAVX2(const char* ptr) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                     _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+    __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                                     _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+    __m256i other = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')),
+                                    _mm256_cmpeq_epi8(v, _mm256_set1_epi8('$')));
+    __m256i ident = _mm256_or_si256(_mm256_or_si256(alpha, digit), other);
+    return ~uint32_t(_mm256_movemask_epi8(ident));
+}
+
+SLANG_TARGET_AVX2 static inline uint32_t lineCommentStopMaskAVX2(const char* ptr) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+    __m256i stop = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+                                                   _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))),
+                                   _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_setzero_si256()),
+                                                   v));
+    return uint32_t(_mm256_movemask_epi8(stop));
+}
+
+SLANG_TARGET_AVX2 static inline uint32_t inactiveTextStopMaskAVX2(const char* ptr) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+    __m256i ws = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('\t' - 1)),
+                                  _mm256_cmpgt_epi8(_mm256_set1_epi8('\r' + 1), v));
+    __m256i ctrl = _mm256_andnot_si256(ws, _mm256_cmpgt_epi8(_mm256_set1_epi8(0x20), v));
+    __m256i stop = _mm256_or_si256(
+        _mm256_or_si256(_mm256_or_si256(ctrl, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7f))),
+                        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('`')),
+                                        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('/')),
+                        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))));
+    return uint32_t(_mm256_movemask_epi8(stop));
+}
+
+SLANG_TARGET_AVX2 static inline uint32_t newlineStopMaskAVX2(const char* ptr) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+    __m256i stop = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+                                   _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')));
+    return uint32_t(_mm256_movemask_epi8(stop));
+}
+
+SLANG_TARGET_AVX2 static inline uint32_t blockCommentStopMaskAVX2(const char* ptr) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+    __m256i stop = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('*')),
+                                                   _mm256_cmpeq_epi8(v, _mm256_set1_epi8('/'))),
+                                   _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_setzero_si256()),
+                                                   v));
+    return uint32_t(_mm256_movemask_epi8(stop));
+}
+
+template<uint32_t (*StopMask)(const char*)>
+static const char* scanSSE2(const char* ptr, const char* end) {
+    while (end - ptr >= 16) {
+        if (uint32_t mask = StopMask(ptr))
+            return ptr + std::countr_zero(mask);
+        ptr += 16;
+    }
+    return ptr;
+}
+
+template<uint32_t (*StopMask)(const char*)>
+SLANG_TARGET_AVX2 static const char* scanAVX2(const char* ptr, const char* end) {
+    while (end - ptr >= 32) {
+        if (uint32_t mask = StopMask(ptr))
+            return ptr + std::countr_zero(mask);
+        ptr += 32;
+    }
+    return ptr;
+}
+
+#    define SCAN_VECTORIZED(ptr, end, name)                      \
+        switch (getSimdLevel()) {                                \
+            case SimdLevel::AVX2:                                \
+                ptr = scanAVX2<name##StopMaskAVX2>(ptr, end);    \
+                break;                                           \
+            case SimdLevel::SSE2:                                \
+                ptr = scanSSE2<name##StopMaskSSE2>(ptr, end);    \
+                break;                                           \
+            default:                                             \
+                break;                                           \
+        }
+#else
+#    define SCAN_VECTORIZED(ptr, end, name)
+#endif
+
+// Note that the vectorized scanners always stop at the first matching
+// character, so the scalar loops only have to handle the tail of the
+// range that was too short to fill a full vector.
+
+const char* skipHorizontalWhitespace(const char* ptr, const char* end) {
+    SCAN_VECTORIZED(ptr, end, ws)
+    while (ptr != end && isHorizontalWhitespace(*ptr))
+        ptr++;
+    return ptr;
+}
+
+const char* skipIdentifierChars(const char* ptr, const char* end) {
+    SCAN_VECTORIZED(ptr, end, ident)
+    while (ptr != end && isIdentifierChar(*ptr))
+        ptr++;
+    return ptr;
+}
+
+const char* findLineCommentBreak(const char* ptr, const char* end) {
+    SCAN_VECTORIZED(ptr, end, lineComment)
+    while (ptr != end && !isLineCommentBreak(*ptr))
+        ptr++;
+    return ptr;
+}
+
+const char* findBlockCommentBreak(const char* ptr, const char* end) {
+    SCAN_VECTORIZED(ptr, end, blockComment)
+    while (ptr != end && !isBlockCommentBreak(*ptr))
+        ptr++;
+    return ptr;
+}
+
+const char* findInactiveTextBreak(const char* ptr, const char* end) {
+    SCAN_VECTORIZED(ptr, end, inactiveText)
+    while (ptr != end && !isInactiveTextBreak(*ptr))
+        ptr++;
+    return ptr;
+}
+
+const char* findNewline(const char* ptr, const char* end) {
+    SCAN_VECTORIZED(ptr, end, newline)
+    while (ptr != end && *ptr != '\n' && *ptr != '\r')
+        ptr++;
+    return ptr;
+}
+
 } // namespace slang
@@ -9,6 +9,7 @@
 
 #include <string>
 
+#include "slang/text/CharInfo.h"
 #include "slang/text/Glob.h"
 #include "slang/util/OS.h"
 #include "slang/util/String.h"
@@ -30,9 +31,15 @@ std::error_code SourceManager::addSystemDirectories(std::string_view pattern) {
     std::error_code ec;
     svGlob({}, pattern, GlobMode::Directories, dirs, /* expandEnvVars */ false, ec);
 
-    // Note: locking the separate mutex for include dirs here.
+    // Note: locking the separate mutex for include dirs here. Directories that
+    // are already in the list are skipped; they can't change the result of a lookup
+    // and would otherwise pile up when a long-lived source manager gets the same
+    // options applied more than once.
     std::unique_lock lock(includeDirMutex);
-    systemDirectories.insert(systemDirectories.end(), dirs.begin(), dirs.end());
+    for (auto& dir : dirs) {
+        if (std::ranges::find(systemDirectories, dir) == systemDirectories.end())
+            systemDirectories.emplace_back(std::move(dir));
+    }
     return ec;
 }
 
@@ -41,9 +48,13 @@ std::error_code SourceManager::addUserDirectories(std::string_view pattern) {
     std::error_code ec;
     svGlob({}, pattern, GlobMode::Directories, dirs, /* expandEnvVars */ false, ec);
 
-    // Note: locking the separate mutex for include dirs here.
+    // Note: locking the separate mutex for include dirs here,
+    // and skipping duplicates the same as for system directories.
     std::unique_lock lock(includeDirMutex);
-    userDirectories.insert(userDirectories.end(), dirs.begin(), dirs.end());
+    for (auto& dir : dirs) {
+        if (std::ranges::find(userDirectories, dir) == userDirectories.end())
+            userDirectories.emplace_back(std::move(dir));
+    }
     return ec;
 }
 
@@ -63,6 +74,21 @@ size_t SourceManager::getLineNumber(SourceLocation location) const {
         return lineDirective->lineOfDirective + (rawLineNumber - lineDirective->lineInFile) - 1;
 }
 
+void SourceManager::precomputeLineOffsets(BufferID buffer) const {
+    FileData* fd;
+    {
+        std::shared_lock lock(mutex);
+        auto info = getFileInfo(buffer, lock);
+        if (!info || !info->data)
+            return;
+
+        fd = info->data;
+    }
+
+    // File data is never freed, so there's no need to hold the lock.
+    fd->getLineOffsets();
+}
+
 size_t SourceManager::getColumnNumber(SourceLocation location) const {
     std::shared_lock lock(mutex);
     auto info = getFileInfo(location.buffer(), lock);
@@ -72,8 +98,8 @@ size_t SourceManager::getColumnNumber(SourceLocation location) const {
     // walk backward to find start of line
     auto fd = info->data;
     size_t lineStart = location.offset();
-    SLANG_ASSERT(lineStart < fd->mem.size());
-    while (lineStart > 0 && fd->mem[lineStart - 1] != '\n' && fd->mem[lineStart - 1] != '\r')
+    SLANG_ASSERT(lineStart < fd->text.size());
+    while (lineStart > 0 && fd->text[lineStart - 1] != '\n' && fd->text[lineStart - 1] != '\r')
         lineStart--;
 
     return location.offset() - lineStart + 1;
@@ -210,8 +236,7 @@ std::string_view SourceManager::getSourceText(BufferID buffer) const {
     if (!info || !info->data)
         return "";
 
-    auto fd = info->data;
-    return std::string_view(fd->mem.data(), fd->mem.size());
+    return info->data->text;
 }
 
 uint64_t SourceManager::getSortKey(BufferID buffer) const {
@@ -390,6 +415,28 @@ void SourceManager::addDiagnosticDirective(SourceLocation location, std::string_
     }
 }
 
+void SourceManager::clearDirectives(BufferID buffer) {
+    std::unique_lock lock(mutex);
+    if (FileInfo* info = getFileInfo(buffer, lock))
+        info->lineDirectives.clear();
+    diagDirectives.erase(buffer);
+}
+
+std::vector<SourceManager::LineDirectiveInfo> SourceManager::getLineDirectives(
+    BufferID buffer) const {
+    std::shared_lock lock(mutex);
+    if (const FileInfo* info = getFileInfo(buffer, lock))
+        return info->lineDirectives;
+    return {};
+}
+
+void SourceManager::addLineDirectives(BufferID buffer,
+                                      std::span<const LineDirectiveInfo> directives) {
+    std::unique_lock lock(mutex);
+    if (FileInfo* info = getFileInfo(buffer, lock))
+        info->lineDirectives.insert(info->lineDirectives.end(), directives.begin(), directives.end());
+}
+
 std::span<const SourceManager::DiagnosticDirectiveInfo> SourceManager::getDiagnosticDirectives(
     BufferID buffer) const {
     if (auto it = diagDirectives.find(buffer); it != diagDirectives.end())
@@ -432,8 +479,11 @@ SourceBuffer SourceManager::createBufferEntry(FileData* fd, SourceLocation inclu
     if (sortKey == UINT64_MAX)
         sortKey = bufferEntries.size() << 32;
 
+    if (includedFrom)
+        fd->isIncluded = true;
+
     bufferEntries.emplace_back(FileInfo(fd, library, includedFrom, sortKey));
-    return SourceBuffer{std::string_view(fd->mem.data(), fd->mem.size()), library,
+    return SourceBuffer{fd->text, library,
                         BufferID((uint32_t)(bufferEntries.size() - 1), fd->name)};
 }
 
@@ -454,6 +504,80 @@ bool SourceManager::isCached(const fs::path& path) const {
     return it != lookupCache.end();
 }
 
+std::vector<SourceManager::ChangedFile> SourceManager::invalidateChangedFiles() {
+    std::vector<ChangedFile> results;
+    std::unique_lock lock(mutex);
+
+    for (auto it = lookupCache.begin(); it != lookupCache.end();) {
+        auto& [fd, ec] = it->second;
+        if (ec) {
+            // The file failed to load previously; forget about
+            // that so that the next request tries again.
+            lookupCache.erase(it++);
+            continue;
+        }
+
+        // Buffers assigned from memory have nothing on disk to compare against.
+        if (fd->modTime == fs::file_time_type::min()) {
+            ++it;
+            continue;
+        }
+
+        std::error_code timeEc;
+        auto modTime = fs::last_write_time(fd->fullPath, timeEc);
+        if (!timeEc && modTime == fd->modTime) {
+            ++it;
+            continue;
+        }
+
+        // The timestamp changed, but the contents may not have. Mapped files
+        // can't be compared because their view may already reflect the new
+        // contents, so they are always treated as changed.
+        if (!timeEc && !fd->mem.empty()) {
+            SmallVector<char> buffer;
+            if (!OS::readFile(fd->fullPath, buffer) &&
+                std::string_view(buffer.data(), buffer.size()) == fd->text) {
+                fd->modTime = modTime;
+                ++it;
+                continue;
+            }
+        }
+
+        results.push_back({fd->fullPath, fd->isIncluded});
+        retiredFiles.emplace_back(std::move(fd));
+        lookupCache.erase(it++);
+    }
+
+    return results;
+}
+
+void SourceManager::releaseRetiredFiles() {
+    std::unique_lock lock(mutex);
+    if (retiredFiles.empty())
+        return;
+
+    flat_hash_set<const FileData*> retired;
+    for (auto& fd : retiredFiles)
+        retired.insert(fd.get());
+
+    // The entries themselves have to stay, since buffer IDs are indices
+    // into this list, but they no longer point at anything.
+    for (auto& entry : bufferEntries) {
+        auto info = std::get_if<FileInfo>(&entry);
+        if (info && retired.contains(info->data)) {
+            info->data = nullptr;
+            info->lineDirectives = {};
+        }
+    }
+
+    erase_if(diagDirectives, [&](auto& pair) {
+        auto info = getFileInfo(pair.first, lock);
+        return info && !info->data;
+    });
+
+    retiredFiles.clear();
+}
+
 SourceManager::BufferOrError SourceManager::openCached(const fs::path& fullPath,
                                                        SourceLocation includedFrom,
                                                        const SourceLibrary* library,
@@ -484,6 +608,23 @@ SourceManager::BufferOrError SourceManager::openCached(const fs::path& fullPath,
         }
     }
 
+    // Remember when the file was last written, before reading it, so
+    // that later modifications can be found by invalidateChangedFiles.
+    std::error_code timeEc;
+    auto modTime = fs::last_write_time(absPath, timeEc);
+    if (timeEc)
+        modTime = fs::file_time_type::min();
+
+    if (memoryMapFiles) {
+        // If mapping fails for any reason we fall back to reading the file
+        // normally below, which will report any real errors with the file.
+        MappedFile mapping;
+        if (!OS::mapFile(absPath, mapping)) {
+            return cacheBuffer(std::move(absPath), std::move(pathStr), includedFrom, library,
+                               sortKey, std::move(mapping), modTime);
+        }
+    }
+
     // do the read
     SmallVector<char> buffer;
     if (std::error_code ec = OS::readFile(absPath, buffer)) {
@@ -493,12 +634,14 @@ SourceManager::BufferOrError SourceManager::openCached(const fs::path& fullPath,
     }
 
     return cacheBuffer(std::move(absPath), std::move(pathStr), includedFrom, library, sortKey,
-                       std::move(buffer));
+                       std::move(buffer), modTime);
 }
 
+template<typename TContents>
 SourceBuffer SourceManager::cacheBuffer(fs::path&& path, std::string&& pathStr,
                                         SourceLocation includedFrom, const SourceLibrary* library,
-                                        uint64_t sortKey, SmallVector<char>&& buffer) {
+                                        uint64_t sortKey, TContents&& contents,
+                                        fs::file_time_type modTime) {
     std::string name;
     if (!disableProximatePaths) {
         std::error_code ec;
@@ -513,8 +656,9 @@ SourceBuffer SourceManager::cacheBuffer(fs::path&& path, std::string&& pathStr,
     std::unique_lock lock(mutex);
 
     auto directory = &*directories.insert(path.parent_path()).first;
-    auto fd = std::make_unique<FileData>(directory, std::move(name), std::move(buffer),
+    auto fd = std::make_unique<FileData>(directory, std::move(name), std::move(contents),
                                          std::move(path));
+    fd->modTime = modTime;
 
     // Note: it's possible that insertion here fails due to another thread
     // racing against us to open and insert the same file. We do a lookup
@@ -529,45 +673,20 @@ SourceBuffer SourceManager::cacheBuffer(fs::path&& path, std::string&& pathStr,
 }
 
 template<IsLock TLock>
-size_t SourceManager::getRawLineNumber(SourceLocation location, TLock& readLock) const {
-    FileData* fd;
-    {
-        // Separate scope so that info isn't used after it may potentially
-        // get invalidated when we briefly unloack a read lock and grab a
-        // write lock below.
-        const FileInfo* info = getFileInfo(location.buffer(), readLock);
-        if (!info || !info->data)
-            return 0;
-
-        fd = info->data;
-    }
-
-    if (fd->lineOffsets.empty()) {
-        // We need to compute line offsets. If the lock is a write lock then
-        // we can just go ahead and do that; if not we need to unlock the
-        // read lock and grab a write lock.
-        if constexpr (std::is_same_v<TLock, std::shared_lock<std::shared_mutex>>) {
-            readLock.unlock();
-
-            std::unique_lock writeLock(mutex);
-            computeLineOffsets(fd->mem, fd->lineOffsets);
-
-            writeLock.unlock();
-            readLock.lock();
-        }
-        else {
-            computeLineOffsets(fd->mem, fd->lineOffsets);
-        }
-    }
+size_t SourceManager::getRawLineNumber(SourceLocation location, TLock& lock) const {
+    const FileInfo* info = getFileInfo(location.buffer(), lock);
+    if (!info || !info->data)
+        return 0;
 
     // Find the first line offset that is greater than the given location offset. That iterator
     // then tells us how many lines away from the beginning we are.
-    auto it = std::ranges::lower_bound(fd->lineOffsets, location.offset());
+    auto& lineOffsets = info->data->getLineOffsets();
+    auto it = std::ranges::lower_bound(lineOffsets, location.offset());
 
     // We want to ensure the line we return is strictly greater than the given location offset.
     // So if it is equal, add one to the lower bound we got.
-    size_t line = size_t(it - fd->lineOffsets.begin());
-    if (it != fd->lineOffsets.end() && *it == location.offset())
+    size_t line = size_t(it - lineOffsets.begin());
+    if (it != lineOffsets.end() && *it == location.offset())
         line++;
     return line;
 }
@@ -630,24 +749,23 @@ SourceLocation SourceManager::getOriginalLocImpl(SourceLocation location, TLock&
     return std::get<ExpansionInfo>(bufferEntries[buffer.getId()]).originalLoc + location.offset();
 }
 
-void SourceManager::computeLineOffsets(const SmallVector<char>& buffer,
+void SourceManager::computeLineOffsets(std::string_view text,
                                        std::vector<size_t>& offsets) noexcept {
     // first line always starts at offset 0
     offsets.push_back(0);
 
-    const char* ptr = buffer.data();
-    const char* end = buffer.data() + buffer.size();
-    while (ptr != end) {
-        if (ptr[0] == '\n' || ptr[0] == '\r') {
-            // if we see \r\n or \n\r skip both chars
-            if ((ptr[1] == '\n' || ptr[1] == '\r') && ptr[0] != ptr[1])
-                ptr++;
-            ptr++;
-            offsets.push_back((size_t)(ptr - buffer.data()));
-        }
-        else {
+    const char* ptr = text.data();
+    const char* end = text.data() + text.size();
+    while (true) {
+        ptr = findNewline(ptr, end);
+        if (ptr == end)
+            break;
+
+        // if we see \r\n or \n\r skip both chars
+        if ((ptr[1] == '\n' || ptr[1] == '\r') && ptr[0] != ptr[1])
             ptr++;
-        }
+        ptr++;
+        offsets.push_back((size_t)(ptr - text.data()));
     }
 }
 
@@ -0,0 +1,68 @@
+//------------------------------------------------------------------------------
+// BKTree.cpp
+// Index of strings for finding approximate matches
+//
+// SPDX-FileCopyrightText: Michael Popoloski
+// SPDX-License-Identifier: MIT
+//------------------------------------------------------------------------------
+#include "slang/util/BKTree.h"
+
+#include "slang/util/String.h"
+
+namespace slang {
+
+// See: https://en.wikipedia.org/wiki/BK-tree
+
+void BKTree::add(std::string_view str) {
+    auto newIndex = uint32_t(nodes.size());
+    if (nodes.empty()) {
+        nodes.push_back({str, 0});
+        return;
+    }
+
+    uint32_t current = 0;
+    while (true) {
+        int dist = editDistance(nodes[current].str, str);
+
+        // Look for an existing child at the same distance and descend into it;
+        // otherwise the new string becomes a child of the current node.
+        uint32_t child = nodes[current].firstChild;
+        while (child && nodes[child].distance != dist)
+            child = nodes[child].nextSibling;
+
+        if (!child) {
+            nodes.push_back({str, dist, 0, nodes[current].firstChild});
+            nodes[current].firstChild = newIndex;
+            return;
+        }
+
+        current = child;
+    }
+}
+
+void BKTree::find(std::string_view str, int maxDistance, SmallVectorBase<Match>& results) const {
+    if (nodes.empty() || maxDistance < 0)
+        return;
+
+    SmallVector<uint32_t> stack;
+    stack.push_back(0);
+    while (!stack.empty()) {
+        auto index = stack.back();
+        stack.pop_back();
+
+        auto& node = nodes[index];
+        int dist = editDistance(node.str, str);
+        if (dist <= maxDistance)
+            results.push_back({index, dist});
+
+        // By the triangle inequality only children whose distance from this
+        // node is within maxDistance of our own distance can hold matches.
+        for (auto child = node.firstChild; child; child = nodes[child].nextSibling) {
+            int childDist = nodes[child].distance;
+            if (childDist >= dist - maxDistance && childDist <= dist + maxDistance)
+                stack.push_back(child);
+        }
+    }
+}
+
+} // namespace slang
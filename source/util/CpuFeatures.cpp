@@ -0,0 +1,68 @@
+//------------------------------------------------------------------------------
+// CpuFeatures.cpp
+// Runtime detection of host CPU capabilities
+//
+// SPDX-FileCopyrightText: Michael Popoloski
+// SPDX-License-Identifier: MIT
+//------------------------------------------------------------------------------
+#include "slang/util/CpuFeatures.h"
+
+#include <atomic>
+
+#if defined(SLANG_SIMD_X86) && defined(_MSC_VER) && !defined(__clang__)
+#    include <immintrin.h>
+#    include <intrin.h>
+#endif
+
+namespace slang {
+
+static SimdLevel computeSimdLevel() {
+#if defined(SLANG_SIMD_X86)
+#    if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] >= 7) {
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        if (osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+            __cpuidex(info, 7, 0);
+            if (info[1] & (1 << 5))
+                return SimdLevel::AVX2;
+        }
+    }
+#    else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::AVX2;
+#    endif
+
+    // SSE2 is part of the x86-64 baseline.
+    return SimdLevel::SSE2;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+SimdLevel detectSimdLevel() {
+    static const SimdLevel detected = computeSimdLevel();
+    return detected;
+}
+
+static std::atomic<SimdLevel>& activeLevel() {
+    static std::atomic<SimdLevel> level{detectSimdLevel()};
+    return level;
+}
+
+SimdLevel getSimdLevel() {
+    return activeLevel().load(std::memory_order_relaxed);
+}
+
+void setSimdLevel(SimdLevel level) {
+    auto detected = detectSimdLevel();
+    if (level > detected)
+        level = detected;
+    activeLevel().store(level, std::memory_order_relaxed);
+}
+
+} // namespace slang
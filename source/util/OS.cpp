@@ -26,6 +26,7 @@
 #    include <io.h>
 #else
 #    include <fcntl.h>
+#    include <sys/mman.h>
 #    include <sys/stat.h>
 #    include <unistd.h>
 #endif
@@ -177,6 +178,68 @@ std::error_code OS::readFile(const fs::path& path, SmallVector<char>& buffer) {
     return ec;
 }
 
+std::error_code OS::mapFile(const fs::path& path, MappedFile& result) {
+    auto& pathStr = path.native();
+    if (pathStr == L"-")
+        return make_error_code(std::errc::not_supported);
+
+    HANDLE handle = ::CreateFileW(pathStr.c_str(), GENERIC_READ,
+                                  FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                                  NULL);
+    if (handle == INVALID_HANDLE_VALUE)
+        return std::error_code(::GetLastError(), std::system_category());
+
+    SYSTEM_INFO sysInfo;
+    ::GetSystemInfo(&sysInfo);
+
+    std::error_code ec;
+    LARGE_INTEGER fileSize;
+    if (::GetFileType(handle) != FILE_TYPE_DISK) {
+        ec = make_error_code(std::errc::not_supported);
+    }
+    else if (!::GetFileSizeEx(handle, &fileSize)) {
+        ec.assign(::GetLastError(), std::system_category());
+    }
+    else if (fileSize.QuadPart == 0 || (fileSize.QuadPart % sysInfo.dwPageSize) == 0) {
+        // We rely on the zero-filled tail of the last page to provide
+        // the null terminator, so files that exactly fill their last
+        // page need to be read into memory instead.
+        ec = make_error_code(std::errc::not_supported);
+    }
+    else {
+        HANDLE mapping = ::CreateFileMappingW(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mapping) {
+            ec.assign(::GetLastError(), std::system_category());
+        }
+        else {
+            void* view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (!view) {
+                ec.assign(::GetLastError(), std::system_category());
+            }
+            else {
+                result.reset();
+                result.base = view;
+                result.length = size_t(fileSize.QuadPart) + 1;
+                result.mappedLength = size_t(fileSize.QuadPart);
+            }
+            ::CloseHandle(mapping);
+        }
+    }
+
+    ::CloseHandle(handle);
+    return ec;
+}
+
+void MappedFile::reset() {
+    if (base)
+        ::UnmapViewOfFile(base);
+
+    base = nullptr;
+    length = 0;
+    mappedLength = 0;
+}
+
 #else
 
 void OS::setupConsole() {
@@ -284,8 +347,91 @@ std::error_code OS::readFile(const fs::path& path, SmallVector<char>& buffer) {
     return ec;
 }
 
+std::error_code OS::mapFile(const fs::path& path, MappedFile& result) {
+    auto& pathStr = path.native();
+    if (pathStr == "-")
+        return make_error_code(std::errc::not_supported);
+
+    int fd;
+    while (true) {
+        fd = ::open(pathStr.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0)
+            break;
+
+        if (errno != EINTR)
+            return std::error_code(errno, std::generic_category());
+    }
+
+    std::error_code ec;
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+        ec.assign(errno, std::generic_category());
+    }
+    else if (!S_ISREG(status.st_mode) || status.st_size == 0) {
+        ec = make_error_code(std::errc::not_supported);
+    }
+    else {
+        // Reserve an extra page of anonymous (and therefore zero-filled) memory
+        // after the file contents and then map the file over the start of it.
+        // That guarantees the view is null terminated even when the file size
+        // is an exact multiple of the page size.
+        auto fileSize = (size_t)status.st_size;
+        auto totalSize = fileSize + (size_t)::sysconf(_SC_PAGESIZE);
+        void* region = ::mmap(nullptr, totalSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (region == MAP_FAILED) {
+            ec.assign(errno, std::generic_category());
+        }
+        else {
+            void* view = ::mmap(region, fileSize, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0);
+            if (view == MAP_FAILED) {
+                ec.assign(errno, std::generic_category());
+                ::munmap(region, totalSize);
+            }
+            else {
+                ::posix_madvise(view, fileSize, POSIX_MADV_SEQUENTIAL);
+
+                result.reset();
+                result.base = view;
+                result.length = fileSize + 1;
+                result.mappedLength = totalSize;
+            }
+        }
+    }
+
+    ::close(fd);
+    return ec;
+}
+
+void MappedFile::reset() {
+    if (base)
+        ::munmap(base, mappedLength);
+
+    base = nullptr;
+    length = 0;
+    mappedLength = 0;
+}
+
 #endif
 
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+    base(std::exchange(other.base, nullptr)), length(std::exchange(other.length, 0)),
+    mappedLength(std::exchange(other.mappedLength, 0)) {
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        reset();
+        base = std::exchange(other.base, nullptr);
+        length = std::exchange(other.length, 0);
+        mappedLength = std::exchange(other.mappedLength, 0);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    reset();
+}
+
 void OS::writeFile(const fs::path& path, std::string_view contents) {
     if (path == "-") {
         std::cout.write(contents.data(), (std::streamsize)contents.size());
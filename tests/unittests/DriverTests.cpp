@@ -3,11 +3,13 @@
 
 #include "Test.h"
 #include <fmt/core.h>
+#include <fstream>
 #include <regex>
 
 #include "slang/ast/symbols/CompilationUnitSymbols.h"
 #include "slang/ast/symbols/InstanceSymbols.h"
 #include "slang/driver/Driver.h"
+#include "slang/util/String.h"
 
 using namespace slang::driver;
 
@@ -241,6 +243,290 @@ TEST_CASE("Driver single-unit parsing") {
     CHECK(driver.reportParseDiags());
 }
 
+TEST_CASE("Driver parallel single-unit parsing") {
+    Driver driver;
+    driver.addStandardArgs();
+
+    auto args = fmt::format("testfoo \"{0}test.sv\" \"{0}test2.sv\" --single-unit "
+                            "--parallel-single-unit -j 4 --lint-only",
+                            findTestDir());
+    CHECK(driver.parseCommandLine(args));
+    CHECK(driver.processOptions());
+    CHECK(driver.parseAllSources());
+    CHECK(driver.reportParseDiags());
+}
+
+TEST_CASE("Driver missing single-unit for parallel single-unit") {
+    auto guard = OS::captureOutput();
+
+    Driver driver;
+    driver.addStandardArgs();
+
+    const char* argv[] = {"testfoo", "--parallel-single-unit"};
+    CHECK(driver.parseCommandLine(2, argv));
+    CHECK(!driver.processOptions());
+    CHECK(stderrContains("--single-unit must be set"));
+}
+
+TEST_CASE("Driver include token cache") {
+    Driver driver;
+    driver.addStandardArgs();
+
+    auto args = fmt::format("testfoo \"{0}test.sv\" --cache-includes", findTestDir());
+    CHECK(driver.parseCommandLine(args));
+    CHECK(driver.processOptions());
+    REQUIRE(driver.includeTokenCache);
+
+    CHECK(driver.parseAllSources());
+    CHECK(driver.includeTokenCache->getMisses() == 1);
+    CHECK(driver.includeTokenCache->getHits() == 0);
+
+    // Parsing again replays the header from the cache.
+    CHECK(driver.parseAllSources());
+    CHECK(driver.includeTokenCache->getMisses() == 1);
+    CHECK(driver.includeTokenCache->getHits() == 1);
+}
+
+TEST_CASE("Driver parse cache") {
+    std::error_code ec;
+    auto dir = fs::temp_directory_path(ec) / "slang_parse_cache_test";
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir / "cache", ec);
+
+    std::ofstream(dir / "top.sv") << "`include \"inc.svh\"\nmodule m; `FOO endmodule\n";
+    std::ofstream(dir / "inc.svh") << "`define FOO int i;\n";
+
+    auto parse = [&](std::string_view extraArgs = {}) -> std::string {
+        Driver driver;
+        driver.addStandardArgs();
+
+        auto args = fmt::format("testfoo \"{}\" --parse-cache \"{}\" {}",
+                                getU8Str(dir / "top.sv"), getU8Str(dir / "cache"), extraArgs);
+        CHECK(driver.parseCommandLine(args));
+        CHECK(driver.processOptions());
+        CHECK(driver.parseAllSources());
+        REQUIRE(driver.syntaxTrees.size() == 1);
+        return driver.syntaxTrees[0]->root().toString();
+    };
+
+    auto countCacheFiles = [&] {
+        size_t count = 0;
+        for (auto& entry : fs::directory_iterator(dir / "cache"))
+            count += entry.path().extension() == ".slcache";
+        return count;
+    };
+
+    auto first = parse();
+    CHECK(countCacheFiles() == 1);
+
+    // The second parse loads the cached tree.
+    CHECK(parse() == first);
+    CHECK(countCacheFiles() == 1);
+
+    // Changing an included file invalidates the cached tree.
+    std::ofstream(dir / "inc.svh") << "`define FOO int j;\n";
+    auto third = parse();
+    CHECK(third != first);
+    CHECK(third.find("int j;") != std::string::npos);
+    CHECK(countCacheFiles() == 1);
+
+    // Entries beyond the size bound are pruned once the run writes to the cache.
+    std::ofstream(dir / "top.sv") << "`include \"inc.svh\"\nmodule n; `FOO endmodule\n";
+    parse("--parse-cache-max-size 0");
+    CHECK(countCacheFiles() == 0);
+
+    fs::remove_all(dir, ec);
+}
+
+TEST_CASE("Driver syntax tree cache") {
+    std::error_code ec;
+    auto dir = fs::temp_directory_path(ec) / "slang_tree_cache_test";
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir / "lib", ec);
+
+    auto writeFile = [&](const fs::path& path, std::string_view text) {
+        std::ofstream(dir / path) << text;
+
+        // Make sure the change is visible even with coarse file timestamps.
+        auto time = fs::last_write_time(dir / path, ec);
+        fs::last_write_time(dir / path, time + std::chrono::seconds(10), ec);
+    };
+
+    writeFile("top.sv", "module top; leaf l(); libmod lm(); endmodule\n");
+    writeFile("leaf.sv", "module leaf; endmodule\n");
+    writeFile("other.sv", "`include \"inc.svh\"\nmodule other; `FOO endmodule\n");
+    writeFile("inc.svh", "`define FOO int i;\n");
+    writeFile("lib/libmod.sv", "module libmod; endmodule\n");
+
+    SourceManager sourceManager;
+    auto cache = std::make_shared<SyntaxTreeCache>();
+    auto parse = [&] {
+        Driver driver(sourceManager);
+        driver.sourceLoader.setTreeCache(cache);
+        driver.addStandardArgs();
+
+        auto args = fmt::format("testfoo \"{}\" \"{}\" \"{}\" -y \"{}\"",
+                                getU8Str(dir / "top.sv"), getU8Str(dir / "leaf.sv"),
+                                getU8Str(dir / "other.sv"), getU8Str(dir / "lib"));
+        CHECK(driver.parseCommandLine(args));
+        CHECK(driver.processOptions());
+        CHECK(driver.parseAllSources());
+        return driver.syntaxTrees;
+    };
+
+    auto first = parse();
+    REQUIRE(first.size() == 4);
+    CHECK(cache->getHits() == 0);
+    CHECK(cache->size() == 4);
+
+    // Nothing changed, so every tree comes from the cache,
+    // including the one found via the search directory.
+    CHECK(sourceManager.invalidateChangedFiles().empty());
+    auto second = parse();
+    CHECK(second == first);
+    CHECK(cache->getHits() == 4);
+
+    // Touching a file without changing its contents doesn't invalidate it.
+    writeFile("leaf.sv", "module leaf; endmodule\n");
+    CHECK(sourceManager.invalidateChangedFiles().empty());
+
+    // Changing a source file only reparses that file.
+    writeFile("leaf.sv", "module leaf; int i; endmodule\n");
+    auto changed = sourceManager.invalidateChangedFiles();
+    REQUIRE(changed.size() == 1);
+    CHECK(changed[0].path.filename() == "leaf.sv");
+    CHECK(!changed[0].wasIncluded);
+
+    cache->invalidate(changed);
+    CHECK(cache->size() == 3);
+
+    auto third = parse();
+    REQUIRE(third.size() == 4);
+    CHECK(third[0] == first[0]);
+    CHECK(third[1] != first[1]);
+    CHECK(third[1]->root().toString().find("int i;") != std::string::npos);
+
+    // Once nothing refers to the old contents of the file they can be freed.
+    auto oldBuffer = first[1]->root().getFirstToken().location().buffer();
+    auto newBuffer = third[1]->root().getFirstToken().location().buffer();
+    CHECK(!sourceManager.getSourceText(oldBuffer).empty());
+    sourceManager.releaseRetiredFiles();
+    CHECK(sourceManager.getSourceText(oldBuffer).empty());
+    CHECK(sourceManager.getSourceText(newBuffer).find("int i;") != std::string::npos);
+
+    // Changing an included file drops everything.
+    writeFile("inc.svh", "`define FOO int j;\n");
+    changed = sourceManager.invalidateChangedFiles();
+    REQUIRE(changed.size() == 1);
+    CHECK(changed[0].wasIncluded);
+
+    cache->invalidate(changed);
+    CHECK(cache->size() == 0);
+
+    auto fourth = parse();
+    REQUIRE(fourth.size() == 4);
+    CHECK(fourth[2]->root().toString().find("int j;") != std::string::npos);
+
+    fs::remove_all(dir, ec);
+}
+
+TEST_CASE("Driver precompiled syntax trees") {
+    std::error_code ec;
+    auto dir = fs::temp_directory_path(ec) / "slang_precompiled_test";
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir, ec);
+
+    std::ofstream(dir / "pkg.sv") << "package p;\n    `include \"inc.svh\"\nendpackage\n";
+    std::ofstream(dir / "inc.svh") << "localparam int P = 4;\n";
+    std::ofstream(dir / "top.sv") << "module m; int i = p::P; endmodule\n";
+
+    auto pkgPath = getU8Str(dir / "pkg.sv");
+    auto topPath = getU8Str(dir / "top.sv");
+    auto outPath = getU8Str(dir / "pkg.slpk");
+
+    {
+        Driver driver;
+        driver.addStandardArgs();
+
+        auto args = fmt::format("testfoo \"{}\" --write-precompiled \"{}\"", pkgPath, outPath);
+        CHECK(driver.parseCommandLine(args));
+        CHECK(driver.processOptions());
+        CHECK(driver.parseAllSources());
+        CHECK(fs::exists(outPath));
+    }
+
+    auto loadAndCompile = [&](bool expectSuccess) {
+        auto guard = OS::captureOutput();
+
+        Driver driver;
+        driver.addStandardArgs();
+
+        auto args = fmt::format("testfoo \"{}\" --precompiled \"{}\"", topPath, outPath);
+        CHECK(driver.parseCommandLine(args));
+        CHECK(driver.processOptions());
+        CHECK(driver.parseAllSources() == expectSuccess);
+        if (!expectSuccess) {
+            CHECK(stderrContains("unable to load precompiled syntax"));
+            return;
+        }
+
+        REQUIRE(driver.syntaxTrees.size() == 2);
+        CHECK(driver.syntaxTrees[0]->root().toString().find("package p;") != std::string::npos);
+
+        auto compilation = driver.createCompilation();
+        CHECK(driver.reportCompilation(*compilation, /* quiet */ true));
+    };
+
+    loadAndCompile(true);
+
+    // Changing an included file means the precompiled trees can't be used.
+    std::ofstream(dir / "inc.svh") << "localparam int P = 5;\n";
+    loadAndCompile(false);
+
+    // Trees parsed into a library are loaded back into a library of the same name.
+    std::ofstream(dir / "lib.map") << "library mylib libmod.sv;\n";
+    std::ofstream(dir / "libmod.sv") << "module libmod; endmodule\n";
+
+    auto mapPath = getU8Str(dir / "lib.map");
+    {
+        Driver driver;
+        driver.addStandardArgs();
+
+        auto args = fmt::format("testfoo --libmap \"{}\" --write-precompiled \"{}\"", mapPath,
+                                outPath);
+        CHECK(driver.parseCommandLine(args));
+        CHECK(driver.processOptions());
+        CHECK(driver.parseAllSources());
+    }
+    {
+        Driver driver;
+        driver.addStandardArgs();
+
+        auto args = fmt::format("testfoo \"{}\" --precompiled \"{}\"", topPath, outPath);
+        CHECK(driver.parseCommandLine(args));
+        CHECK(driver.processOptions());
+        CHECK(driver.parseAllSources());
+
+        REQUIRE(driver.syntaxTrees.size() == 2);
+        auto library = driver.syntaxTrees[0]->getSourceLibrary();
+        REQUIRE(library);
+        CHECK(library->name == "mylib");
+        CHECK(driver.syntaxTrees[0]->isLibraryUnit);
+    }
+
+    // Files written by a build with a different format hash are rejected.
+    {
+        std::fstream file(dir / "pkg.slpk", std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(5);
+        char c = char(file.get());
+        file.seekp(5);
+        file.put(char(c ^ 1));
+    }
+    loadAndCompile(false);
+
+    fs::remove_all(dir, ec);
+}
+
 TEST_CASE("Driver single-unit parsing files with no EOL") {
     Driver driver;
     driver.addStandardArgs();
@@ -343,6 +629,7 @@ TEST_CASE("Driver setting a bunch of compilation options") {
         args += " --max-include-depth=4 --max-parse-depth=10 --max-lexer-errors=2";
         args += " --max-hierarchy-depth=10 --max-generate-steps=1  --max-constexpr-depth=1";
         args += " --max-constexpr-steps=2 --constexpr-backtrace-limit=4 --max-instance-array=5";
+        args += " --max-constexpr-call-cache=8";
         args += " --ignore-unknown-modules --relax-enum-conversions --allow-hierarchical-const";
         args += " --allow-dup-initial-drivers --strict-driver-checking --lint-only";
         args += " --color-diagnostics=false";
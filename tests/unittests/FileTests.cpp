@@ -2,10 +2,14 @@
 // SPDX-License-Identifier: MIT
 
 #include "Test.h"
+#include <atomic>
 #include <fstream>
+#include <thread>
 
 #include "slang/text/Glob.h"
 #include "slang/text/SourceManager.h"
+#include "slang/util/CpuFeatures.h"
+#include "slang/util/OS.h"
 #include "slang/util/String.h"
 
 std::string getTestInclude() {
@@ -23,6 +27,35 @@ TEST_CASE("Read source") {
     CHECK(file->data.length() > 0);
 }
 
+TEST_CASE("Read source (memory mapped)") {
+    SourceManager manager;
+    manager.setMemoryMapFiles(true);
+
+    CHECK(!manager.readSource("X:\\nonsense.txt", /* library */ nullptr));
+
+    std::string testPath = getTestInclude();
+    auto file = manager.readSource(testPath, /* library */ nullptr);
+    REQUIRE(file);
+    REQUIRE(file->data.length() > 0);
+    CHECK(file->data.back() == '\0');
+
+    SmallVector<char> expected;
+    REQUIRE(!OS::readFile(testPath, expected));
+    CHECK(file->data == std::string_view(expected.data(), expected.size()));
+
+    // Files that exactly fill a page still need to be null terminated.
+    std::error_code ec;
+    auto pagePath = fs::temp_directory_path(ec) / "slang_mmap_page.sv";
+    std::ofstream(pagePath) << std::string(4096, 'a');
+
+    auto page = manager.readSource(pagePath, /* library */ nullptr);
+    REQUIRE(page);
+    CHECK(page->data.length() == 4097);
+    CHECK(page->data.back() == '\0');
+
+    fs::remove(pagePath, ec);
+}
+
 TEST_CASE("Read header (absolute)") {
     SourceManager manager;
     std::string testPath = getTestInclude();
@@ -93,6 +126,61 @@ TEST_CASE("Read header (dev/null)") {
     }
 }
 
+TEST_CASE("Line numbers") {
+    // Lines of all different lengths, with each of the kinds of line endings.
+    std::string text;
+    const char* endings[] = {"\n", "\r\n", "\n\r", "\r", "\n\n", "\r\r"};
+    for (size_t i = 0; i < 200; i++) {
+        text.append(i % 70, char('a' + i % 26));
+        text += endings[i % std::size(endings)];
+    }
+
+    std::vector<size_t> expected;
+    size_t line = 1;
+    for (size_t i = 0; i < text.size(); i++) {
+        expected.push_back(line);
+        char c = text[i];
+        if (c == '\n' || c == '\r') {
+            if (i + 1 < text.size() && (text[i + 1] == '\n' || text[i + 1] == '\r') &&
+                text[i + 1] != c) {
+                expected.push_back(line);
+                i++;
+            }
+            line++;
+        }
+    }
+
+    auto original = getSimdLevel();
+    for (auto level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+        setSimdLevel(level);
+
+        SourceManager manager;
+        auto buffer = manager.assignText(text);
+
+        // Look up lines from several threads at once, racing to compute the offsets.
+        std::vector<std::thread> threads;
+        std::atomic<size_t> mismatches = 0;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&] {
+                for (size_t i = 0; i < expected.size(); i++) {
+                    if (manager.getLineNumber(SourceLocation(buffer.id, i)) != expected[i])
+                        mismatches++;
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+        CHECK(mismatches == 0);
+    }
+    setSimdLevel(original);
+
+    SourceManager manager;
+    auto buffer = manager.assignText(text);
+    manager.precomputeLineOffsets(buffer.id);
+    CHECK(manager.getLineNumber(SourceLocation(buffer.id, text.size() - 1)) == expected.back());
+}
+
 static void globAndCheck(const fs::path& basePath, std::string_view pattern, GlobMode mode,
                          GlobRank expectedRank, std::error_code expectedEc,
                          std::initializer_list<const char*> expected) {
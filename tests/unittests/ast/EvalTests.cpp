@@ -2540,3 +2540,284 @@ TEST_CASE("Array map eval") {
 
     NO_SESSION_ERRORS;
 }
+
+TEST_CASE("Constant functions compiled to bytecode") {
+    auto tree = SyntaxTree::fromText(R"(
+module m;
+    function automatic int fib(int n);
+        if (n < 2)
+            return n;
+        else
+            return fib(n - 1) + fib(n - 2);
+    endfunction
+
+    function automatic int loops(int n);
+        int sum = 0;
+        for (int i = 0; i < n; i++) begin
+            if (i == 3) continue;
+            if (i > 20) break;
+            sum += i * 2;
+        end
+        while (sum > 100) sum -= 7;
+        do sum++; while (sum % 5 != 0);
+        return sum;
+    endfunction
+
+    function automatic logic [15:0] bits(logic [15:0] v);
+        logic [15:0] result;
+        int arr[4];
+        for (int i = 0; i < 16; i++)
+            result[15 - i] = v[i];
+        for (int i = 0; i < 4; i++)
+            arr[i] = i * i;
+        result[0] = arr[3] == 9 && arr[2] == 4;
+        return result;
+    endfunction
+
+    function automatic int chain(int x);
+        if (x == 0) return 10;
+        else if (x == 1) return 11;
+        else if (x == 2) begin
+            if (x > 1) return 12;
+        end
+        else return 13;
+        return 14;
+    endfunction
+
+    function automatic int cases(int x);
+        int y = x;
+        y++;
+        ++y;
+        case (x)
+            0: return y;
+            1, 2: y = y << 2;
+            default: y = -y;
+        endcase
+        return x > 3 ? y : y + 1;
+    endfunction
+
+    function automatic logic [3:0] merge(logic c);
+        return c ? 4'b1010 : 4'b1000;
+    endfunction
+
+    function int statics(int x);
+        static int s = 5;
+        $display("ignored");
+        return s + x;
+    endfunction
+
+    localparam int p1 = fib(15);
+    localparam int p2 = loops(30);
+    localparam logic [15:0] p3 = bits(16'h1234);
+    localparam int p4 = chain(0) + chain(1) + chain(2) + chain(3);
+    localparam int p5 = cases(0) + cases(1) + cases(5);
+    localparam logic [3:0] p6 = merge(1'bx);
+    localparam int p7 = statics(1);
+endmodule
+)");
+
+    for (auto compile : {false, true}) {
+        CompilationOptions options;
+        if (compile)
+            options.flags |= CompilationFlags::CompileConstantFunctions;
+
+        Compilation compilation(options);
+        compilation.addSyntaxTree(tree);
+
+        auto& diags = compilation.getAllDiagnostics();
+        REQUIRE(diags.size() == 2);
+        CHECK(diags[0].code == diag::ConstEvalStaticSkipped);
+        CHECK(diags[1].code == diag::ConstSysTaskIgnored);
+
+        auto& root = compilation.getRoot();
+        auto value = [&](std::string_view name) {
+            return root.lookupName<ParameterSymbol>(name).getValue().toString();
+        };
+
+        CHECK(value("m.p1") == "610");
+        CHECK(value("m.p2") == "100");
+        CHECK(value("m.p3") == "16'd11337");
+        CHECK(value("m.p4") == "46");
+        CHECK(value("m.p5") == "8");
+        CHECK(value("m.p6") == "4'b10x0");
+        CHECK(value("m.p7") == "1");
+    }
+}
+
+TEST_CASE("Constant functions compiled to bytecode respect step limits") {
+    std::string text = R"(
+module m;
+    function automatic int count(int n);
+        int total = 0;
+        for (int i = 0; i < n; i++) begin
+            if (i[0]) total += i;
+            else total++;
+        end
+        return total;
+    endfunction
+)";
+    for (int i = 0; i < 24; i++) {
+        auto n = std::to_string(i);
+        text += "    localparam int r" + n + " = count(" + n + ");\n";
+    }
+    text += "endmodule\n";
+
+    auto tree = SyntaxTree::fromText(text);
+    std::vector<std::pair<DiagCode, SourceLocation>> results[2];
+    std::vector<std::string> values[2];
+    for (int i = 0; i < 2; i++) {
+        CompilationOptions options;
+        options.maxConstexprSteps = 64;
+        if (i)
+            options.flags |= CompilationFlags::CompileConstantFunctions;
+
+        Compilation compilation(options);
+        compilation.addSyntaxTree(tree);
+
+        for (auto& diag : compilation.getAllDiagnostics())
+            results[i].emplace_back(diag.code, diag.location);
+
+        auto& m = compilation.getRoot().lookupName<InstanceSymbol>("m");
+        for (auto& param : m.body.membersOfType<ParameterSymbol>())
+            values[i].push_back(param.getValue().toString());
+    }
+
+    CHECK(!results[0].empty());
+    CHECK(results[0] == results[1]);
+    CHECK(values[0] == values[1]);
+}
+
+TEST_CASE("Eval function locals across frames") {
+    ScriptSession session;
+    session.eval(R"(
+function automatic int sum(int n);
+    int total = n;
+    if (n > 0) begin
+        int inner = sum(n - 1);
+        total += inner;
+    end
+    begin
+        int inner = total;
+        total = inner;
+    end
+    return total;
+endfunction
+)");
+
+    session.eval(R"(
+function automatic int weights(int n);
+    int arr[4] = '{1, 2, 3, 4};
+    int result = 0;
+    foreach (arr[i]) begin
+        int w = arr[i] * (i + n);
+        result += w;
+    end
+    for (int i = 0; i < n; i++) begin
+        int w = sum(i);
+        result += w;
+    end
+    return result;
+endfunction
+)");
+
+    CHECK(session.eval("sum(10)").integer() == 55);
+    CHECK(session.eval("weights(3)").integer() == 54);
+    CHECK(session.eval("weights(0)").integer() == 20);
+
+    NO_SESSION_ERRORS;
+}
+
+TEST_CASE("Constant function call memoization") {
+    auto tree = SyntaxTree::fromText(R"(
+module m;
+    localparam int base = 2;
+
+    function automatic int width(int n);
+        int result = 0;
+        while ((base ** result) < n) result++;
+        return result;
+    endfunction
+
+    function automatic int noisy(int n);
+        $display("%0d", n);
+        return n;
+    endfunction
+
+    function automatic int wrapper(int n);
+        return noisy(n) + width(n);
+    endfunction
+
+    localparam int a = width(100);
+    localparam int b = width(100);
+    localparam int c = width(1000);
+    localparam int d = wrapper(4);
+    localparam int e = wrapper(4);
+endmodule
+)");
+
+    for (uint32_t limit : {0u, 16384u}) {
+        CompilationOptions options;
+        options.maxConstexprCallCache = limit;
+
+        Compilation compilation(options);
+        compilation.addSyntaxTree(tree);
+        compilation.getAllDiagnostics();
+
+        auto& m = compilation.getRoot().lookupName<InstanceSymbol>("m");
+        auto value = [&](std::string_view name) {
+            return m.body.find<ParameterSymbol>(name).getValue().integer();
+        };
+
+        CHECK(value("a") == 7);
+        CHECK(value("b") == 7);
+        CHECK(value("c") == 10);
+        CHECK(value("d") == 6);
+        CHECK(value("e") == 6);
+
+        // Only the calls of width can be memoized, since wrapper ends up calling
+        // a system task. The call within wrapper gets evaluated the first time
+        // and found in the cache the second time.
+        auto& stats = compilation.getConstexprCallCacheStats();
+        if (limit) {
+            CHECK(stats.hits == 2);
+            CHECK(stats.misses == 3);
+        }
+        else {
+            CHECK(stats.hits == 0);
+            CHECK(stats.misses == 0);
+        }
+        CHECK(stats.evictions == 0);
+    }
+}
+
+TEST_CASE("Constant function memoization with real arguments") {
+    auto tree = SyntaxTree::fromText(R"(
+module m;
+    function automatic longint bits(real r);
+        return $realtobits(r);
+    endfunction
+
+    localparam longint a = bits(0.0);
+    localparam longint b = bits(-0.0);
+    localparam longint c = bits(0.0);
+endmodule
+)");
+
+    Compilation compilation;
+    compilation.addSyntaxTree(tree);
+    NO_COMPILATION_ERRORS;
+
+    auto& m = compilation.getRoot().lookupName<InstanceSymbol>("m");
+    auto value = [&](std::string_view name) {
+        return m.body.find<ParameterSymbol>(name).getValue().integer().as<uint64_t>();
+    };
+
+    // 0.0 and -0.0 compare equal but must not share a cached result.
+    CHECK(value("a") == 0);
+    CHECK(value("b") == 1ull << 63);
+    CHECK(value("c") == 0);
+
+    auto& stats = compilation.getConstexprCallCacheStats();
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 2);
+}
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: MIT
 
 #include "Test.h"
+#include <catch2/benchmark/catch_benchmark.hpp>
 
 #include "slang/ast/symbols/BlockSymbols.h"
 #include "slang/ast/symbols/CompilationUnitSymbols.h"
@@ -9,6 +10,7 @@
 #include "slang/ast/symbols/MemberSymbols.h"
 #include "slang/ast/symbols/ParameterSymbols.h"
 #include "slang/text/SourceManager.h"
+#include "slang/util/ThreadPool.h"
 
 TEST_CASE("Finding top level") {
     auto file1 = SyntaxTree::fromText(
@@ -1908,3 +1910,379 @@ endmodule
     compilation.addSyntaxTree(tree);
     NO_COMPILATION_ERRORS;
 }
+
+TEST_CASE("Identical instances share elaborated bodies") {
+    auto tree = SyntaxTree::fromText(R"(
+module leaf #(parameter int W = 4)(input logic [W-1:0] a, output logic [W-1:0] b);
+    assign b = ~a;
+endmodule
+
+module up;
+    assign top.x = 1;
+endmodule
+
+module down;
+    logic y;
+endmodule
+
+module top;
+    logic [3:0] a, b, c, d;
+    logic [7:0] e, f;
+    logic x;
+
+    leaf l1(.a(a), .b(b));
+    leaf l2(.a(c), .b(d));
+    leaf #(8) l3(.a(e), .b(f));
+    leaf #(.W(8)) l4(.a(e), .b());
+
+    up u1();
+    up u2();
+
+    down d1();
+    down d2();
+    assign d2.y = 1;
+endmodule
+)");
+
+    for (auto disable : {false, true}) {
+        CompilationOptions options;
+        if (disable)
+            options.flags |= CompilationFlags::DisableInstanceCaching;
+
+        Compilation compilation(options);
+        compilation.addSyntaxTree(tree);
+
+        auto& diags = compilation.getAllDiagnostics();
+        REQUIRE(diags.size() == 1);
+        CHECK(diags[0].code == diag::MultipleContAssigns);
+
+        auto& root = compilation.getRoot();
+        auto getCanonical = [&](std::string_view name) {
+            return root.lookupName<InstanceSymbol>(name).getCanonicalBody();
+        };
+
+        auto& l1 = root.lookupName<InstanceSymbol>("top.l1");
+        auto& l3 = root.lookupName<InstanceSymbol>("top.l3");
+        CHECK(getCanonical("top.l1") == nullptr);
+        CHECK(getCanonical("top.l2") == (disable ? nullptr : &l1.body));
+        CHECK(getCanonical("top.l3") == nullptr);
+        CHECK(getCanonical("top.l4") == (disable ? nullptr : &l3.body));
+
+        // Upward references and drivers from outside keep bodies from being shared.
+        CHECK(getCanonical("top.u2") == nullptr);
+        CHECK(getCanonical("top.d2") == nullptr);
+        CHECK(l1.getDefinition().getInstanceCount() == 4);
+    }
+}
+
+TEST_CASE("Diagnostics in shared instance bodies") {
+    auto tree = SyntaxTree::fromText(R"(
+module leaf #(parameter int P);
+    if (P == 1) begin : g
+        $warning("P is one");
+    end
+endmodule
+
+module mid #(parameter int Q = 0);
+    leaf #(1) l1();
+    leaf #(Q) l2();
+endmodule
+
+module top;
+    mid m1();
+    mid m2();
+    mid #(1) m3();
+endmodule
+)");
+
+    for (auto disable : {false, true}) {
+        CompilationOptions options;
+        if (disable)
+            options.flags |= CompilationFlags::DisableInstanceCaching;
+
+        Compilation compilation(options);
+        compilation.addSyntaxTree(tree);
+
+        auto& diags = compilation.getAllDiagnostics();
+        REQUIRE(diags.size() == 1);
+        CHECK(diags[0].code == diag::WarningTask);
+        CHECK(diags[0].coalesceCount == 4u);
+
+        auto& root = compilation.getRoot();
+        auto& m1 = root.lookupName<InstanceSymbol>("top.m1");
+        auto& m2 = root.lookupName<InstanceSymbol>("top.m2");
+        CHECK(m2.getCanonicalBody() == (disable ? nullptr : &m1.body));
+        CHECK(m1.getDefinition().getInstanceCount() == 3);
+
+        // Shared bodies can still be looked into on demand.
+        auto& l2 = root.lookupName<InstanceSymbol>("top.m2.l2");
+        CHECK(l2.body.getParameters().size() == 1);
+        CHECK(l2.getDefinition().getInstanceCount() == 6);
+    }
+}
+
+TEST_CASE("Parallel elaboration matches serial diagnostics") {
+    auto tree = SyntaxTree::fromText(R"(
+interface bus #(parameter int W = 8); logic [W-1:0] data; modport m(input data); endinterface
+
+module leaf #(parameter int P = 0)(input logic [3:0] a, output logic [3:0] b);
+    logic unused_thing;
+    if (P == 1) begin : g
+        $warning("P is one");
+        logic [3:0] q = a + 5'd1;
+    end
+    always_comb b = ~a;
+endmodule
+
+module ileaf(bus.m bb);
+    int i = bb.data;
+endmodule
+
+module mid #(parameter int Q = 0);
+    logic [3:0] a[4], b[4];
+    leaf #(1) l1(.a(a[0]), .b(b[0]));
+    leaf #(Q) l2(.a(a[1]), .b(b[1]));
+    for (genvar i = 0; i < 2; i++) begin : gen
+        leaf #(i) lg(.a(a[i+2]), .b(b[i+2]));
+    end
+    leaf arr[3:0](.a(4'b1), .b());
+    leaf #(Q + 2) lq(.a(a[3]), .b());
+endmodule
+
+module imid(bus.m bb);
+    ileaf il(bb);
+endmodule
+
+module top;
+    bus #(8) b1();
+    mid m1();
+    mid m2();
+    mid #(1) m3();
+    mid m4();
+    for (genvar i = 0; i < 8; i++) begin : g
+        mid #(i + 3) m();
+    end
+    imid im(b1);
+    assign m4.gen[0].lg.unused_thing = 1;
+    initial $display(m2.l2.b);
+endmodule
+)");
+
+    auto serial = [&] {
+        Compilation compilation;
+        compilation.addSyntaxTree(tree);
+        return report(compilation.getAllDiagnostics());
+    }();
+
+    for (uint32_t threads : {2u, 4u}) {
+        Compilation compilation;
+        compilation.addSyntaxTree(tree);
+
+        ThreadPool threadPool(threads);
+        compilation.getSemanticDiagnostics(threadPool);
+        CHECK(report(compilation.getAllDiagnostics()) == serial);
+
+        auto& m4 = compilation.getRoot().lookupName<InstanceSymbol>("top.m4");
+        CHECK(m4.getDefinition().getInstanceCount() == 12);
+    }
+}
+
+TEST_CASE("Elaborating only selected hierarchy paths") {
+    auto tree = SyntaxTree::fromText(R"(
+module a;
+    logic x = undeclared_a;
+endmodule
+
+module b;
+    logic y = undeclared_b;
+    c c1();
+endmodule
+
+module c;
+    logic z = undeclared_c;
+endmodule
+
+module top;
+    a a1();
+    b b1();
+    if (1) begin : g
+        a a2();
+        b b2();
+    end
+endmodule
+)");
+
+    auto check = [&](std::vector<std::string> paths, std::vector<std::string> expected) {
+        CompilationOptions options;
+        options.elabPaths = std::move(paths);
+
+        Compilation compilation(options);
+        compilation.addSyntaxTree(tree);
+
+        std::vector<std::string> names;
+        for (auto& diag : compilation.getAllDiagnostics()) {
+            if (diag.code == diag::UndeclaredIdentifier)
+                names.emplace_back(diag.args[0].index() == 0 ? std::get<0>(diag.args[0]) : ""s);
+            else
+                names.emplace_back(toString(diag.code));
+        }
+        CHECK(names == expected);
+    };
+
+    check({}, {"undeclared_a", "undeclared_b", "undeclared_c"});
+    check({"top.b1"}, {"undeclared_b", "undeclared_c"});
+    check({"top.b1.c1", "top.b1"}, {"undeclared_b", "undeclared_c"});
+    check({"top.g.a2"}, {"undeclared_a"});
+    check({"top.g", "top.nope", "top.a1.x"},
+          {"undeclared_a", "undeclared_b", "undeclared_c", "InvalidElabPath", "InvalidElabPath"});
+}
+
+TEST_CASE("Incremental elaboration reuses unchanged partitions") {
+    auto leafTree = SyntaxTree::fromText(R"(
+module leaf;
+    logic x = undeclared_leaf;
+endmodule
+)");
+    auto alphaTree = SyntaxTree::fromText(R"(
+module alpha;
+    logic a = undeclared_alpha;
+    leaf l1();
+    leaf l2();
+endmodule
+)");
+    auto topTree = SyntaxTree::fromText(R"(
+module top;
+    alpha a1();
+    beta b1();
+    beta b2();
+    beta b3();
+endmodule
+)");
+    auto betaTree1 = SyntaxTree::fromText(R"(
+module beta;
+    leaf l();
+endmodule
+)");
+    auto betaTree2 = SyntaxTree::fromText(R"(
+module beta;
+    leaf l();
+    int b = undeclared_beta;
+endmodule
+)");
+
+    auto addTrees = [&](Compilation& compilation, const std::shared_ptr<SyntaxTree>& betaTree) {
+        for (auto& tree : {leafTree, alphaTree, topTree, betaTree})
+            compilation.addSyntaxTree(tree);
+    };
+
+    auto getAlphaCompilation = [](Compilation& compilation) -> const Compilation* {
+        for (auto& diag : compilation.getSemanticDiagnostics()) {
+            if (diag.code == diag::UndeclaredIdentifier && diag.args[0].index() == 0 &&
+                std::get<0>(diag.args[0]) == "undeclared_alpha") {
+                return &diag.symbol->getParentScope()->getCompilation();
+            }
+        }
+        return nullptr;
+    };
+
+    auto fresh = [&](const std::shared_ptr<SyntaxTree>& betaTree) {
+        Compilation compilation;
+        addTrees(compilation, betaTree);
+        return report(compilation.getSemanticDiagnostics());
+    };
+
+    Compilation first;
+    addTrees(first, betaTree1);
+    ThreadPool threadPool(2);
+    CHECK(report(first.getSemanticDiagnostics(threadPool)) == fresh(betaTree1));
+
+    auto alphaComp = getAlphaCompilation(first);
+    REQUIRE(alphaComp);
+    CHECK(alphaComp != &first);
+
+    // Only the instances of the edited definition should need to be elaborated again,
+    // including when elaborating with a single thread.
+    Compilation second;
+    second.reuseElaboration(first);
+    addTrees(second, betaTree2);
+    ThreadPool singleThread(1);
+    CHECK(report(second.getSemanticDiagnostics(singleThread)) == fresh(betaTree2));
+    CHECK(getAlphaCompilation(second) == alphaComp);
+
+    Compilation third;
+    third.reuseElaboration(second);
+    addTrees(third, betaTree1);
+    CHECK(report(third.getSemanticDiagnostics(threadPool)) == fresh(betaTree1));
+    CHECK(getAlphaCompilation(third) == alphaComp);
+
+    // Changing something other than a definition means nothing can be reused.
+    auto pkgTree = SyntaxTree::fromText("package p; endpackage");
+    Compilation fourth;
+    fourth.reuseElaboration(third);
+    addTrees(fourth, betaTree1);
+    fourth.addSyntaxTree(pkgTree);
+    fourth.getSemanticDiagnostics(threadPool);
+    CHECK(getAlphaCompilation(fourth) != alphaComp);
+}
+
+TEST_CASE("Incremental elaboration latency", "[.][benchmark]") {
+    // Time to get diagnostics after editing one file of a large design, with and
+    // without reusing the elaboration of the previous version.
+    constexpr size_t numUnits = 64;
+    auto makeUnit = [](size_t index, bool edited) {
+        std::string text = fmt::format(R"(
+module cell_{0} #(parameter int W = 1)(input logic [W-1:0] a, output logic [W-1:0] b);
+    logic [W-1:0] r[8];
+    for (genvar i = 0; i < 8; i++) begin : g
+        always_comb r[i] = (a << i) ^ (a >> (W - i)) + W'(i * {0});
+    end
+    assign b = r[0] | r[7];
+endmodule
+
+module unit_{0};
+    for (genvar i = 1; i <= 32; i++) begin : g
+        logic [i-1:0] a, b;
+        cell_{0} #(i) c(.a, .b);
+    end
+)",
+                                       index);
+        if (edited)
+            text += "    int edited = undeclared;\n";
+        return SyntaxTree::fromText(text + "endmodule\n");
+    };
+
+    std::vector<std::shared_ptr<SyntaxTree>> trees;
+    std::string top = "module top;\n";
+    for (size_t i = 0; i < numUnits; i++) {
+        trees.push_back(makeUnit(i, false));
+        top += fmt::format("    unit_{0} u{0}();\n", i);
+    }
+    trees.push_back(SyntaxTree::fromText(top + "endmodule\n"));
+
+    ThreadPool threadPool(4);
+    Compilation previous;
+    for (auto& tree : trees)
+        previous.addSyntaxTree(tree);
+    previous.getSemanticDiagnostics(threadPool);
+
+    auto editAndElaborate = [&](bool incremental) {
+        Compilation compilation;
+        if (incremental)
+            compilation.reuseElaboration(previous);
+
+        compilation.addSyntaxTree(makeUnit(0, true));
+        for (size_t i = 1; i < trees.size(); i++)
+            compilation.addSyntaxTree(trees[i]);
+        return compilation.getSemanticDiagnostics(threadPool).size();
+    };
+
+    CHECK(editAndElaborate(true) == editAndElaborate(false));
+
+    BENCHMARK("Full elaboration after edit") {
+        return editAndElaborate(false);
+    };
+
+    BENCHMARK("Incremental elaboration after edit") {
+        return editAndElaborate(true);
+    };
+}
@@ -2174,3 +2174,92 @@ endmodule
     CHECK(diags[4].code == diag::UndeclaredIdentifier);
     CHECK(diags[5].code == diag::ImplicitNamedPortNotFound);
 }
+
+TEST_CASE("Lookup result caching") {
+    auto tree = SyntaxTree::fromText(R"(
+package p;
+    localparam int W = 8;
+endpackage
+
+module top;
+    import p::*;
+    for (genvar i = 0; i < 4; i++) begin : g
+        if (1) begin : h
+            logic [W-1:0] a = W;
+            logic [W-1:0] b = W + i;
+            int y = z;
+        end
+    end
+    int z;
+
+    mid m1();
+endmodule
+
+module mid;
+    int q = 1;
+    leaf l1();
+endmodule
+
+module leaf;
+    int v = mid.q;
+    int u = mid.q + 1;
+endmodule
+)");
+
+    Compilation compilation;
+    compilation.addSyntaxTree(tree);
+
+    auto& diags = compilation.getAllDiagnostics();
+    REQUIRE(diags.size() == 4);
+    for (auto& diag : diags)
+        CHECK(diag.code == diag::UsedBeforeDeclared);
+
+    auto& b = compilation.getRoot().lookupName<VariableSymbol>("top.g[3].h.b");
+    CHECK(b.getType().getBitWidth() == 8);
+    CHECK(b.getInitializer()->eval(ASTContext(*b.getParentScope(), LookupLocation::max))
+              .integer() == 11);
+
+    auto& q = compilation.getRoot().lookupName<VariableSymbol>("top.m1.q");
+    auto& v = compilation.getRoot().lookupName<VariableSymbol>("top.m1.l1.v");
+    CHECK(&v.getInitializer()->as<HierarchicalValueExpression>().symbol == &q);
+
+    auto& stats = compilation.getLookupCacheStats();
+    CHECK(stats.unqualifiedHits > 0);
+    CHECK(stats.unqualifiedMisses > 0);
+    CHECK(stats.upwardHits > 0);
+    CHECK(stats.upwardMisses > 0);
+}
+
+TEST_CASE("Typo correction in large packages") {
+    std::string text = "package p;\n";
+    for (int i = 0; i < 500; i++)
+        text += "    int sig_" + std::to_string(i) + ";\n";
+    text += R"(
+    typedef int sig_type;
+endpackage
+
+module m;
+    import p::*;
+    int foo = sig_4999;
+    int bar = sig_10x;
+    sig_typ baz;
+    int sigbutveryfaraway = 1;
+    int q = sigbutveryfaraways;
+endmodule
+)";
+
+    auto tree = SyntaxTree::fromText(text);
+    Compilation compilation;
+    compilation.addSyntaxTree(tree);
+
+    auto& diags = compilation.getAllDiagnostics();
+    REQUIRE(diags.size() == 4);
+    CHECK(diags[0].code == diag::TypoIdentifier);
+    CHECK(std::get<std::string>(diags[0].args[1]) == "sig_499");
+    CHECK(diags[1].code == diag::TypoIdentifier);
+    CHECK(std::get<std::string>(diags[1].args[1]) == "sig_10");
+    CHECK(diags[2].code == diag::TypoIdentifier);
+    CHECK(std::get<std::string>(diags[2].args[1]) == "sig_type");
+    CHECK(diags[3].code == diag::TypoIdentifier);
+    CHECK(std::get<std::string>(diags[3].args[1]) == "sigbutveryfaraway");
+}
@@ -4,6 +4,7 @@
 #include "Test.h"
 #include <fmt/format.h>
 
+#include "slang/ast/symbols/BlockSymbols.h"
 #include "slang/ast/symbols/CompilationUnitSymbols.h"
 #include "slang/ast/symbols/InstanceSymbols.h"
 #include "slang/ast/symbols/ParameterSymbols.h"
@@ -1266,3 +1267,63 @@ endmodule
         CHECK(p.getValue().integer() == i + 1);
     }
 }
+
+TEST_CASE("defparams across iterations with unchanged subtrees") {
+    auto tree = SyntaxTree::fromText(R"(
+module top;
+    parameter a = 0;
+    parameter b = 0;
+    defparam a = 5;
+    defparam b = a + 1;
+    defparam m2.fixed.inner.v = b;
+
+    leaf #(1) l0();
+    mid #(b) m1();
+    mid m2();
+endmodule
+
+module mid #(parameter int p = 0);
+    leaf #(3) fixed();
+    if (p > 4) begin : g
+        leaf #(p) l();
+        defparam l.inner.v = p + 100;
+    end
+endmodule
+
+module leaf #(parameter int w = 0);
+    sub inner();
+    defparam inner.u = w;
+endmodule
+
+module sub;
+    parameter v = 0;
+    parameter u = 0;
+    initial $display(v, u);
+endmodule
+)");
+
+    // Hierarchical constants turn off reuse of subtrees between
+    // iterations, so both ways should get the same results.
+    auto flags = GENERATE(CompilationFlags::None, CompilationFlags::AllowHierarchicalConst);
+
+    CompilationOptions options;
+    options.flags = flags;
+
+    Compilation compilation(options);
+    compilation.addSyntaxTree(tree);
+    NO_COMPILATION_ERRORS;
+
+    auto param = [&](auto name) {
+        return compilation.getRoot().lookupName<ParameterSymbol>(name).getValue().integer();
+    };
+
+    CHECK(param("top.b") == 6);
+    CHECK(param("top.l0.inner.u") == 1);
+    CHECK(param("top.m1.p") == 6);
+    CHECK(param("top.m1.fixed.inner.u") == 3);
+    CHECK(param("top.m1.g.l.inner.u") == 6);
+    CHECK(param("top.m1.g.l.inner.v") == 106);
+    CHECK(param("top.m2.fixed.inner.u") == 3);
+    CHECK(param("top.m2.fixed.inner.v") == 6);
+    CHECK(compilation.getRoot().lookupName<GenerateBlockSymbol>("top.m2.g").isUninstantiated);
+}
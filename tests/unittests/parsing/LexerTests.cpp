@@ -2,12 +2,14 @@
 // SPDX-License-Identifier: MIT
 
 #include "Test.h"
+#include <catch2/benchmark/catch_benchmark.hpp>
 
 #include "slang/parsing/Preprocessor.h"
 #include "slang/syntax/AllSyntax.h"
 #include "slang/syntax/SyntaxPrinter.h"
 #include "slang/text/CharInfo.h"
 #include "slang/text/SourceManager.h"
+#include "slang/util/CpuFeatures.h"
 
 using LF = LexerFacts;
 
@@ -1263,3 +1265,127 @@ TEST_CASE("Hex escape corner case") {
     CHECK(diagnostics[0].code == diag::InvalidHexEscapeCode);
     CHECK(diagnostics[1].code == diag::ExpectedClosingQuote);
 }
+
+static std::string makeScanTestText() {
+    // Build up runs of whitespace, identifiers, and comments of various lengths
+    // so that we cross vector widths and hit every possible stopping position.
+    std::string text;
+    for (int i = 0; i < 70; i++) {
+        text += std::string(size_t(i), ' ') + "\t" + std::string(size_t(i), 'a') + "$_" +
+                std::to_string(i) + " // " + std::string(size_t(i), 'c') + "\xc3\xa9" +
+                std::string(size_t(i), 'd') + "\n/* " + std::string(size_t(i), '/') + "*" +
+                std::string(size_t(i), 'x') + "\xe2\x82\xac */\n";
+    }
+    return text;
+}
+
+static std::vector<std::string> lexAllTokens(std::string_view text) {
+    diagnostics.clear();
+    auto buffer = getSourceManager().assignText(text);
+    Lexer lexer(buffer, alloc, diagnostics);
+
+    std::vector<std::string> results;
+    while (true) {
+        Token token = lexer.lex();
+        results.push_back(token.toString());
+        if (token.kind == TokenKind::EndOfFile)
+            break;
+    }
+    return results;
+}
+
+TEST_CASE("Vectorized scanning matches scalar") {
+    auto text = makeScanTestText();
+    auto original = getSimdLevel();
+
+    setSimdLevel(SimdLevel::Scalar);
+    auto expected = lexAllTokens(text);
+    auto expectedDiags = diagnostics.size();
+
+    for (auto level : {SimdLevel::SSE2, SimdLevel::AVX2}) {
+        setSimdLevel(level);
+        CHECK(lexAllTokens(text) == expected);
+        CHECK(diagnostics.size() == expectedDiags);
+    }
+
+    setSimdLevel(original);
+}
+
+TEST_CASE("Scanning routines stop at the right place") {
+    auto original = getSimdLevel();
+    for (auto level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+        setSimdLevel(level);
+        for (size_t i = 0; i < 70; i++) {
+            std::string ws(i, ' ');
+            ws += "\t\v\fx";
+            CHECK(skipHorizontalWhitespace(ws.data(), ws.data() + ws.size()) == &ws.back());
+
+            std::string ident(i, 'Z');
+            ident += "09_$@";
+            CHECK(skipIdentifierChars(ident.data(), ident.data() + ident.size()) ==
+                  &ident.back());
+
+            std::string line(i, '*');
+            line += "/\r";
+            CHECK(findLineCommentBreak(line.data(), line.data() + line.size()) == &line.back());
+
+            std::string block(i, '\\');
+            block += "\x80";
+            CHECK(findBlockCommentBreak(block.data(), block.data() + block.size()) ==
+                  &block.back());
+
+            std::string text(i, '\t');
+            text += "\r";
+            CHECK(findNewline(text.data(), text.data() + text.size()) == &text.back());
+            CHECK(findNewline(text.data(), text.data() + i) == text.data() + i);
+
+            std::string inactive(i, 'a');
+            inactive += " \t\r\n;'`";
+            CHECK(findInactiveTextBreak(inactive.data(), inactive.data() + inactive.size()) ==
+                  &inactive.back());
+            inactive.back() = '\x7f';
+            CHECK(findInactiveTextBreak(inactive.data(), inactive.data() + inactive.size()) ==
+                  &inactive.back());
+
+            CHECK(skipIdentifierChars(ident.data(), ident.data() + i) == ident.data() + i);
+        }
+    }
+    setSimdLevel(original);
+}
+
+TEST_CASE("Lexer throughput", "[.][benchmark]") {
+    // Lexing speed of netlist-like text at each SIMD level.
+    std::string text;
+    for (int i = 0; i < 20000; i++) {
+        text += "    // Generated cell instance " + std::to_string(i) +
+                " with a reasonably long descriptive comment\n"
+                "    sky130_fd_sc_hd__dfxtp_1 u_datapath_lane_reg_" +
+                std::to_string(i) +
+                " (.CLK(clk_i), .D(lane_next_value), .Q(lane_current_value));\n"
+                "    /* block comment describing the purpose of this particular cell */\n";
+    }
+
+    auto buffer = getSourceManager().assignText(text);
+    auto lexAll = [&] {
+        BumpAllocator localAlloc;
+        Diagnostics localDiags;
+        Lexer lexer(buffer, localAlloc, localDiags);
+        size_t count = 0;
+        while (lexer.lex().kind != TokenKind::EndOfFile)
+            count++;
+        return count;
+    };
+
+    auto original = getSimdLevel();
+    for (auto level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+        setSimdLevel(level);
+        if (getSimdLevel() != level)
+            continue;
+
+        BENCHMARK("Lex " + std::to_string(text.size()) + " bytes, SIMD level " +
+                  std::to_string(int(level))) {
+            return lexAll();
+        };
+    }
+    setSimdLevel(original);
+}
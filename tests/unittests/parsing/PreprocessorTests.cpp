@@ -7,6 +7,7 @@
 #include "slang/syntax/AllSyntax.h"
 #include "slang/syntax/SyntaxPrinter.h"
 #include "slang/text/SourceManager.h"
+#include "slang/util/ThreadPool.h"
 
 void trimTrailingWhitespace(std::string& str) {
     size_t off = 0;
@@ -97,6 +98,161 @@ TEST_CASE("Double include, with pragma once") {
     CHECK_DIAGNOSTICS_EMPTY;
 }
 
+TEST_CASE("Include guard detection") {
+    auto& text = R"(
+`include "guarded.svh"
+`include "guarded.svh"
+`include "guarded_else.svh"
+`include "guarded_else.svh"
+`include "guarded_trailing.svh"
+`include "guarded_trailing.svh"
+`undef GUARDED_SVH
+`include "guarded.svh"
+)";
+
+    // The include token cache is used to count how many times files actually get opened.
+    IncludeTokenCache cache;
+    PreprocessorOptions ppOptions;
+    ppOptions.includeTokenCache = &cache;
+
+    Bag options;
+    options.set(ppOptions);
+
+    diagnostics.clear();
+    Preprocessor preprocessor(getSourceManager(), alloc, diagnostics, options);
+    preprocessor.pushSource(text);
+
+    std::string result;
+    while (true) {
+        Token token = preprocessor.next();
+        result += token.toString();
+        if (token.kind == TokenKind::EndOfFile)
+            break;
+    }
+
+    CHECK_DIAGNOSTICS_EMPTY;
+    CHECK(result.find("guarded = 1") != result.rfind("guarded = 1"));
+    CHECK(result.find("again = 1") != std::string::npos);
+    CHECK(result.find("trailing = 1") != result.rfind("trailing = 1"));
+
+    // Only the classic guard idiom is detected; the other files
+    // have contents outside of their guard conditional.
+    auto state = preprocessor.getUnitState();
+    REQUIRE(state.includeGuards.size() == 1);
+    CHECK(state.includeGuards.begin()->second == "GUARDED_SVH");
+
+    // The second include of the guarded file is skipped.
+    CHECK(cache.getHits() + cache.getMisses() == 6);
+}
+
+TEST_CASE("Include token cache") {
+    auto& text = R"(
+`include "cached_include.svh"
+`define CACHED_TWICE
+`include "cached_include.svh"
+)";
+
+    auto expected = preprocess(text);
+    auto expectedDiags = diagnostics;
+    REQUIRE(!expectedDiags.empty());
+
+    IncludeTokenCache cache;
+    PreprocessorOptions ppOptions;
+    ppOptions.includeTokenCache = &cache;
+
+    Bag options;
+    options.set(ppOptions);
+
+    auto checkDiags = [&] {
+        REQUIRE(diagnostics.size() == expectedDiags.size());
+        for (size_t i = 0; i < diagnostics.size(); i++) {
+            CHECK(diagnostics[i].code == expectedDiags[i].code);
+            CHECK(diagnostics[i].location.offset() == expectedDiags[i].location.offset());
+        }
+    };
+
+    // The first include lexes the file and the second replays it, switching back
+    // to the lexer partway through when the keyword version changes.
+    CHECK(preprocess(text, options) == expected);
+    checkDiags();
+    CHECK(cache.getMisses() == 1);
+    CHECK(cache.getHits() == 1);
+    CHECK(cache.size() == 1);
+
+    // Another preprocessor sharing the cache replays both includes.
+    CHECK(preprocess(text, options) == expected);
+    checkDiags();
+    CHECK(cache.getMisses() == 1);
+    CHECK(cache.getHits() == 3);
+}
+
+TEST_CASE("Discarding trivia") {
+    auto& text = R"(
+`define STR(x) `"x  +  x`"
+`define ADD(a, b) a   +   b
+module m; /* inline */ localparam string s = `STR(foo   bar);
+    localparam int i = `ADD(1,
+                            2); // trailing comment
+    /* multi-line
+       comment */ wire w;
+endmodule
+`include "cached_include.svh"
+`define CACHED_TWICE
+`include "cached_include.svh"
+)";
+
+    auto lexAll = [&](bool discardTrivia, IncludeTokenCache* cache) {
+        LexerOptions lexerOptions;
+        lexerOptions.discardTrivia = discardTrivia;
+        PreprocessorOptions ppOptions;
+        ppOptions.includeTokenCache = cache;
+
+        Bag options;
+        options.set(lexerOptions);
+        options.set(ppOptions);
+
+        diagnostics.clear();
+        Preprocessor preprocessor(getSourceManager(), alloc, diagnostics, options);
+        preprocessor.pushSource(text);
+
+        std::vector<Token> tokens;
+        while (true) {
+            tokens.push_back(preprocessor.next());
+            if (tokens.back().kind == TokenKind::EndOfFile)
+                break;
+        }
+        return tokens;
+    };
+
+    auto expected = lexAll(false, nullptr);
+    auto expectedDiags = diagnostics;
+
+    IncludeTokenCache cache;
+    for (auto cachePtr : {(IncludeTokenCache*)nullptr, &cache}) {
+        auto tokens = lexAll(true, cachePtr);
+        REQUIRE(tokens.size() == expected.size());
+        REQUIRE(diagnostics.size() == expectedDiags.size());
+        for (size_t i = 0; i < diagnostics.size(); i++)
+            CHECK(diagnostics[i].code == expectedDiags[i].code);
+
+        for (size_t i = 0; i < tokens.size(); i++) {
+            CHECK(tokens[i].kind == expected[i].kind);
+            CHECK(tokens[i].valueText() == expected[i].valueText());
+            CHECK(tokens[i].location().offset() == expected[i].location().offset());
+            CHECK(tokens[i].isOnSameLine() == expected[i].isOnSameLine());
+            CHECK(tokens[i].trivia().empty() == expected[i].trivia().empty());
+
+            for (auto& trivia : tokens[i].trivia()) {
+                if (trivia.kind == TriviaKind::LineComment ||
+                    trivia.kind == TriviaKind::BlockComment) {
+                    CHECK(trivia.getRawText().find("comment") == std::string_view::npos);
+                }
+            }
+        }
+    }
+    CHECK(cache.getHits() == 1);
+}
+
 TEST_CASE("Include directive errors") {
     auto& text = R"(
 `include
@@ -935,6 +1091,92 @@ TEST_CASE("Nested branches") {
     CHECK_DIAGNOSTICS_EMPTY;
 }
 
+TEST_CASE("Skipping inactive regions") {
+    auto& text = R"(
+`ifdef NEVER
+    module m; string s = "`endif \"`else\"";
+    // `endif in a comment
+    /* `elsif in a block
+       comment */ `define FOO 1
+    `ifdef NESTED
+        8'hff \esc
+    `endif
+`else
+    int i;
+`endif
+`ifndef DONE int j; `elsif NEVER `FOO `endif
+)";
+
+    CHECK(preprocess(text) == "\n    int i;\n int j;\n");
+    CHECK_DIAGNOSTICS_EMPTY;
+
+    auto tree = SyntaxTree::fromText(text);
+    CHECK(SyntaxPrinter::printFile(*tree) == text);
+
+    // Skipped text is attached as DisabledText trivia to the next token lexed,
+    // which is usually the directive that ends the inactive region. Only text
+    // that the fast path doesn't handle ends up as disabled tokens.
+    Preprocessor preprocessor(getSourceManager(), alloc, diagnostics);
+    preprocessor.pushSource(text);
+    Token token = preprocessor.next();
+    CHECK(token.valueText() == "int");
+
+    std::vector<std::string_view> disabledText;
+    std::vector<std::string_view> disabledTokens;
+    for (auto& trivia : token.trivia()) {
+        if (trivia.kind != TriviaKind::Directive)
+            continue;
+
+        auto& syntax = *trivia.syntax();
+        TokenList tokens = ConditionalBranchDirectiveSyntax::isKind(syntax.kind)
+                               ? syntax.as<ConditionalBranchDirectiveSyntax>().disabledTokens
+                               : syntax.as<UnconditionalBranchDirectiveSyntax>().disabledTokens;
+
+        auto addDisabledText = [&](Token t) {
+            for (auto& tt : t.trivia()) {
+                if (tt.kind == TriviaKind::DisabledText)
+                    disabledText.push_back(tt.getRawText());
+            }
+        };
+
+        addDisabledText(syntax.getFirstToken());
+        for (auto t : tokens) {
+            addDisabledText(t);
+            disabledTokens.push_back(t.rawText());
+        }
+    }
+
+    CHECK(disabledTokens == std::vector<std::string_view>{"\\esc"});
+    CHECK(disabledText == std::vector<std::string_view>{
+                              "\n    module m; string s = \"`endif \\\"`else\\\"\";\n"
+                              "    // `endif in a comment\n"
+                              "    /* `elsif in a block\n"
+                              "       comment */ `define FOO 1\n    ",
+                              "\n        8'hff ", "\n    ", "\n"});
+}
+
+TEST_CASE("Skipping long inactive regions") {
+    // Long runs of plain text are skipped a window at a time,
+    // without falling back to lexing each token.
+    std::string text = "`ifdef NEVER\n";
+    while (text.size() < SVInt::MAX_BITS / 2)
+        text += "int i; ";
+    text += "\n`endif\nint j;\n";
+
+    Preprocessor preprocessor(getSourceManager(), alloc, diagnostics);
+    preprocessor.pushSource(text);
+    Token token = preprocessor.next();
+    CHECK(token.valueText() == "int");
+
+    for (auto& trivia : token.trivia()) {
+        if (trivia.kind == TriviaKind::Directive &&
+            trivia.syntax()->kind == SyntaxKind::IfDefDirective) {
+            CHECK(trivia.syntax()->as<ConditionalBranchDirectiveSyntax>().disabledTokens.empty());
+        }
+    }
+    CHECK_DIAGNOSTICS_EMPTY;
+}
+
 TEST_CASE("IfDef inside macro") {
     auto& text = "`define FOO \\\n"
                  "  `ifdef BAR \\\n"
@@ -2682,3 +2924,76 @@ endmodule
     REQUIRE(diagnostics.size() == 1);
     CHECK(diagnostics[0].code == diag::ProtectedEnvelope);
 }
+
+static void checkParallelSingleUnit(std::span<const std::string_view> texts) {
+    SourceManager& sourceManager = SyntaxTree::getDefaultSourceManager();
+    std::vector<SourceBuffer> buffers;
+    for (auto text : texts)
+        buffers.push_back(sourceManager.assignText(text));
+
+    ThreadPool threadPool(4);
+    auto expected = SyntaxTree::fromBuffers(buffers, sourceManager);
+    auto actual = SyntaxTree::fromBuffersParallel(buffers, sourceManager, threadPool);
+
+    CHECK(SyntaxPrinter::printFile(*actual) == SyntaxPrinter::printFile(*expected));
+    CHECK(actual->root().as<CompilationUnitSyntax>().members.size() ==
+          expected->root().as<CompilationUnitSyntax>().members.size());
+
+    auto macroNames = [](const SyntaxTree& tree) {
+        std::vector<std::string_view> names;
+        for (auto macro : tree.getDefinedMacros())
+            names.push_back(macro->name.valueText());
+        return names;
+    };
+    CHECK(macroNames(*actual) == macroNames(*expected));
+
+    auto& actualDiags = actual->diagnostics();
+    auto& expectedDiags = expected->diagnostics();
+    REQUIRE(actualDiags.size() == expectedDiags.size());
+    for (size_t i = 0; i < actualDiags.size(); i++) {
+        CHECK(actualDiags[i].code == expectedDiags[i].code);
+        CHECK(actualDiags[i].location == expectedDiags[i].location);
+    }
+
+    auto& actualMeta = actual->getMetadata();
+    auto& expectedMeta = expected->getMetadata();
+    CHECK(actualMeta.nodeMap.size() == expectedMeta.nodeMap.size());
+    CHECK(actualMeta.globalInstances == expectedMeta.globalInstances);
+    CHECK(actualMeta.eofToken.location() == expectedMeta.eofToken.location());
+}
+
+TEST_CASE("Parallel single unit parsing") {
+    std::string_view texts[] = {
+        "`define FOO 1\n`timescale 1ns/1ps\nmodule a; endmodule\n",
+        "// comment\n`ifdef FOO\nmodule b; endmodule\n`else\nmodule c; endmodule\n`endif\n"
+        "`define BAR(x) x + 1\n",
+        "module d; localparam int p = `BAR(2); endmodule\n`undef FOO\n`default_nettype none\n",
+        "`ifndef FOO\nmodule e; wire w; endmodule\n`endif\n",
+        "  // only trivia here\n",
+        "",
+        "module f; g g1(); endmodule"};
+    checkParallelSingleUnit(texts);
+}
+
+TEST_CASE("Parallel single unit parsing with dependency chain") {
+    // Each file only defines its macro if the previous one did, which forces
+    // several rounds of re-parsing and eventually a sequential fallback.
+    std::vector<std::string> storage;
+    storage.push_back("`define M0\n");
+    for (int i = 1; i < 10; i++) {
+        storage.push_back(fmt::format("`ifdef M{0}\n`define M{1}\nmodule m{1}; endmodule\n`endif\n",
+                                      i - 1, i));
+    }
+
+    std::vector<std::string_view> texts(storage.begin(), storage.end());
+    checkParallelSingleUnit(texts);
+}
+
+TEST_CASE("Parallel single unit parsing falls back when state spans files") {
+    std::string_view texts[] = {"`define FOO\n`ifdef FOO\n", "module a; endmodule\n",
+                                "`endif\nmodule b; endmodule\n"};
+    checkParallelSingleUnit(texts);
+
+    std::string_view errorTexts[] = {"module a;\n", "endmodule\n"};
+    checkParallelSingleUnit(errorTexts);
+}
@@ -7,6 +7,7 @@
 #include "slang/ast/ASTVisitor.h"
 #include "slang/parsing/ParserMetadata.h"
 #include "slang/syntax/SyntaxPrinter.h"
+#include "slang/syntax/SyntaxSerializer.h"
 #include "slang/syntax/SyntaxVisitor.h"
 
 class SemanticModel {
@@ -749,3 +750,88 @@ TEST_CASE("Visit all file") {
 
     CHECK(count == 1456);
 }
+
+static std::string printAll(const SyntaxTree& tree) {
+    return SyntaxPrinter()
+        .setIncludeDirectives(true)
+        .setIncludeSkipped(true)
+        .setIncludeTrivia(true)
+        .setIncludeMissing(true)
+        .print(tree)
+        .str();
+}
+
+TEST_CASE("Syntax tree serialization round trip") {
+    auto& text = R"(
+`define FOO(a, b) a + b
+`timescale 1ns/1ps
+`default_nettype none
+module m #(parameter int P = `FOO(3'b1x0, 4.5))(input logic [3:0] a);
+    // comment
+    /* block */ string s = "hello\n";
+    localparam time t = 10ns;
+    logic [7:0] b = 'z;
+    assign b = a +;
+endmodule
+`pragma once asdf
+`resetall
+`pragma
+)";
+
+    auto tree = SyntaxTree::fromText(text);
+    auto data = SyntaxSerializer::serialize(*tree);
+    REQUIRE(data);
+
+    auto loaded = SyntaxSerializer::deserialize(*data, tree->sourceManager());
+    REQUIRE(loaded);
+    CHECK(printAll(*loaded) == printAll(*tree));
+    CHECK(loaded->root().isEquivalentTo(tree->root()));
+    CHECK(loaded->getDefinedMacros().size() == tree->getDefinedMacros().size());
+    CHECK(loaded->getMetadata().nodeMap.size() == tree->getMetadata().nodeMap.size());
+
+    auto& diags = tree->diagnostics();
+    auto& loadedDiags = loaded->diagnostics();
+    REQUIRE(loadedDiags.size() == diags.size());
+    for (size_t i = 0; i < diags.size(); i++) {
+        CHECK(loadedDiags[i].code == diags[i].code);
+        CHECK(loadedDiags[i].location.offset() == diags[i].location.offset());
+    }
+
+    // Corrupted or truncated data fails to load.
+    auto truncated = std::span<const char>(*data).first(data->size() / 2);
+    CHECK(!SyntaxSerializer::deserialize(truncated, tree->sourceManager()));
+
+    auto corrupted = *data;
+    corrupted.back() ^= 1;
+    CHECK(!SyntaxSerializer::deserialize(corrupted, tree->sourceManager()));
+
+    // So does data written with a different node layout or library version,
+    // which shows up as a different format hash after the magic and version.
+    auto otherFormat = *data;
+    otherFormat[5] ^= 1;
+    CHECK(!SyntaxSerializer::deserialize(otherFormat, tree->sourceManager()));
+}
+
+TEST_CASE("Syntax tree serialization of a file") {
+    fs::path path = findTestDir();
+    path /= "../../regression/all.sv";
+    auto result = SyntaxTree::fromFile(path.string());
+    REQUIRE(result);
+
+    auto tree = *result;
+    auto data = SyntaxSerializer::serialize(*tree);
+    REQUIRE(data);
+
+    auto loaded = SyntaxSerializer::deserialize(*data, tree->sourceManager());
+    REQUIRE(loaded);
+    CHECK(printAll(*loaded) == printAll(*tree));
+    CHECK(loaded->root().isEquivalentTo(tree->root()));
+
+    Compilation compilation;
+    compilation.addSyntaxTree(tree);
+
+    Compilation loadedCompilation;
+    loadedCompilation.addSyntaxTree(loaded);
+    CHECK(loadedCompilation.getAllDiagnostics().size() ==
+          compilation.getAllDiagnostics().size());
+}
@@ -2,12 +2,14 @@
 // SPDX-License-Identifier: MIT
 
 #include "Test.h"
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_approx.hpp>
 #include <cmath>
 #include <sstream>
 using Catch::Approx;
 
 #include "slang/numeric/SVInt.h"
+#include "slang/util/CpuFeatures.h"
 
 TEST_CASE("Construction") {
     SVInt value1;
@@ -248,6 +250,49 @@ TEST_CASE("SVInt to string (and back)") {
     CHECK(str == SVInt::fromString(str).toString());
 }
 
+TEST_CASE("Huge literal radix conversions") {
+    // Long decimal strings are split recursively at powers of ten, so check
+    // values right on and around the split points, plus long runs of zeros
+    // that need to be padded back in when printing. Parsing only splits
+    // strings of more than 40000 digits.
+    for (uint32_t digits : {511u, 512u, 513u, 1500u, 4100u, 40000u, 40001u, 65537u}) {
+        bitwidth_t bits = bitwidth_t(ceil(digits * log2(10.0)));
+        std::string nines(digits, '9');
+        SVInt value = SVInt::fromString(std::to_string(bits) + "'d" + nines);
+        SVInt expected = SVInt(bits, 10, false).pow(SVInt(32, digits, false)) -
+                         SVInt(bits, 1, false);
+        CHECK(value == expected);
+        CHECK(value.toString(LiteralBase::Decimal, false, SVInt::MAX_BITS) == nines);
+        CHECK((value + SVInt(bits, 1, false)).toString(LiteralBase::Decimal, false,
+                                                       SVInt::MAX_BITS) ==
+              "1" + std::string(digits, '0'));
+    }
+
+    std::string text = "1" + std::string(600, '0') + "123" + std::string(1100, '0') + "7" +
+                       std::string(3000, '0') + "42";
+    auto roundTrip = [](const std::string& str, LiteralBase base) {
+        return SVInt::fromString(str).toString(base, true, SVInt::MAX_BITS) == str;
+    };
+    CHECK(roundTrip("20000'd" + text, LiteralBase::Decimal));
+
+    text = "3" + std::string(20000, '0') + "5" + std::string(32767, '0') + "1";
+    CHECK(roundTrip("180000'd" + text, LiteralBase::Decimal));
+
+    // Sized decimal literals that overflow get truncated from the left.
+    CHECK("70'd1234567890123456789012345678901234567890"_si == "70'h38acbc5f96ce3f0ad2"_si);
+
+    SVInt pow2 = SVInt(100001, 1, false).shl(100000);
+    CHECK(pow2.toString(LiteralBase::Hex, false, SVInt::MAX_BITS) ==
+          "1" + std::string(25000, '0'));
+    CHECK(pow2.toString(LiteralBase::Octal, false, SVInt::MAX_BITS) ==
+          "2" + std::string(33333, '0'));
+
+    CHECK(roundTrip("9001'h" + std::string(700, 'f') + "x" + std::string(800, '0') + "z5",
+                    LiteralBase::Hex));
+    CHECK(roundTrip("9001'o" + std::string(1000, '7') + "x" + std::string(900, '0') + "z5",
+                    LiteralBase::Octal));
+}
+
 TEST_CASE("Comparison") {
     CHECK(SVInt(9000) == SVInt(1024, 9000, false));
     CHECK(SVInt(-4) == -4);
@@ -431,6 +476,41 @@ TEST_CASE("Division") {
     testDiv("1024'd19"_si.shl(811), "1024'd4356013"_si, "1024'd1"_si);
 }
 
+TEST_CASE("Wide multiplication and division") {
+    // Karatsuba multiplication and recursive division only kick in
+    // for values that are dozens of words wide.
+    const bitwidth_t width = 16384;
+    auto ones = [&](bitwidth_t bits) {
+        return SVInt(width, 1, false).shl(bits) - SVInt(width, 1, false);
+    };
+    auto pattern = [&](uint32_t words, uint64_t seed) {
+        SVInt result(width, 0, false);
+        for (uint32_t i = 0; i < words; i++) {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            result = result.shl(64) | SVInt(width, seed, false);
+        }
+        return result;
+    };
+
+    auto k = ones(2893);
+    CHECK(k * k == SVInt(width, 1, false).shl(5786) - SVInt(width, 1, false).shl(2894) +
+                       SVInt(width, 1, false));
+
+    auto a = pattern(70, 1);
+    auto b = pattern(45, 2);
+    auto c = pattern(20, 3);
+    testDiv(a, b, c);
+    testDiv(a, pattern(60, 4), c);
+    testDiv(ones(4500), ones(3000), ones(1500));
+    testDiv(a, "16384'd3"_si, "16384'd2"_si);
+
+    // All ones quotients stress the corrections of the quotient estimates.
+    auto q = (b.shl(2560) - SVInt(width, 1, false)) / b;
+    auto r = (b.shl(2560) - SVInt(width, 1, false)) % b;
+    CHECK(q == ones(2560));
+    CHECK(r == b - SVInt(width, 1, false));
+}
+
 TEST_CASE("Power") {
     // 0**y
     CHECK(SVInt::Zero.pow(SVInt::Zero) == 1);
@@ -613,6 +693,138 @@ TEST_CASE("Slicing") {
           "215'h728560c56c16d0b0be23da38038624767ffffffffffffffffffffd");
 }
 
+TEST_CASE("Inline storage transitions") {
+    // 2-state values up to 128 bits and 4-state values up to 64 bits are stored
+    // inline; values need to move back and forth as they gain and lose unknowns.
+    SVInt v1 = "128'hfedcba9876543210_0123456789abcdef"_si;
+    v1.set(3, 0, "4'bx01z"_si);
+    CHECK_THAT(v1.slice(3, 0), exactlyEquals("4'bx01z"_si));
+    CHECK(v1.slice(127, 4) == "124'hfedcba9876543210_0123456789abcde"_si);
+
+    v1.flattenUnknowns();
+    CHECK(v1 == "128'hfedcba9876543210_0123456789abcde2"_si);
+
+    SVInt v2 = "65'h1_0000000000000001"_si;
+    v2.set(64, 64, "1'bz"_si);
+    CHECK_THAT(v2.slice(64, 64), exactlyEquals("1'bz"_si));
+    CHECK(v2.slice(63, 0) == 1);
+    v2.set(64, 64, "1'b1"_si);
+    CHECK_THAT(v2, exactlyEquals("65'h1_0000000000000001"_si));
+
+    SVInt v3 = "64'hxxxxxxxx_12345678"_si;
+    CHECK_THAT(v3 | "64'hffffffff_00000000"_si, exactlyEquals("64'hffffffff_12345678"_si));
+    CHECK_THAT(v3.zext(65), exactlyEquals("65'h0_xxxxxxxx_12345678"_si));
+    SVInt pair[] = {v3, v3};
+    CHECK_THAT(SVInt::concat(pair).slice(95, 32), exactlyEquals("64'h12345678_xxxxxxxx"_si));
+
+    SVInt v4 = v3;
+    v4 = "129'h1_00000000_00000000_00000000_00000000"_si;
+    CHECK(v4.countLeadingZeros() == 0);
+    v4 = std::move(v3);
+    CHECK_THAT(v4, exactlyEquals("64'hxxxxxxxx_12345678"_si));
+    v4 = v1;
+    CHECK(v4 == v1);
+}
+
+static SVInt makePatternValue(bitwidth_t width, uint32_t seed, bool unknowns) {
+    // Builds a hex literal with a deterministic mix of digits, optionally including
+    // unknown digits, so that every word of the value has something interesting in it.
+    const char* digits = unknowns ? "0123456789abcdefxzf0" : "0123456789abcdef";
+    const uint32_t numDigits = unknowns ? 20 : 16;
+
+    std::string text = std::to_string(width) + "'h";
+    for (bitwidth_t i = 0; i < width; i += 4) {
+        seed = seed * 1103515245 + 12345;
+        text += digits[(seed >> 16) % numDigits];
+    }
+    return SVInt::fromString(text);
+}
+
+TEST_CASE("Vectorized bitwise operations match scalar") {
+    auto original = getSimdLevel();
+
+    auto runAll = [](const SVInt& a, const SVInt& b) {
+        std::vector<SVInt> results;
+        results.push_back(a & b);
+        results.push_back(a | b);
+        results.push_back(a ^ b);
+        results.push_back(a.xnor(b));
+        results.push_back(~a);
+        results.push_back(SVInt(a.reductionAnd()));
+        results.push_back(SVInt(a.reductionOr()));
+        results.push_back(SVInt(a.reductionXor()));
+        results.push_back(SVInt(a == b));
+        results.push_back(SVInt(a == a));
+        for (bitwidth_t amount : {1u, 7u, 63u, 64u, 65u, 130u}) {
+            results.push_back(a.shl(amount));
+            results.push_back(a.lshr(amount));
+            results.push_back(a.ashr(amount));
+        }
+        return results;
+    };
+
+    for (bitwidth_t width : {65u, 200u, 257u, 1000u, 4099u}) {
+        for (bool unknowns : {false, true}) {
+            SVInt a = makePatternValue(width, width, unknowns);
+            a.setSigned(true);
+
+            // Pair the value with one of the same kind and one of the other kind
+            // so that both the 2-state and 4-state paths of each kernel are hit.
+            for (const SVInt& b : {makePatternValue(width, width * 3 + 1, unknowns),
+                                   makePatternValue(width, width + 7, !unknowns)}) {
+                setSimdLevel(SimdLevel::Scalar);
+                auto expected = runAll(a, b);
+
+                for (auto level : {SimdLevel::SSE2, SimdLevel::AVX2}) {
+                    setSimdLevel(level);
+                    auto results = runAll(a, b);
+                    REQUIRE(results.size() == expected.size());
+                    for (size_t i = 0; i < results.size(); i++)
+                        CHECK_THAT(results[i], exactlyEquals(expected[i]));
+                }
+            }
+        }
+    }
+
+    setSimdLevel(original);
+}
+
+TEST_CASE("SVInt bitwise throughput", "[.][benchmark]") {
+    // Wide 4-state bitwise operations at each SIMD level.
+    auto original = getSimdLevel();
+    for (bitwidth_t width : {1024u, 16384u, 262144u}) {
+        SVInt a = makePatternValue(width, 1, true);
+        SVInt b = makePatternValue(width, 2, true);
+        for (auto level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+            setSimdLevel(level);
+            if (getSimdLevel() != level)
+                continue;
+
+            auto suffix = std::to_string(width) + " bits, SIMD level " +
+                          std::to_string(int(level));
+            BENCHMARK("And " + suffix) { return a & b; };
+            BENCHMARK("Not " + suffix) { return ~a; };
+            BENCHMARK("Reduction or " + suffix) { return a.reductionOr(); };
+            BENCHMARK("Equality " + suffix) { return a == b; };
+            BENCHMARK("Shift right " + suffix) { return a.lshr(13); };
+        }
+    }
+    setSimdLevel(original);
+}
+
+TEST_CASE("SVInt multiplication and division throughput", "[.][benchmark]") {
+    // Multiplication and division from a single word up to widths where
+    // Karatsuba and recursive division do most of the work.
+    for (bitwidth_t width : {64u, 256u, 1024u, 4096u, 16384u, 65536u}) {
+        SVInt a = makePatternValue(width, 1, false);
+        SVInt b = makePatternValue(width / 2, 2, false).zext(width);
+
+        auto suffix = std::to_string(width) + " bits";
+        BENCHMARK("Multiply " + suffix) { return a * a; };
+        BENCHMARK("Divide " + suffix) { return a / b; };
+    }
+}
+
 TEST_CASE("SVInt misc functions") {
     CHECK("100'b111"_si.countLeadingZeros() == 97);
     CHECK("128'hffff000000000000ffff000000000000"_si.countLeadingOnes() == 16);
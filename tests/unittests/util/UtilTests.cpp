@@ -5,6 +5,7 @@
 #include <catch2/matchers/catch_matchers_string.hpp>
 #include <sstream>
 
+#include "slang/util/BKTree.h"
 #include "slang/util/Random.h"
 #include "slang/util/ThreadPool.h"
 #include "slang/util/TimeTrace.h"
@@ -64,3 +65,37 @@ TEST_CASE("TimeTrace tests") {
     std::ostringstream sstr;
     TimeTrace::write(sstr);
 }
+
+TEST_CASE("BKTree finds approximate matches") {
+    std::vector<std::string> words = {"alpha", "alpine", "beta", "better", "bet",
+                                      "gamma", "game",   "alpha", "delta", "zeta"};
+
+    BKTree tree;
+    CHECK(tree.empty());
+    for (auto& word : words)
+        tree.add(word);
+    CHECK(tree.size() == words.size());
+
+    // Compare the results against a brute force search.
+    for (std::string_view query : {"alpa", "bet", "gama", "xyz", "delta", ""}) {
+        for (int maxDistance = 0; maxDistance <= 3; maxDistance++) {
+            SmallVector<BKTree::Match> matches;
+            tree.find(query, maxDistance, matches);
+
+            std::vector<uint32_t> expected;
+            for (uint32_t i = 0; i < words.size(); i++) {
+                if (editDistance(words[i], query) <= maxDistance)
+                    expected.push_back(i);
+            }
+
+            std::vector<uint32_t> actual;
+            for (auto& match : matches) {
+                CHECK(match.distance == editDistance(words[match.index], query));
+                actual.push_back(match.index);
+            }
+
+            std::ranges::sort(actual);
+            CHECK(actual == expected);
+        }
+    }
+}
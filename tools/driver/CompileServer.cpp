@@ -0,0 +1,443 @@
+//------------------------------------------------------------------------------
+// CompileServer.cpp
+// Persistent compile server mode for the driver program
+//
+// SPDX-FileCopyrightText: Michael Popoloski
+// SPDX-License-Identifier: MIT
+//------------------------------------------------------------------------------
+#include "CompileServer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fmt/core.h>
+#include <vector>
+
+#include "slang/util/OS.h"
+#include "slang/util/ScopeGuard.h"
+#include "slang/util/TimeTrace.h"
+
+#if !defined(_WIN32)
+#    include <cerrno>
+#    include <csignal>
+#    include <sys/socket.h>
+#    include <sys/stat.h>
+#    include <sys/un.h>
+#    include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace slang::driver {
+
+static constexpr std::string_view ConnectOption = "--connect"sv;
+
+#if !defined(_WIN32)
+
+// Each request starts with this tag, sent along with the client's standard
+// stream file descriptors. It's followed by the number of strings in the
+// request and then each string (the working directory followed by the
+// arguments) as a length and its bytes. The server replies with the exit
+// code once the request completes.
+static constexpr uint32_t RequestTag = 0x736c6e67;
+static constexpr int NumStreams = 3;
+
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static bool writeAll(int fd, const void* data, size_t size) {
+    auto ptr = static_cast<const char*>(data);
+    while (size > 0) {
+        auto n = ::write(fd, ptr, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+
+        ptr += n;
+        size -= size_t(n);
+    }
+    return true;
+}
+
+static bool readAll(int fd, void* data, size_t size) {
+    auto ptr = static_cast<char*>(data);
+    while (size > 0) {
+        auto n = ::read(fd, ptr, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+
+        ptr += n;
+        size -= size_t(n);
+    }
+    return true;
+}
+
+static bool sendTagAndStreams(int fd) {
+    uint32_t tag = RequestTag;
+    iovec iov{&tag, sizeof(tag)};
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * NumStreams)] = {};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    auto cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * NumStreams);
+
+    int fds[NumStreams] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    ssize_t n;
+    do {
+        n = ::sendmsg(fd, &msg, 0);
+    } while (n < 0 && errno == EINTR);
+    return n == ssize_t(sizeof(tag));
+}
+
+static bool receiveTagAndStreams(int fd, int (&fds)[NumStreams]) {
+    uint32_t tag = 0;
+    iovec iov{&tag, sizeof(tag)};
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * NumStreams)] = {};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t n;
+    do {
+        n = ::recvmsg(fd, &msg, 0);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0)
+        return false;
+
+    // Collect every descriptor that was passed to us, no matter how it was
+    // sent, so that all of them get closed if the request isn't what we expect.
+    // Otherwise a misbehaving client could leak descriptors into the server.
+    std::vector<int> received;
+    int numMessages = 0;
+    for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+            continue;
+
+        numMessages++;
+        size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (size_t i = 0; i < count; i++) {
+            int stream;
+            memcpy(&stream, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+            received.push_back(stream);
+        }
+    }
+
+    if (n != ssize_t(sizeof(tag)) || tag != RequestTag || (msg.msg_flags & MSG_CTRUNC) ||
+        numMessages != 1 || received.size() != size_t(NumStreams)) {
+        for (int stream : received)
+            ::close(stream);
+        return false;
+    }
+
+    std::ranges::copy(received, fds);
+    return true;
+}
+
+static bool sendStrings(int fd, std::span<const std::string> strings) {
+    std::string buffer;
+    auto append = [&](uint32_t value) {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+
+    append(uint32_t(strings.size()));
+    for (auto& str : strings) {
+        append(uint32_t(str.size()));
+        buffer += str;
+    }
+    return writeAll(fd, buffer.data(), buffer.size());
+}
+
+static bool receiveStrings(int fd, std::vector<std::string>& strings) {
+    // Guard against bogus requests asking for absurd amounts of memory.
+    static constexpr uint32_t MaxStrings = 1u << 20;
+    static constexpr uint32_t MaxLength = 1u << 24;
+
+    uint32_t count;
+    if (!readAll(fd, &count, sizeof(count)) || count == 0 || count > MaxStrings)
+        return false;
+
+    strings.resize(count);
+    for (auto& str : strings) {
+        uint32_t length;
+        if (!readAll(fd, &length, sizeof(length)) || length > MaxLength)
+            return false;
+
+        str.resize(length);
+        if (!readAll(fd, str.data(), length))
+            return false;
+    }
+    return true;
+}
+
+static bool makeAddress(const std::string& socketPath, sockaddr_un& addr) {
+    addr = {};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(addr.sun_path))
+        return false;
+
+    memcpy(addr.sun_path, socketPath.data(), socketPath.size());
+    return true;
+}
+
+// Redirects the process's standard streams to the given file descriptors
+// for as long as the object lives.
+class StreamRedirect {
+public:
+    explicit StreamRedirect(const int (&fds)[NumStreams]) {
+        fflush(stdout);
+        fflush(stderr);
+        for (int i = 0; i < NumStreams; i++) {
+            saved[i] = ::dup(i);
+            ::dup2(fds[i], i);
+        }
+        clearerr(stdin);
+    }
+
+    ~StreamRedirect() {
+        fflush(stdout);
+        fflush(stderr);
+        for (int i = 0; i < NumStreams; i++) {
+            ::dup2(saved[i], i);
+            ::close(saved[i]);
+        }
+        clearerr(stdin);
+    }
+
+private:
+    int saved[NumStreams];
+};
+
+static void handleRequest(int conn, CompileSession& session, std::string& sessionKey,
+                          CompileRequestHandler handler) {
+    int fds[NumStreams];
+    if (!receiveTagAndStreams(conn, fds))
+        return;
+
+    auto closeStreams = ScopeGuard([&fds] {
+        for (int stream : fds)
+            ::close(stream);
+    });
+
+    // The first string is the client's working directory;
+    // the rest are its arguments, starting with the program name.
+    std::vector<std::string> strings;
+    if (!receiveStrings(conn, strings) || strings.size() < 2)
+        return;
+
+    int32_t result;
+    {
+        StreamRedirect redirect(fds);
+
+        std::error_code ec;
+        fs::current_path(strings[0], ec);
+        if (ec) {
+            OS::printE(fmt::format("error: compile server can't change to directory '{}': {}\n",
+                                   strings[0], ec.message()));
+            result = 1;
+        }
+        else {
+            // Everything that was loaded before is only valid for an identical
+            // working directory and command line; anything else starts over.
+            std::string key;
+            for (auto& str : strings) {
+                key += str;
+                key += '\0';
+            }
+
+            if (key != sessionKey) {
+                session.previousCompilation.reset();
+                session.treeCache = std::make_shared<SyntaxTreeCache>();
+                session.sourceManager = std::make_unique<SourceManager>();
+                sessionKey = std::move(key);
+            }
+            else {
+                auto changed = session.sourceManager->invalidateChangedFiles();
+                session.treeCache->invalidate(changed);
+            }
+
+            std::vector<const char*> args;
+            for (size_t i = 1; i < strings.size(); i++)
+                args.push_back(strings[i].c_str());
+
+            // Colors are decided per request based on the client's streams.
+            OS::setStdoutColorsEnabled(false);
+            OS::setStderrColorsEnabled(false);
+
+            auto previous = session.previousCompilation.get();
+            result = handler(args, session);
+
+            // The tree cache has already dropped every tree parsed from the old
+            // contents of changed files, so once the compilation built from them
+            // is gone too, nothing refers to those contents anymore.
+            if (!session.previousCompilation || session.previousCompilation.get() != previous)
+                session.sourceManager->releaseRetiredFiles();
+
+            // A request can exit without writing out its time trace;
+            // make sure it doesn't leak into the next one.
+            TimeTrace::reset();
+        }
+    }
+
+    writeAll(conn, &result, sizeof(result));
+}
+
+int runCompileServer(const std::string& socketPath, CompileRequestHandler handler) {
+    sockaddr_un addr;
+    if (!makeAddress(socketPath, addr)) {
+        OS::printE(fmt::format("error: invalid compile server socket path '{}'\n", socketPath));
+        return 1;
+    }
+
+    int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        OS::printE(fmt::format("error: unable to create socket: {}\n", strerror(errno)));
+        return 1;
+    }
+
+    auto closeListener = ScopeGuard([listenFd] { ::close(listenFd); });
+
+    // A server that didn't shut down cleanly leaves its socket file behind,
+    // which would make binding fail. Anything that isn't a socket is left alone.
+    struct stat st;
+    if (::lstat(socketPath.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+        ::unlink(socketPath.c_str());
+
+    // Only the user running the server is allowed to connect to it.
+    auto oldMask = ::umask(0077);
+    int bindResult = ::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    ::umask(oldMask);
+
+    if (bindResult != 0 || ::listen(listenFd, 16) != 0) {
+        OS::printE(fmt::format("error: unable to listen on '{}': {}\n", socketPath,
+                               strerror(errno)));
+        return 1;
+    }
+
+    auto removeSocket = ScopeGuard([&socketPath] { ::unlink(socketPath.c_str()); });
+
+    // Interrupting the server should remove the socket on the way out, so
+    // these handlers don't restart the blocking accept below. Writes to
+    // clients that have gone away shouldn't take the server down either.
+    struct sigaction action = {};
+    action.sa_handler = [](int) { stopRequested = 1; };
+    sigemptyset(&action.sa_mask);
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+    ::signal(SIGPIPE, SIG_IGN);
+
+    OS::print(fmt::format("slang compile server listening on '{}'\n", socketPath));
+    fflush(stdout);
+
+    CompileSession session;
+    std::string sessionKey;
+    while (!stopRequested) {
+        int conn = ::accept(listenFd, nullptr, nullptr);
+        if (conn < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+
+            OS::printE(fmt::format("error: compile server failed to accept a connection: {}\n",
+                                   strerror(errno)));
+            return 1;
+        }
+
+        handleRequest(conn, session, sessionKey, handler);
+        ::close(conn);
+    }
+
+    return 0;
+}
+
+static std::optional<int> runCompileClient(const std::string& socketPath,
+                                           std::vector<std::string>&& args) {
+    sockaddr_un addr;
+    if (!makeAddress(socketPath, addr))
+        return std::nullopt;
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return std::nullopt;
+
+    auto closeSocket = ScopeGuard([fd] { ::close(fd); });
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+        return std::nullopt;
+
+    std::error_code ec;
+    args.insert(args.begin(), fs::current_path(ec).native());
+    if (ec)
+        return std::nullopt;
+
+    // Flush anything we've buffered so far, since the server
+    // is about to write directly to the same streams.
+    fflush(stdout);
+    fflush(stderr);
+
+    if (!sendTagAndStreams(fd) || !sendStrings(fd, args))
+        return std::nullopt;
+
+    int32_t result;
+    if (!readAll(fd, &result, sizeof(result))) {
+        OS::printE("error: lost connection to the compile server\n");
+        return 1;
+    }
+    return result;
+}
+
+#else
+
+int runCompileServer(const std::string&, CompileRequestHandler) {
+    OS::printE("error: compile server mode is not supported on this platform\n");
+    return 1;
+}
+
+static std::optional<int> runCompileClient(const std::string&, std::vector<std::string>&&) {
+    return std::nullopt;
+}
+
+#endif
+
+std::optional<int> tryRunCompileClient(int argc, const char* const argv[]) {
+    std::optional<std::string> socketPath;
+    std::vector<std::string> args;
+    for (int i = 0; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (i > 0 && arg == ConnectOption && i + 1 < argc) {
+            socketPath = argv[++i];
+        }
+        else if (i > 0 && arg.starts_with(ConnectOption) && arg.size() > ConnectOption.size() &&
+                 arg[ConnectOption.size()] == '=') {
+            socketPath = arg.substr(ConnectOption.size() + 1);
+        }
+        else {
+            args.emplace_back(arg);
+        }
+    }
+
+    if (!socketPath)
+        return std::nullopt;
+
+    auto result = runCompileClient(*socketPath, std::move(args));
+    if (!result) {
+        OS::printE(fmt::format("warning: unable to connect to compile server at '{}'; "
+                               "compiling locally\n",
+                               *socketPath));
+    }
+    return result;
+}
+
+} // namespace slang::driver
@@ -0,0 +1,61 @@
+//------------------------------------------------------------------------------
+//! @file CompileServer.h
+//! @brief Persistent compile server mode for the driver program
+//
+// SPDX-FileCopyrightText: Michael Popoloski
+// SPDX-License-Identifier: MIT
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "slang/ast/Compilation.h"
+#include "slang/driver/SourceLoader.h"
+#include "slang/text/SourceManager.h"
+#include "slang/util/Function.h"
+
+namespace slang::driver {
+
+/// State that the compile server keeps warm between requests
+/// that have the same working directory and command line.
+struct CompileSession {
+    /// The source manager that holds all files loaded so far.
+    std::unique_ptr<SourceManager> sourceManager;
+
+    /// Syntax trees of files that haven't changed since they were parsed.
+    std::shared_ptr<SyntaxTreeCache> treeCache;
+
+    /// The compilation from the previous request, whose elaboration
+    /// results can be reused by the next one.
+    std::unique_ptr<ast::Compilation> previousCompilation;
+};
+
+/// Runs a single compile request with the given command line arguments
+/// (including the program name) against the given session.
+/// @returns the exit code of the request.
+using CompileRequestHandler = function_ref<int(std::span<const char* const>, CompileSession&)>;
+
+/// @brief Runs a compile server that listens on the Unix domain socket
+/// at the given path until the process is interrupted or terminated.
+///
+/// Requests are handled one at a time by invoking @a handler with the
+/// client's standard streams and working directory in place of the
+/// server's own. Any stale socket file at the path is removed first.
+/// @returns the exit code for the server process.
+int runCompileServer(const std::string& socketPath, CompileRequestHandler handler);
+
+/// @brief Forwards the given command line to a compile server, if it
+/// contains a `--connect <socket>` option.
+///
+/// The option is removed from the forwarded arguments. The client's
+/// standard streams are passed to the server, which writes its output
+/// directly to them.
+/// @returns the exit code of the request, or std::nullopt if the command
+/// line doesn't ask for a server or the server can't be reached, in
+/// which case the caller should compile locally instead.
+std::optional<int> tryRunCompileClient(int argc, const char* const argv[]);
+
+} // namespace slang::driver
@@ -9,6 +9,8 @@
 #include <fstream>
 #include <iostream>
 
+#include "CompileServer.h"
+
 #include "slang/ast/ASTSerializer.h"
 #include "slang/ast/Compilation.h"
 #include "slang/ast/symbols/CompilationUnitSymbols.h"
@@ -55,12 +57,19 @@ void printJson(Compilation& compilation, const std::string& fileName,
 }
 
 template<typename TArgs>
-int driverMain(int argc, TArgs argv) {
+int driverMain(int argc, TArgs argv, CompileSession* session = nullptr) {
     SLANG_TRY {
         OS::setupConsole();
         OS::tryEnableColors();
 
-        Driver driver;
+        // When serving a compile request, files and parsed trees are shared with
+        // earlier requests, so the cache has to be in place before any get added.
+        auto driverPtr = session ? std::make_unique<Driver>(*session->sourceManager)
+                                 : std::make_unique<Driver>();
+        auto& driver = *driverPtr;
+        if (session)
+            driver.sourceLoader.setTreeCache(session->treeCache);
+
         driver.addStandardArgs();
 
         std::optional<bool> showHelp;
@@ -112,6 +121,17 @@ int driverMain(int argc, TArgs argv) {
                            "the results to the given file in Chrome Event Tracing JSON format",
                            "<path>");
 
+        std::optional<std::string> compileServer;
+        std::optional<std::string> connectPath;
+        driver.cmdLine.add("--compile-server", compileServer,
+                           "Run as a persistent compile server that listens for requests on the "
+                           "given Unix domain socket, keeping loaded files warm between them",
+                           "<socket>");
+        driver.cmdLine.add("--connect", connectPath,
+                           "Send this compile request to the compile server listening on the "
+                           "given socket, or compile locally if it can't be reached",
+                           "<socket>");
+
         if (!driver.parseCommandLine(argc, argv))
             return 1;
 
@@ -128,6 +148,25 @@ int driverMain(int argc, TArgs argv) {
             return 0;
         }
 
+        if (compileServer) {
+            if (session) {
+                OS::printE(fg(driver.diagClient->errorColor), "error: ");
+                OS::printE("a compile request can't start another compile server\n");
+                return 1;
+            }
+
+            return runCompileServer(*compileServer, [](std::span<const char* const> args,
+                                                       CompileSession& session) {
+                return driverMain(int(args.size()), args.data(), &session);
+            });
+        }
+
+        // The server holds on to loaded files across requests, and a file that
+        // gets truncated on disk while it's mapped would crash the whole server,
+        // so files are always read into memory when serving requests.
+        if (session)
+            driver.options.memoryMapFiles = false;
+
         if (!driver.processOptions())
             return 2;
 
@@ -165,10 +204,17 @@ int driverMain(int argc, TArgs argv) {
                 {
                     TimeTraceScope timeScope("elaboration"sv, ""sv);
                     auto compilation = driver.createCompilation();
+                    if (session && session->previousCompilation)
+                        compilation->reuseElaboration(*session->previousCompilation);
+
                     ok &= driver.reportCompilation(*compilation, quiet == true);
                     if (astJsonFile)
                         printJson(*compilation, *astJsonFile, astJsonScopes,
                                   includeSourceInfo == true);
+
+                    // Only parallel elaboration records results that can be reused.
+                    if (session && driver.options.parallelElaboration == true)
+                        session->previousCompilation = std::move(compilation);
                 }
             }
         }
@@ -201,6 +247,10 @@ int driverMain(int argc, TArgs argv) {
 #ifndef FUZZ_TARGET
 
 int main(int argc, char** argv) {
+    // Requests for a compile server are forwarded before doing any work locally.
+    if (auto result = tryRunCompileClient(argc, argv))
+        return *result;
+
     return driverMain(argc, argv);
 }
 